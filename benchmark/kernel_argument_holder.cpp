@@ -0,0 +1,99 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <executor_kernel_arg.h>
+#include <expr_evaluator.h>
+#include <fusion.h>
+#include <ir/all_nodes.h>
+
+#include <benchmark/benchmark.h>
+
+#include <c10/util/irange.h>
+
+#include <benchmark/utils.h>
+#include <test/utils.h>
+
+using namespace nvfuser;
+
+// Measures the host cost of the KernelArgumentHolder for a growing number of
+// arguments: creating it from the inputs, copying it, as is done for every
+// segment and every compilation, and flattening a copy into the launch
+// buffer.
+
+static std::vector<c10::IValue> makeInputs(int64_t num_args) {
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> inputs;
+  inputs.reserve(num_args);
+  for (auto i : c10::irange(num_args)) {
+    (void)i;
+    inputs.emplace_back(at::randn({128, 64}, options));
+  }
+  return inputs;
+}
+
+static void KernelArgumentHolder_Create(benchmark::State& benchmark_state) {
+  auto inputs = makeInputs(benchmark_state.range(0));
+  for (auto _ : benchmark_state) {
+    auto args = KernelArgumentHolder::createKernelArgumentHolder(inputs);
+    benchmark::DoNotOptimize(args.size());
+  }
+  benchmark_state.SetItemsProcessed(
+      benchmark_state.iterations() * benchmark_state.range(0));
+}
+
+static void KernelArgumentHolder_Copy(benchmark::State& benchmark_state) {
+  auto inputs = makeInputs(benchmark_state.range(0));
+  auto args = KernelArgumentHolder::createKernelArgumentHolder(inputs);
+  for (auto _ : benchmark_state) {
+    KernelArgumentHolder copy(args);
+    benchmark::DoNotOptimize(copy.size());
+  }
+  benchmark_state.SetItemsProcessed(
+      benchmark_state.iterations() * benchmark_state.range(0));
+}
+
+static void KernelArgumentHolder_CopyAndGetBuffer(
+    benchmark::State& benchmark_state) {
+  const auto num_args = benchmark_state.range(0);
+  auto inputs = makeInputs(num_args);
+  auto args = KernelArgumentHolder::createKernelArgumentHolder(inputs);
+
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+  std::vector<TensorView*> tvs;
+  tvs.reserve(num_args);
+  for (auto i : c10::irange(num_args)) {
+    (void)i;
+    auto tv = makeSymbolicTensor(2);
+    fusion.addInput(tv);
+    tvs.push_back(tv);
+  }
+  ExpressionEvaluator eval;
+
+  for (auto _ : benchmark_state) {
+    KernelArgumentHolder copy(args);
+    benchmark::DoNotOptimize(copy.getBuffer(PrimDataType::Int, tvs, eval));
+  }
+  benchmark_state.SetItemsProcessed(benchmark_state.iterations() * num_args);
+}
+
+//------------------------------------------------------------------------------
+
+BENCHMARK(KernelArgumentHolder_Create)
+    ->RangeMultiplier(2)
+    ->Range(1, 200)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(KernelArgumentHolder_Copy)
+    ->RangeMultiplier(2)
+    ->Range(1, 200)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(KernelArgumentHolder_CopyAndGetBuffer)
+    ->RangeMultiplier(2)
+    ->Range(1, 200)
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,109 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <executor.h>
+#include <fusion.h>
+#include <inlining.h>
+#include <ir/all_nodes.h>
+#include <ir/builder.h>
+#include <maxinfo_propagator.h>
+#include <ops/all_ops.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cuda_runtime.h>
+
+#include <benchmark/utils.h>
+#include <test/utils.h>
+
+using namespace nvfuser;
+
+// Measures the NVRTC compile time of a structured kernel with the pruned
+// preamble (only the runtime modules the kernel uses) versus the full
+// preamble. The size of the structured code is reported as a counter.
+
+static void compileStructuredCode(
+    benchmark::State& benchmark_state,
+    Fusion* fusion,
+    const std::vector<c10::IValue>& aten_inputs) {
+  const bool prune_preamble = benchmark_state.range(0);
+
+  FusionExecutor fe;
+  fe.compileFusion(fusion, aten_inputs);
+
+  const auto code = prune_preamble
+      ? fe.getStructuredCode()
+      : fe.getStructuredCode(fe.kernelString(), fe.kernel()->indexType());
+  const auto kernel_name = "CudaCodeGen::" + fe.kernelName();
+
+  for (auto _ : benchmark_state) {
+    FusionExecutor rtc_fe;
+    rtc_fe.compileRtc(code, kernel_name, true, fe.kernel()->indexType());
+  }
+
+  benchmark_state.counters["code_bytes"] = (double)code.size();
+}
+
+static void KernelPreamble_Pointwise(benchmark::State& benchmark_state) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto tv0 = makeSymbolicTensor(2);
+  auto tv1 = makeSymbolicTensor(2);
+  fusion.addInput(tv0);
+  fusion.addInput(tv1);
+  auto tv2 = relu(add(tv0, tv1));
+  fusion.addOutput(tv2);
+
+  tv2->merge(0);
+  tv2->split(0, 128);
+  TransformPropagatorWithCheck propagator(tv2);
+  MaxRootDomainInfoSpanningTree(tv2).traverse(&propagator);
+  tv2->axis(0)->parallelize(ParallelType::BIDx);
+  tv2->axis(1)->parallelize(ParallelType::TIDx);
+  inlineMost();
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs = {
+      at::randn({1024, 1024}, options), at::randn({1024, 1024}, options)};
+
+  compileStructuredCode(benchmark_state, &fusion, aten_inputs);
+}
+
+static void KernelPreamble_GridReduction(benchmark::State& benchmark_state) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion.addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  fusion.addOutput(tv1);
+
+  tv1->split(1, 128);
+  tv1->axis(0)->parallelize(ParallelType::BIDy);
+  tv1->axis(1)->parallelize(ParallelType::BIDx);
+  tv1->axis(2)->parallelize(ParallelType::TIDx);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs = {at::randn({128, 4096}, options)};
+
+  compileStructuredCode(benchmark_state, &fusion, aten_inputs);
+}
+
+//------------------------------------------------------------------------------
+
+BENCHMARK(KernelPreamble_Pointwise)
+    ->ArgName("pruned")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(KernelPreamble_GridReduction)
+    ->ArgName("pruned")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond);
@@ -9,6 +9,7 @@
 #include <ir/all_nodes.h>
 #include <ops/all_ops.h>
 #include <ops/arith.h>
+#include <scheduler/utils.h>
 
 #include <benchmark/benchmark.h>
 #include <benchmark/utils.h>
@@ -58,3 +59,33 @@ BENCHMARK_REGISTER_F(ManyPointwiseOpsFixture, ManyPointwiseOpsCopyTest)
     ->RangeMultiplier(2)
     ->Range(1 << 3, 1 << 12)
     ->Complexity();
+
+// Schedulers propagate the transformations of a reference tensor several
+// times while scheduling it
+BENCHMARK_DEFINE_F(ManyPointwiseOpsFixture, ManyPointwiseOpsPropagateTest)
+(benchmark::State& state) {
+  std::unique_ptr<Fusion> fcopy;
+  for (auto _ : state) {
+    state.PauseTiming();
+    fcopy = std::make_unique<Fusion>(*fusion_);
+    FusionGuard fg(fcopy.get());
+    auto reference = fcopy->outputs().at(0)->as<TensorView>();
+    state.ResumeTiming();
+
+    reference->merge(0);
+    scheduler_utils::transformPropagateToAllFrom(reference, -1);
+    reference->split(0, 128);
+    scheduler_utils::transformPropagateToAllFrom(reference, -1);
+    reference->split(0, 4);
+    scheduler_utils::transformPropagateToAllFrom(reference, -1);
+    reference->axis(0)->parallelize(ParallelType::BIDx);
+    reference->axis(2)->parallelize(ParallelType::TIDx);
+    scheduler_utils::parallelizeAllLike(reference);
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK_REGISTER_F(ManyPointwiseOpsFixture, ManyPointwiseOpsPropagateTest)
+    ->RangeMultiplier(2)
+    ->Range(1 << 3, 1 << 10)
+    ->Complexity();
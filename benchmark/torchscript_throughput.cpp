@@ -0,0 +1,88 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <benchmark/benchmark.h>
+
+#include <c10/cuda/CUDAFunctions.h>
+#include <c10/util/irange.h>
+#include <torch/csrc/jit/api/function_impl.h>
+#include <torch/csrc/jit/codegen/cuda/interface.h>
+#include <torch/csrc/jit/ir/irparser.h>
+#include <torch/torch.h>
+
+#include <benchmark/utils.h>
+#include <test/utils.h>
+
+#include <string>
+
+using namespace nvfuser;
+
+namespace {
+
+// Graphs using different alphas are different fusion groups
+std::string fusionIR(int64_t alpha) {
+  return R"IR(
+graph(%x.1 : Tensor,
+      %y.1 : Tensor):
+  %12 : NoneType = prim::Constant()
+  %11 : bool = prim::Constant[value=0]()
+  %9 : int = prim::Constant[value=1]()
+  %alpha : int = prim::Constant[value=)IR" +
+      std::to_string(alpha) + R"IR(]()
+  %3 : Tensor = aten::exp(%x.1)
+  %5 : Tensor = aten::relu(%y.1)
+  %6 : Tensor = aten::sin(%5)
+  %8 : Tensor = aten::add(%3, %6, %alpha)
+  %10 : int[] = prim::ListConstruct(%9)
+  %13 : Tensor = aten::sum(%8, %10, %11, %12)
+  return (%13)
+)IR";
+}
+
+} // namespace
+
+// Throughput of TorchScript functions run by several threads at once. Each
+// thread runs its own function, either all of the same fusion group, or each
+// of a different one.
+static void TorchScript_Throughput(
+    benchmark::State& benchmark_state,
+    bool distinct_fusions) {
+  torch::jit::fuser::cuda::setEnabled(true);
+
+  const int64_t alpha =
+      distinct_fusions ? (int64_t)benchmark_state.thread_index() + 1 : 1;
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(fusionIR(alpha), g.get());
+  torch::jit::GraphFunction fn("nvfuser_benchmark", g, nullptr);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor x = at::randn({128, 1024}, options);
+  at::Tensor y = at::randn({128, 1024}, options);
+
+  // Profiling runs and compilation (not included in the measurement)
+  for (auto i : c10::irange(5)) {
+    (void)i;
+    auto stack = createStack({x, y});
+    fn.run(stack);
+  }
+
+  for (auto _ : benchmark_state) {
+    auto stack = createStack({x, y});
+    fn.run(stack);
+  }
+  c10::cuda::device_synchronize();
+}
+
+BENCHMARK_CAPTURE(TorchScript_Throughput, SameFusion, false)
+    ->ThreadRange(1, 8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_CAPTURE(TorchScript_Throughput, DistinctFusions, true)
+    ->ThreadRange(1, 8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
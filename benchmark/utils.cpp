@@ -8,8 +8,12 @@
 #include <benchmark/utils.h>
 #include <c10/cuda/CUDACachingAllocator.h>
 #include <scheduler/all_schedulers.h>
+#include <scheduler/autotune.h>
+#include <scheduler/tuning_db.h>
 #include <test/utils.h>
 
+#include <filesystem>
+#include <iostream>
 #include <sstream>
 
 using namespace nvfuser;
@@ -137,11 +141,67 @@ std::string toString(LaunchParams lparams) {
   return ss.str();
 }
 
+namespace {
+
+//! Tunes the fusion of fusion_executor_cache for aten_inputs if
+//! PYTORCH_NVFUSER_BENCHMARK_AUTOTUNE is set to the path of a tuning
+//! database. Tuned parameters are added to the database, which is loaded
+//! first if it exists. Returns the executor cache to benchmark, which uses
+//! the tuned parameters.
+FusionExecutorCache* maybeAutotune(
+    FusionExecutorCache* fusion_executor_cache,
+    std::vector<c10::IValue>& aten_inputs) {
+  static const char* db_file =
+      std::getenv("PYTORCH_NVFUSER_BENCHMARK_AUTOTUNE");
+  if (db_file == nullptr) {
+    return fusion_executor_cache;
+  }
+  static bool db_loaded = false;
+  if (!db_loaded) {
+    if (std::filesystem::exists(db_file)) {
+      TuningDatabase::get().load(db_file);
+    }
+    db_loaded = true;
+  }
+
+  fusion_executor_cache->runFusionWithInputs(aten_inputs);
+  auto runtime = fusion_executor_cache->getMostRecentKernelRuntime();
+  if (runtime->isSegmented() &&
+      runtime->fusionSegments()->groups().size() > 1) {
+    std::cout << "Segmented fusions are not tuned" << std::endl;
+    return fusion_executor_cache;
+  }
+
+  KernelTimeTuningBackend backend;
+  auto report = autotuneFusion(
+      fusion_executor_cache->fusion(),
+      KernelArgumentHolder::createKernelArgumentHolder(aten_inputs),
+      backend);
+  std::cout << report.toString() << std::endl;
+  TuningDatabase::get().save(db_file);
+
+  // Heuristics of runtimes that were already created are not recomputed, so
+  // the tuned parameters are benchmarked with a new executor cache
+  static std::unordered_map<
+      FusionExecutorCache*,
+      std::unique_ptr<FusionExecutorCache>>
+      tuned_caches;
+  auto& tuned_cache = tuned_caches[fusion_executor_cache];
+  if (tuned_cache == nullptr) {
+    tuned_cache = std::make_unique<FusionExecutorCache>(
+        std::make_unique<Fusion>(*fusion_executor_cache->fusion()));
+  }
+  return tuned_cache.get();
+}
+
+} // namespace
+
 void runBenchmarkIterations(
     benchmark::State& benchmark_state,
     FusionExecutorCache* fusion_executor_cache,
     std::vector<c10::IValue>& aten_inputs) {
   c10::cuda::CUDACachingAllocator::emptyCache();
+  fusion_executor_cache = maybeAutotune(fusion_executor_cache, aten_inputs);
   fusion_executor_cache->runFusionWithInputs(aten_inputs);
   bool segmented =
       fusion_executor_cache->getMostRecentKernelRuntime()->isSegmented() &&
@@ -35,6 +35,11 @@ std::string toString(LaunchParams lparams);
 // Run benchmark iterations with provided inputs. If not segmented, report
 // kernel time from the runtime, as well as heuristic parameters. If segmented
 // use timers. Make sure to clear L2 between iterations.
+//
+// If PYTORCH_NVFUSER_BENCHMARK_AUTOTUNE is set to the path of a tuning
+// database, unsegmented fusions are tuned for the inputs first (see
+// scheduler/autotune.h), the tuned parameters are saved to the database, and
+// the tuned fusion is benchmarked.
 void runBenchmarkIterations(
     benchmark::State& benchmark_state,
     FusionExecutorCache* fusion_executor_cache,
@@ -143,24 +143,44 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
  public:
   static std::string generateKernelDefinition(
       const kir::Kernel* kernel,
-      const std::string& kernel_name) {
-    CudaKernelGenerator codegen(kernel);
+      const std::string& kernel_name,
+      RuntimeModules* used_modules,
+      bool device_function = false) {
+    CudaKernelGenerator codegen(kernel, device_function);
     codegen.genDeclaration(kernel_name);
     codegen.startBlock();
     codegen.genPrologue();
     codegen.genBody();
     codegen.endBlock();
     TORCH_CHECK(codegen.block_nest_level_ == 0);
+    if (used_modules != nullptr) {
+      used_modules->insert(
+          codegen.used_modules_.begin(), codegen.used_modules_.end());
+    }
     return codegen.code_.str();
   }
 
+  static std::vector<std::pair<std::string, std::string>> generateParameters(
+      const kir::Kernel* kernel) {
+    CudaKernelGenerator codegen(kernel);
+    return codegen.genParameters();
+  }
+
  private:
-  explicit CudaKernelGenerator(const kir::Kernel* kernel) : kernel_(kernel) {
+  explicit CudaKernelGenerator(
+      const kir::Kernel* kernel,
+      bool device_function = false)
+      : kernel_(kernel), device_function_(device_function) {
     initStringStreamFormat(code_);
   }
 
   using kir::ConstIrVisitor::handle;
 
+  //! Record that the generated code calls into the given runtime module
+  void requireModule(RuntimeModule module) {
+    used_modules_.insert(module);
+  }
+
   void initStringStreamFormat(std::stringstream& ss) {
     ss.imbue(std::locale("C"));
     ss << std::scientific;
@@ -185,13 +205,27 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
     }
   }
 
+  //! Block indices and grid dimensions are parameters of device functions,
+  //! as they run on a slice of the grid of the kernel that calls them
+  std::string genParallelName(const NamedScalar* ns) {
+    const auto ptype = ns->getParallelIndex().has_value()
+        ? ns->getParallelIndex().value()
+        : ns->getParallelDim().value();
+    if (!device_function_ || !isParallelTypeBlockDim(ptype)) {
+      return ns->name();
+    }
+    const auto& name = ns->name();
+    return (ns->getParallelIndex().has_value() ? "block_idx" : "grid_dim") +
+        name.substr(name.find('.'));
+  }
+
   std::string genVariableName(const Val* v) {
     if (auto ns = dynamic_cast<const NamedScalar*>(v)) {
       // dim3 components are unsigned int. Cast to signed integer to
       // support negative indexing
       if (ns->getParallelIndex().has_value() ||
           ns->getParallelDim().has_value()) {
-        return "((nvfuser_index_t)" + ns->name() + ")";
+        return "((nvfuser_index_t)" + genParallelName(ns) + ")";
       } else {
         return ns->name();
       }
@@ -222,11 +256,11 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   // Generates the kernel function declaration
-  void genDeclaration(const std::string& kernel_name) {
+  //! Type and name of each parameter of the kernel: inputs, outputs,
+  //! global buffers and the RNG state
+  std::vector<std::pair<std::string, std::string>> genParameters() {
     const auto& kernel_summary = kernel_->summary();
 
-    code_ << "__global__ void " << kernel_name << "(";
-
     std::unordered_set<Val*> unique_args;
 
     std::vector<Val*> params;
@@ -241,6 +275,8 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
       params.push_back(val);
     }
 
+    std::vector<std::pair<std::string, std::string>> declarations;
+
     // Generate parameter declarations
     unsigned int duplicate_counter = 0;
     for (auto i : c10::irange(params.size())) {
@@ -257,28 +293,25 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
         var_name_ss << "_duplicate_" << duplicate_counter++;
       }
 
+      std::stringstream type_ss;
       if (const auto tv = dynamic_cast<TensorView*>(params[i])) {
         if (tv->isCpuScalar()) {
-          code_ << " CpuScalarTensor<" << params[i]->dtype() << "> "
-                << var_name_ss.str();
+          type_ss << "CpuScalarTensor<" << params[i]->dtype() << ">";
         } else {
-          code_
+          type_ss
               << "Tensor<" << params[i]->dtype() << ", "
               << TensorDomain::noReductions(tv->getMaybeRFactorDomain()).size()
               << ", "
               << TensorDomain::noReductions(tv->getMaybeAllocationDomain())
                      .size()
-              << "> " << var_name_ss.str();
+              << ">";
         }
       } else {
         TORCH_INTERNAL_ASSERT(params[i]->isScalar()); // NOLINT (LLVM bug 48525)
         TORCH_INTERNAL_ASSERT(params[i]->definition() == nullptr);
-        code_ << params[i]->dtype() << " " << var_name_ss.str();
-      }
-
-      if (i + 1 != params.size()) {
-        code_ << ", ";
+        type_ss << params[i]->dtype();
       }
+      declarations.emplace_back(type_ss.str(), var_name_ss.str());
     }
 
     // Global buffers
@@ -287,15 +320,33 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
       const auto tv = allocate->buffer()->as<TensorView>();
       const auto& alloc_domain =
           TensorDomain::noReductions(tv->getMaybeAllocationDomain());
-      code_ << ", Tensor<" << tv->dtype() << ", " << alloc_domain.size() << ", "
-            << alloc_domain.size() << "> " << genVariableName(tv);
+      std::stringstream type_ss;
+      type_ss << "Tensor<" << tv->dtype() << ", " << alloc_domain.size()
+              << ", " << alloc_domain.size() << ">";
+      declarations.emplace_back(type_ss.str(), genVariableName(tv));
     }
 
     // Kernels generating random numbers take extra (seed, offset) arguments
     if (kernel_summary.max_rng_offsets >= 0) {
-      code_ << ", at::PhiloxCudaState philox_args";
+      declarations.emplace_back("at::PhiloxCudaState", "philox_args");
     }
 
+    return declarations;
+  }
+
+  void genDeclaration(const std::string& kernel_name) {
+    code_ << (device_function_ ? "__device__ void " : "__global__ void ")
+          << kernel_name << "(";
+    const auto params = genParameters();
+    for (auto i : c10::irange(params.size())) {
+      if (i > 0) {
+        code_ << ", ";
+      }
+      code_ << params[i].first << " " << params[i].second;
+    }
+    if (device_function_) {
+      code_ << ", const uint3 block_idx, const dim3 grid_dim";
+    }
     code_ << ") ";
   }
 
@@ -589,6 +640,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
 
   // Utility function to emit a cp.async intrinsic
   void genCpAsync(const LoadStoreOp* ldst, size_t vec_size) {
+    requireModule(RuntimeModule::TensorCore);
     auto dtype = ldst->in()->getDataType().value();
     bool is_cg = ldst->opType() == LoadStoreOpType::CpAsyncCg;
 
@@ -613,6 +665,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void genLdMatrix(const LoadStoreOp* ldst, size_t vector_word_size) {
+    requireModule(RuntimeModule::TensorCore);
     auto dtype = ldst->in()->getDataType().value();
     indent() << "Turing::ldMatrix";
     if (ldst->opType() == LoadStoreOpType::LdMatrixTranspose) {
@@ -631,6 +684,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
     switch (sop->tv()->getMemoryType()) {
       case MemoryType::Shared:
         code_ << "toSmem(" << genVariableName(sop->tv()) << ")";
+        requireModule(RuntimeModule::TensorCore);
         break;
       case MemoryType::Global:
         code_ << genVariableName(sop->tv()) << ".data";
@@ -1007,6 +1061,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   std::string genMmaOp(const MmaOp* mma, bool init = false) {
+    requireModule(RuntimeModule::TensorCore);
     std::stringstream ss;
     auto options = mma->options();
     ss << genArchString(options.macro) << "::";
@@ -1393,6 +1448,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void genBlockWelford(const WelfordOp* wop) {
+    requireModule(RuntimeModule::Welford);
     TORCH_INTERNAL_ASSERT(
         ir_utils::getTvOutput(wop)->domain()->hasBlockReduction(),
         "Not block-parallel WelfordOp: ",
@@ -1475,6 +1531,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void handle(const WelfordOp* wop) final {
+    requireModule(RuntimeModule::Welford);
     TORCH_INTERNAL_ASSERT(wop->out()->isA<kir::TensorIndex>());
 
     const auto out = wop->out()->as<kir::TensorIndex>();
@@ -1511,6 +1568,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void handle(const kir::VectorizedWelfordOp* wop) final {
+    requireModule(RuntimeModule::Welford);
     const auto out_var = wop->outVar();
     const auto out_avg = wop->outAvg();
     const auto out_N = wop->outN();
@@ -1616,6 +1674,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void handle(const kir::GridReduction* grop) final {
+    requireModule(RuntimeModule::GridReduction);
     TORCH_INTERNAL_ASSERT(grop->out()->isA<kir::TensorIndex>());
 
     const auto out = grop->out()->as<kir::TensorIndex>();
@@ -1683,6 +1742,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void generateGridAllreduce(const kir::GridReduction* grop) {
+    requireModule(RuntimeModule::FusedReduction);
     TORCH_INTERNAL_ASSERT(grop->isAllreduce());
 
     const auto out = grop->out()->as<kir::TensorIndex>();
@@ -1751,6 +1811,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void handle(const kir::GroupedGridReduction* grouped_grop) final {
+    requireModule(RuntimeModule::GridReduction);
     const auto out = ir_utils::getTvOutput(grouped_grop);
     const auto domain = out->domain();
     TORCH_INTERNAL_ASSERT(domain->hasGridReduction());
@@ -1913,6 +1974,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
 
   void generateGroupedGridAllreduce(
       const kir::GroupedGridReduction* grouped_grop) {
+    requireModule(RuntimeModule::FusedReduction);
     TORCH_INTERNAL_ASSERT(grouped_grop->isAllreduce());
 
     // There are two dimensions of grouping: horizontal grouping and
@@ -2061,6 +2123,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   // Mostly the same as the grouped grid redution version
   void generateGroupedGridAllreduceWelford(
       const kir::GroupedGridWelford* grouped_gwop) {
+    requireModule(RuntimeModule::FusedReduction);
     TORCH_INTERNAL_ASSERT(grouped_gwop->isAllreduce());
 
     const auto index_replacement_maps = getLoopIndexReplacementMaps();
@@ -2215,6 +2278,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
 
   void generateGroupedGridAllreduceWelfordOuter(
       const kir::GroupedGridWelford* grouped_gwop) {
+    requireModule(RuntimeModule::FusedReduction);
     TORCH_INTERNAL_ASSERT(grouped_gwop->isAllreduce());
 
     const auto num_grouped_iterations =
@@ -2305,6 +2369,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void handle(const kir::GridBroadcast* grop) final {
+    requireModule(RuntimeModule::GridBroadcast);
     const auto bop = grop->broadcast_op();
     TORCH_INTERNAL_ASSERT(bop->out()->isA<kir::TensorIndex>());
 
@@ -2345,6 +2410,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void handle(const kir::GridWelford* gwop) final {
+    requireModule(RuntimeModule::Welford);
     const auto wop = gwop->welford_op();
     TORCH_INTERNAL_ASSERT(wop->outAvg()->isA<kir::TensorIndex>());
 
@@ -2423,6 +2489,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void generateGridAllreduce(const kir::GridWelford* gwop) {
+    requireModule(RuntimeModule::FusedReduction);
     const auto wop = gwop->welford_op();
     TORCH_INTERNAL_ASSERT(wop->isAllreduce());
 
@@ -2526,6 +2593,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void handle(const kir::AllocateFusedReduction* alloc_fused_reduction) final {
+    requireModule(RuntimeModule::FusedReduction);
     // See the runtime file of the fused reduction
     enum class ReductionParallelTypeState { Reduce, Iter, Pred, Inactive };
 
@@ -2800,6 +2868,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void handle(const kir::CpAsyncWait* cpasync_wait) final {
+    requireModule(RuntimeModule::TensorCore);
     if (cpasync_wait->keepStages() > 0) {
       // Perform partial sync, see comment on kir::CpAsyncWait.
       indent() << "Ampere::cpAsyncPartialBarrier<" << cpasync_wait->keepStages()
@@ -2811,6 +2880,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void handle(const kir::CpAsyncCommit* cpasync_wait) final {
+    requireModule(RuntimeModule::TensorCore);
     // Commit inflight cp.async transfers. See comment on kir::CpAsyncCommit.
     indent() << "Ampere::cpAsyncCommit();\n";
   }
@@ -2911,15 +2981,36 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   std::vector<bool> aligned_scope_exprs_;
   //! Keep track of the Val* and its generated variable name
   std::unordered_map<const Val*, std::string> val_to_name_;
+  //! Runtime modules the generated code calls into
+  RuntimeModules used_modules_;
+  //! Generate a __device__ function instead of a kernel, see
+  //! generateCudaDeviceFunction
+  bool device_function_ = false;
 };
 
 } // namespace
 
 std::string generateCudaKernel(
     const kir::Kernel* kernel,
-    const std::string& kernel_name) {
+    const std::string& kernel_name,
+    RuntimeModules* used_modules) {
   FUSER_PERF_SCOPE("generateCudaKernel");
-  return CudaKernelGenerator::generateKernelDefinition(kernel, kernel_name);
+  return CudaKernelGenerator::generateKernelDefinition(
+      kernel, kernel_name, used_modules);
+}
+
+std::string generateCudaDeviceFunction(
+    const kir::Kernel* kernel,
+    const std::string& function_name,
+    RuntimeModules* used_modules) {
+  FUSER_PERF_SCOPE("generateCudaDeviceFunction");
+  return CudaKernelGenerator::generateKernelDefinition(
+      kernel, function_name, used_modules, /*device_function=*/true);
+}
+
+std::vector<std::pair<std::string, std::string>> getKernelParameters(
+    const kir::Kernel* kernel) {
+  return CudaKernelGenerator::generateParameters(kernel);
 }
 
 } // namespace codegen
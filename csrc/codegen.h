@@ -11,14 +11,48 @@
 #include <kernel.h>
 
 #include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace nvfuser {
 namespace codegen {
 
-//! Generates a CUDA kernel definition for the given kernel
+//! Optional groups of runtime helpers (runtime/*.cu) that only need to be
+//! part of the kernel preamble when the generated code calls into them
+enum class RuntimeModule {
+  GridReduction, //! grid_reduction.cu
+  GridBroadcast, //! grid_broadcast.cu
+  Welford, //! welford.cu
+  FusedReduction, //! tuple.cu, fused_reduction.cu and the fused welford
+                  //! helpers. Requires Welford
+  TensorCore //! tensorcore.cu and memory.cu
+};
+
+using RuntimeModules = std::unordered_set<RuntimeModule>;
+
+//! Generates a CUDA kernel definition for the given kernel. When
+//! used_modules is given, the runtime modules the generated code depends on
+//! are added to it.
 TORCH_CUDA_CU_API std::string generateCudaKernel(
     const kir::Kernel* kernel,
-    const std::string& kernel_name = "CUDAGeneratedKernel");
+    const std::string& kernel_name = "CUDAGeneratedKernel",
+    RuntimeModules* used_modules = nullptr);
+
+//! Generates a __device__ function with the body of the given kernel, for
+//! kernels that pack several kernels into one launch (see
+//! horizontal_fusion.h). The block index and the grid dimensions are the
+//! additional parameters block_idx and grid_dim of the function, so that the
+//! body can run on a slice of the grid of the calling kernel.
+TORCH_CUDA_CU_API std::string generateCudaDeviceFunction(
+    const kir::Kernel* kernel,
+    const std::string& function_name,
+    RuntimeModules* used_modules = nullptr);
+
+//! Type and name of each parameter of the kernel generated for the given
+//! kernel, in order
+TORCH_CUDA_CU_API std::vector<std::pair<std::string, std::string>>
+getKernelParameters(const kir::Kernel* kernel);
 
 } // namespace codegen
 } // namespace nvfuser
@@ -0,0 +1,300 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <compiled_kernel_cache.h>
+
+#include <device_lower/pass/loop_rotation.h>
+#include <instrumentation.h>
+#include <ir/all_nodes.h>
+#include <iter_visitor.h>
+
+#include <c10/util/hash.h>
+
+#include <algorithm>
+#include <sstream>
+
+namespace nvfuser {
+
+namespace {
+
+//! Serializes a fusion with statement names replaced by canonical
+//! indices. Vals are numbered when they are first referenced and their
+//! properties are written at that point, so the output only depends on the
+//! structure of the fusion.
+class FusionCanonicalizer {
+ public:
+  static std::string canonicalize(Fusion* fusion) {
+    FusionCanonicalizer canonicalizer;
+    canonicalizer.serialize(fusion);
+    return canonicalizer.ss_.str();
+  }
+
+ private:
+  void serialize(Fusion* fusion) {
+    FusionGuard fg(fusion);
+
+    ss_ << "inputs:";
+    for (auto inp : fusion->inputs()) {
+      ss_ << " " << ref(inp);
+    }
+    ss_ << "\n";
+
+    std::vector<Val*> terminals = fusion->getTerminatingOutputs();
+    terminals.insert(
+        terminals.end(), fusion->inputs().begin(), fusion->inputs().end());
+    for (auto stmt : StmtSort::getStmts(fusion, terminals, true, true)) {
+      if (stmt->isExpr()) {
+        writeExpr(stmt->as<Expr>());
+      } else {
+        ref(stmt->as<Val>());
+      }
+    }
+
+    ss_ << "outputs:";
+    for (auto out : fusion->outputs()) {
+      ss_ << " " << ref(out);
+    }
+    ss_ << "\n";
+
+    // Aliases are kept in an unordered map, so sort them by canonical index
+    std::vector<std::pair<int64_t, int64_t>> aliases;
+    for (const auto& [out, inp] : fusion->ioAlias()) {
+      aliases.emplace_back(ref(out), ref(inp));
+    }
+    std::sort(aliases.begin(), aliases.end());
+    for (const auto& [out, inp] : aliases) {
+      ss_ << "alias: " << out << " -> " << inp << "\n";
+    }
+
+    if (fusion->hasManaged("loop_rotation")) {
+      for (const auto& [tv, pos, selection] :
+           fusion->getManaged<LoopRotationParam>("loop_rotation")) {
+        ss_ << "rotate: " << ref(tv) << " @" << pos << " {";
+        std::vector<std::string> selected;
+        for (auto stmt : selection) {
+          selected.push_back(
+              stmt->isVal() ? std::to_string(ref(stmt->as<Val>()))
+                            : "e" + std::to_string(exprRef(stmt->as<Expr>())));
+        }
+        std::sort(selected.begin(), selected.end());
+        ss_ << toDelimitedString(selected) << "}\n";
+      }
+    }
+  }
+
+  //! Canonical index of a val. Writes the val on first reference.
+  int64_t ref(Val* val) {
+    if (val == nullptr) {
+      return -1;
+    }
+    auto it = val_ids_.find(val);
+    if (it != val_ids_.end()) {
+      return it->second;
+    }
+    const auto id = (int64_t)val_ids_.size();
+    val_ids_.emplace(val, id);
+
+    // Members are referenced, and thus written, before the val itself
+    std::stringstream val_ss;
+    val_ss << id << " = " << val->vtype() << "<" << val->dtype() << ">";
+    if (auto tv = dynamic_cast<TensorView*>(val)) {
+      val_ss << "(" << tv->getMemoryType() << ", domain " << ref(tv->domain())
+             << ", ca " << tv->getComputeAtPosition() << ", cw "
+             << tv->getComputeWithPosition() << ", pp "
+             << tv->getMaxProducerPosition() << ", circular "
+             << (tv->isCircularBuffered() ? tv->circularBufferDepth()
+                                          : (tv->isDoubleBuffered() ? 2 : 0))
+             << ", cpu " << tv->isCpuScalar() << ")";
+    } else if (auto td = dynamic_cast<TensorDomain*>(val)) {
+      val_ss << "(root " << refs(td->root());
+      if (td->hasRFactor()) {
+        val_ss << ", rfactor " << refs(td->rfactor());
+      }
+      if (td->hasAllocation()) {
+        val_ss << ", allocation " << refs(td->allocation());
+      }
+      val_ss << ", leaf " << refs(td->leaf()) << ", contiguity "
+             << td->getContiguityString() << ")";
+    } else if (auto iter_domain = dynamic_cast<IterDomain*>(val)) {
+      val_ss << "(" << iter_domain->getIterType() << ", "
+             << iter_domain->getParallelType() << ", start "
+             << ref(iter_domain->start()) << ", extent "
+             << ref(iter_domain->extent()) << ", expanded "
+             << (iter_domain->hasExpandedExtent()
+                     ? ref(iter_domain->expandedExtent())
+                     : -1)
+             << ", stop_offset " << ref(iter_domain->stopOffset())
+             << ", rfactor " << iter_domain->isRFactorProduct() << ", padded "
+             << iter_domain->hasPaddingToMultipleOfWarp() << ":"
+             << iter_domain->getMaybeSizeAfterPadding().value_or(-1)
+             << ", mma_swizzled " << iter_domain->isMmaSwizzled() << ")";
+    } else if (val->vtype() == ValType::Scalar) {
+      // Constants print their exact value. Symbolic scalars are either
+      // inputs, identified by their position, or defined by an expression
+      // that is written separately.
+      val_ss << "(" << (val->isConst() ? val->toString() : "symbolic") << ")";
+    } else {
+      // Named scalars and attributes print without statement names. Any
+      // other val falls back to its full string, which can only prevent
+      // sharing, not cause wrong sharing.
+      val_ss << "(" << val->toString() << ")";
+    }
+    ss_ << val_ss.str() << "\n";
+    return id;
+  }
+
+  std::string refs(const std::vector<IterDomain*>& ids) {
+    std::vector<int64_t> indices;
+    indices.reserve(ids.size());
+    for (auto id : ids) {
+      indices.push_back(ref(id));
+    }
+    return "[" + toDelimitedString(indices) + "]";
+  }
+
+  //! Canonical index of an expr. Exprs are only numbered, they are written
+  //! in writeExpr.
+  int64_t exprRef(Expr* expr) {
+    return expr_ids_.emplace(expr, (int64_t)expr_ids_.size()).first->second;
+  }
+
+  void writeExpr(Expr* expr) {
+    std::vector<std::string> attributes;
+    for (auto attr : expr->attributes()) {
+      if (attr == nullptr) {
+        attributes.emplace_back("null");
+      } else if (attr->isVal()) {
+        attributes.push_back(std::to_string(ref(attr->as<Val>())));
+      } else {
+        attributes.push_back("e" + std::to_string(exprRef(attr->as<Expr>())));
+      }
+    }
+    std::vector<int64_t> inputs;
+    for (auto inp : expr->inputs()) {
+      inputs.push_back(ref(inp));
+    }
+    std::vector<int64_t> outputs;
+    for (auto out : expr->outputs()) {
+      outputs.push_back(ref(out));
+    }
+    ss_ << "e" << exprRef(expr) << " = " << expr->getOpString() << "("
+        << toDelimitedString(inputs) << " | " << toDelimitedString(attributes)
+        << ") -> " << toDelimitedString(outputs) << "\n";
+  }
+
+ private:
+  std::stringstream ss_;
+  std::unordered_map<Val*, int64_t> val_ids_;
+  std::unordered_map<Expr*, int64_t> expr_ids_;
+};
+
+} // namespace
+
+KernelFingerprint fingerprintFusion(Fusion* fusion) {
+  FUSER_PERF_SCOPE("fingerprintFusion");
+  KernelFingerprint fingerprint;
+  fingerprint.canonical_ir = FusionCanonicalizer::canonicalize(fusion);
+  fingerprint.hash = std::hash<std::string>{}(fingerprint.canonical_ir);
+  return fingerprint;
+}
+
+size_t CompiledKernelKeyHash::operator()(const CompiledKernelKey& key) const {
+  return c10::get_hash(
+      key.fingerprint.hash,
+      (int)key.index_type,
+      key.maxrregcount,
+      key.enable_magic_zero,
+      key.device_major,
+      key.device_minor,
+      key.multi_processor_count,
+      key.keep_compiled_binary,
+      key.compile_options);
+}
+
+CompiledKernelCache& CompiledKernelCache::get() {
+  static CompiledKernelCache singleton;
+  return singleton;
+}
+
+std::shared_ptr<const CompiledKernelEntry> CompiledKernelCache::lookup(
+    const CompiledKernelKey& key) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  return it->second;
+}
+
+std::shared_ptr<const CompiledKernelEntry> CompiledKernelCache::insert(
+    const CompiledKernelKey& key,
+    CompiledKernelEntry entry) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return entries_
+      .emplace(key, std::make_shared<const CompiledKernelEntry>(std::move(entry)))
+      .first->second;
+}
+
+CompiledKernelCache::Stats CompiledKernelCache::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.entries = (int64_t)entries_.size();
+  for (const auto& kv : entries_) {
+    // One of the references is held by the cache itself
+    stats.references += kv.second.use_count() - 1;
+  }
+  return stats;
+}
+
+int64_t CompiledKernelCache::releaseUnused() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  int64_t released = 0;
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.use_count() == 1) {
+      it = entries_.erase(it);
+      released++;
+    } else {
+      ++it;
+    }
+  }
+  return released;
+}
+
+int64_t CompiledKernelCache::releaseUnused(
+    const std::unordered_set<const CompiledKernelEntry*>& kernels) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  int64_t released = 0;
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.use_count() == 1 && kernels.count(it->second.get())) {
+      it = entries_.erase(it);
+      released++;
+    } else {
+      ++it;
+    }
+  }
+  return released;
+}
+
+std::vector<
+    std::pair<CompiledKernelKey, std::shared_ptr<const CompiledKernelEntry>>>
+CompiledKernelCache::entries() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return {entries_.begin(), entries_.end()};
+}
+
+void CompiledKernelCache::clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.clear();
+  hits_ = 0;
+  misses_ = 0;
+}
+
+} // namespace nvfuser
@@ -0,0 +1,180 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <c10/macros/Export.h>
+
+#include <codegen.h>
+#include <executor_params.h>
+#include <executor_utils.h>
+#include <fusion.h>
+#include <type.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace nvfuser {
+
+//! Canonical structural description of a scheduled fusion. Statement names
+//! are replaced by the order in which the statements are first reached from
+//! the fusion inputs and outputs, so segments cut out of different complete
+//! fusions still get the same fingerprint when they describe the same
+//! kernel.
+struct TORCH_CUDA_CU_API KernelFingerprint {
+  std::string canonical_ir;
+  size_t hash = 0;
+
+  bool operator==(const KernelFingerprint& other) const {
+    return hash == other.hash && canonical_ir == other.canonical_ir;
+  }
+};
+
+//! Fingerprint a scheduled fusion. Meant to be called before lowering.
+TORCH_CUDA_CU_API KernelFingerprint fingerprintFusion(Fusion* fusion);
+
+//! Everything that determines the output of codegen and NVRTC for a
+//! scheduled fusion
+struct TORCH_CUDA_CU_API CompiledKernelKey {
+  KernelFingerprint fingerprint;
+  PrimDataType index_type = PrimDataType::Int;
+  int64_t maxrregcount = 255;
+  bool enable_magic_zero = true;
+  //! Compute capability and number of SMs of the device profile the kernel
+  //! was generated for, see currentDeviceProfile. The block size is not part
+  //! of the key, as it is derived from the inputs, see
+  //! CompiledKernelEntry::block_size.
+  int device_major = 0;
+  int device_minor = 0;
+  int64_t multi_processor_count = 0;
+  bool keep_compiled_binary = false;
+  //! NVRTC and module load options, see
+  //! executor_utils::compileOptionsSignature
+  std::string compile_options;
+
+  bool operator==(const CompiledKernelKey& other) const {
+    return fingerprint == other.fingerprint &&
+        index_type == other.index_type &&
+        maxrregcount == other.maxrregcount &&
+        enable_magic_zero == other.enable_magic_zero &&
+        device_major == other.device_major &&
+        device_minor == other.device_minor &&
+        multi_processor_count == other.multi_processor_count &&
+        keep_compiled_binary == other.keep_compiled_binary &&
+        compile_options == other.compile_options;
+  }
+};
+
+struct TORCH_CUDA_CU_API CompiledKernelKeyHash {
+  size_t operator()(const CompiledKernelKey& key) const;
+};
+
+//! Generated and compiled kernel shared by every executor with the same key
+struct CompiledKernelEntry {
+  //! Id of the executor that generated the kernel. The kernel name in
+  //! kernel_code is derived from it.
+  int64_t fusion_id = -1;
+  std::string kernel_code;
+  codegen::RuntimeModules runtime_modules;
+  executor_utils::NvrtcFunction compiled_kernel;
+  std::string compiler_log;
+  std::vector<char> compiled_binary;
+  //! Mangled name of the kernel function in compiled_binary
+  std::string lowered_kernel_name;
+  //! Block size the kernel was compiled for, if known. Executors that
+  //! launch larger blocks recompile the kernel.
+  std::optional<int64_t> block_size;
+  //! Launch parameters computed when the kernel was compiled
+  LaunchParams launch_params;
+  //! Heuristic the fusion was scheduled with and its serialized parameters,
+  //! see FusionExecutor::setHeuristicParams. Empty if unknown.
+  std::string heuristic;
+  std::string heuristic_params;
+};
+
+//! In-process cache of compiled kernels. Executors keep a reference to the
+//! entry they launch, so an entry stays alive as long as any executor uses
+//! it. Entries only referenced by the cache can be dropped with
+//! releaseUnused().
+class TORCH_CUDA_CU_API CompiledKernelCache {
+ public:
+  struct Stats {
+    //! Lookups that found a compiled kernel
+    int64_t hits = 0;
+    //! Lookups that had to generate and compile a kernel
+    int64_t misses = 0;
+    //! Number of cached kernels
+    int64_t entries = 0;
+    //! Number of executor references held on cached kernels
+    int64_t references = 0;
+  };
+
+  //! Thread-safe Meyer's singleton
+  static CompiledKernelCache& get();
+
+  //! Returns the entry for key if it exists. Counts a hit or a miss.
+  std::shared_ptr<const CompiledKernelEntry> lookup(
+      const CompiledKernelKey& key);
+
+  //! Add a newly compiled kernel. If another thread has inserted the same
+  //! key in the meantime, the existing entry is kept and returned.
+  std::shared_ptr<const CompiledKernelEntry> insert(
+      const CompiledKernelKey& key,
+      CompiledKernelEntry entry);
+
+  Stats stats() const;
+
+  //! Drop entries that are not referenced by any executor. Returns the
+  //! number of dropped entries.
+  int64_t releaseUnused();
+
+  //! Drop the given entries if they are not referenced by any executor,
+  //! e.g., once the executors of a fusion are destroyed. Returns the number
+  //! of dropped entries.
+  int64_t releaseUnused(
+      const std::unordered_set<const CompiledKernelEntry*>& kernels);
+
+  //! Drop all entries and reset the statistics
+  void clear();
+
+  //! All cached kernels, e.g., to write them to a kernel bundle
+  std::vector<
+      std::pair<CompiledKernelKey, std::shared_ptr<const CompiledKernelEntry>>>
+  entries() const;
+
+  //! Make executors keep the binaries of the kernels they compile, so that
+  //! they can be written to a kernel bundle
+  void setKeepCompiledBinaries(bool keep) {
+    keep_compiled_binaries_ = keep;
+  }
+
+  bool keepCompiledBinaries() const {
+    return keep_compiled_binaries_;
+  }
+
+ private:
+  CompiledKernelCache() = default;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<
+      CompiledKernelKey,
+      std::shared_ptr<const CompiledKernelEntry>,
+      CompiledKernelKeyHash>
+      entries_;
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+  std::atomic<bool> keep_compiled_binaries_ = false;
+};
+
+} // namespace nvfuser
@@ -7,7 +7,6 @@
 // clang-format on
 #include <device_lower/lower2device.h>
 
-#include <ATen/cuda/CUDAContext.h>
 #include <device_lower/analysis/divisible_split.h>
 #include <device_lower/analysis/shift.h>
 #include <device_lower/pass/alias_memory.h>
@@ -29,6 +28,7 @@
 #include <device_lower/pass/warp_reduce.h>
 #include <device_lower/utils.h>
 #include <device_lower/validation.h>
+#include <device_profile.h>
 #include <expr_simplifier.h>
 #include <fusion.h>
 #include <instrumentation.h>
@@ -36,6 +36,7 @@
 #include <ir/utils.h>
 
 #include <list>
+#include <sstream>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -143,7 +144,7 @@ class KIRCleaner : public OptOutDispatch {
 void GpuLower::collectPaddedParallelDims() {
   bool can_be_single_warp = true;
 
-  auto warp_size = at::cuda::warp_size();
+  auto warp_size = currentDeviceProfile()->warp_size;
 
   auto used_vals = fusion_->usedMathVals();
   for (auto tv : ir_utils::filterByType<TensorView>(used_vals)) {
@@ -237,19 +238,75 @@ void dumpExprsIfEnabled(
   }
 }
 
+std::string lowerPassStatsToJson(const std::vector<LowerPassStats>& stats) {
+  std::stringstream ss;
+  ss << "[";
+  bool first = true;
+  for (const auto& pass : stats) {
+    if (!first) {
+      ss << ",";
+    }
+    first = false;
+    ss << "\n  {\"name\": \"" << pass.name << "\""
+       << ", \"time_ms\": " << pass.time_ms
+       << ", \"ir_nodes_before\": " << pass.ir_nodes_before
+       << ", \"ir_nodes_after\": " << pass.ir_nodes_after
+       << ", \"exprs_before\": " << pass.exprs_before
+       << ", \"exprs_after\": " << pass.exprs_after << "}";
+  }
+  ss << "\n]";
+  return ss.str();
+}
+
+void GpuLower::passCompleted(
+    const std::vector<Expr*>& exprs,
+    std::string pass_name) {
+  if (!collect_pass_stats_) {
+    dumpExprsIfEnabled(exprs, std::move(pass_name));
+    return;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  const auto ir_nodes = static_cast<int64_t>(
+      kernel_->vals().size() + kernel_->unordered_exprs().size());
+  const auto num_exprs = static_cast<int64_t>(
+      ir_utils::flattenScopedExprs(exprs).size());
+
+  LowerPassStats pass;
+  pass.name = pass_name;
+  pass.time_ms =
+      std::chrono::duration<double, std::milli>(now - pass_start_).count();
+  pass.ir_nodes_before =
+      pass_stats_.empty() ? ir_nodes : pass_start_ir_nodes_;
+  pass.ir_nodes_after = ir_nodes;
+  pass.exprs_before = pass_stats_.empty() ? num_exprs : pass_start_exprs_;
+  pass.exprs_after = num_exprs;
+  pass_stats_.push_back(pass);
+
+  dumpExprsIfEnabled(exprs, std::move(pass_name));
+
+  // Don't count the time spent in dumping toward the next pass
+  pass_start_ = std::chrono::steady_clock::now();
+  pass_start_ir_nodes_ = ir_nodes;
+  pass_start_exprs_ = num_exprs;
+}
+
 void GpuLower::lower(Fusion* fusion) {
   FUSER_PERF_SCOPE("GpuLower::lower");
   TORCH_INTERNAL_ASSERT(fusion != nullptr);
-  TORCH_INTERNAL_ASSERT(
-      active_gpu_lower == nullptr, "Nested lowering passes are not supported");
 
+  // The active lowering is confined to the current thread, so
+  // independent fusions can be lowered concurrently on different
+  // threads. Like FusionGuard, the previously active lowering, if any,
+  // is restored once this lowering is done.
   struct LowerGuard {
-    LowerGuard(GpuLower* gpu_lower) {
+    LowerGuard(GpuLower* gpu_lower) : prev_lower(active_gpu_lower) {
       active_gpu_lower = gpu_lower;
     }
     ~LowerGuard() {
-      active_gpu_lower = nullptr;
+      active_gpu_lower = prev_lower;
     }
+    GpuLower* prev_lower = nullptr;
   } lower_guard(this);
 
   // Use int64 by default as the kernel index type
@@ -257,6 +314,9 @@ void GpuLower::lower(Fusion* fusion) {
       ? cparams_.index_type.value()
       : PrimDataType::Int;
 
+  pass_stats_.clear();
+  pass_start_ = std::chrono::steady_clock::now();
+
   // Copy fusion into a new kernel for processing
   kernel_ = std::make_unique<kir::Kernel>(fusion, kernel_index_type);
   // Alias the fusion kernel caries around as a view of itself.
@@ -273,20 +333,20 @@ void GpuLower::lower(Fusion* fusion) {
   assignRNGOffset(fusion_);
 
   FusionGuard fg(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "initialize lowering");
+  passCompleted(fusion_->exprs(), "initialize lowering");
 
   // prepare for lowering
   validateIr(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateIr");
+  passCompleted(fusion_->exprs(), "validateIr");
 
   // Checks if any TIDx dim is marked as padded to a warp. Also checks if we can
   // determine the padding is explicitly a single warp.
   collectPaddedParallelDims();
-  dumpExprsIfEnabled(fusion_->exprs(), "collectPaddedParallelDims");
+  passCompleted(fusion_->exprs(), "collectPaddedParallelDims");
 
   // Replaces integers that are tensor sizes by named scalars as "T0.size[0]"
   replaceSymbolicSizes(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "replaceSymbolicSizes");
+  passCompleted(fusion_->exprs(), "replaceSymbolicSizes");
 
   // Build what's refered to as the compute at map. This map contains the
   // mappings of all iteration domains across the fusion. There are three types
@@ -295,74 +355,74 @@ void GpuLower::lower(Fusion* fusion) {
   compute_at_map_ = std::make_shared<ComputeAtMap>(fusion_);
 
   resolveComputeWith(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "resolveComputeWith");
+  passCompleted(fusion_->exprs(), "resolveComputeWith");
 
   if (isDebugDumpEnabled(DebugDumpOption::ComputeAtMap)) {
     std::cout << compute_at_map_->toString() << std::endl;
   }
   compute_at_map_->validateAndPropagatePType();
-  dumpExprsIfEnabled(fusion_->exprs(), "validateAndPropagatePType");
+  passCompleted(fusion_->exprs(), "validateAndPropagatePType");
 
   // Uses compute_at_map, find all splits that are enforced to be divisible
   divisible_splits_ = getAllDivisibleSplits(fusion_, compute_at_map_.get());
-  dumpExprsIfEnabled(fusion_->exprs(), "getAllDivisibleSplits");
+  passCompleted(fusion_->exprs(), "getAllDivisibleSplits");
 
   // Used in parallel dimension map
   concretized_broadcast_domains_ =
       std::make_shared<const ConcretizedBroadcastDomains>(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "build ConcretizedBroadcastDomains");
+  passCompleted(fusion_->exprs(), "build ConcretizedBroadcastDomains");
 
   parallelDimensionMap().build(fusion_);
   if (isDebugDumpEnabled(DebugDumpOption::ParallelDimensions)) {
     std::cout << "Parallel dimension map:" << std::endl;
     std::cout << parallel_dimension_map_.toString() << std::endl;
   }
-  dumpExprsIfEnabled(fusion_->exprs(), "build parallelDimensionMap");
+  passCompleted(fusion_->exprs(), "build parallelDimensionMap");
 
   // Validate mma data format and compatibility if any on the fusion.
   validateMma(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateMma");
+  passCompleted(fusion_->exprs(), "validateMma");
 
   // Validate swizzle usage on the fusion schedule.
   validateSwizzle(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateSwizzle");
+  passCompleted(fusion_->exprs(), "validateSwizzle");
 
   validateResize(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateResize");
+  passCompleted(fusion_->exprs(), "validateResize");
 
   // Compute thread predicates. Depends on parallel_dimension_map_
   thread_pred_map_.build(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "build thread_pred_map_");
+  passCompleted(fusion_->exprs(), "build thread_pred_map_");
 
   // Fuse cetain patterns of reductions, such as a grid reduction
   // followed by a grid broadcast. Only depends on parallelization and
   // thread predicate map.
   fuseReductionsAndBroadcasts(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "fuseReductionsAndBroadcasts");
+  passCompleted(fusion_->exprs(), "fuseReductionsAndBroadcasts");
 
   // Scan the whole fusion and build mappings about halo extensions of
   // all IterDomains
   halo_info_ = std::make_shared<HaloInfo>(fusion_, compute_at_map_);
-  dumpExprsIfEnabled(fusion_->exprs(), "build HaloInfo");
+  passCompleted(fusion_->exprs(), "build HaloInfo");
 
   // Want to run this after parallel map and halo info map are
   // created. vectorized_accesses_ and vectorized_set_info_ are filled.
   validateAndCollectVectorizeInfo(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateAndCollectVectorizeInfo");
+  passCompleted(fusion_->exprs(), "validateAndCollectVectorizeInfo");
 
   // Depends on ComputeAtMap and HaloInfo.
   validateAndConvertIterDomainGrouping(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateAndConvertIterDomainGrouping");
+  passCompleted(fusion_->exprs(), "validateAndConvertIterDomainGrouping");
 
   // Assumes all grouped reductions are convered to
   // GroupedReductionOp, which is done by
   // validateAndConvertIterDomainGrouping
   validateGroupedReductions(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateGroupedReductions");
+  passCompleted(fusion_->exprs(), "validateGroupedReductions");
 
   // all of the lookup TVs are fusion inputs
   validateLookupTV(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateLookupTV");
+  passCompleted(fusion_->exprs(), "validateLookupTV");
 
   // Depends on thread_pred_map_, validates parallelization collects which
   // tensor views need WAR or RAW syncs
@@ -370,70 +430,70 @@ void GpuLower::lower(Fusion* fusion) {
   if (isDebugDumpEnabled(DebugDumpOption::SyncMap)) {
     std::cout << sync_map_->toString() << std::endl;
   }
-  dumpExprsIfEnabled(fusion_->exprs(), "SyncMap");
+  passCompleted(fusion_->exprs(), "SyncMap");
 
   partialSplitMap().build(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "build partialSplitMap");
+  passCompleted(fusion_->exprs(), "build partialSplitMap");
 
   validatePartialSplit(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validatePartialSplit");
+  passCompleted(fusion_->exprs(), "validatePartialSplit");
 
   nonDivisibleSplitInfo().build(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "build nonDivisibleSplitInfo");
+  passCompleted(fusion_->exprs(), "build nonDivisibleSplitInfo");
 
   // Detects all exprssions that don't need predicates. Depends on
   // nonDivisibleSplitInfo.
   pred_elimination_ = std::make_unique<PredicateElimination>(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "build predicateElimination");
+  passCompleted(fusion_->exprs(), "build predicateElimination");
 
   doubleBufferInfo().build(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "build doubleBufferInfo");
+  passCompleted(fusion_->exprs(), "build doubleBufferInfo");
 
   compute_at_map_->allocateIndexVariables();
-  dumpExprsIfEnabled(fusion_->exprs(), "allocateIndexVariables");
+  passCompleted(fusion_->exprs(), "allocateIndexVariables");
   // Run our passes keeping the lowered expressions and forwarding
   // them
 
   // Reorder expressions for loop-nest generation respecting computeAt
   // relationships
   const auto exprs_sorted = reorderExprsForComputeAt();
-  dumpExprsIfEnabled(exprs_sorted, "reorderExprsForComputeAt");
+  passCompleted(exprs_sorted, "reorderExprsForComputeAt");
 
   // Generate loop-nests and place each expression at its
   // corresponding loop
   const auto exprs_lowered = LoopNestGenerator::loweredExprs(exprs_sorted);
-  dumpExprsIfEnabled(exprs_lowered, "LoopNestGenerator");
+  passCompleted(exprs_lowered, "LoopNestGenerator");
 
   // Replace squeezes, Transpose, Shift, Gather, and View ops with
   // unary ops since they're not separately processed in lowering.
   const auto exprs_unary_replaced = unarySetOpInserter(exprs_lowered);
-  dumpExprsIfEnabled(exprs_unary_replaced, "unarySetOpInserter");
+  passCompleted(exprs_unary_replaced, "unarySetOpInserter");
 
   // Insert allocations
   const auto exprs_alloced = insertAllocations(exprs_unary_replaced);
-  dumpExprsIfEnabled(exprs_alloced, "insertAllocations");
+  passCompleted(exprs_alloced, "insertAllocations");
 
   // Insert read after write smem syncs
   const auto exprs_raw_sync = insertRawThreadSynchronization(exprs_alloced);
-  dumpExprsIfEnabled(exprs_raw_sync, "insertRawThreadSynchronization");
+  passCompleted(exprs_raw_sync, "insertRawThreadSynchronization");
 
   // Reuse memory locations
   const auto exprs_reuse_mem = reuseMemoryAllocations(exprs_raw_sync);
-  dumpExprsIfEnabled(exprs_reuse_mem, "reuseMemoryAllocations");
+  passCompleted(exprs_reuse_mem, "reuseMemoryAllocations");
 
   // Insert SyncThreads at end of for-loop to avoid WAR race condition
   const auto exprs_war_sync = insertWarThreadSynchronization(exprs_reuse_mem);
-  dumpExprsIfEnabled(exprs_war_sync, "insertWarThreadSynchronization");
+  passCompleted(exprs_war_sync, "insertWarThreadSynchronization");
 
   const auto exprs_double_buffered = DoubleBufferPass::run(exprs_war_sync);
-  dumpExprsIfEnabled(exprs_double_buffered, "DoubleBufferPass");
+  passCompleted(exprs_double_buffered, "DoubleBufferPass");
 
   const auto exprs_loop_rotated = fusion_->hasManaged("loop_rotation")
       ? rotateLoops(
             exprs_double_buffered,
             fusion_->getManaged<LoopRotationParam>("loop_rotation"))
       : exprs_double_buffered;
-  dumpExprsIfEnabled(exprs_loop_rotated, "rotateLoops");
+  passCompleted(exprs_loop_rotated, "rotateLoops");
 
   // This pass inserts predicates as well as branches in the code. Up until now
   // the code is explicitly single shot for loop based. Need to be careful in
@@ -441,37 +501,37 @@ void GpuLower::lower(Fusion* fusion) {
   // insertions could be on if then or else instead of directly on a for loop.
   const auto exprs_unrolled_loops =
       UnrollPass::runPass(fusion_, exprs_loop_rotated);
-  dumpExprsIfEnabled(exprs_unrolled_loops, "UnrollPass");
+  passCompleted(exprs_unrolled_loops, "UnrollPass");
 
   commonScalarMap().initialize(exprs_unrolled_loops);
 
   const auto exprs_unrolled_mv_loops =
       processMisalignedVectorization(exprs_unrolled_loops);
-  dumpExprsIfEnabled(exprs_unrolled_mv_loops, "processMisalignedVectorization");
+  passCompleted(exprs_unrolled_mv_loops, "processMisalignedVectorization");
 
   const auto exprs_indexed_loops =
       IndexLowering::getIndexedExprs(exprs_unrolled_mv_loops);
-  dumpExprsIfEnabled(exprs_indexed_loops, "IndexLowering");
+  passCompleted(exprs_indexed_loops, "IndexLowering");
 
   // TODO: It seems this type of optimization would be far easier to implement
   // on fusion ir than kernel ir. We should likely refactor this to at least run
   // before allocation insertion.
   const auto exprs_with_fused_broadcast = fuseWarpReduce(exprs_indexed_loops);
-  dumpExprsIfEnabled(exprs_with_fused_broadcast, "fuseWarpReduce");
+  passCompleted(exprs_with_fused_broadcast, "fuseWarpReduce");
 
   const auto exprs_conditional_loops =
       generateConditionalFromPredicate(exprs_with_fused_broadcast);
-  dumpExprsIfEnabled(
+  passCompleted(
       exprs_conditional_loops, "generateConditionalFromPredicate");
 
   const auto exprs_common_index_allocated =
       allocateCommonScalars(exprs_conditional_loops);
-  dumpExprsIfEnabled(exprs_common_index_allocated, "allocateCommonScalars");
+  passCompleted(exprs_common_index_allocated, "allocateCommonScalars");
 
   std::vector<Expr*> exprs_welford_vectorized;
   if (!isOptionDisabled(DisableOption::WelfordVectorization)) {
     exprs_welford_vectorized = vectorizeWelford(exprs_common_index_allocated);
-    dumpExprsIfEnabled(exprs_welford_vectorized, "vectorizeWelford");
+    passCompleted(exprs_welford_vectorized, "vectorizeWelford");
   } else {
     exprs_welford_vectorized = exprs_common_index_allocated;
   }
@@ -481,22 +541,27 @@ void GpuLower::lower(Fusion* fusion) {
     // Insert fake zero updates to make sure nvrtc doesn't blow out register use
     // on index and predicate reuse
     exprs_register_adjusted = insertMagicZero(exprs_welford_vectorized);
-    dumpExprsIfEnabled(exprs_register_adjusted, "insertMagicZero");
+    passCompleted(exprs_register_adjusted, "insertMagicZero");
   } else {
     exprs_register_adjusted = exprs_welford_vectorized;
   }
 
   const auto exprs_cleaned_up_loops =
       KIRCleaner::cleanUp(exprs_register_adjusted);
-  dumpExprsIfEnabled(exprs_cleaned_up_loops, "KIRCleaner");
+  passCompleted(exprs_cleaned_up_loops, "KIRCleaner");
 
   const auto exprs_instrumented = instrumentKernel(exprs_cleaned_up_loops);
-  dumpExprsIfEnabled(exprs_instrumented, "instrumentKernel");
+  passCompleted(exprs_instrumented, "instrumentKernel");
 
   // We now have the lowered expressions, finalize the kernel IR. This function
   // will also copy over some relevant information for code generation from
   // GpuLower.
   kernel_->finalize(exprs_instrumented);
+
+  if (isDebugDumpEnabled(DebugDumpOption::LowerPassStats)) {
+    std::cout << "Lowering pass statistics:" << std::endl;
+    std::cout << lowerPassStatsToJson(pass_stats_) << std::endl;
+  }
 }
 
 kir::Kernel* GpuLower::kernel() const {
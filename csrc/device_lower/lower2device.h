@@ -31,13 +31,33 @@
 #include <root_domain_map.h>
 #include <vectorization_info.h>
 
+#include <chrono>
 #include <memory>
 #include <ostream>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace nvfuser {
 
+//! Wall time and IR size recorded for one step of GpuLower::lower. IR nodes
+//! are the Vals and Exprs registered in the kernel container. Exprs are the
+//! expressions the step works on, i.e., the math expressions of the fusion for
+//! analyses and the flattened lowered expressions once loop nests exist.
+struct LowerPassStats {
+  std::string name;
+  double time_ms = 0.0;
+  int64_t ir_nodes_before = 0;
+  int64_t ir_nodes_after = 0;
+  int64_t exprs_before = 0;
+  int64_t exprs_after = 0;
+};
+
+//! Serialize pass statistics as a JSON array of objects
+TORCH_CUDA_CU_API std::string lowerPassStatsToJson(
+    const std::vector<LowerPassStats>& stats);
+
 // TODO: we frequently use pairwise root mapping from consumers to producers.
 // This information is implicitly in the computeAtMaps, but there's no isolated
 // container for this information that we can reuse. Would be nice to generate
@@ -51,12 +71,18 @@ class TORCH_CUDA_CU_API GpuLower : public NonCopyable {
 
   // GpuLower lowers the provided fusion into a kernel which can be translated
   // into cuda code. index_type allows to compile the kernel based on int32
-  // indexing instead of int64 for additional performance.
+  // indexing instead of int64 for additional performance. Pass statistics are
+  // collected if collect_pass_stats is set or with the lower_pass_stats dump
+  // option, as counting the IR after every pass adds to the lowering time.
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
   explicit GpuLower(
       Fusion* fusion,
-      const CompileParams& cparams = CompileParams())
-      : cparams_(cparams) {
+      const CompileParams& cparams = CompileParams(),
+      bool collect_pass_stats = false)
+      : collect_pass_stats_(
+            collect_pass_stats ||
+            isDebugDumpEnabled(DebugDumpOption::LowerPassStats)),
+        cparams_(cparams) {
     lower(fusion);
   }
 
@@ -174,6 +200,12 @@ class TORCH_CUDA_CU_API GpuLower : public NonCopyable {
     return profile_;
   }
 
+  //! Per-pass wall time and IR sizes of this lowering, in pass order. Empty
+  //! unless collected, see the constructor.
+  const std::vector<LowerPassStats>& passStats() const {
+    return pass_stats_;
+  }
+
   bool isNvFuserZeroEnabled() {
     if (isOptionDisabled(DisableOption::MagicZero)) {
       return false;
@@ -204,6 +236,11 @@ class TORCH_CUDA_CU_API GpuLower : public NonCopyable {
 
   bool resolveComputeWith(Fusion* fusion);
 
+  //! Records the statistics of the pass that just completed, if they are
+  //! collected, and dumps its output expressions if requested. The pass is
+  //! assumed to have started when the previous pass completed.
+  void passCompleted(const std::vector<Expr*>& exprs, std::string pass_name);
+
  private:
   // Lowered Kernel IR
   std::unique_ptr<kir::Kernel> kernel_;
@@ -229,6 +266,11 @@ class TORCH_CUDA_CU_API GpuLower : public NonCopyable {
   FusedReductionInfo fused_reduction_info_;
   std::shared_ptr<const SyncMap> sync_map_;
   kir::KernelPerformanceProfile profile_;
+  bool collect_pass_stats_ = false;
+  std::vector<LowerPassStats> pass_stats_;
+  std::chrono::steady_clock::time_point pass_start_;
+  int64_t pass_start_ir_nodes_ = 0;
+  int64_t pass_start_exprs_ = 0;
   std::unordered_set<Split*> divisible_splits_;
   CompileParams cparams_;
 
@@ -13,6 +13,8 @@
 
 #include <device_lower/pass/scalar_hoist.h>
 
+#include <map>
+
 namespace nvfuser {
 
 namespace {
@@ -96,15 +98,95 @@ kir::ForLoop* getLoopAtPos(
   return loops.at(position);
 }
 
+bool isCommutative(BinaryOpType type) {
+  return type == BinaryOpType::Add || type == BinaryOpType::Mul ||
+      type == BinaryOpType::And || type == BinaryOpType::Or ||
+      type == BinaryOpType::Xor || type == BinaryOpType::Max ||
+      type == BinaryOpType::Min || type == BinaryOpType::Eq ||
+      type == BinaryOpType::NE;
+}
+
+// Similar to Val::sameAs, but also treats the operands of commutative binary
+// operations as unordered. Indices of different tensors in the same loop nest
+// are computed separately, and the simplifier only orders operands by their
+// loop dependency, so the same address arithmetic can show up as `a + b` for
+// one tensor and `b + a` for another. Recognizing them as equivalent allows
+// the computation to be shared across tensors.
+//
+// The result of each pair of Vals compared is memoized. Otherwise retrying
+// the swapped operands of every commutative operation would take time
+// exponential in the depth of the expressions.
+class ScalarEquivalence {
+ public:
+  bool operator()(Val* a, Val* b) {
+    if (a == b) {
+      return true;
+    }
+    auto it = memo_.find({a, b});
+    if (it != memo_.end()) {
+      return it->second;
+    }
+    bool result = compare(a, b);
+    memo_[{a, b}] = result;
+    return result;
+  }
+
+ private:
+  bool compare(Val* a, Val* b) {
+    auto def_a = a->definition();
+    auto def_b = b->definition();
+    // Val::sameAs is not used for defined Vals, as it doesn't memoize either
+    if (def_a == nullptr || def_b == nullptr) {
+      return a->sameAs(b);
+    }
+    if (a->vtype() != b->vtype() || a->dtype() != b->dtype()) {
+      return false;
+    }
+    if (typeid(*def_a) != typeid(*def_b) || def_a->outputs().size() != 1 ||
+        def_b->outputs().size() != 1 ||
+        def_a->inputs().size() != def_b->inputs().size() ||
+        def_a->attributes().size() != def_b->attributes().size()) {
+      return false;
+    }
+    for (const auto i : c10::irange(def_a->attributes().size())) {
+      if (!def_a->attribute(i)->sameAs(def_b->attribute(i))) {
+        return false;
+      }
+    }
+    bool same_order = true;
+    for (const auto i : c10::irange(def_a->inputs().size())) {
+      if (!(*this)(def_a->input(i), def_b->input(i))) {
+        same_order = false;
+        break;
+      }
+    }
+    if (same_order) {
+      return true;
+    }
+    auto bop = dynamic_cast<BinaryOp*>(def_a);
+    if (bop == nullptr || !isCommutative(bop->getBinaryOpType())) {
+      return false;
+    }
+    return (*this)(def_a->input(0), def_b->input(1)) &&
+        (*this)(def_a->input(1), def_b->input(0));
+  }
+
+  std::map<std::pair<Val*, Val*>, bool> memo_;
+};
+
 // Check if in the definition of from, there is a subexpression equivalent to
 // reference. If found, then return this subexpression.
-Val* findRefAsSubexprOf(Val* from, Val* reference, bool exact) {
+Val* findRefAsSubexprOf(
+    Val* from,
+    Val* reference,
+    bool exact,
+    ScalarEquivalence& is_equivalent) {
   if (exact) {
     if (from == reference) {
       return from;
     }
   } else {
-    if (from->sameAs(reference)) {
+    if (is_equivalent(from, reference)) {
       return from;
     }
   }
@@ -114,7 +196,8 @@ Val* findRefAsSubexprOf(Val* from, Val* reference, bool exact) {
   auto def = from->definition();
   if (def != nullptr) {
     for (auto input : def->inputs()) {
-      auto common_subexpr = findRefAsSubexprOf(input, reference, exact);
+      auto common_subexpr =
+          findRefAsSubexprOf(input, reference, exact, is_equivalent);
       if (common_subexpr != nullptr) {
         return common_subexpr;
       }
@@ -123,8 +206,17 @@ Val* findRefAsSubexprOf(Val* from, Val* reference, bool exact) {
   return nullptr;
 }
 
+Val* findRefAsSubexprOf(Val* from, Val* reference, bool exact) {
+  ScalarEquivalence is_equivalent;
+  return findRefAsSubexprOf(from, reference, exact, is_equivalent);
+}
+
 } // namespace
 
+bool isEquivalentScalar(Val* a, Val* b) {
+  return ScalarEquivalence()(a, b);
+}
+
 std::pair<Val*, bool> CommonScalarMap::hoistScalarImpl(
     Val* value,
     const std::vector<kir::ForLoop*>& loops,
@@ -162,8 +254,9 @@ std::pair<Val*, bool> CommonScalarMap::hoistScalarImpl(
   if (auto existing_subexpr = reuseScalarIfAlreadyComputed(value, my_loop)) {
     return {existing_subexpr, false};
   }
+  ScalarEquivalence is_equivalent;
   for (auto existing_subexpr : seen_subexprs) {
-    if (value->sameAs(existing_subexpr)) {
+    if (is_equivalent(value, existing_subexpr)) {
       common_scalar_map_[my_loop].emplace_back(existing_subexpr);
       hoisted_or_reused_.emplace(existing_subexpr);
       return {existing_subexpr, false};
@@ -307,9 +400,11 @@ Val* CommonScalarMap::reuseScalarIfAlreadyComputed(
   auto it = common_scalar_map_.find(loop);
   if (it != common_scalar_map_.end()) {
     auto& indices = it->second;
+    ScalarEquivalence is_equivalent;
     for (auto it = indices.begin(); it != indices.end(); it++) {
       auto idx = *it;
-      auto common_subexpr = findRefAsSubexprOf(idx, value, false);
+      auto common_subexpr =
+          findRefAsSubexprOf(idx, value, false, is_equivalent);
       if (common_subexpr != nullptr) {
         if (common_subexpr != idx) {
           // If the reuse is a subexpression instead of the complete
@@ -107,6 +107,10 @@ class TORCH_CUDA_CU_API CommonScalarMap {
   std::unordered_set<Val*> hoisted_or_reused_;
 };
 
+//! Similar to Val::sameAs, but also treats the operands of commutative binary
+//! operations as unordered, e.g., a + b * c is equivalent to c * b + a
+TORCH_CUDA_CU_API bool isEquivalentScalar(Val* a, Val* b);
+
 //! Insert allocations of hoisted indices. Must be called after
 //! collecting all common indices.
 std::vector<Expr*> allocateCommonScalars(const std::vector<Expr*>& exprs);
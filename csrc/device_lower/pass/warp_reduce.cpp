@@ -5,10 +5,10 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 // clang-format on
-#include <ATen/cuda/CUDAContext.h>
 #include <device_lower/lower2device.h>
 #include <device_lower/pass/warp_reduce.h>
 #include <device_lower/utils.h>
+#include <device_profile.h>
 #include <expr_evaluator.h>
 #include <ir/internal_nodes.h>
 #include <ir/utils.h>
@@ -386,7 +386,7 @@ class FuseBroadcastWithWarpReduce : private kir::IrVisitor {
   // Checks if the given IterDomain is mapped to a single warp,
   //  i.e. they are known at compile time to be of constant
   //   size of warp_size and they are paralleled on TIDx
-  int warp_size = at::cuda::warp_size();
+  int64_t warp_size = currentDeviceProfile()->warp_size;
   bool isSingleWarp(IterDomain* id) {
     if (id->getParallelType() != ParallelType::TIDx) {
       return false;
@@ -7,10 +7,10 @@
 // clang-format on
 #include <device_lower/utils.h>
 
-#include <ATen/cuda/CUDAContext.h>
 #include <c10/util/irange.h>
 #include <device_lower/analysis/thread_predicate.h>
 #include <device_lower/lower2device.h>
+#include <device_profile.h>
 #include <ir/iostream.h>
 #include <ir/utils.h>
 #include <iter_visitor.h>
@@ -300,7 +300,7 @@ c10::optional<IterDomain*> getMaybeWarpReductionDim(
 
   if (reduction_on_xdim->extent()->isConstInt()) {
     auto extent_value = reduction_on_xdim->extent()->evaluateInt();
-    if (extent_value % at::cuda::warp_size() == 0) {
+    if (extent_value % currentDeviceProfile()->warp_size == 0) {
       return c10::optional<IterDomain*>(reduction_on_xdim);
     }
   }
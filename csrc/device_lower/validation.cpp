@@ -10,6 +10,7 @@
 #include <contiguity.h>
 #include <device_lower/lower2device.h>
 #include <device_lower/utils.h>
+#include <device_profile.h>
 #include <instrumentation.h>
 #include <ir/iostream.h>
 #include <ir/utils.h>
@@ -18,7 +19,6 @@
 #include <transform_replay.h>
 #include <type.h>
 
-#include <ATen/cuda/CUDAContext.h>
 #include <limits>
 
 namespace nvfuser {
@@ -891,7 +891,7 @@ void validateMmaTensors(MmaOp* mma) {
               paralel_dim_map.isExact(ptype) &&
                   paralel_dim_map.get(ptype)->isConstInt() &&
                   paralel_dim_map.get(ptype)->evaluateInt() ==
-                      at::cuda::warp_size(),
+                      currentDeviceProfile()->warp_size,
               "TIDx is reserved for lane id in mma kernels, and it needs to be exactly a warp");
           tidx_validated = true;
         }
@@ -0,0 +1,173 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <device_profile.h>
+#include <utils.h>
+
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/util/Exception.h>
+#include <c10/util/irange.h>
+
+#include <sstream>
+#include <unordered_map>
+
+namespace nvfuser {
+
+namespace {
+
+DeviceProfile makeProfile(
+    std::string name,
+    int major,
+    int minor,
+    int64_t multi_processor_count,
+    int64_t max_threads_per_multi_processor,
+    int64_t shared_mem_per_block_optin,
+    int64_t shared_mem_per_multi_processor,
+    int64_t l2_cache_size,
+    int64_t clock_rate) {
+  DeviceProfile profile;
+  profile.name = std::move(name);
+  profile.major = major;
+  profile.minor = minor;
+  profile.multi_processor_count = multi_processor_count;
+  profile.max_threads_per_multi_processor = max_threads_per_multi_processor;
+  profile.max_threads_per_block = 1024;
+  profile.warp_size = 32;
+  profile.regs_per_block = 64 * 1024;
+  profile.regs_per_multi_processor = 64 * 1024;
+  profile.shared_mem_per_block = 48 * 1024;
+  profile.shared_mem_per_block_optin = shared_mem_per_block_optin;
+  profile.shared_mem_per_multi_processor = shared_mem_per_multi_processor;
+  profile.l2_cache_size = l2_cache_size;
+  profile.clock_rate = clock_rate;
+  return profile;
+}
+
+const std::unordered_map<std::string, DeviceProfile>& builtinProfiles() {
+  static const std::unordered_map<std::string, DeviceProfile> profiles = {
+      {"v100",
+       makeProfile(
+           "v100", 7, 0, 80, 2048, 96 << 10, 96 << 10, 6 << 20, 1530000)},
+      {"t4",
+       makeProfile("t4", 7, 5, 40, 1024, 64 << 10, 64 << 10, 4 << 20, 1590000)},
+      {"a100",
+       makeProfile(
+           "a100", 8, 0, 108, 2048, 163 << 10, 164 << 10, 40 << 20, 1410000)},
+      {"a10",
+       makeProfile(
+           "a10", 8, 6, 72, 1536, 99 << 10, 100 << 10, 6 << 20, 1695000)},
+      {"h100",
+       makeProfile(
+           "h100", 9, 0, 132, 2048, 227 << 10, 228 << 10, 50 << 20, 1980000)},
+  };
+  return profiles;
+}
+
+// Profile injected on this thread by DeviceProfileGuard, if any
+thread_local const DeviceProfile* injected_profile = nullptr; // NOLINT
+
+} // namespace
+
+DeviceProfile DeviceProfile::fromProperties(const cudaDeviceProp& prop) {
+  DeviceProfile profile;
+  profile.name = prop.name;
+  profile.major = prop.major;
+  profile.minor = prop.minor;
+  profile.multi_processor_count = prop.multiProcessorCount;
+  profile.max_threads_per_multi_processor = prop.maxThreadsPerMultiProcessor;
+  profile.max_threads_per_block = prop.maxThreadsPerBlock;
+  profile.warp_size = prop.warpSize;
+  profile.regs_per_block = prop.regsPerBlock;
+  profile.regs_per_multi_processor = prop.regsPerMultiprocessor;
+  profile.shared_mem_per_block = (int64_t)prop.sharedMemPerBlock;
+  profile.shared_mem_per_block_optin = (int64_t)prop.sharedMemPerBlockOptin;
+  profile.shared_mem_per_multi_processor =
+      (int64_t)prop.sharedMemPerMultiprocessor;
+  profile.l2_cache_size = prop.l2CacheSize;
+  profile.clock_rate = prop.clockRate;
+  return profile;
+}
+
+DeviceProfile DeviceProfile::builtin(const std::string& name) {
+  const auto& profiles = builtinProfiles();
+  auto it = profiles.find(name);
+  TORCH_CHECK(
+      it != profiles.end(),
+      "Unknown device profile: ",
+      name,
+      ". Available profiles: ",
+      toDelimitedString(builtinNames()));
+  return it->second;
+}
+
+const std::vector<std::string>& DeviceProfile::builtinNames() {
+  static const std::vector<std::string> names = {
+      "v100", "t4", "a100", "a10", "h100"};
+  return names;
+}
+
+std::string DeviceProfile::toString() const {
+  std::stringstream ss;
+  ss << name << " (sm_" << major << minor << "): " << multi_processor_count
+     << " SMs, " << max_threads_per_multi_processor << " threads/SM, "
+     << max_threads_per_block << " threads/block, warp " << warp_size << ", "
+     << regs_per_block << " regs/block, " << shared_mem_per_block_optin
+     << " B smem/block, " << l2_cache_size << " B L2";
+  return ss.str();
+}
+
+const DeviceProfile* currentDeviceProfile() {
+  // Injected profiles are returned without querying the CUDA runtime, so
+  // that they can be used on hosts without a GPU
+  if (injected_profile != nullptr) {
+    return injected_profile;
+  }
+  return physicalDeviceProfile(at::cuda::current_device());
+}
+
+const DeviceProfile* deviceProfile(int64_t device_index) {
+  if (injected_profile != nullptr) {
+    return injected_profile;
+  }
+  return physicalDeviceProfile(device_index);
+}
+
+const DeviceProfile* physicalDeviceProfile(int64_t device_index) {
+  // Properties of real devices do not change, so convert them only once
+  static const std::vector<DeviceProfile> device_profiles = [] {
+    std::vector<DeviceProfile> profiles;
+    for (auto device : c10::irange(at::cuda::device_count())) {
+      profiles.push_back(DeviceProfile::fromProperties(
+          *at::cuda::getDeviceProperties(device)));
+    }
+    return profiles;
+  }();
+  return &device_profiles.at(device_index);
+}
+
+const DeviceProfile* injectedDeviceProfile() {
+  return injected_profile;
+}
+
+DeviceProfileGuard::DeviceProfileGuard(DeviceProfile profile)
+    : profile_(std::make_unique<const DeviceProfile>(std::move(profile))),
+      prev_profile_(injected_profile) {
+  injected_profile = profile_.get();
+}
+
+DeviceProfileGuard::DeviceProfileGuard(const DeviceProfile* profile)
+    : prev_profile_(injected_profile) {
+  if (profile != nullptr) {
+    injected_profile = profile;
+  }
+}
+
+DeviceProfileGuard::~DeviceProfileGuard() {
+  injected_profile = prev_profile_;
+}
+
+} // namespace nvfuser
@@ -0,0 +1,97 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <c10/macros/Export.h>
+
+#include <cuda_runtime_api.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nvfuser {
+
+//! Device properties used by segmentation, scheduling heuristics, lowering
+//! and codegen. By default these are read from the current CUDA device. A
+//! profile can be injected on a thread with DeviceProfileGuard so that
+//! everything up to
+//! CUDA source generation runs without a GPU, e.g., to generate kernels
+//! ahead of time or to test scheduling decisions for another architecture.
+struct TORCH_CUDA_CU_API DeviceProfile {
+  std::string name;
+  int major = 0;
+  int minor = 0;
+  int64_t multi_processor_count = 0;
+  int64_t max_threads_per_multi_processor = 0;
+  int64_t max_threads_per_block = 0;
+  int64_t warp_size = 32;
+  int64_t regs_per_block = 0;
+  int64_t regs_per_multi_processor = 0;
+  int64_t shared_mem_per_block = 0;
+  int64_t shared_mem_per_block_optin = 0;
+  int64_t shared_mem_per_multi_processor = 0;
+  int64_t l2_cache_size = 0;
+  //! Clock rate in kHz
+  int64_t clock_rate = 0;
+
+  //! Compute capability as major * 10 + minor, e.g., 80 for sm_80
+  int computeCapability() const {
+    return major * 10 + minor;
+  }
+
+  static DeviceProfile fromProperties(const cudaDeviceProp& prop);
+
+  //! Built-in profile of a common architecture, see builtinNames()
+  static DeviceProfile builtin(const std::string& name);
+
+  static const std::vector<std::string>& builtinNames();
+
+  std::string toString() const;
+};
+
+//! Profile of the device kernels are generated for. Returns the profile
+//! injected on this thread by the innermost DeviceProfileGuard, otherwise the
+//! properties of the current CUDA device. The profile is valid as long as
+//! the guard that injected it.
+TORCH_CUDA_CU_API const DeviceProfile* currentDeviceProfile();
+
+//! Same as currentDeviceProfile, but for the given CUDA device when no
+//! profile is injected
+TORCH_CUDA_CU_API const DeviceProfile* deviceProfile(int64_t device_index);
+
+//! Properties of the given CUDA device, ignoring injected profiles. Only
+//! needed where the physical device matters, e.g., to decide whether a
+//! kernel generated for the current profile can be loaded.
+TORCH_CUDA_CU_API const DeviceProfile* physicalDeviceProfile(
+    int64_t device_index);
+
+//! Profile injected on this thread by the innermost DeviceProfileGuard, or
+//! nullptr. Work handed to other threads, like the compilation of segments,
+//! injects it there with DeviceProfileGuard as well.
+TORCH_CUDA_CU_API const DeviceProfile* injectedDeviceProfile();
+
+//! Injects a device profile on the current thread for its lifetime
+class TORCH_CUDA_CU_API DeviceProfileGuard {
+ public:
+  explicit DeviceProfileGuard(DeviceProfile profile);
+  //! Injects a profile owned by a guard of another thread, which must outlive
+  //! this guard. A nullptr profile keeps the current one.
+  explicit DeviceProfileGuard(const DeviceProfile* profile);
+  ~DeviceProfileGuard();
+
+  DeviceProfileGuard(const DeviceProfileGuard&) = delete;
+  DeviceProfileGuard& operator=(const DeviceProfileGuard&) = delete;
+
+ private:
+  std::unique_ptr<const DeviceProfile> profile_;
+  const DeviceProfile* prev_profile_;
+};
+
+} // namespace nvfuser
@@ -9,7 +9,9 @@
 #include <executor.h>
 
 #include <codegen.h>
+#include <compiled_kernel_cache.h>
 #include <device_lower/analysis/bank_conflict.h>
+#include <device_profile.h>
 #include <executor_kernel_arg.h>
 #include <executor_utils.h>
 #include <instrumentation.h>
@@ -33,7 +35,7 @@
 
 namespace nvfuser {
 
-int64_t FusionExecutor::fusion_id_counter_ = 0;
+std::atomic<int64_t> FusionExecutor::fusion_id_counter_{0};
 
 bool fill_allocation_with_nan_ = false;
 
@@ -93,12 +95,28 @@ std::unique_ptr<PrecomputedValues>& FusionExecutor::
 std::string FusionExecutor::getStructuredCode(
     const std::string& kernel_str,
     PrimDataType index_type) const {
+  return getStructuredCodeWithPreamble(
+      kernel_str, index_type, executor_utils::kernelPreamble());
+}
+
+std::string FusionExecutor::getStructuredCode(
+    const std::string& kernel_str,
+    PrimDataType index_type,
+    const codegen::RuntimeModules& runtime_modules) const {
+  return getStructuredCodeWithPreamble(
+      kernel_str, index_type, executor_utils::kernelPreamble(runtime_modules));
+}
+
+std::string FusionExecutor::getStructuredCodeWithPreamble(
+    const std::string& kernel_str,
+    PrimDataType index_type,
+    const std::string& preamble) const {
   // generating cuda code;
   std::string code = "";
   code += includeStdComplex();
   code += std::string("namespace ") + FusionExecutor::kernelNamespace() +
-      " {\n" + defineIntegerTypes() + defineIndexType(index_type) +
-      executor_utils::kernelPreamble() + kernel_str + "}\n";
+      " {\n" + defineIntegerTypes() + defineIndexType(index_type) + preamble +
+      kernel_str + "}\n";
 
   if (isDebugDumpEnabled(DebugDumpOption::CudaKernel)) {
     std::cout << "\n======= Codegen output for kernel: " << kernelName()
@@ -123,7 +141,8 @@ std::string FusionExecutor::getStructuredCode(
 }
 
 std::string FusionExecutor::getStructuredCode() const {
-  return getStructuredCode(kernelString(), kernel()->indexType());
+  return getStructuredCode(
+      kernelString(), kernel()->indexType(), runtime_modules_);
 }
 
 // TODO: come up with a more user friendly interface
@@ -256,13 +275,24 @@ void FusionExecutor::compileFusion(
 
   TORCH_INTERNAL_ASSERT(
       options_.device.is_cuda(), "Provided device to CUDA fuser is the CPU.");
-  auto properties = at::cuda::getDeviceProperties(options_.device.index());
+  // The kernel is checked against the device it is generated for, which is
+  // an injected profile when generating kernels for another device
+  auto properties = currentDeviceProfile();
   // TODO: These properties should be set as part of the constructor so that it
   // can be const
-  device_smem_limit_ = static_cast<int64_t>(properties->sharedMemPerBlockOptin);
-  warp_size_ = properties->warpSize;
+  device_smem_limit_ = properties->shared_mem_per_block_optin;
+  warp_size_ = properties->warp_size;
+
+  auto external_code_path = std::getenv("PYTORCH_NVFUSER_EXTERNAL_SRC");
+  const bool reuse_kernel = external_code_path == nullptr &&
+      !isOptionDisabled(DisableOption::KernelReuse);
+  std::optional<KernelFingerprint> fingerprint;
+  if (reuse_kernel) {
+    fingerprint = fingerprintFusion(fusion);
+  }
 
-  lowered_ = std::make_unique<GpuLower>(fusion, compile_params);
+  lowered_ = std::make_unique<GpuLower>(
+      fusion, compile_params, collect_lower_pass_stats_);
 
   const auto kernel = lowered_->kernel();
   fusion_ = lowered_->kernel()->as<Fusion>();
@@ -295,21 +325,6 @@ void FusionExecutor::compileFusion(
     }
   }
 
-  kernel_code_ = codegen::generateCudaKernel(kernel, kernelName());
-
-  auto load_external_code = [](const char* external_code_path) {
-    std::cout << "--------> Compiling external cuda code: "
-              << external_code_path << std::endl;
-    std::ifstream cuda_src(external_code_path);
-    std::stringstream buffer;
-    buffer << cuda_src.rdbuf();
-    return buffer.str();
-  };
-  auto external_code_path = std::getenv("PYTORCH_NVFUSER_EXTERNAL_SRC");
-  const auto structured_code = external_code_path
-      ? load_external_code(external_code_path)
-      : getStructuredCode();
-
   const auto& kernel_summary = kernel->summary();
 
   // We currently shouldn't allocate any more shared mem
@@ -337,9 +352,10 @@ void FusionExecutor::compileFusion(
   // TODO: pass block_size here;
   std::optional<int64_t> dynamic_smem = std::nullopt;
   std::optional<int64_t> block_size = std::nullopt;
+  LaunchParams launch_params;
   if (!args.empty()) {
     auto expr_eval = executor_utils::bindInputs(args, kernel);
-    auto launch_params =
+    launch_params =
         computeLaunchParams(launch_constraints, expr_eval, warp_size_);
     block_size = launch_params.nThreads();
     dynamic_smem = launch_params.smem();
@@ -357,21 +373,109 @@ void FusionExecutor::compileFusion(
       (block_size.has_value() ? block_size.value() : 1),
       block_size_high_water_mark_);
   maxrregcount_high_water_mark_ = compile_params.maxrregcount;
-  std::tie(compiled_kernel_, last_compiler_log_, last_compiled_binary_) =
-      executor_utils::getCompiledKernel(
-          kernel_code_,
-          structured_code,
-          getCanonicalKernelName(),
-          fusion_id_,
-          block_size,
-          maxrregcount_high_water_mark_,
-          save_compiled_binary_ || isDebugDumpEnabled(DebugDumpOption::Sass));
+  const bool keep_compiled_binary = save_compiled_binary_ ||
+      isDebugDumpEnabled(DebugDumpOption::Sass) ||
+      CompiledKernelCache::get().keepCompiledBinaries();
+
+  // Kernels with the same fingerprint and compilation parameters generate
+  // the same code, so reuse the kernel compiled by another executor
+  std::optional<CompiledKernelKey> shared_kernel_key;
+  shared_kernel_.reset();
+  if (fingerprint.has_value()) {
+    shared_kernel_key = CompiledKernelKey{
+        std::move(fingerprint.value()),
+        kernel->indexType(),
+        maxrregcount_high_water_mark_,
+        compile_params.enable_magic_zero,
+        properties->major,
+        properties->minor,
+        properties->multi_processor_count,
+        keep_compiled_binary,
+        executor_utils::compileOptionsSignature()};
+    shared_kernel_ = CompiledKernelCache::get().lookup(*shared_kernel_key);
+  }
+
+  if (shared_kernel_ != nullptr) {
+    // Keep the id of this executor, and rename the kernel in the shared code
+    // accordingly, so that recompiling it, e.g., for a larger block size,
+    // looks up the right function
+    kernel_code_ = shared_kernel_->kernel_code;
+    const std::string shared_declaration =
+        "__global__ void kernel" + std::to_string(shared_kernel_->fusion_id) +
+        "(";
+    const auto declaration_pos = kernel_code_.find(shared_declaration);
+    TORCH_INTERNAL_ASSERT(
+        declaration_pos != std::string::npos,
+        "Kernel declaration not found in shared kernel code");
+    kernel_code_.replace(
+        declaration_pos,
+        shared_declaration.size(),
+        "__global__ void " + kernelName() + "(");
+    runtime_modules_ = shared_kernel_->runtime_modules;
+    // The shared kernel may have been compiled for smaller blocks than this
+    // executor launches, in which case the launch recompiles it
+    if (shared_kernel_->block_size.has_value()) {
+      block_size_high_water_mark_ = shared_kernel_->block_size.value();
+    }
+    compiled_kernel_ = shared_kernel_->compiled_kernel;
+    last_compiler_log_ = shared_kernel_->compiler_log;
+    last_compiled_binary_ = shared_kernel_->compiled_binary;
+  } else {
+    runtime_modules_.clear();
+    kernel_code_ =
+        codegen::generateCudaKernel(kernel, kernelName(), &runtime_modules_);
+
+    auto load_external_code = [](const char* external_code_path) {
+      std::cout << "--------> Compiling external cuda code: "
+                << external_code_path << std::endl;
+      std::ifstream cuda_src(external_code_path);
+      std::stringstream buffer;
+      buffer << cuda_src.rdbuf();
+      return buffer.str();
+    };
+    const auto structured_code = external_code_path
+        ? load_external_code(external_code_path)
+        : getStructuredCode();
+
+    std::string lowered_kernel_name;
+    std::tie(compiled_kernel_, last_compiler_log_, last_compiled_binary_) =
+        executor_utils::getCompiledKernel(
+            kernel_code_,
+            structured_code,
+            getCanonicalKernelName(),
+            fusion_id_,
+            block_size,
+            maxrregcount_high_water_mark_,
+            keep_compiled_binary,
+            &lowered_kernel_name);
+
+    if (shared_kernel_key.has_value()) {
+      shared_kernel_ = CompiledKernelCache::get().insert(
+          *shared_kernel_key,
+          {fusion_id_,
+           kernel_code_,
+           runtime_modules_,
+           compiled_kernel_,
+           last_compiler_log_,
+           last_compiled_binary_,
+           lowered_kernel_name,
+           block_size,
+           launch_params,
+           heuristic_,
+           heuristic_params_});
+    }
+  }
   TORCH_INTERNAL_ASSERT(
       fusion_id_ > 0, "failed to assign a fusion_id_ after compilation.");
 
   // These should be nullopt at this point, but reset just in case
   resetCompiledKernelProperties();
 
+  // Kernels generated for another device are only compiled, not loaded
+  if (compiled_kernel_.function == nullptr) {
+    return;
+  }
+
   // If the dynamic shmem size is known, make sure the compiled kernel
   // has at least that size of dynamic shmem
   if (dynamic_smem.has_value()) {
@@ -1326,8 +1430,9 @@ void validateCooperativeLaunch(
 
   auto grid_size =
       launch_params.gdimx() * launch_params.gdimy() * launch_params.gdimz();
-  auto max_active_blocks = num_blocks_per_SM *
-      at::cuda::getDeviceProperties(device_index)->multiProcessorCount;
+  const auto multi_processor_count =
+      deviceProfile(device_index)->multi_processor_count;
+  auto max_active_blocks = num_blocks_per_SM * multi_processor_count;
   TORCH_INTERNAL_ASSERT(
       (int64_t)(max_active_blocks) >= grid_size,
       "Wanted to launch a cooperative kernel, however the number of blocks is greater than ",
@@ -1342,7 +1447,7 @@ void validateCooperativeLaunch(
       ") but limited to ",
       num_blocks_per_SM,
       " * ",
-      at::cuda::getDeviceProperties(device_index)->multiProcessorCount);
+      multi_processor_count);
 }
 
 // Dump fusion inputs and outputs as well as some useful fusion
@@ -1491,6 +1596,8 @@ void FusionExecutor::recompileKernel(
   const auto structured_code = getStructuredCode();
   block_size_high_water_mark_ = new_launch_params.nThreads();
   maxrregcount_high_water_mark_ = new_compile_params.maxrregcount;
+  // The recompiled kernel is private to this executor
+  shared_kernel_.reset();
 
   std::tie(compiled_kernel_, last_compiler_log_, last_compiled_binary_) =
       executor_utils::getCompiledKernel(
@@ -1597,12 +1704,12 @@ std::vector<TensorView*> FusionExecutor::getTvsForKernelArguments() const {
   return tvs;
 }
 
-std::vector<at::Tensor> FusionExecutor::runFusion(
+FusionExecutor::PreparedLaunch FusionExecutor::prepareLaunch(
     KernelArgumentHolder& args,
     const LaunchParams& launch_constraints,
     CompileParams compile_params,
     std::vector<at::Tensor> outputs) {
-  FUSER_PERF_SCOPE("FusionExecutor::RunFusion");
+  FUSER_PERF_SCOPE("FusionExecutor::prepareLaunch");
   TORCH_INTERNAL_ASSERT(compiled());
   TORCH_INTERNAL_ASSERT(
       fusion_id_ > 0, "Cannot run fusion, it was not compiled.");
@@ -1620,28 +1727,41 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
   }
 
   c10::DeviceGuard dg(options_.device);
-  auto stream = at::cuda::getCurrentCUDAStream();
   at::cuda::jit::initializeCudaContext();
   TORCH_INTERNAL_ASSERT(lowered_);
 
-  // Placeholder for the case where parameter cache is not used
-  ExecutorEntry temporary_executor_entry;
-
-  ExecutorEntry* executor_entry =
-      args.getCacheId().has_value() && !disable_parameter_cache_
-      ? &executor_entry_lookup_[*args.getCacheId()]
-      : &temporary_executor_entry;
+  // Only the entry lookup and the kernel recompilation are done under the
+  // lock, the rest of the launch works on the entry of this run
+  std::shared_ptr<const ExecutorEntry> executor_entry;
+  CUfunction function = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(*mutex_);
+    std::shared_ptr<const ExecutorEntry>* cached_entry =
+        args.getCacheId().has_value() && !disable_parameter_cache_
+        ? &executor_entry_lookup_[*args.getCacheId()]
+        : nullptr;
+    if (cached_entry != nullptr) {
+      executor_entry = *cached_entry;
+    }
 
-  // Initialize the executor entry if not initlized
-  if (!executor_entry->init) {
-    initializeExecutorEntry(
-        *executor_entry, args, launch_constraints, compile_params, outputs);
-  }
+    // Initialize the executor entry if not initlized
+    if (executor_entry == nullptr) {
+      auto new_entry = std::make_shared<ExecutorEntry>();
+      initializeExecutorEntry(
+          *new_entry, args, launch_constraints, compile_params, outputs);
+      if (cached_entry != nullptr) {
+        *cached_entry = new_entry;
+      }
+      executor_entry = std::move(new_entry);
+    }
 
-  recompileKernel(executor_entry->launch_params, compile_params);
+    recompileKernel(executor_entry->launch_params, compile_params);
+    ensureAvailableDynamicSmemSize(executor_entry->launch_params.smem());
+    function = compiled_kernel_.function;
 
-  // TODO: Why does this need to be stored in the class?
-  launch_params_ = executor_entry->launch_params;
+    // TODO: Why does this need to be stored in the class?
+    launch_params_ = executor_entry->launch_params;
+  }
 
   // context manager to disable auto grad for `empty_cuda` calls later
   at::AutoDispatchBelowADInplaceOrView non_variable_type_mode;
@@ -1701,7 +1821,7 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
   }
 
   if (isDebugDumpEnabled(DebugDumpOption::LaunchParam)) {
-    launch_params_.print();
+    executor_entry->launch_params.print();
   }
 
   if (isDebugDumpEnabled(DebugDumpOption::KernelArgs)) {
@@ -1718,6 +1838,64 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
     std::cout << "Index type: " << kernel()->indexType() << std::endl;
   }
 
+  PreparedLaunch prepared;
+  prepared.launch_params = executor_entry->launch_params;
+  prepared.function = function;
+  auto ee = executor_utils::bindInputs(args, kernel());
+  prepared.arg_buffer =
+      args.getBuffer(kernel()->indexType(), getTvsForKernelArguments(), ee);
+  prepared.outputs = std::move(outputs);
+  prepared.intermediates = std::move(intermediates);
+  prepared.profile_buffer = std::move(profile_buffer);
+  return prepared;
+}
+
+void FusionExecutor::launch(const PreparedLaunch& prepared) {
+  c10::DeviceGuard dg(options_.device);
+  auto stream = at::cuda::getCurrentCUDAStream();
+  if (!kernel()->summary().has_cooperative_grid_reduction) {
+    FUSER_PERF_SCOPE("ExecutorRunFusion::cuLaunchKernel");
+    CUDA_SAFE_CALL(cuLaunchKernel(
+        prepared.function,
+        prepared.launch_params.gdimx(),
+        prepared.launch_params.gdimy(),
+        prepared.launch_params.gdimz(),
+        prepared.launch_params.bdimx(),
+        prepared.launch_params.bdimy(),
+        prepared.launch_params.bdimz(),
+        prepared.launch_params.smem(),
+        stream,
+        prepared.arg_buffer,
+        nullptr));
+  } else {
+    FUSER_PERF_SCOPE("ExecutorRunFusion::cuLaunchCooperativeKernel");
+    CUDA_SAFE_CALL(cuLaunchCooperativeKernel(
+        prepared.function,
+        prepared.launch_params.gdimx(),
+        prepared.launch_params.gdimy(),
+        prepared.launch_params.gdimz(),
+        prepared.launch_params.bdimx(),
+        prepared.launch_params.bdimy(),
+        prepared.launch_params.bdimz(),
+        prepared.launch_params.smem(),
+        stream,
+        prepared.arg_buffer));
+  }
+}
+
+std::vector<at::Tensor> FusionExecutor::runFusion(
+    KernelArgumentHolder& args,
+    const LaunchParams& launch_constraints,
+    CompileParams compile_params,
+    std::vector<at::Tensor> outputs) {
+  FUSER_PERF_SCOPE("FusionExecutor::RunFusion");
+  const auto num_inputs = args.size();
+  auto prepared = prepareLaunch(
+      args, launch_constraints, compile_params, std::move(outputs));
+
+  c10::DeviceGuard dg(options_.device);
+  auto stream = at::cuda::getCurrentCUDAStream();
+
   cudaEvent_t start_event = {};
   cudaEvent_t finish_event = {};
 
@@ -1730,38 +1908,7 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
   }
 
   if (execute_kernel_) {
-    ensureAvailableDynamicSmemSize(executor_entry->launch_params.smem());
-    auto ee = executor_utils::bindInputs(args, kernel());
-    auto arg_buffer =
-        args.getBuffer(kernel()->indexType(), getTvsForKernelArguments(), ee);
-    if (!kernel()->summary().has_cooperative_grid_reduction) {
-      FUSER_PERF_SCOPE("ExecutorRunFusion::cuLaunchKernel");
-      CUDA_SAFE_CALL(cuLaunchKernel(
-          compiled_kernel_.function,
-          launch_params_.gdimx(),
-          launch_params_.gdimy(),
-          launch_params_.gdimz(),
-          launch_params_.bdimx(),
-          launch_params_.bdimy(),
-          launch_params_.bdimz(),
-          launch_params_.smem(),
-          stream,
-          arg_buffer,
-          nullptr));
-    } else {
-      FUSER_PERF_SCOPE("ExecutorRunFusion::cuLaunchCooperativeKernel");
-      CUDA_SAFE_CALL(cuLaunchCooperativeKernel(
-          compiled_kernel_.function,
-          launch_params_.gdimx(),
-          launch_params_.gdimy(),
-          launch_params_.gdimz(),
-          launch_params_.bdimx(),
-          launch_params_.bdimy(),
-          launch_params_.bdimz(),
-          launch_params_.smem(),
-          stream,
-          arg_buffer));
-    }
+    launch(prepared);
   }
 
   if (measure_kernel_time_ ||
@@ -1784,7 +1931,7 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
             (int64_t)dataTypeSize(tensor_arg_abstract->getDataType());
       }
     }
-    for (const auto& output : outputs) {
+    for (const auto& output : prepared.outputs) {
       bytes_processed_ += output.numel() *
           (int64_t)dataTypeSize(aten_to_data_type(output.scalar_type()));
     }
@@ -1799,10 +1946,10 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
   }
 
   if (isOptionEnabled(EnableOption::KernelProfile)) {
-    std::cout << kernel()->profile().toString(profile_buffer);
+    std::cout << kernel()->profile().toString(prepared.profile_buffer);
   }
 
-  return outputs;
+  return prepared.outputs;
 }
 
 void FusionExecutor::compileRtc(
@@ -6,6 +6,7 @@
  */
 // clang-format on
 #pragma once
+#include <compiled_kernel_cache.h>
 #include <device_lower/lower2device.h>
 #include <executor_params.h>
 #include <executor_utils.h>
@@ -18,6 +19,10 @@
 
 #include <c10/core/DeviceType.h>
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 namespace nvfuser {
 
 TORCH_CUDA_CU_API bool shouldFillAllocationWithNan();
@@ -87,6 +92,34 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
       CompileParams compile_params = CompileParams(),
       std::vector<at::Tensor> outputs = {});
 
+  //! What a launch of the compiled kernel needs, see prepareLaunch
+  struct PreparedLaunch {
+    LaunchParams launch_params;
+    //! Kernel compiled for launch_params, see recompileKernel
+    CUfunction function = nullptr;
+    std::vector<at::Tensor> outputs;
+    std::vector<at::Tensor> intermediates;
+    at::Tensor profile_buffer;
+    //! Kernel parameters. Points into the argument holder given to
+    //! prepareLaunch, so it is valid as long as the holder is not modified.
+    void** arg_buffer = nullptr;
+  };
+
+  //! Does everything runFusion does before launching the kernel: computes
+  //! the launch parameters, allocates outputs and intermediate buffers and
+  //! pushes them to args. Used by runFusion and by HorizontalKernel, which
+  //! launches several kernels at once. Several threads may prepare launches
+  //! of the same executor concurrently.
+  PreparedLaunch prepareLaunch(
+      KernelArgumentHolder& args,
+      const LaunchParams& launch_constraints = LaunchParams(),
+      CompileParams compile_params = CompileParams(),
+      std::vector<at::Tensor> outputs = {});
+
+  //! Launches the compiled kernel with a prepared launch on the current
+  //! stream
+  void launch(const PreparedLaunch& prepared);
+
   std::vector<at::Tensor> runFusion(
       const at::ArrayRef<c10::IValue>& inputs,
       const std::vector<at::Tensor>& outputs,
@@ -115,7 +148,26 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
     return fusion_id_ != -1 && lowered_ && compiled_kernel_.function != nullptr;
   };
 
+  //! Returns the CompiledKernelCache entry of the kernel, null if the kernel
+  //! isn't shared
+  const CompiledKernelEntry* sharedKernel() const {
+    return shared_kernel_.get();
+  }
+
+  //! Returns false if the compiled kernel accesses an input, or an output
+  //! aliasing an input, of args with aligned vectorization but its data
+  //! pointer is not aligned to the vector word size. Such tensors would
+  //! fail validation in runFusion.
+  bool hasAlignedVectorizedTensors(const KernelArgumentHolder& args) {
+    TORCH_INTERNAL_ASSERT(compiled(), "Kernel is not compiled");
+    // The compile-time data cache is filled lazily
+    std::lock_guard<std::mutex> guard(*mutex_);
+    return executor_utils::hasAlignedVectorizedTensors(
+        lowered_->kernel(), args, compileTimeDataCache());
+  }
+
   void evictCache(size_t cache_id) {
+    std::lock_guard<std::mutex> guard(*mutex_);
     executor_entry_lookup_.erase(cache_id);
   }
 
@@ -144,11 +196,32 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
     return lowered_->kernel();
   }
 
+  //! Per-pass statistics of the lowering of this kernel
+  const std::vector<LowerPassStats>& lowerPassStats() const {
+    TORCH_INTERNAL_ASSERT(lowered_);
+    return lowered_->passStats();
+  }
+
   //! Internal knob used for debugging/profiling only
   void setExecuteKernelFlag(bool execute_kernel) {
     execute_kernel_ = execute_kernel;
   }
 
+  //! Collect the per-pass statistics of the lowerings of later compilations,
+  //! see lowerPassStats
+  void setCollectLowerPassStats(bool collect_lower_pass_stats) {
+    collect_lower_pass_stats_ = collect_lower_pass_stats;
+  }
+
+  //! Heuristic the fusion of the next compilation is scheduled with, see
+  //! toString(ScheduleHeuristic), and its parameters, see
+  //! serializeHeuristicParams. They are recorded with the compiled kernel,
+  //! e.g., to be written to a kernel bundle.
+  void setHeuristicParams(std::string heuristic, std::string params) {
+    heuristic_ = std::move(heuristic);
+    heuristic_params_ = std::move(params);
+  }
+
   //! Internal knob used for debugging/profiling only
   void setMeasureKernelTimeFlag(bool measure_kernel_time) {
     measure_kernel_time_ = measure_kernel_time;
@@ -175,6 +248,7 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
 
   //! Returns the launch parameters from the last kernel execution
   LaunchParams lastLaunchParams() const {
+    std::lock_guard<std::mutex> guard(*mutex_);
     return launch_params_;
   }
 
@@ -184,11 +258,24 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
     return kernel_code_;
   }
 
-  // Add preamble and wrap in namespace
+  //! Returns the runtime modules the generated kernel calls into
+  const codegen::RuntimeModules& runtimeModules() const {
+    return runtime_modules_;
+  }
+
+  // Add preamble and wrap in namespace. Without an explicit module set the
+  // full preamble is used as the kernel string may call any helper.
   std::string getStructuredCode(
       const std::string& kernel,
       PrimDataType index_type) const;
 
+  std::string getStructuredCode(
+      const std::string& kernel,
+      PrimDataType index_type,
+      const codegen::RuntimeModules& runtime_modules) const;
+
+  //! Structured code of the generated kernel, with only the runtime modules
+  //! it uses in the preamble
   std::string getStructuredCode() const;
 
   //! Returns the latest compile log
@@ -213,6 +300,10 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
         last_compiled_binary_, "-fun 1 -c");
   }
 
+  static std::string kernelNamespace() {
+    return "CudaCodeGen";
+  }
+
   std::string getCanonicalKernelName() const {
     return kernelNamespace() + "::" + kernelName();
   }
@@ -253,9 +344,10 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
       const at::ArrayRef<c10::IValue>& inputs);
 
  private:
-  static std::string kernelNamespace() {
-    return "CudaCodeGen";
-  }
+  std::string getStructuredCodeWithPreamble(
+      const std::string& kernel,
+      PrimDataType index_type,
+      const std::string& preamble) const;
 
   LaunchParams computeLaunchParams(
       const LaunchParams& launch_constraints,
@@ -355,12 +447,16 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
   int64_t warp_size_ = 0;
   executor_utils::NvrtcFunction compiled_kernel_;
 
+  // Kernel shared through CompiledKernelCache. Holding it keeps the cache
+  // entry referenced while this executor uses it.
+  std::shared_ptr<const CompiledKernelEntry> shared_kernel_;
+
   // TensorViews actually used in the kernel.
   std::vector<TensorView*> used_tvs_;
 
   // Counter to be used for kernel name.
   int64_t fusion_id_ = -1;
-  static int64_t fusion_id_counter_;
+  static std::atomic<int64_t> fusion_id_counter_;
 
   std::unique_ptr<GpuLower> lowered_;
   // Copy of lowered_->kernel()
@@ -372,8 +468,17 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
   int64_t maxrregcount_high_water_mark_ = 255;
 
   // lookup table to take short cut to retrieve recorded information in order to
-  // launch kernels without re-inference parameters.
-  std::unordered_map<size_t, ExecutorEntry> executor_entry_lookup_;
+  // launch kernels without re-inference parameters. Entries are immutable
+  // once initialized, and runs hold on to their entry, so it may be evicted
+  // while in use.
+  std::unordered_map<size_t, std::shared_ptr<const ExecutorEntry>>
+      executor_entry_lookup_;
+
+  // Guards executor_entry_lookup_, the compile-time data cache, the
+  // recompilation of the kernel and launch_params_, so that launches of this
+  // executor can be prepared concurrently. Held in a unique_ptr to keep the
+  // executor movable.
+  std::unique_ptr<std::mutex> mutex_ = std::make_unique<std::mutex>();
 
   // Compile time information caching. This is used for shape inference
   //  support. The cache stores graph information that are available
@@ -391,6 +496,9 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
   // Profiling support: knob to enable measuring kernel execution time
   bool measure_kernel_time_ = false;
 
+  // Profiling support: knob to collect the statistics of lowering passes
+  bool collect_lower_pass_stats_ = false;
+
   // Profiling support: the last kernel execution time, if measure_kernel_time_
   // is true
   float kernel_time_ms_ = 0;
@@ -410,12 +518,20 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
   // Profiling support: kept copy of the cuda kernel
   std::string kernel_code_;
 
+  // Runtime modules kernel_code_ calls into. Used to prune the preamble.
+  codegen::RuntimeModules runtime_modules_;
+
   // Profiling support: nvrtc log for debugging
   std::string last_compiler_log_;
 
   // save compiled binary
   bool save_compiled_binary_ = false;
 
+  // Heuristic and parameters the fusion is scheduled with, see
+  // setHeuristicParams
+  std::string heuristic_;
+  std::string heuristic_params_;
+
   // nvrtc compiled binary
   std::vector<char> last_compiled_binary_;
 };
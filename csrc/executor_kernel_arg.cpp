@@ -326,45 +326,45 @@ PrimDataType TensorArgAbstract::getSmallestIndexType() const {
 namespace {
 
 template <int nalloc, typename nvfuser_index_t>
-std::unique_ptr<TensorArgAbstract> getTensorArg(
+std::shared_ptr<TensorArgAbstract> getTensorArg(
     at::Tensor tensor,
     TensorView* tv,
     ExpressionEvaluator& eval) {
   switch (tensor.ndimension()) {
     case (0):
-      return std::make_unique<
+      return std::make_shared<
           TensorArg<TensorArgCodegen<0, nalloc, nvfuser_index_t>>>(
           std::move(tensor), tv, eval);
     case (1):
-      return std::make_unique<
+      return std::make_shared<
           TensorArg<TensorArgCodegen<1, nalloc, nvfuser_index_t>>>(
           std::move(tensor), tv, eval);
     case (2):
-      return std::make_unique<
+      return std::make_shared<
           TensorArg<TensorArgCodegen<2, nalloc, nvfuser_index_t>>>(
           std::move(tensor), tv, eval);
     case (3):
-      return std::make_unique<
+      return std::make_shared<
           TensorArg<TensorArgCodegen<3, nalloc, nvfuser_index_t>>>(
           std::move(tensor), tv, eval);
     case (4):
-      return std::make_unique<
+      return std::make_shared<
           TensorArg<TensorArgCodegen<4, nalloc, nvfuser_index_t>>>(
           std::move(tensor), tv, eval);
     case (5):
-      return std::make_unique<
+      return std::make_shared<
           TensorArg<TensorArgCodegen<5, nalloc, nvfuser_index_t>>>(
           std::move(tensor), tv, eval);
     case (6):
-      return std::make_unique<
+      return std::make_shared<
           TensorArg<TensorArgCodegen<6, nalloc, nvfuser_index_t>>>(
           std::move(tensor), tv, eval);
     case (7):
-      return std::make_unique<
+      return std::make_shared<
           TensorArg<TensorArgCodegen<7, nalloc, nvfuser_index_t>>>(
           std::move(tensor), tv, eval);
     case (8):
-      return std::make_unique<
+      return std::make_shared<
           TensorArg<TensorArgCodegen<8, nalloc, nvfuser_index_t>>>(
           std::move(tensor), tv, eval);
     default:
@@ -378,7 +378,7 @@ std::unique_ptr<TensorArgAbstract> getTensorArg(
 }
 
 template <typename nvfuser_index_t>
-std::unique_ptr<TensorArgAbstract> getTensorArg(
+std::shared_ptr<TensorArgAbstract> getTensorArg(
     at::Tensor tensor,
     TensorView* tv,
     ExpressionEvaluator& eval) {
@@ -418,11 +418,11 @@ std::unique_ptr<TensorArgAbstract> getTensorArg(
   return nullptr;
 }
 
-std::unique_ptr<TensorArgAbstract> getAbstractTensorArg(at::Tensor tensor) {
-  return std::make_unique<TensorArgAbstract>(std::move(tensor));
+std::shared_ptr<TensorArgAbstract> getAbstractTensorArg(at::Tensor tensor) {
+  return std::make_shared<TensorArgAbstract>(std::move(tensor));
 }
 
-std::unique_ptr<TensorArgAbstract> getTensorArg(
+std::shared_ptr<TensorArgAbstract> getTensorArg(
     at::Tensor tensor,
     TensorView* tv,
     ExpressionEvaluator& eval,
@@ -454,6 +454,7 @@ KernelArgumentHolder KernelArgumentHolder::createKernelArgumentHolder(
 
   KernelArgumentHolder args;
   args.setDeviceIndex(device_index);
+  args.reserve(inputs.size());
   args.push(inputs);
 
   return args;
@@ -462,8 +463,8 @@ KernelArgumentHolder KernelArgumentHolder::createKernelArgumentHolder(
 namespace {
 
 template <size_t size>
-std::unique_ptr<ArgAbstract> makeCpuScalarTensorArg(const at::Tensor& tensor) {
-  auto ptr = std::make_unique<CpuScalarTensorArg<size>>();
+std::shared_ptr<ArgAbstract> makeCpuScalarTensorArg(const at::Tensor& tensor) {
+  auto ptr = std::make_shared<CpuScalarTensorArg<size>>();
   static_assert(sizeof(ptr->instance_) == size);
   std::memcpy(&(ptr->instance_), tensor.data_ptr(), size);
   return ptr;
@@ -506,16 +507,16 @@ void KernelArgumentHolder::push(const c10::IValue& val) {
   switch (scalar_val.type()) {
     case c10::ScalarType::ComplexDouble:
       arguments_.push_back(
-          std::make_unique<ComplexDoubleArg>(scalar_val.toComplexDouble()));
+          std::make_shared<ComplexDoubleArg>(scalar_val.toComplexDouble()));
       return;
     case c10::ScalarType::Double:
-      arguments_.push_back(std::make_unique<DoubleArg>(scalar_val.toDouble()));
+      arguments_.push_back(std::make_shared<DoubleArg>(scalar_val.toDouble()));
       return;
     case c10::ScalarType::Long:
-      arguments_.push_back(std::make_unique<LongArg>(scalar_val.toLong()));
+      arguments_.push_back(std::make_shared<LongArg>(scalar_val.toLong()));
       return;
     case c10::ScalarType::Bool:
-      arguments_.push_back(std::make_unique<BoolArg>(scalar_val.toBool()));
+      arguments_.push_back(std::make_shared<BoolArg>(scalar_val.toBool()));
       return;
     default:
       TORCH_INTERNAL_ASSERT(
@@ -528,18 +529,18 @@ void KernelArgumentHolder::push(const c10::IValue& val) {
 }
 
 void KernelArgumentHolder::push(int64_t val) {
-  arguments_.push_back(std::make_unique<LongArg>(val));
+  arguments_.push_back(std::make_shared<LongArg>(val));
 }
 
 void KernelArgumentHolder::push(const at::PhiloxCudaState& val) {
-  arguments_.push_back(std::make_unique<PhiloxCudaStateArg>(val));
+  arguments_.push_back(std::make_shared<PhiloxCudaStateArg>(val));
 }
 
 // Create buffer, flatten arguments into it, align by 8 Bytes, return pointers
 // in the buffer
 void** KernelArgumentHolder::getBuffer(
     PrimDataType index_type,
-    std::vector<TensorView*> tvs,
+    const std::vector<TensorView*>& tvs,
     ExpressionEvaluator& eval) {
   TORCH_INTERNAL_ASSERT(
       arguments_.size() == tvs.size(),
@@ -548,16 +549,17 @@ void** KernelArgumentHolder::getBuffer(
     void_ptrs_.resize(arguments_.size());
   }
   for (const auto i : c10::irange(arguments_.size())) {
-    if (auto tensor_arg =
-            dynamic_cast<TensorArgAbstract*>(arguments_.at(i).get())) {
+    auto& arg = arguments_[i];
+    if (arg->isType(ArgType::Tensor)) {
+      auto tensor_arg = static_cast<TensorArgAbstract*>(arg.get());
       if (tensor_arg->isAbstract() ||
           tensor_arg->getIndexType() != index_type) {
-        auto resolved_arg =
-            getTensorArg(tensor_arg->getTensor(), tvs.at(i), eval, index_type);
-        arguments_.at(i) = std::move(resolved_arg);
+        // The argument may be shared with other holders, so it is replaced
+        // rather than modified
+        arg = getTensorArg(tensor_arg->getTensor(), tvs[i], eval, index_type);
       }
     }
-    void_ptrs_.at(i) = static_cast<void*>(arguments_.at(i)->arg());
+    void_ptrs_[i] = static_cast<void*>(arg->arg());
   }
   return void_ptrs_.data();
 }
@@ -585,19 +587,22 @@ void KernelArgumentHolder::push(const ArgAbstract* arg) {
   arguments_.emplace_back(arg->clone());
 }
 
+void KernelArgumentHolder::push(std::shared_ptr<ArgAbstract> arg) {
+  arguments_.push_back(std::move(arg));
+}
+
 void KernelArgumentHolder::erase(const ArgAbstract* arg_to_delete) {
   auto iter = std::remove_if(
       arguments_.begin(),
       arguments_.end(),
-      [&](const std::unique_ptr<ArgAbstract>& ref) {
+      [&](const std::shared_ptr<ArgAbstract>& ref) {
         return arg_to_delete == ref.get();
       });
   arguments_.erase(iter, arguments_.end());
 }
 
 void KernelArgumentHolder::swap(int i, const ArgAbstract* arg) {
-  auto holder = arg->clone();
-  arguments_[i].swap(holder);
+  arguments_[i] = arg->clone();
 }
 
 void KernelArgumentHolder::appendPhiloxRNGSeed(uint64_t rand_offset) {
@@ -372,6 +372,11 @@ struct CpuScalarTensorArg : public ArgAbstract {
 //! for both compilation as well as kernel execution. The important thing is to
 //! strip ownership of tensor from KernelArgumentHolder, so that during async
 //! compilation, we are not unnecessarily holding memory that is not needed.
+//!
+//! Arguments are immutable once pushed, so copies of a holder, like the
+//! holders of the segments of a fusion, share them instead of cloning them.
+//! Replacing an argument, as swap and getBuffer do, only affects the holder
+//! it is replaced in.
 class TORCH_CUDA_CU_API KernelArgumentHolder {
  public:
   //! create KernelArgumentHolder from c10 inputs. Note that we we not taking
@@ -384,20 +389,20 @@ class TORCH_CUDA_CU_API KernelArgumentHolder {
   KernelArgumentHolder() = default;
 
   KernelArgumentHolder(const KernelArgumentHolder& self)
-      : device_index_(self.getDeviceIndex()), cache_id_(self.getCacheId()) {
-    for (const auto& arg : self.arguments_) {
-      push(arg.get());
-    }
-  }
+      : arguments_(self.arguments_),
+        device_index_(self.getDeviceIndex()),
+        cache_id_(self.getCacheId()) {}
 
   KernelArgumentHolder& operator=(const KernelArgumentHolder& self) {
+    arguments_ = self.arguments_;
     device_index_ = self.getDeviceIndex();
-    for (const auto& arg : self.arguments_) {
-      push(arg.get());
-    }
+    cache_id_ = self.getCacheId();
     return *this;
   }
 
+  KernelArgumentHolder(KernelArgumentHolder&&) = default;
+  KernelArgumentHolder& operator=(KernelArgumentHolder&&) = default;
+
   //! Computes the smallest index type for the currently held
   //! arguments. It does not consider any other tensors used in a kernel.
   PrimDataType getSmallestIndexTypeOfArguments() const;
@@ -421,7 +426,7 @@ class TORCH_CUDA_CU_API KernelArgumentHolder {
   // type.
   void** getBuffer(
       PrimDataType index_type,
-      std::vector<TensorView*> tvs,
+      const std::vector<TensorView*>& tvs,
       ExpressionEvaluator& eval);
 
   void push(const c10::ArrayRef<c10::IValue>& args);
@@ -430,6 +435,9 @@ class TORCH_CUDA_CU_API KernelArgumentHolder {
 
   void push(const ArgAbstract* arg);
 
+  // Push an argument shared with another holder
+  void push(std::shared_ptr<ArgAbstract> arg);
+
   void erase(const ArgAbstract* arg);
 
   void swap(int i, const ArgAbstract* arg);
@@ -451,6 +459,15 @@ class TORCH_CUDA_CU_API KernelArgumentHolder {
     return at(ind);
   };
 
+  //! Returns an argument to be shared with another holder
+  const std::shared_ptr<ArgAbstract>& sharedAt(size_t ind) const {
+    return arguments_.at(ind);
+  }
+
+  void reserve(size_t size) {
+    arguments_.reserve(size);
+  }
+
   size_t size() const {
     return arguments_.size();
   }
@@ -478,7 +495,7 @@ class TORCH_CUDA_CU_API KernelArgumentHolder {
   std::string toString() const;
 
  private:
-  std::vector<std::unique_ptr<ArgAbstract>> arguments_;
+  std::vector<std::shared_ptr<ArgAbstract>> arguments_;
   std::vector<void*> void_ptrs_;
 
   int8_t device_index_ = 0;
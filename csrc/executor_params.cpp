@@ -7,7 +7,7 @@
 // clang-format on
 #include <executor_params.h>
 
-#include <ATen/cuda/CUDAContext.h>
+#include <device_profile.h>
 
 namespace nvfuser {
 
@@ -15,8 +15,7 @@ void LaunchParams::assertValid() {
   TORCH_INTERNAL_ASSERT(
       bdimx() * bdimy() * bdimz() > 0 &&
           bdimx() * bdimy() * bdimz() <=
-              (int64_t)at::cuda::getCurrentDeviceProperties()
-                  ->maxThreadsPerMultiProcessor,
+              currentDeviceProfile()->max_threads_per_multi_processor,
       "Selected invalid number of threads for cuda: ",
       bdimx() * bdimy() * bdimz());
   TORCH_INTERNAL_ASSERT(
@@ -12,6 +12,7 @@
 #include <c10/util/irange.h>
 
 #include <contiguity.h>
+#include <device_profile.h>
 #include <executor_utils.h>
 #include <instrumentation.h>
 #include <ir/all_nodes.h>
@@ -50,8 +51,11 @@
 #include <nvfuser_resources/warp.h>
 #include <nvfuser_resources/welford.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <fstream>
+#include <mutex>
+#include <unordered_map>
 #include <variant>
 
 #include <nvrtc.h>
@@ -59,7 +63,18 @@
 namespace nvfuser {
 namespace executor_utils {
 
-std::string kernelPreamble() {
+namespace {
+
+std::string assembleKernelPreamble(
+    const codegen::RuntimeModules& modules,
+    bool use_block_sync_atomic) {
+  auto uses = [&modules](codegen::RuntimeModule module) {
+    return modules.count(module) > 0;
+  };
+  // Fused reductions are built on top of the welford helpers
+  const bool fused_reduction = uses(codegen::RuntimeModule::FusedReduction);
+  const bool welford = fused_reduction || uses(codegen::RuntimeModule::Welford);
+
   std::stringstream ss;
   ss << nvfuser_resources::basic_type_traits_cu;
   ss << nvfuser_resources::complex_number_cu;
@@ -74,10 +89,12 @@ std::string kernelPreamble() {
   ss << nvfuser_resources::random_numbers_cu;
   ss << nvfuser_resources::helpers_cu;
   ss << nvfuser_resources::index_utils_cu;
-  ss << nvfuser_resources::tuple_cu;
+  if (fused_reduction) {
+    ss << nvfuser_resources::tuple_cu;
+  }
 
   // Synchronization classes
-  if (std::getenv("PYTORCH_NVFUSER_USE_BLOCK_SYNC_ATOMIC")) {
+  if (use_block_sync_atomic) {
     ss << nvfuser_resources::block_sync_atomic_cu;
   } else {
     ss << nvfuser_resources::block_sync_default_cu;
@@ -86,18 +103,28 @@ std::string kernelPreamble() {
 
   // Communication classes
   ss << nvfuser_resources::block_reduction_cu;
-  ss << nvfuser_resources::grid_reduction_cu;
-  ss << nvfuser_resources::grid_broadcast_cu;
+  if (uses(codegen::RuntimeModule::GridReduction)) {
+    ss << nvfuser_resources::grid_reduction_cu;
+  }
+  if (uses(codegen::RuntimeModule::GridBroadcast)) {
+    ss << nvfuser_resources::grid_broadcast_cu;
+  }
   ss << nvfuser_resources::broadcast_cu;
-  ss << nvfuser_resources::welford_cu;
+  if (welford) {
+    ss << nvfuser_resources::welford_cu;
+  }
   ss << nvfuser_resources::warp_cu;
-  ss << nvfuser_resources::tensorcore_cu;
-  ss << nvfuser_resources::memory_cu;
-  ss << nvfuser_resources::fused_welford_helper_cu;
-  ss << nvfuser_resources::fused_reduction_cu;
-  ss << nvfuser_resources::fused_welford_impl_cu;
-  ss << nvfuser_resources::block_welford_outer_cu;
-  ss << nvfuser_resources::fused_welford_impl_outer_cu;
+  if (uses(codegen::RuntimeModule::TensorCore)) {
+    ss << nvfuser_resources::tensorcore_cu;
+    ss << nvfuser_resources::memory_cu;
+  }
+  if (fused_reduction) {
+    ss << nvfuser_resources::fused_welford_helper_cu;
+    ss << nvfuser_resources::fused_reduction_cu;
+    ss << nvfuser_resources::fused_welford_impl_cu;
+    ss << nvfuser_resources::block_welford_outer_cu;
+    ss << nvfuser_resources::fused_welford_impl_outer_cu;
+  }
 
   // Random utilities
   ss << nvfuser_resources::PhiloxCudaStateRaw_cu;
@@ -105,11 +132,56 @@ std::string kernelPreamble() {
   return ss.str();
 }
 
+const codegen::RuntimeModules& allRuntimeModules() {
+  static const codegen::RuntimeModules all_modules = {
+      codegen::RuntimeModule::GridReduction,
+      codegen::RuntimeModule::GridBroadcast,
+      codegen::RuntimeModule::Welford,
+      codegen::RuntimeModule::FusedReduction,
+      codegen::RuntimeModule::TensorCore};
+  return all_modules;
+}
+
+} // namespace
+
+std::string kernelPreamble() {
+  return kernelPreamble(allRuntimeModules());
+}
+
+std::string kernelPreamble(const codegen::RuntimeModules& requested_modules) {
+  FUSER_PERF_SCOPE("executor_utils::kernelPreamble");
+  const auto& modules =
+      isOptionDisabled(DisableOption::KernelPreamblePruning)
+      ? allRuntimeModules()
+      : requested_modules;
+
+  const bool use_block_sync_atomic =
+      std::getenv("PYTORCH_NVFUSER_USE_BLOCK_SYNC_ATOMIC") != nullptr;
+
+  // The preamble only depends on the module set, so each combination is
+  // assembled once and reused by every kernel that needs it.
+  uint64_t key = use_block_sync_atomic ? 1 : 0;
+  for (auto module : modules) {
+    key |= (uint64_t)1 << ((int)module + 1);
+  }
+
+  static std::mutex preamble_cache_mutex;
+  static std::unordered_map<uint64_t, std::string> preamble_cache;
+  std::lock_guard<std::mutex> guard(preamble_cache_mutex);
+  auto it = preamble_cache.find(key);
+  if (it == preamble_cache.end()) {
+    it = preamble_cache
+             .emplace(key, assembleKernelPreamble(modules, use_block_sync_atomic))
+             .first;
+  }
+  return it->second;
+}
+
 namespace {
 
 // Query the target GPU version number NVRTC compiles CUDA kernels for
 TORCH_CUDA_CU_API void queryTargetGPUVersion(
-    const cudaDeviceProp* const prop,
+    const DeviceProfile* const profile,
     int& major,
     int& minor,
     bool& compile_to_sass) {
@@ -124,7 +196,7 @@ TORCH_CUDA_CU_API void queryTargetGPUVersion(
 
   // Version supported by device
   // Usually any lower version works too but is less efficient
-  const CudaVersion dev_version = CudaVersion(prop->major, prop->minor);
+  const CudaVersion dev_version = CudaVersion(profile->major, profile->minor);
   // Maximum version supported by the driver, cap dev_version to this
   CudaVersion max_dev_version;
   if (nvrtc_version.first <= 7) { // 7 supports 2-5.x
@@ -828,6 +900,58 @@ void validateVectorizedTensors(
   validateVectorizedSplits(kernel, expr_eval);
 }
 
+bool hasAlignedVectorizedTensors(
+    kir::Kernel* kernel,
+    const KernelArgumentHolder& args,
+    caching::ExecutorCompileTimeInfoCache* data_cache) {
+  FUSER_PERF_SCOPE("executor_utils::hasAlignedVectorizedTensors");
+  auto tensor_vectorization_validation_entry =
+      executor_utils::caching::ExecutorCompileTimeEntry<
+          executor_utils::caching::VectorizedTensorValidation>(
+          data_cache, [kernel]() {
+            return executor_utils::getVectorizedTensorValidationInfo(kernel);
+          });
+
+  auto is_aligned = [&](TensorView* tv, int64_t input_pos) {
+    auto word_size = kernel->summary().vectorized_accesses.at(tv);
+    auto tensor_arg_abstract =
+        dynamic_cast<const TensorArgAbstract*>(args[input_pos]);
+    TORCH_INTERNAL_ASSERT(tensor_arg_abstract, "alias io only supports tensor");
+    const auto word_size_in_bytes =
+        word_size * dataTypeSize(tensor_arg_abstract->getDataType());
+    return tensor_arg_abstract->getPointerAddress() % word_size_in_bytes == 0;
+  };
+
+  for (auto pos : tensor_vectorization_validation_entry.get()
+                      .aligned_vectorized_inp_tensor_pos) {
+    if (!is_aligned(kernel->inputs().at(pos)->as<TensorView>(), pos)) {
+      return false;
+    }
+  }
+
+  // Outputs are allocated aligned, except for the ones that alias inputs
+  auto input_alias_indices_entry =
+      executor_utils::caching::ExecutorCompileTimeEntry<
+          executor_utils::caching::InputAliasIndices>(data_cache, [&]() {
+        return std::make_unique<std::vector<std::pair<int, int>>>(
+            kernel->getOutputToInputAliasIndices());
+      });
+  const auto& output_to_input_aliases = input_alias_indices_entry.get();
+  for (auto pos : tensor_vectorization_validation_entry.get()
+                      .aligned_vectorized_out_tensor_pos) {
+    auto alias_it = std::find_if(
+        output_to_input_aliases.begin(),
+        output_to_input_aliases.end(),
+        [pos](const auto& alias) { return alias.first == pos; });
+    if (alias_it != output_to_input_aliases.end() &&
+        !is_aligned(
+            kernel->outputs().at(pos)->as<TensorView>(), alias_it->second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 namespace {
 
 void bindInputForExprEvaluation(
@@ -1361,26 +1485,22 @@ std::tuple<std::vector<char>, std::string> compileSource(
   return {object_code, lowered_kernel_name_str};
 }
 
-} // namespace
-
-// Compile the source if no existing compiled binary is found in KernelDB
-std::tuple<NvrtcFunction, std::string, std::vector<char>> getCompiledKernel(
-    c10::optional<std::reference_wrapper<const std::string>> kernel_code,
-    const std::string& full_src_code,
-    const std::string& func_name,
-    int64_t id,
+// Set up the NVRTC and module load options for the current device. Returns
+// whether the kernel is compiled to SASS.
+bool prepareCompileDrivers(
+    NvrtcCompileDriver& nvrtc_compile_driver,
+    CuModuleLoadDataDriver& module_load_driver,
     std::optional<int64_t> opt_block_size,
-    const int64_t max_register_heuristic,
-    bool return_compiled_binary) {
-  FUSER_PERF_SCOPE("executor_utils::NVRTC");
-
+    const int64_t max_register_heuristic) {
   at::cuda::jit::initializeCudaContext();
 
-  const auto prop = at::cuda::getCurrentDeviceProperties();
+  // Kernels are compiled for the device they are generated for, which is
+  // an injected profile when generating kernels for another device
+  const auto profile = currentDeviceProfile();
 
   int major = 0, minor = 0;
   bool compile_to_sass = false;
-  queryTargetGPUVersion(prop, major, minor, compile_to_sass);
+  queryTargetGPUVersion(profile, major, minor, compile_to_sass);
 
 #if CUDA_VERSION < 11010
   // compile to sass is not allowed prior to CUDA 11.1
@@ -1394,9 +1514,6 @@ std::tuple<NvrtcFunction, std::string, std::vector<char>> getCompiledKernel(
     compile_to_sass = false;
   }
 
-  NvrtcCompileDriver nvrtc_compile_driver;
-  CuModuleLoadDataDriver module_load_driver;
-
   fillCompileOptions(
       nvrtc_compile_driver,
       module_load_driver,
@@ -1406,6 +1523,60 @@ std::tuple<NvrtcFunction, std::string, std::vector<char>> getCompiledKernel(
       opt_block_size,
       max_register_heuristic);
 
+  return compile_to_sass;
+}
+
+// Kernels generated for an injected profile of another compute capability
+// can't be loaded on the current device. They are only compiled, e.g., to
+// be written to a kernel bundle.
+bool canLoadOnCurrentDevice() {
+  const auto target = currentDeviceProfile();
+  const auto device = physicalDeviceProfile(at::cuda::current_device());
+  return target->computeCapability() == device->computeCapability();
+}
+
+} // namespace
+
+std::string compileOptionsSignature() {
+  // Must cover every option read by fillCompileOptions and
+  // prepareCompileDrivers, besides the architecture, the block size and the
+  // register count
+  std::stringstream ss;
+  ss << "fmad=" << !isOptionDisabled(DisableOption::Fma);
+  ss << ";lineinfo=" << isDebugDumpEnabled(DebugDumpOption::DebugInfo);
+  ss << ";profile=" << isOptionEnabled(EnableOption::KernelProfile);
+  ss << ";verbose="
+     << (isDebugDumpEnabled(DebugDumpOption::PrintPtxasLog) ||
+         isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose) ||
+         isOptionEnabled(EnableOption::WarnRegisterSpill));
+  const char* ptxas_opt_level = getenv("PYTORCH_NVFUSER_JIT_OPT_LEVEL");
+  ss << ";opt=" << (ptxas_opt_level ? atoi(ptxas_opt_level) : -1);
+  ss << ";sass="
+     << !(isOptionDisabled(DisableOption::CompileToSass) ||
+          isDebugDumpEnabled(DebugDumpOption::Ptx));
+  return ss.str();
+}
+
+// Compile the source if no existing compiled binary is found in KernelDB
+std::tuple<NvrtcFunction, std::string, std::vector<char>> getCompiledKernel(
+    c10::optional<std::reference_wrapper<const std::string>> kernel_code,
+    const std::string& full_src_code,
+    const std::string& func_name,
+    int64_t id,
+    std::optional<int64_t> opt_block_size,
+    const int64_t max_register_heuristic,
+    bool return_compiled_binary,
+    std::string* lowered_kernel_name) {
+  FUSER_PERF_SCOPE("executor_utils::NVRTC");
+
+  NvrtcCompileDriver nvrtc_compile_driver;
+  CuModuleLoadDataDriver module_load_driver;
+  const bool compile_to_sass = prepareCompileDrivers(
+      nvrtc_compile_driver,
+      module_load_driver,
+      opt_block_size,
+      max_register_heuristic);
+
   std::stringstream log;
 
   if (compile_to_sass) {
@@ -1451,6 +1622,12 @@ std::tuple<NvrtcFunction, std::string, std::vector<char>> getCompiledKernel(
   }
 
   NvrtcFunction compiled_kernel;
+  if (!canLoadOnCurrentDevice()) {
+    if (lowered_kernel_name != nullptr) {
+      *lowered_kernel_name = lowered_kernel_name_str;
+    }
+    return {compiled_kernel, log.str(), object_code};
+  }
 
   log << module_load_driver.invoke(compiled_kernel.module, object_code.data())
       << std::endl;
@@ -1468,9 +1645,40 @@ std::tuple<NvrtcFunction, std::string, std::vector<char>> getCompiledKernel(
     object_code.clear();
   }
 
+  if (lowered_kernel_name != nullptr) {
+    *lowered_kernel_name = lowered_kernel_name_str;
+  }
+
   return {compiled_kernel, log.str(), object_code};
 }
 
+std::tuple<NvrtcFunction, std::string> loadCompiledKernel(
+    const std::vector<char>& object_code,
+    const std::string& lowered_kernel_name,
+    std::optional<int64_t> opt_block_size,
+    const int64_t max_register_heuristic) {
+  FUSER_PERF_SCOPE("executor_utils::loadCompiledKernel");
+
+  NvrtcCompileDriver nvrtc_compile_driver;
+  CuModuleLoadDataDriver module_load_driver;
+  prepareCompileDrivers(
+      nvrtc_compile_driver,
+      module_load_driver,
+      opt_block_size,
+      max_register_heuristic);
+
+  NvrtcFunction compiled_kernel;
+  auto log =
+      module_load_driver.invoke(compiled_kernel.module, object_code.data());
+
+  CUDA_SAFE_CALL(cuModuleGetFunction(
+      &(compiled_kernel.function),
+      compiled_kernel.module,
+      lowered_kernel_name.c_str()));
+
+  return {compiled_kernel, log};
+}
+
 namespace caching {
 
 //! CompileTimeInfo is the actual subclass of CompileTimeInfoBase that will
@@ -16,6 +16,7 @@
 
 #include <torch/csrc/jit/ir/ir.h>
 
+#include <codegen.h>
 #include <device_lower/lower2device.h>
 #include <executor_kernel_arg.h>
 #include <expr_evaluator.h>
@@ -70,6 +71,10 @@ namespace executor_utils {
 // Include all the functions we might need in generated code
 std::string kernelPreamble();
 
+// Include the always-needed functions plus the given optional runtime
+// modules. Assembled preambles are cached per module set.
+std::string kernelPreamble(const codegen::RuntimeModules& modules);
+
 void validateKernelInputs(
     Fusion* fusion,
     const KernelArgumentHolder& args,
@@ -95,7 +100,9 @@ struct NvrtcFunction {
   CUfunction function = nullptr;
 };
 
-// Returns executable function and the ptxas log from compilation
+// Returns executable function and the ptxas log from compilation. Kernels
+// generated for an injected profile of another compute capability are only
+// compiled, and their function is null.
 std::tuple<NvrtcFunction, std::string, std::vector<char>> getCompiledKernel(
     c10::optional<std::reference_wrapper<const std::string>> kernel_code,
     const std::string& code,
@@ -103,7 +110,22 @@ std::tuple<NvrtcFunction, std::string, std::vector<char>> getCompiledKernel(
     int64_t id,
     std::optional<int64_t> opt_block_size = std::nullopt,
     const int64_t max_register_heuristic = 255,
-    bool return_compiled_binary = false);
+    bool return_compiled_binary = false,
+    std::string* lowered_kernel_name = nullptr);
+
+// Describes the NVRTC and module load options getCompiledKernel derives from
+// the enabled options, the debug dump options and the environment, so that
+// kernels compiled with different options are not mixed up
+std::string compileOptionsSignature();
+
+// Loads a binary returned by getCompiledKernel, possibly in another process,
+// on a device of the same compute capability. Returns the executable
+// function and the module load log.
+std::tuple<NvrtcFunction, std::string> loadCompiledKernel(
+    const std::vector<char>& object_code,
+    const std::string& lowered_kernel_name,
+    std::optional<int64_t> opt_block_size = std::nullopt,
+    const int64_t max_register_heuristic = 255);
 
 namespace caching {
 // TODO: Could consider putting some of
@@ -299,5 +321,17 @@ void validateVectorizedTensors(
     caching::ExecutorCompileTimeInfoCache* data_cache,
     ExpressionEvaluator& expr_eval);
 
+//! Returns true if the data pointers of all inputs and outputs the kernel
+//! accesses with aligned vectorization are aligned to their vector word
+//! size. Outputs are allocated aligned, so only the outputs that alias
+//! inputs are checked, with the pointers of these inputs. Unlike
+//! validateVectorizedTensors, only the pointers are checked, not the extents
+//! and strides, as only the pointers are not part of the cache key of
+//! alignment-agnostic kernels.
+bool hasAlignedVectorizedTensors(
+    kir::Kernel* kernel,
+    const KernelArgumentHolder& args,
+    caching::ExecutorCompileTimeInfoCache* data_cache);
+
 } // namespace executor_utils
 } // namespace nvfuser
@@ -94,6 +94,7 @@ IrCloner Fusion::copy(const Fusion* from, Fusion* to) {
   to->all_tv_uses_valid_ = from->all_tv_uses_valid_;
   // This should never be true on copy, but copying for completeness.
   to->is_during_update_uses_ = from->is_during_update_uses_;
+  to->tv_graph_version_++;
 
   for (const auto& i : from->managed_data_) {
     if (i.first.has_value()) {
@@ -167,6 +168,7 @@ void Fusion::clear() noexcept {
 
   all_tv_uses_valid_ = false;
   is_during_update_uses_ = false;
+  tv_graph_version_++;
 }
 
 void Fusion::removeExpr(Expr* expr) {
@@ -240,7 +242,7 @@ void Fusion::addInput(Val* input) {
   inputs_.push_back(input);
   input->setIsFusionInput(true);
 
-  all_tv_uses_valid_ = false;
+  invalidateTvUses();
 }
 
 void Fusion::addOutput(Val* output) {
@@ -264,7 +266,7 @@ void Fusion::addOutput(Val* output) {
   outputs_.push_back(output);
   output->setIsFusionOutput(true);
 
-  all_tv_uses_valid_ = false;
+  invalidateTvUses();
 }
 
 void Fusion::removeInput(Val* input) {
@@ -273,7 +275,7 @@ void Fusion::removeInput(Val* input) {
     inputs_.erase(find_input);
   }
   input->setIsFusionInput(false);
-  all_tv_uses_valid_ = false;
+  invalidateTvUses();
 }
 
 void Fusion::removeOutput(Val* output) {
@@ -282,7 +284,7 @@ void Fusion::removeOutput(Val* output) {
     outputs_.erase(find_output);
   }
   output->setIsFusionOutput(false);
-  all_tv_uses_valid_ = false;
+  invalidateTvUses();
 }
 
 void Fusion::replaceOutput(Val* output, Val* replacement) {
@@ -317,6 +319,21 @@ void Fusion::replaceOutput(Val* output, Val* replacement) {
   }
 }
 
+void Fusion::replaceInput(Val* input, Val* replacement) {
+  auto find_input = std::find(inputs_.begin(), inputs_.end(), input);
+  TORCH_CHECK(find_input != inputs_.end(), "Unable to find input in Fusion");
+  TORCH_CHECK(
+      io_alias_.empty(), "Replacing inputs of aliased fusions not supported");
+
+  *find_input = replacement;
+  replacement->setIsFusionInput(true);
+  if (replacement->getValType().value() == ValType::TensorView) {
+    replacement->as<TensorView>()->setMemoryType(MemoryType::Global);
+  }
+  input->setIsFusionInput(false);
+  invalidateTvUses();
+}
+
 std::vector<Expr*> Fusion::exprs() {
   return StmtSort::getExprs(this);
 }
@@ -129,6 +129,9 @@ class TORCH_CUDA_CU_API Fusion : public IrContainer {
   //! Replace output with another value
   void replaceOutput(Val* output, Val* replacement);
 
+  //! Replace input with another value at the same position
+  void replaceInput(Val* input, Val* replacement);
+
   //! Assert that all leaves found from outputs are registered as an input
   void validateInputs();
 
@@ -253,6 +256,14 @@ class TORCH_CUDA_CU_API Fusion : public IrContainer {
     return is_during_update_uses_;
   }
 
+  //! Changes every time TensorView uses are invalidated, i.e. whenever an
+  //! expression between TensorViews or a fusion input or output is added or
+  //! removed, or when the root or rfactor domain of a TensorView is replaced.
+  //! Used to invalidate information cached about the TensorView graph.
+  int64_t tvGraphVersion() const {
+    return tv_graph_version_;
+  }
+
   const auto& ioAlias() const {
     return io_alias_;
   }
@@ -407,6 +418,7 @@ class TORCH_CUDA_CU_API Fusion : public IrContainer {
   friend SegmentedFusion;
   friend class TranslateApplicableWelford;
   friend Val;
+  friend TensorView;
 
   static IrCloner copy(const Fusion* from, Fusion* to);
 
@@ -433,6 +445,13 @@ class TORCH_CUDA_CU_API Fusion : public IrContainer {
   //! the update).
   void invalidateTvUses() {
     all_tv_uses_valid_ = false;
+    tv_graph_version_++;
+  }
+
+  //! Declare that the root or rfactor domain of a TensorView was replaced,
+  //! which doesn't change TensorView uses
+  void invalidateTvDomains() {
+    tv_graph_version_++;
   }
 
  private:
@@ -458,6 +477,7 @@ class TORCH_CUDA_CU_API Fusion : public IrContainer {
   //  the states are either all valid or all invalid
   bool all_tv_uses_valid_ = false;
   bool is_during_update_uses_ = false;
+  int64_t tv_graph_version_ = 0;
 
   std::vector<std::pair<std::any, CloneFn>> managed_data_;
   std::unordered_map<std::string, std::pair<std::any, CloneFn>>
@@ -13,9 +13,11 @@
 #include <ir/graphviz.h>
 #include <ir/iostream.h>
 #include <ir/utils.h>
+#include <ops/alias.h>
 #include <ops/arith.h>
 #include <scheduler/debug_utils.h>
 
+#include <numeric>
 #include <sstream>
 
 namespace nvfuser {
@@ -2490,6 +2492,202 @@ bool SegmentCandidateFinder::translateWelfordInFusion(
   return TranslateApplicableWelford::run(fusion, runtime_inputs);
 }
 
+namespace {
+
+//! The reduction splitReductionInFusion rewrites
+struct SplitReductionCandidate {
+  ReductionOp* rop = nullptr;
+  //! Cast of in read by the reduction, if any
+  UnaryOp* cast = nullptr;
+  TensorView* in = nullptr;
+  TensorView* out = nullptr;
+  int64_t input_index = 0;
+  int64_t reduction_axis = 0;
+};
+
+std::optional<SplitReductionCandidate> findSplitReductionCandidate(
+    Fusion* fusion) {
+  if (isOptionDisabled(DisableOption::SplitReduction) ||
+      SegmentCandidateFinder::hasSegmentHints(fusion) ||
+      !fusion->ioAlias().empty()) {
+    return std::nullopt;
+  }
+
+  auto reduction_ops = ir_utils::getReductionOps(fusion);
+  if (reduction_ops.size() != 1 || !reduction_ops[0]->isA<ReductionOp>()) {
+    return std::nullopt;
+  }
+  auto rop = reduction_ops[0]->as<ReductionOp>();
+  if (rop->isAllreduce() || !rop->in()->isA<TensorView>()) {
+    return std::nullopt;
+  }
+  auto out = rop->out()->as<TensorView>();
+
+  // The reduced tensor needs to be a fusion input, or a cast of one, so that
+  // it can be read with the split sizes
+  auto in = rop->in()->as<TensorView>();
+  UnaryOp* cast = nullptr;
+  if (auto uop = dynamic_cast<UnaryOp*>(in->definition())) {
+    if (uop->getUnaryOpType() != UnaryOpType::Cast || in->uses().size() > 1 ||
+        in->isFusionOutput()) {
+      return std::nullopt;
+    }
+    cast = uop;
+    in = uop->in()->as<TensorView>();
+  }
+  if (!in->isFusionInput() || in->isFusionOutput() || in->uses().size() > 1 ||
+      in->hasAllocation()) {
+    return std::nullopt;
+  }
+  auto input_index = std::distance(
+      fusion->inputs().begin(),
+      std::find(fusion->inputs().begin(), fusion->inputs().end(), in));
+
+  const auto& out_root = out->getRootDomain();
+  auto reduction_axis = -1;
+  for (auto i : c10::irange(out_root.size())) {
+    if (out_root[i]->isReduction()) {
+      if (reduction_axis >= 0) {
+        return std::nullopt;
+      }
+      reduction_axis = (int)i;
+    }
+  }
+  auto in_root = TensorDomain::noReductions(in->getMaybeRFactorDomain());
+  if (reduction_axis < 0 || in_root.size() != out_root.size()) {
+    return std::nullopt;
+  }
+  return SplitReductionCandidate{
+      rop, cast, in, out, input_index, reduction_axis};
+}
+
+} // namespace
+
+std::optional<SplitReductionInput> SegmentCandidateFinder::getSplitReduction(
+    Fusion* fusion,
+    const KernelArgumentHolder& runtime_inputs) {
+  FUSER_PERF_SCOPE("SegmentCandidateFinder::getSplitReduction");
+  auto candidate = findSplitReductionCandidate(fusion);
+  if (!candidate.has_value()) {
+    return std::nullopt;
+  }
+
+  SchedulerRuntimeInfo runtime_info(fusion, runtime_inputs);
+  std::vector<int64_t> sizes;
+  for (auto id :
+       TensorDomain::noReductions(candidate->in->getMaybeRFactorDomain())) {
+    if (id->isBroadcast()) {
+      return std::nullopt;
+    }
+    auto extent = runtime_info.expressionEvaluator().evaluate(id->extent());
+    if (!extent.has_value() || extent->as<int64_t>() <= 1) {
+      return std::nullopt;
+    }
+    sizes.push_back(extent->as<int64_t>());
+  }
+
+  if (!SchedulerEntry::canSchedule(
+          ScheduleHeuristic::Reduction, fusion, runtime_info)) {
+    return std::nullopt;
+  }
+  auto rparams = getReductionHeuristics(fusion, runtime_info);
+  const auto reduction_numel = sizes[candidate->reduction_axis];
+  const auto iteration_numel =
+      std::accumulate(
+          sizes.begin(), sizes.end(), (int64_t)1, std::multiplies<int64_t>()) /
+      reduction_numel;
+  const auto factor = splitReductionFactor(
+      *rparams,
+      iteration_numel,
+      (int64_t)dataTypeSize(candidate->out->dtype()));
+
+  // Largest divisor of the reduction extent not exceeding the factor. Giving
+  // up more than half of the factor isn't worth the extra segment.
+  int64_t chunks = std::min(factor, reduction_numel);
+  while (chunks > 1 && reduction_numel % chunks != 0) {
+    chunks--;
+  }
+  if (chunks <= 1 || 2 * chunks < factor) {
+    return std::nullopt;
+  }
+
+  SplitReductionInput split_reduction_input;
+  split_reduction_input.input_index = candidate->input_index;
+  split_reduction_input.reduction_axis = candidate->reduction_axis;
+  split_reduction_input.chunks = chunks;
+  return split_reduction_input;
+}
+
+std::optional<SplitReductionInput> SegmentCandidateFinder::
+    splitReductionInFusion(
+        Fusion* fusion,
+        const KernelArgumentHolder& runtime_inputs) {
+  auto split_reduction_input = getSplitReduction(fusion, runtime_inputs);
+  if (split_reduction_input.has_value()) {
+    splitReductionInFusion(fusion, split_reduction_input.value());
+  }
+  return split_reduction_input;
+}
+
+void SegmentCandidateFinder::splitReductionInFusion(
+    Fusion* fusion,
+    const SplitReductionInput& split_reduction_input) {
+  FUSER_PERF_SCOPE("SegmentCandidateFinder::splitReductionInFusion");
+  auto candidate = findSplitReductionCandidate(fusion);
+  TORCH_INTERNAL_ASSERT(
+      candidate.has_value() &&
+          candidate->input_index == split_reduction_input.input_index &&
+          candidate->reduction_axis == split_reduction_input.reduction_axis,
+      "The reduction of the fusion can't be split as requested");
+  auto rop = candidate->rop;
+  auto cast = candidate->cast;
+  auto in = candidate->in;
+  auto out = candidate->out;
+  const auto reduction_axis = (int)candidate->reduction_axis;
+
+  // T0[..., R] becomes T0[..., S, R / S]. The extents are symbolic, so the
+  // rewritten fusion runs with any R that is a multiple of S.
+  const auto in_ndims =
+      TensorDomain::noReductions(in->getMaybeRFactorDomain()).size();
+  std::vector<std::optional<bool>> contiguity = in->getContiguity();
+  contiguity.insert(contiguity.begin() + reduction_axis, true);
+  auto split_in = TensorViewBuilder()
+                      .ndims(in_ndims + 1)
+                      .dtype(in->dtype())
+                      .contiguity(contiguity)
+                      .build();
+  fusion->replaceInput(in, split_in);
+
+  auto partial_in = split_in;
+  if (cast != nullptr) {
+    partial_in = castOp(cast->out()->dtype(), split_in);
+  }
+  auto partial = reductionOp(
+      rop->getReductionOpType(),
+      {reduction_axis + 1},
+      rop->init(),
+      partial_in);
+  auto final_out = reductionOp(
+      rop->getReductionOpType(),
+      {reduction_axis},
+      rop->init(),
+      segment_set(partial));
+
+  // replaceValInExpr updates the uses of out
+  const auto out_uses = out->uses();
+  for (auto use : out_uses) {
+    ir_utils::replaceValInExpr(use, out, final_out);
+  }
+  if (out->isFusionOutput()) {
+    fusion->replaceOutput(out, final_out);
+  }
+  fusion->removeVal(out);
+  if (cast != nullptr) {
+    fusion->removeVal(cast->out());
+  }
+  fusion->removeVal(in);
+}
+
 //! CombineReductions:
 //!  This pass works before the main merge node process
 //!    It identifies reduction operations that can be combined
@@ -14,8 +14,10 @@
 #include <scheduler/registry.h>
 #include <utils.h>
 
+#include <atomic>
 #include <deque>
 #include <list>
+#include <optional>
 #include <unordered_set>
 #include <vector>
 
@@ -460,7 +462,7 @@ class TORCH_CUDA_CU_API SegmentedFusion {
 
   //! Utility to give unique name for each segmented fusion
   static size_t segmentedFusionName() {
-    static size_t counter = 0;
+    static std::atomic<size_t> counter{0};
     return counter++;
   }
 };
@@ -555,6 +557,36 @@ class TORCH_CUDA_CU_API SegmentCandidateFinder {
       Fusion* fusion,
       const KernelArgumentHolder& runtime_inputs);
 
+  //! Rewrites a fusion that the reduction scheduler would run as a grid
+  //! reduction into two stages separated by a segment_set, when
+  //! splitReductionFactor expects that to be faster:
+  //!
+  //!   T1[I, rR] = sum(T0[I, R])
+  //! becomes
+  //!   T1[I, S, rR/S] = sum(T0[I, S, R/S])
+  //!   T2[I, S] = segment_set(T1)
+  //!   T3[I, rS] = sum(T2)
+  //!
+  //! T0 must be a fusion input, optionally cast before the reduction, so the
+  //! split only changes the sizes it is read with. The number of chunks S is
+  //! chosen for runtime_inputs, the rewritten fusion runs with any reduction
+  //! extent that is a multiple of S. Returns how the input is read if the
+  //! fusion was rewritten.
+  static std::optional<SplitReductionInput> splitReductionInFusion(
+      Fusion* fusion,
+      const KernelArgumentHolder& runtime_inputs);
+
+  //! How splitReductionInFusion would rewrite fusion for runtime_inputs,
+  //! without rewriting it
+  static std::optional<SplitReductionInput> getSplitReduction(
+      Fusion* fusion,
+      const KernelArgumentHolder& runtime_inputs);
+
+  //! Rewrites fusion as getSplitReduction returned it would be
+  static void splitReductionInFusion(
+      Fusion* fusion,
+      const SplitReductionInput& split_reduction_input);
+
  private:
   // Perform segmentation on and take ownership of the given fusion
   SegmentCandidateFinder(
@@ -0,0 +1,291 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <horizontal_fusion.h>
+
+#include <instrumentation.h>
+#include <utils.h>
+
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/core/DeviceGuard.h>
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <unordered_set>
+
+namespace nvfuser {
+
+std::string horizontalPackingBlocker(const kir::Kernel* kernel) {
+  const auto& summary = kernel->summary();
+  if (summary.has_grid_reductions || summary.has_grid_welford ||
+      summary.has_cooperative_grid_reduction) {
+    return "grid reductions synchronize the whole grid";
+  }
+  if (summary.has_grid_broadcasts) {
+    return "grid broadcasts synchronize the whole grid";
+  }
+  if (summary.max_rng_offsets >= 0) {
+    return "random numbers are generated";
+  }
+  if (kernel->profile().getNumberOfProfileEntries() > 0) {
+    return "the kernel is profiled";
+  }
+  return "";
+}
+
+std::vector<std::vector<SegmentedGroup*>> planHorizontalPacks(
+    const std::vector<SegmentedGroup*>& run_order,
+    const std::function<bool(SegmentedGroup*)>& can_pack,
+    int64_t max_pack_size) {
+  std::vector<std::vector<SegmentedGroup*>> packs;
+  std::vector<SegmentedGroup*> pack;
+  // Outputs of the segments of the current pack
+  std::unordered_set<Val*> pack_outputs;
+
+  auto close_pack = [&]() {
+    if (pack.size() > 1) {
+      packs.push_back(pack);
+    }
+    pack.clear();
+    pack_outputs.clear();
+  };
+
+  for (auto group : run_order) {
+    if (!can_pack(group)) {
+      close_pack();
+      continue;
+    }
+    const bool depends_on_pack = std::any_of(
+        group->inputs().begin(), group->inputs().end(), [&](Val* input) {
+          return pack_outputs.count(input) > 0;
+        });
+    if (depends_on_pack || (int64_t)pack.size() >= max_pack_size) {
+      close_pack();
+    }
+    pack.push_back(group);
+    pack_outputs.insert(group->outputs().begin(), group->outputs().end());
+  }
+  close_pack();
+  return packs;
+}
+
+std::string generateHorizontalKernel(
+    const std::vector<const kir::Kernel*>& kernels,
+    const std::string& kernel_name,
+    codegen::RuntimeModules* used_modules) {
+  FUSER_PERF_SCOPE("generateHorizontalKernel");
+  TORCH_INTERNAL_ASSERT(!kernels.empty(), "No kernels to pack");
+
+  std::stringstream code;
+  std::vector<std::vector<std::pair<std::string, std::string>>> params;
+  for (auto i : c10::irange(kernels.size())) {
+    auto blocker = horizontalPackingBlocker(kernels[i]);
+    TORCH_INTERNAL_ASSERT(
+        blocker.empty(), "Kernel ", i, " can't be packed: ", blocker);
+    code << codegen::generateCudaDeviceFunction(
+                kernels[i], kernel_name + "_" + std::to_string(i), used_modules)
+         << "\n";
+    params.push_back(codegen::getKernelParameters(kernels[i]));
+  }
+
+  // Parameters of kernel i are prefixed by k<i>_
+  code << "__global__ void " << kernel_name << "(";
+  for (auto i : c10::irange(kernels.size())) {
+    for (const auto& [type, name] : params[i]) {
+      code << type << " k" << i << "_" << name << ", ";
+    }
+  }
+  for (auto i : c10::irange(kernels.size())) {
+    code << "const uint3 grid" << i
+         << (i + 1 < kernels.size() ? ", " : ") {\n");
+  }
+
+  code << "  unsigned int block_offset = 0;\n";
+  for (auto i : c10::irange(kernels.size())) {
+    const auto grid = "grid" + std::to_string(i);
+    code << "  if (blockIdx.x < block_offset + " << grid << ".x) {\n"
+         << "    if (blockIdx.y < " << grid << ".y && blockIdx.z < " << grid
+         << ".z) {\n"
+         << "      " << kernel_name << "_" << i << "(";
+    for (const auto& param : params[i]) {
+      code << "k" << i << "_" << param.second << ", ";
+    }
+    code << "make_uint3(blockIdx.x - block_offset, blockIdx.y, blockIdx.z), "
+         << "dim3(" << grid << ".x, " << grid << ".y, " << grid << ".z));\n"
+         << "    }\n"
+         << "    return;\n"
+         << "  }\n"
+         << "  block_offset += " << grid << ".x;\n";
+  }
+  code << "}\n";
+  return code.str();
+}
+
+HorizontalKernel::HorizontalKernel(std::vector<FusionExecutor*> executors)
+    : executors_(std::move(executors)) {
+  TORCH_CHECK(!executors_.empty(), "No kernels to pack");
+  std::vector<const kir::Kernel*> kernels;
+  for (auto executor : executors_) {
+    TORCH_CHECK(executor->compiled(), "Packed kernels must be compiled");
+    kernels.push_back(executor->kernel());
+    num_parameters_.push_back(
+        codegen::getKernelParameters(executor->kernel()).size());
+  }
+  index_type_ = kernels.front()->indexType();
+  for (auto kernel : kernels) {
+    TORCH_CHECK(
+        kernel->indexType() == index_type_,
+        "Packed kernels must use the same index type");
+  }
+
+  static std::atomic<int64_t> num_horizontal_kernels{0};
+  kernel_name_ = "horizontal_kernel" + std::to_string(++num_horizontal_kernels);
+  code_ = generateHorizontalKernel(kernels, kernel_name_, &runtime_modules_);
+}
+
+void HorizontalKernel::compile(int64_t block_size) {
+  FUSER_PERF_SCOPE("HorizontalKernel::compile");
+  const auto structured_code = executors_.front()->getStructuredCode(
+      code_, index_type_, runtime_modules_);
+  std::tie(compiled_kernel_, std::ignore, std::ignore) =
+      executor_utils::getCompiledKernel(
+          code_,
+          structured_code,
+          FusionExecutor::kernelNamespace() + "::" + kernel_name_,
+          // Only used to name dumped files
+          0,
+          block_size);
+  compiled_block_size_ = block_size;
+  available_dynamic_smem_size_ = 0;
+}
+
+std::vector<std::vector<at::Tensor>> HorizontalKernel::run(
+    std::vector<KernelArgumentHolder>& args,
+    const std::vector<LaunchParams>& launch_constraints,
+    const std::vector<CompileParams>& compile_params) {
+  FUSER_PERF_SCOPE("HorizontalKernel::run");
+  TORCH_CHECK(
+      args.size() == executors_.size() &&
+          launch_constraints.size() == executors_.size() &&
+          compile_params.size() == executors_.size(),
+      "Expected arguments for ",
+      executors_.size(),
+      " kernels");
+
+  std::vector<FusionExecutor::PreparedLaunch> prepared;
+  prepared.reserve(executors_.size());
+  for (auto i : c10::irange(executors_.size())) {
+    prepared.push_back(executors_[i]->prepareLaunch(
+        args[i], launch_constraints[i], compile_params[i]));
+  }
+
+  // Kernels are laid out along blockIdx.x
+  const auto& first = prepared.front().launch_params;
+  bool can_pack = true;
+  int64_t gdimx = 0;
+  int64_t gdimy = 1;
+  int64_t gdimz = 1;
+  int64_t smem = 0;
+  for (const auto& launch : prepared) {
+    const auto& lparams = launch.launch_params;
+    can_pack = can_pack && lparams.bdimx() == first.bdimx() &&
+        lparams.bdimy() == first.bdimy() && lparams.bdimz() == first.bdimz();
+    gdimx += lparams.gdimx();
+    gdimy = std::max(gdimy, lparams.gdimy());
+    gdimz = std::max(gdimz, lparams.gdimz());
+    smem = std::max(smem, lparams.smem());
+  }
+  can_pack = can_pack && gdimx <= std::numeric_limits<int32_t>::max();
+
+  std::vector<std::vector<at::Tensor>> outputs;
+  outputs.reserve(prepared.size());
+  if (!can_pack) {
+    if (isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose)) {
+      std::cout << "Launching the " << executors_.size()
+                << " kernels of a horizontal pack one by one, as their "
+                << "block sizes differ or their grids are too large"
+                << std::endl;
+      for (const auto& launch : prepared) {
+        std::cout << launch.launch_params.toString();
+      }
+    }
+    for (auto i : c10::irange(executors_.size())) {
+      executors_[i]->launch(prepared[i]);
+      outputs.push_back(std::move(prepared[i].outputs));
+    }
+    return outputs;
+  }
+
+  c10::DeviceGuard dg(
+      c10::Device(c10::DeviceType::CUDA, args.front().getDeviceIndex()));
+  const auto block_size = first.nThreads();
+  CUfunction function = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (compiled_kernel_.function == nullptr ||
+        block_size > compiled_block_size_) {
+      compile(block_size);
+    }
+    if (smem > available_dynamic_smem_size_) {
+      CUDA_SAFE_CALL(cuFuncSetAttribute(
+          compiled_kernel_.function,
+          CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
+          smem));
+      available_dynamic_smem_size_ = smem;
+    }
+    function = compiled_kernel_.function;
+  }
+
+  // Parameters of the kernels in order, followed by their grid dimensions
+  std::vector<uint3> grids;
+  grids.reserve(prepared.size());
+  for (const auto& launch : prepared) {
+    const auto& lparams = launch.launch_params;
+    grids.push_back(
+        {(unsigned int)lparams.gdimx(),
+         (unsigned int)lparams.gdimy(),
+         (unsigned int)lparams.gdimz()});
+  }
+  std::vector<void*> params;
+  for (auto i : c10::irange(prepared.size())) {
+    params.insert(
+        params.end(),
+        prepared[i].arg_buffer,
+        prepared[i].arg_buffer + num_parameters_[i]);
+  }
+  for (auto& grid : grids) {
+    params.push_back(&grid);
+  }
+
+  {
+    FUSER_PERF_SCOPE("HorizontalKernel::cuLaunchKernel");
+    CUDA_SAFE_CALL(cuLaunchKernel(
+        function,
+        gdimx,
+        gdimy,
+        gdimz,
+        first.bdimx(),
+        first.bdimy(),
+        first.bdimz(),
+        smem,
+        at::cuda::getCurrentCUDAStream(),
+        params.data(),
+        nullptr));
+  }
+  num_packed_launches_.fetch_add(1, std::memory_order_relaxed);
+
+  for (auto& launch : prepared) {
+    outputs.push_back(std::move(launch.outputs));
+  }
+  return outputs;
+}
+
+} // namespace nvfuser
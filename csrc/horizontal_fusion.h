@@ -0,0 +1,132 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <c10/macros/Export.h>
+
+#include <codegen.h>
+#include <executor.h>
+#include <executor_utils.h>
+#include <fusion_segmenter.h>
+#include <kernel.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace nvfuser {
+
+//! Horizontal fusion packs independent kernels into a single launch, in the
+//! style of multi-tensor apply. Each kernel gets a slice of the grid along
+//! blockIdx.x:
+//!
+//!   __device__ void packed_0(<params of kernel 0>, block_idx, grid_dim);
+//!   __device__ void packed_1(<params of kernel 1>, block_idx, grid_dim);
+//!   __global__ void packed(<params of kernel 0>, <params of kernel 1>,
+//!                          uint3 grid0, uint3 grid1) {
+//!     // blocks [0, grid0.x) run packed_0, the next grid1.x blocks run
+//!     // packed_1 with their block index shifted by grid0.x
+//!   }
+//!
+//! The device functions are generated from the lowered kernels with
+//! codegen::generateCudaDeviceFunction, and the parameters of the packed
+//! kernel are the parameters of the kernels in order, followed by the grid
+//! dimensions of each kernel. This works for the many tiny kernels of, e.g.,
+//! per-parameter optimizer updates, which are launch bound.
+//!
+//! All packed kernels must be launched with the same block size, and kernels
+//! that synchronize the grid or generate random numbers can't be packed.
+
+//! Returns why kernel can't be packed with other kernels, or an empty string
+//! if it can be
+TORCH_CUDA_CU_API std::string horizontalPackingBlocker(
+    const kir::Kernel* kernel);
+
+//! Splits run_order, the order in which the segments of a segmented fusion
+//! are run, into packs of segments that can be launched together. A pack is
+//! a run of consecutive segments for which can_pack is true and that don't
+//! consume outputs of each other. As packs are consecutive in run_order, no
+//! segment outside of a pack can depend on one member of the pack and be a
+//! dependency of another. Only packs of at least two segments are returned.
+TORCH_CUDA_CU_API std::vector<std::vector<SegmentedGroup*>>
+planHorizontalPacks(
+    const std::vector<SegmentedGroup*>& run_order,
+    const std::function<bool(SegmentedGroup*)>& can_pack,
+    int64_t max_pack_size = 8);
+
+//! Code of a kernel named kernel_name that runs each of kernels on a slice
+//! of its grid, see above. When used_modules is given, the runtime modules
+//! the generated code depends on are added to it.
+TORCH_CUDA_CU_API std::string generateHorizontalKernel(
+    const std::vector<const kir::Kernel*>& kernels,
+    const std::string& kernel_name,
+    codegen::RuntimeModules* used_modules = nullptr);
+
+//! Runs the kernels of several compiled FusionExecutors with a single
+//! launch. The executors can be segments of one fusion or independent
+//! fusions, and must outlive the HorizontalKernel.
+class TORCH_CUDA_CU_API HorizontalKernel {
+ public:
+  //! The kernels of executors must be packable, see horizontalPackingBlocker,
+  //! and use the same index type. The packed kernel is compiled on the first
+  //! run.
+  explicit HorizontalKernel(std::vector<FusionExecutor*> executors);
+
+  const std::string& kernelName() const {
+    return kernel_name_;
+  }
+
+  //! Code of the packed kernel, without the preamble
+  const std::string& kernelString() const {
+    return code_;
+  }
+
+  //! Number of parameters the packed kernel takes for each executor
+  const std::vector<size_t>& numParameters() const {
+    return num_parameters_;
+  }
+
+  //! Runs executor i with args[i], launch_constraints[i] and
+  //! compile_params[i] as FusionExecutor::runFusion would, and returns the
+  //! outputs of each executor. Outputs and intermediate buffers are pushed
+  //! to args. The kernels are launched one by one if they need different
+  //! block sizes. Several threads may run the kernel concurrently.
+  std::vector<std::vector<at::Tensor>> run(
+      std::vector<KernelArgumentHolder>& args,
+      const std::vector<LaunchParams>& launch_constraints,
+      const std::vector<CompileParams>& compile_params);
+
+  //! Number of runs that launched the packed kernel
+  int64_t numPackedLaunches() const {
+    return num_packed_launches_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  //! Compile the packed kernel for blocks of block_size threads. The caller
+  //! must hold mutex_.
+  void compile(int64_t block_size);
+
+  std::vector<FusionExecutor*> executors_;
+  std::vector<size_t> num_parameters_;
+  PrimDataType index_type_ = PrimDataType::Int;
+  std::string kernel_name_;
+  std::string code_;
+  codegen::RuntimeModules runtime_modules_;
+
+  //! Guards the compiled kernel and its properties
+  std::mutex mutex_;
+  executor_utils::NvrtcFunction compiled_kernel_;
+  int64_t compiled_block_size_ = 0;
+  int64_t available_dynamic_smem_size_ = 0;
+  std::atomic<int64_t> num_packed_launches_ = 0;
+};
+
+} // namespace nvfuser
@@ -621,9 +621,9 @@ class TORCH_CUDA_CU_API TensorView : public Val {
   void commitLeafToRFactor();
 
  protected:
-  void setDomain(TensorDomain* td) {
-    domain_ = td;
-  }
+  //! Changes the tvGraphVersion of the fusion if the root or rfactor domain
+  //! is replaced
+  void setDomain(TensorDomain* td);
 
  private:
   int64_t normalizeAxisPos(int64_t pos) const {
@@ -6,6 +6,7 @@
  */
 // clang-format on
 #include <device_lower/lower2device.h>
+#include <device_profile.h>
 #include <expr_evaluator.h>
 #include <instrumentation.h>
 #include <ir/iostream.h>
@@ -424,7 +425,7 @@ std::string KernelPerformanceProfile::toString(const at::Tensor& buffer) const {
     return ss.str();
   }
 
-  double kilo_freq = at::cuda::getCurrentDeviceProperties()->clockRate;
+  double kilo_freq = (double)currentDeviceProfile()->clock_rate;
 
   ss << std::setprecision(3) << std::fixed;
 
@@ -0,0 +1,292 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <kernel_bundle.h>
+
+#include <compiled_kernel_cache.h>
+#include <executor.h>
+#include <instrumentation.h>
+#include <kernel_db/utils.h>
+#include <utils.h>
+
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/util/Exception.h>
+
+#include <cuda.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace nvfuser {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+const std::string manifest_file = "manifest.csv";
+const std::string manifest_magic = "nvfuser_kernel_bundle";
+const std::string kernel_header =
+    "kernel,fusion_id,index_type,maxrregcount,enable_magic_zero,"
+    "device_major,device_minor,multi_processor_count,compile_options,"
+    "runtime_modules,lowered_kernel_name,binary,block_size,launch_params,"
+    "heuristic,heuristic_params";
+
+std::vector<std::string> splitCsvLine(const std::string& line) {
+  std::vector<std::string> fields;
+  std::stringstream ss(line);
+  std::string field;
+  while (std::getline(ss, field, ',')) {
+    fields.push_back(field);
+  }
+  // getline does not return a trailing empty field
+  if (!line.empty() && line.back() == ',') {
+    fields.emplace_back();
+  }
+  return fields;
+}
+
+int64_t encodeRuntimeModules(const codegen::RuntimeModules& modules) {
+  int64_t bits = 0;
+  for (auto module : modules) {
+    bits |= (int64_t)1 << static_cast<int>(module);
+  }
+  return bits;
+}
+
+// Grid and block dimensions, which may be LaunchParams::UNINITIALIZED_VAL,
+// followed by the shared memory size, separated by ':'
+std::string encodeLaunchParams(const LaunchParams& lparams) {
+  std::stringstream ss;
+  for (auto ptype : kParallelTypeThreads) {
+    ss << lparams.getRawVal(ptype) << ":";
+  }
+  ss << lparams.smem();
+  return ss.str();
+}
+
+LaunchParams decodeLaunchParams(const std::string& encoded) {
+  std::vector<int64_t> values;
+  std::stringstream ss(encoded);
+  for (std::string value; std::getline(ss, value, ':');) {
+    values.push_back(std::stoll(value));
+  }
+  TORCH_CHECK(values.size() == 7, "Corrupted launch parameters: ", encoded);
+  LaunchParams lparams(
+      values[0], values[1], values[2], values[3], values[4], values[5]);
+  lparams.setSmem(values[6]);
+  return lparams;
+}
+
+codegen::RuntimeModules decodeRuntimeModules(int64_t bits) {
+  codegen::RuntimeModules modules;
+  for (int i = 0; i <= static_cast<int>(codegen::RuntimeModule::TensorCore);
+       ++i) {
+    if (bits & ((int64_t)1 << i)) {
+      modules.insert(static_cast<codegen::RuntimeModule>(i));
+    }
+  }
+  return modules;
+}
+
+} // namespace
+
+int64_t writeKernelBundle(
+    const std::string& bundle_dir,
+    const DeviceProfile& target) {
+  FUSER_PERF_SCOPE("writeKernelBundle");
+
+  const fs::path bundle_path(bundle_dir);
+  fs::create_directories(bundle_path);
+
+  std::stringstream manifest;
+  manifest << manifest_magic << "," << kernel_bundle_version << ","
+           << CUDA_VERSION << "\n";
+  manifest << "target," << target.name << "," << target.major << ","
+           << target.minor << "," << target.multi_processor_count << "\n";
+  manifest << kernel_header << "\n";
+
+  int64_t num_kernels = 0;
+  for (const auto& [key, entry] : CompiledKernelCache::get().entries()) {
+    if (key.device_major != target.major ||
+        key.device_minor != target.minor ||
+        key.multi_processor_count != target.multi_processor_count) {
+      continue;
+    }
+    const std::string kernel_name = "kernel" + std::to_string(num_kernels++);
+
+    // Binaries are compiled for the device the kernels are generated for,
+    // even if the builder runs on another one
+    const bool write_binary = !entry->compiled_binary.empty();
+
+    TORCH_CHECK(
+        copy_to_text_file(
+            (bundle_path / (kernel_name + ".ir")).string(),
+            key.fingerprint.canonical_ir) &&
+            copy_to_text_file(
+                (bundle_path / (kernel_name + ".cu")).string(),
+                entry->kernel_code),
+        "Failed to write kernel bundle to ",
+        bundle_dir);
+    if (write_binary) {
+      TORCH_CHECK(
+          copy_to_binary_file(
+              (bundle_path / (kernel_name + ".bin")).string(),
+              entry->compiled_binary),
+          "Failed to write kernel bundle to ",
+          bundle_dir);
+    }
+
+    manifest << kernel_name << "," << entry->fusion_id << ","
+             << static_cast<int>(key.index_type) << "," << key.maxrregcount
+             << "," << key.enable_magic_zero << "," << key.device_major << ","
+             << key.device_minor << "," << key.multi_processor_count << ","
+             << key.compile_options << ","
+             << encodeRuntimeModules(entry->runtime_modules) << ","
+             << (write_binary ? entry->lowered_kernel_name : "") << ","
+             << (write_binary ? kernel_name + ".bin" : "") << ","
+             << entry->block_size.value_or(-1) << ","
+             << encodeLaunchParams(entry->launch_params) << ","
+             << entry->heuristic << "," << entry->heuristic_params << "\n";
+  }
+
+  TORCH_CHECK(
+      copy_to_text_file((bundle_path / manifest_file).string(), manifest.str()),
+      "Failed to write kernel bundle manifest to ",
+      bundle_dir);
+  return num_kernels;
+}
+
+KernelBundleStats loadKernelBundle(const std::string& bundle_dir) {
+  FUSER_PERF_SCOPE("loadKernelBundle");
+
+  const fs::path bundle_path(bundle_dir);
+  std::ifstream manifest((bundle_path / manifest_file).string());
+  TORCH_CHECK(manifest, "Kernel bundle manifest not found in ", bundle_dir);
+
+  std::string line;
+  std::getline(manifest, line);
+  auto header = splitCsvLine(line);
+  TORCH_CHECK(
+      header.size() == 3 && header[0] == manifest_magic,
+      "Not a kernel bundle: ",
+      bundle_dir);
+  TORCH_CHECK(
+      std::stoll(header[1]) == kernel_bundle_version,
+      "Kernel bundle version ",
+      header[1],
+      " is not supported, expected version ",
+      kernel_bundle_version);
+  // Binaries of another toolkit may not load with the current driver, so
+  // they are compiled from source instead
+  const bool use_binaries = std::stoll(header[2]) == CUDA_VERSION;
+
+  // Target line, only informational
+  std::getline(manifest, line);
+  std::getline(manifest, line);
+  TORCH_CHECK(
+      line == kernel_header, "Corrupted kernel bundle manifest: ", line);
+
+  const auto profile = currentDeviceProfile();
+  // Binaries can only be loaded on the compute capability they were
+  // compiled for, which the current profile has unless it is injected
+  const bool can_load_binaries = use_binaries &&
+      profile->computeCapability() ==
+          physicalDeviceProfile(at::cuda::current_device())
+              ->computeCapability();
+  auto& cache = CompiledKernelCache::get();
+
+  KernelBundleStats stats;
+  while (std::getline(manifest, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    auto fields = splitCsvLine(line);
+    TORCH_CHECK(
+        fields.size() == 16, "Corrupted kernel bundle manifest: ", line);
+
+    CompiledKernelKey key;
+    key.index_type = static_cast<PrimDataType>(std::stoi(fields[2]));
+    key.maxrregcount = std::stoll(fields[3]);
+    key.enable_magic_zero = std::stoi(fields[4]) != 0;
+    key.device_major = std::stoi(fields[5]);
+    key.device_minor = std::stoi(fields[6]);
+    key.multi_processor_count = std::stoll(fields[7]);
+    if (key.device_major != profile->major ||
+        key.device_minor != profile->minor ||
+        key.multi_processor_count != profile->multi_processor_count) {
+      stats.skipped++;
+      continue;
+    }
+
+    TORCH_CHECK(
+        copy_from_text_file(
+            (bundle_path / (fields[0] + ".ir")).string(),
+            key.fingerprint.canonical_ir),
+        "Failed to read kernel bundle entry ",
+        fields[0]);
+    key.fingerprint.hash =
+        std::hash<std::string>{}(key.fingerprint.canonical_ir);
+
+    CompiledKernelEntry entry;
+    entry.fusion_id = std::stoll(fields[1]);
+    entry.runtime_modules = decodeRuntimeModules(std::stoll(fields[9]));
+    const auto block_size = std::stoll(fields[12]);
+    if (block_size >= 0) {
+      entry.block_size = block_size;
+    }
+    entry.launch_params = decodeLaunchParams(fields[13]);
+    entry.heuristic = fields[14];
+    entry.heuristic_params = fields[15];
+    TORCH_CHECK(
+        copy_from_text_file(
+            (bundle_path / (fields[0] + ".cu")).string(), entry.kernel_code),
+        "Failed to read kernel bundle entry ",
+        fields[0]);
+
+    const bool has_binary = can_load_binaries && !fields[11].empty() &&
+        copy_from_binary_file(
+            (bundle_path / fields[11]).string(), entry.compiled_binary);
+    if (has_binary) {
+      // The binary was compiled with the options of the builder
+      key.compile_options = fields[8];
+      entry.lowered_kernel_name = fields[10];
+      std::tie(entry.compiled_kernel, entry.compiler_log) =
+          executor_utils::loadCompiledKernel(
+              entry.compiled_binary,
+              entry.lowered_kernel_name,
+              entry.block_size,
+              key.maxrregcount);
+    } else {
+      FusionExecutor fe;
+      const auto structured_code = fe.getStructuredCode(
+          entry.kernel_code, key.index_type, entry.runtime_modules);
+      std::tie(entry.compiled_kernel, entry.compiler_log, std::ignore) =
+          executor_utils::getCompiledKernel(
+              entry.kernel_code,
+              structured_code,
+              FusionExecutor::kernelNamespace() + "::kernel" +
+                  std::to_string(entry.fusion_id),
+              entry.fusion_id,
+              entry.block_size,
+              key.maxrregcount,
+              false,
+              &entry.lowered_kernel_name);
+      key.compile_options = executor_utils::compileOptionsSignature();
+      stats.compiled++;
+    }
+    // Executors only ask for binaries when dumping or bundling
+    entry.compiled_binary.clear();
+    key.keep_compiled_binary = false;
+
+    cache.insert(key, std::move(entry));
+    stats.loaded++;
+  }
+  return stats;
+}
+
+} // namespace nvfuser
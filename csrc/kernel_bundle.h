@@ -0,0 +1,58 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <c10/macros/Export.h>
+
+#include <device_profile.h>
+
+#include <cstdint>
+#include <string>
+
+namespace nvfuser {
+
+//! A kernel bundle is a directory with the kernels generated ahead of time
+//! by the kernel bundle builder (tools/kernel_bundle_builder.cpp). It holds
+//! a manifest.csv file and, per kernel, the canonical IR of the scheduled
+//! fusion it was generated from, the CUDA source and, if it was compiled
+//! for the target device, the compiled binary.
+//!
+//! Kernels are keyed like in CompiledKernelCache, i.e., by the structural
+//! fingerprint of the scheduled fusion, the device profile and the
+//! compilation parameters. Each kernel also records the block size and
+//! launch parameters it was compiled for and the heuristic parameters it was
+//! scheduled with. Loading a bundle inserts its kernels into
+//! CompiledKernelCache, so that executors scheduled the same way skip code
+//! generation and compilation.
+
+//! Version of the bundle format. Bundles of other versions are rejected.
+constexpr int64_t kernel_bundle_version = 3;
+
+struct KernelBundleStats {
+  //! Kernels inserted into CompiledKernelCache
+  int64_t loaded = 0;
+  //! Kernels that had to be compiled from source as no usable binary was
+  //! bundled
+  int64_t compiled = 0;
+  //! Kernels generated for another compute capability
+  int64_t skipped = 0;
+};
+
+//! Write the kernels in CompiledKernelCache that were generated for the
+//! compute capability of the target device to bundle_dir, along with the
+//! binaries compiled for it. Returns the number of written kernels.
+TORCH_CUDA_CU_API int64_t
+writeKernelBundle(const std::string& bundle_dir, const DeviceProfile& target);
+
+//! Load the kernels of bundle_dir that match the current device profile into
+//! CompiledKernelCache. Kernels without a usable binary are compiled from
+//! source.
+TORCH_CUDA_CU_API KernelBundleStats
+loadKernelBundle(const std::string& bundle_dir);
+
+} // namespace nvfuser
@@ -7,6 +7,7 @@
 // clang-format on
 #include <kernel_cache.h>
 
+#include <device_profile.h>
 #include <dynamic_transform.h>
 #include <executor_params.h>
 #include <instrumentation.h>
@@ -14,6 +15,7 @@
 #include <parser.h>
 #include <scheduler/debug_utils.h>
 #include <scheduler/registry.h>
+#include <scheduler/tuning_db.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/runtime/graph_executor.h>
 
@@ -21,10 +23,48 @@
 #include <c10/cuda/CUDAGuard.h>
 #include <c10/util/irange.h>
 #include <torch/csrc/jit/jit_log.h>
+
+#include <algorithm>
 namespace nvfuser {
 
 namespace {
 
+//! Parameters of the scalar fallback kernel of an alignment-agnostic
+//! runtime: the same schedule, with vectorized accesses of the inputs turned
+//! into unrolled ones. Returns nullptr if params doesn't vectorize inputs.
+std::shared_ptr<HeuristicParams> makeScalarFallbackParams(
+    const HeuristicParams& params) {
+  auto fallback = params.clone();
+  if (auto pparams = std::dynamic_pointer_cast<PointwiseParams>(fallback)) {
+    if (!pparams->vectorize) {
+      return nullptr;
+    }
+    pparams->vectorize = false;
+  } else if (
+      auto rparams = std::dynamic_pointer_cast<ReductionParams>(fallback)) {
+    if (!rparams->vectorize_inner_reduction && !rparams->vectorize_iter_dom) {
+      return nullptr;
+    }
+    rparams->vectorize_inner_reduction = false;
+    rparams->vectorize_iter_dom = false;
+  } else if (
+      auto tparams = std::dynamic_pointer_cast<TransposeParams>(fallback)) {
+    if (tparams->vectorize_factor1 == 1 && tparams->vectorize_factor2 == 1) {
+      return nullptr;
+    }
+    tparams->vectorize_factor1 = 1;
+    tparams->vectorize_factor2 = 1;
+    // The block size of transposes depends on the vectorization factors
+    auto smem = tparams->lparams.smem();
+    tparams->lparams = LaunchParams();
+    tparams->lparams.bind(tparams->getThreadsPerBlock(), ParallelType::TIDx);
+    tparams->lparams.setSmem(smem);
+  } else {
+    return nullptr;
+  }
+  return fallback;
+}
+
 int getNumThreads() {
   const char* option_env_name = "NVFUSER_NUM_THREADS";
   auto dump_options = std::getenv(option_env_name);
@@ -55,6 +95,19 @@ void encodeBuffer(T value, std::string& buffer) {
   }
 }
 
+// Tensor inputs recorded by the profiler, so it can construct the data flow
+// graph of the fused kernel
+std::vector<c10::IValue> recordedInputs(const KernelArgumentHolder& args) {
+  std::vector<c10::IValue> inputs;
+  for (auto i : c10::irange(args.size())) {
+    if (args[i]->isType(ArgType::Tensor)) {
+      inputs.emplace_back(
+          static_cast<const TensorArgAbstract*>(args[i])->getTensor());
+    }
+  }
+  return inputs;
+}
+
 // This ArgumentManager do two things
 // (1) add outputs from a segment to the global fusion args to pass it to next
 // segment (2) delete args no longer being used to save memory. For task (2), it
@@ -73,10 +126,16 @@ class ArgumentManager {
         fusion_inputs, runtime_workspace.group_extent_binding_order);
     setLastUsedSegmentID(runtime_workspace.group_run_order);
   }
-  const std::unordered_map<Val*, const ArgAbstract*>& getTensorMap() {
-    return tensor_map_;
+  std::unordered_map<Val*, const ArgAbstract*> getTensorMap() const {
+    std::unordered_map<Val*, const ArgAbstract*> tensor_map;
+    tensor_map.reserve(tensor_map_.size());
+    for (const auto& [val, arg] : tensor_map_) {
+      tensor_map.emplace(val, arg.get());
+    }
+    return tensor_map;
   }
-  const ArgAbstract* checkTensorMap(Val* v) {
+  //! The argument is shared with the holder of the fusion arguments
+  const std::shared_ptr<ArgAbstract>& checkTensorMap(Val* v) {
     return tensor_map_.at(v);
   }
   // T is assumed to be either std::vector<at::Tensro> or KernelArgumentHolder
@@ -94,7 +153,7 @@ class ArgumentManager {
  private:
   KernelArgumentHolder& fusion_args_;
   // map from val to args
-  std::unordered_map<Val*, const ArgAbstract*> tensor_map_;
+  std::unordered_map<Val*, std::shared_ptr<ArgAbstract>> tensor_map_;
   // map segment_id to vector of fusion vals lastly used at this segment
   std::unordered_map<int64_t, std::vector<Val*>> vals_last_used_at_segment_;
 
@@ -103,9 +162,11 @@ class ArgumentManager {
       const std::vector<Val*>& group_extent_binding_order) {
     int extent_index = 0;
     auto original_args_size = fusion_args_.size();
+    fusion_args_.reserve(
+        original_args_size + group_extent_binding_order.size());
     // Bind args in the tensor_map
     for (const auto i : c10::irange(original_args_size)) {
-      tensor_map_.emplace(fusion_inputs[i], fusion_args_[i]);
+      tensor_map_.emplace(fusion_inputs[i], fusion_args_.sharedAt(i));
       // Bind tensorview inputs values in case some segmented group
       //  needs it down the road.
       // TODO: we probably have done this already up to this point
@@ -119,7 +180,8 @@ class ArgumentManager {
         for (const auto dim : c10::irange(rank)) {
           fusion_args_.push(tensor_arg_abstract->getSize((int)dim));
           tensor_map_.emplace(
-              group_extent_binding_order[extent_index++], fusion_args_.back());
+              group_extent_binding_order[extent_index++],
+              fusion_args_.sharedAt(fusion_args_.size() - 1));
         }
       }
     }
@@ -172,7 +234,7 @@ class ArgumentManager {
     // erase args corresponding to vals lastly used in this segment
     if (group_id >= 1 && vals_last_used_at_segment_.count(group_id)) {
       for (auto val : vals_last_used_at_segment_[group_id]) {
-        fusion_args_.erase(tensor_map_.at(val));
+        fusion_args_.erase(tensor_map_.at(val).get());
         tensor_map_.erase(val);
       }
     }
@@ -192,44 +254,60 @@ class ArgumentManager {
     for (const size_t group_out_i : c10::irange(group_outputs.size())) {
       if (!group_outputs[group_out_i]->isFusionInput()) {
         fusion_args_.push(group_runtime_outputs[group_out_i]);
-        tensor_map_.emplace(group_outputs[group_out_i], fusion_args_.back());
+        tensor_map_.emplace(
+            group_outputs[group_out_i],
+            fusion_args_.sharedAt(fusion_args_.size() - 1));
       }
     }
   }
 };
 
+// Record the heuristic parameters of entry with the kernel executor compiles
+void setHeuristicParams(FusionExecutor& executor, SchedulerEntry* entry) {
+  if (entry->heuristic() == ScheduleHeuristic::NoOp) {
+    return;
+  }
+  executor.setHeuristicParams(
+      toString(entry->heuristic()), serializeHeuristicParams(*entry->params()));
+}
+
 } // namespace
 
+void InputsIdLookup::encodeTensor(
+    const at::Tensor& input_tensor,
+    bool encode_alignment) {
+  for (auto size : input_tensor.sizes()) {
+    encodeBuffer(size, encoding_);
+    encoding_.push_back(' ');
+  }
+  encoding_.push_back('X');
+  encoding_.push_back(' ');
+  for (auto stride : input_tensor.strides()) {
+    encodeBuffer(stride, encoding_);
+    encoding_.push_back(' ');
+  }
+  if (encode_alignment) {
+    encoding_.push_back('a');
+    encodeBuffer(
+        SchedulerRuntimeInfo::computeAlignmentSize(
+            (size_t)input_tensor.data_ptr()),
+        encoding_);
+  }
+  encoding_.push_back('d');
+  encodeBuffer(input_tensor.device().index(), encoding_);
+}
+
 InputsIdLookup::IdLookupReturn InputsIdLookup::lookupId(
     const at::ArrayRef<c10::IValue>& inputs,
-    const std::unordered_set<size_t>& scalar_inputs_to_record) {
-  IdLookupReturn ret;
-
+    const std::unordered_set<size_t>& scalar_inputs_to_record,
+    bool encode_alignment) {
   // lock mutex_ because we are touching encoding_
   std::lock_guard<std::mutex> guard(mutex_);
   encoding_.clear();
   for (const auto i : c10::irange(inputs.size())) {
     auto input = inputs[i];
     if (input.isTensor()) {
-      auto& input_tensor = input.toTensor();
-
-      for (auto size : input_tensor.sizes()) {
-        encodeBuffer(size, encoding_);
-        encoding_.push_back(' ');
-      }
-      encoding_.push_back('X');
-      encoding_.push_back(' ');
-      for (auto stride : input_tensor.strides()) {
-        encodeBuffer(stride, encoding_);
-        encoding_.push_back(' ');
-      }
-      encoding_.push_back('a');
-      encodeBuffer(
-          SchedulerRuntimeInfo::computeAlignmentSize(
-              (size_t)input_tensor.data_ptr()),
-          encoding_);
-      encoding_.push_back('d');
-      encodeBuffer(input_tensor.device().index(), encoding_);
+      encodeTensor(input.toTensor(), encode_alignment);
     } else {
       // encode s for scalar;
       encoding_.push_back('s');
@@ -257,7 +335,59 @@ InputsIdLookup::IdLookupReturn InputsIdLookup::lookupId(
     }
     encoding_.push_back(';');
   }
+  return lookupEncoding();
+}
 
+InputsIdLookup::IdLookupReturn InputsIdLookup::lookupId(
+    const KernelArgumentHolder& args,
+    const std::unordered_set<size_t>& scalar_inputs_to_record,
+    bool encode_alignment) {
+  // lock mutex_ because we are touching encoding_
+  std::lock_guard<std::mutex> guard(mutex_);
+  encoding_.clear();
+  for (const auto i : c10::irange(args.size())) {
+    auto arg = args[i];
+    if (arg->isType(ArgType::Tensor)) {
+      encodeTensor(
+          static_cast<const TensorArgAbstract*>(arg)->tensor_,
+          encode_alignment);
+    } else if (arg->isType(ArgType::CpuScalarTensor)) {
+      // encode c for a cpu scalar tensor, which is passed by value
+      encoding_.push_back('c');
+    } else {
+      // encode s for scalar;
+      encoding_.push_back('s');
+      if (scalar_inputs_to_record.find(i) != scalar_inputs_to_record.end()) {
+        switch (arg->type()) {
+          case ArgType::Long:
+            encodeBuffer(*static_cast<const int64_t*>(arg->arg()), encoding_);
+            break;
+          case ArgType::Bool:
+            encodeBuffer(*static_cast<const bool*>(arg->arg()), encoding_);
+            break;
+          case ArgType::Double:
+            encodeBuffer(*static_cast<const double*>(arg->arg()), encoding_);
+            break;
+          case ArgType::ComplexDouble:
+            encodeBuffer(
+                *static_cast<const c10::complex<double>*>(arg->arg()),
+                encoding_);
+            break;
+          default:
+            TORCH_INTERNAL_ASSERT(
+                false,
+                "Unhandled input type when creating input ID. Cannot record ",
+                arg->toString());
+        }
+      }
+    }
+    encoding_.push_back(';');
+  }
+  return lookupEncoding();
+}
+
+InputsIdLookup::IdLookupReturn InputsIdLookup::lookupEncoding() {
+  IdLookupReturn ret;
   auto& entry = encoding_lookup_[encoding_];
 
   if (entry.id == 0) {
@@ -287,7 +417,20 @@ InputsIdLookup::IdLookupReturn InputsIdLookup::lookupId(
 }
 
 FusionExecutorCache::FusionExecutorCache(std::unique_ptr<Fusion> fusion)
-    : fusion_(std::move(fusion)) {}
+    : fusion_(std::move(fusion)) {
+  static std::once_flag bundle_preloaded;
+  std::call_once(bundle_preloaded, []() {
+    if (const char* bundle_dir = std::getenv("PYTORCH_NVFUSER_KERNEL_BUNDLE")) {
+      preloadKernelBundle(bundle_dir);
+    }
+  });
+}
+
+KernelBundleStats FusionExecutorCache::preloadKernelBundle(
+    const std::string& bundle_dir) {
+  FUSER_PERF_SCOPE("FusionExecutorCache::preloadKernelBundle");
+  return loadKernelBundle(bundle_dir);
+}
 
 KernelArgumentHolder FusionExecutorCache::prepareInputs(
     const at::ArrayRef<c10::IValue>& inputs,
@@ -296,7 +439,12 @@ KernelArgumentHolder FusionExecutorCache::prepareInputs(
 
   KernelArgumentHolder args =
       KernelArgumentHolder::createKernelArgumentHolder(inputs, selected_device);
+  std::lock_guard<std::mutex> guard(mutex_);
+  setCacheId(args);
+  return args;
+}
 
+void FusionExecutorCache::setCacheId(KernelArgumentHolder& args) {
   // TODO: move InputsIdLookup inside KernelArgumentHolder;
   // NOTE: We must ensure that the cache id is in fact unique. Dynamic fusions
   // may contain transformations that depend on input scalars, not just on the
@@ -306,22 +454,30 @@ KernelArgumentHolder FusionExecutorCache::prepareInputs(
   // short-circuiting here, resulting in avoidable rebuilds of concretization
   // info.
   auto id_lookup_ret = inputs_id_lookup_.lookupId(
-      inputs, initialInfo().scalarInputsAffectingConcretization());
+      args,
+      initialInfo().scalarInputsAffectingConcretization(),
+      !alignment_agnostic_);
   if (id_lookup_ret.eviction) {
     evictCache(id_lookup_ret.evict_id);
   }
 
   args.setCacheId(id_lookup_ret.id);
-  return args;
 }
 
 bool FusionExecutorCache::isCompiled(const at::ArrayRef<c10::IValue>& inputs) {
   FUSER_PERF_SCOPE("FusionExecutorCache::isCompiled");
 
   // Access kernels associated with the common device id
-  KernelArgumentHolder args = prepareInputs(inputs);
+  return lookUpKernelRuntime(inputs)->isCompiled();
+}
 
-  return getKernelRuntimeFor(args)->isCompiled();
+FusionKernelRuntime* FusionExecutorCache::lookUpKernelRuntime(
+    const at::ArrayRef<c10::IValue>& inputs) {
+  KernelArgumentHolder args =
+      KernelArgumentHolder::createKernelArgumentHolder(inputs);
+  std::lock_guard<std::mutex> guard(mutex_);
+  setCacheId(args);
+  return getKernelRuntimeFor(args).runtime;
 }
 
 // Note [ Permutation support in nvfuser ]
@@ -362,32 +518,65 @@ std::vector<at::Tensor> FusionExecutorCache::runFusionWithInputs(
     std::optional<PrimDataType> forced_index_type,
     std::optional<int8_t> selected_device) {
   FUSER_PERF_SCOPE("FusionExecutorCache::runFusionWithInputs");
+  KernelArgumentHolder args =
+      KernelArgumentHolder::createKernelArgumentHolder(inputs, selected_device);
+  return runFusionWithArgs(args, forced_index_type);
+}
 
+FusionExecutorCache::RuntimeEntry FusionExecutorCache::
+    getCompiledKernelRuntimeFor(
+    KernelArgumentHolder& args,
+    std::optional<PrimDataType> forced_index_type) {
   // Permute input tensor for kernel execution.
   // See Part_1 in Note [ Channels-Last support in nvfuser ]
-  at::ArrayRef<c10::IValue> perm_inputs = inputs;
-  const auto& to_be_permuted_inputs = fusion_->getPermutationInputMap();
-  std::vector<c10::IValue> inputs_vec;
-  if (!to_be_permuted_inputs.empty()) {
-    inputs_vec = inputs.vec();
-    for (const auto& pair : to_be_permuted_inputs) {
-      auto v = inputs_vec[pair.first];
-      TORCH_CHECK(
-          v.isTensor(), "input permutation can only be applied at tensor");
-      auto tensor = v.toTensor();
-      inputs_vec[pair.first] = tensor.permute(pair.second);
-    }
-    perm_inputs = inputs_vec;
+  for (const auto& pair : fusion_->getPermutationInputMap()) {
+    auto arg = args[pair.first];
+    TORCH_CHECK(
+        arg->isType(ArgType::Tensor),
+        "input permutation can only be applied at tensor");
+    KernelArgumentHolder permuted_arg;
+    permuted_arg.push(static_cast<const TensorArgAbstract*>(arg)
+                          ->getTensor()
+                          .permute(pair.second));
+    args.swap(pair.first, permuted_arg.back());
   }
 
-  KernelArgumentHolder args = prepareInputs(perm_inputs, selected_device);
-  auto kernel_runtime = getKernelRuntimeFor(args, forced_index_type);
-
-  if (!isCompiled(perm_inputs)) {
-    kernel_runtime->compileFusionParallel(args);
+  RuntimeEntry entry;
+  {
+    // Runtimes are looked up and created one thread at a time. They are
+    // compiled without the lock, so inputs served by other runtimes don't
+    // wait for the compilation.
+    std::lock_guard<std::mutex> guard(mutex_);
+
+    // The arguments are captured from the inputs once, the cache lookups and
+    // the runtime only read the captured sizes, strides and pointers.
+    setCacheId(args);
+    entry = getKernelRuntimeFor(args, forced_index_type);
   }
 
-  most_recent_runtime_ = kernel_runtime;
+  // Only the first call compiles the runtime
+  entry.runtime->compileFusionParallel(args);
+  return entry;
+}
+
+void FusionExecutorCache::compileFusionWithArgs(
+    KernelArgumentHolder& args,
+    std::optional<PrimDataType> forced_index_type) {
+  FUSER_PERF_SCOPE("FusionExecutorCache::compileFusionWithArgs");
+  getCompiledKernelRuntimeFor(args, forced_index_type);
+}
+
+std::vector<at::Tensor> FusionExecutorCache::runFusionWithArgs(
+    KernelArgumentHolder& args,
+    std::optional<PrimDataType> forced_index_type) {
+  FUSER_PERF_SCOPE("FusionExecutorCache::runFusionWithArgs");
+
+  const auto entry = getCompiledKernelRuntimeFor(args, forced_index_type);
+  auto kernel_runtime = entry.runtime;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    most_recent_runtime_ = kernel_runtime;
+  }
 
   auto fusion = kernel_runtime->fusionSegments()->completeFusion();
 
@@ -403,11 +592,9 @@ std::vector<at::Tensor> FusionExecutorCache::runFusionWithInputs(
   int seq_id = 0;
   // Record kernel input and output tensors so profiler can construct
   // the data flow graph
-  RECORD_FUNCTION(
-      "run_fused_kernel",
-      std::vector<c10::IValue>(inputs.begin(), inputs.end()),
-      seq_id);
-  auto outputs = kernel_runtime->runWithInputs(args);
+  RECORD_FUNCTION("run_fused_kernel", recordedInputs(args), seq_id);
+  auto outputs =
+      kernel_runtime->runWithInputs(args, entry.launch_constraints.get());
   RECORD_OUTPUTS(outputs);
 
   // Permute output tensor returned by kernel execution.
@@ -453,6 +640,7 @@ std::string FusionExecutorCache::getCode(
     const auto& execs = kernel_runtime->executors();
     const FusionExecutor& fe = execs[0];
     auto index_type = fe.kernel()->indexType();
+    codegen::RuntimeModules runtime_modules;
     // Make sure all the segment index types match. All segments currently
     // use the same index type but this code change in the future.
     for (const auto& exec : execs) {
@@ -462,8 +650,11 @@ std::string FusionExecutorCache::getCode(
           index_type,
           " ",
           exec.kernel()->indexType());
+      runtime_modules.insert(
+          exec.runtimeModules().begin(), exec.runtimeModules().end());
     }
-    std::string full_code = fe.getStructuredCode(kernel_code, index_type);
+    std::string full_code =
+        fe.getStructuredCode(kernel_code, index_type, runtime_modules);
     return full_code;
   } else {
     return kernel_code;
@@ -477,9 +668,7 @@ std::string FusionExecutorCache::getMostRecentCode(bool intrinsic_code) const {
 std::string FusionExecutorCache::getCodeFor(
     const at::ArrayRef<c10::IValue>& inputs,
     bool intrinsic_code) {
-  KernelArgumentHolder args = prepareInputs(inputs);
-  auto kernel_runtime = getKernelRuntimeFor(args);
-  return getCode(kernel_runtime, intrinsic_code);
+  return getCode(lookUpKernelRuntime(inputs), intrinsic_code);
 }
 
 std::string FusionExecutorCache::getScheduledIr(
@@ -507,18 +696,70 @@ std::string FusionExecutorCache::getMostRecentScheduledIr(
   return getScheduledIr(most_recent_runtime_, tensor_transforms);
 }
 
+std::string FusionExecutorCache::getLowerPassStats(
+    FusionKernelRuntime* kernel_runtime) const {
+  TORCH_CHECK(kernel_runtime != nullptr, "Invalid fusion definition!");
+  TORCH_CHECK(kernel_runtime->isCompiled(), "Fusion is not compiled!");
+  std::stringstream ss;
+  ss << "[";
+  bool first_kernel = true;
+  for (const auto& exec : kernel_runtime->executors()) {
+    if (!first_kernel) {
+      ss << ",";
+    }
+    first_kernel = false;
+    ss << "\n" << lowerPassStatsToJson(exec.lowerPassStats());
+  }
+  ss << "\n]";
+  return ss.str();
+}
+
+std::string FusionExecutorCache::getMostRecentLowerPassStats() const {
+  return getLowerPassStats(most_recent_runtime_);
+}
+
 std::string FusionExecutorCache::getScheduledIrFor(
     const at::ArrayRef<c10::IValue>& inputs,
     bool tensor_transforms) {
-  KernelArgumentHolder args = prepareInputs(inputs);
-  auto kernel_runtime = getKernelRuntimeFor(args);
-  return getScheduledIr(kernel_runtime, tensor_transforms);
+  return getScheduledIr(lookUpKernelRuntime(inputs), tensor_transforms);
+}
+
+void FusionExecutorCache::collectLowerPassStats(bool collect) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  const bool drop_compiled = collect && !collect_lower_pass_stats_;
+  collect_lower_pass_stats_ = collect;
+  for (auto& it : kernel_runtimes_) {
+    auto& kernel_runtimes = it.second;
+    for (auto& kernel_runtime : kernel_runtimes) {
+      kernel_runtime->collectLowerPassStats(collect);
+      if (drop_compiled && kernel_runtime->isCompiled()) {
+        dropped_runtimes_.push_back(std::move(kernel_runtime));
+      }
+    }
+    kernel_runtimes.erase(
+        std::remove(kernel_runtimes.begin(), kernel_runtimes.end(), nullptr),
+        kernel_runtimes.end());
+  }
+  if (!drop_compiled) {
+    return;
+  }
+  for (auto it = id_to_kernel_runtime_.begin();
+       it != id_to_kernel_runtime_.end();) {
+    if (it->second.runtime->isCompiled()) {
+      it = id_to_kernel_runtime_.erase(it);
+    } else {
+      ++it;
+    }
+  }
 }
 
 void FusionExecutorCache::evictCache(size_t cache_id) {
   auto it = id_to_kernel_runtime_.find(cache_id);
-  TORCH_INTERNAL_ASSERT(it != id_to_kernel_runtime_.end());
-  it->second->evictCache(cache_id);
+  // The ids of the runtimes dropped by collectLowerPassStats are forgotten
+  if (it == id_to_kernel_runtime_.end()) {
+    return;
+  }
+  it->second.runtime->evictCache(cache_id);
   id_to_kernel_runtime_.erase(it);
 }
 
@@ -529,7 +770,7 @@ DynamicTransformInitialInfo& FusionExecutorCache::initialInfo() {
   return initial_info_.value();
 }
 
-FusionKernelRuntime* FusionExecutorCache::getKernelRuntimeFor(
+FusionExecutorCache::RuntimeEntry FusionExecutorCache::getKernelRuntimeFor(
     const KernelArgumentHolder& args,
     std::optional<PrimDataType> forced_index_type) {
   // Check for id hit case
@@ -543,7 +784,7 @@ FusionKernelRuntime* FusionExecutorCache::getKernelRuntimeFor(
     // If the forced index type is given, don't use the cached runtime
     // if its index type does not match with the forced type
     if (!forced_index_type.has_value() ||
-        forced_index_type.value() == id_it->second->getIndexType()) {
+        forced_index_type.value() == id_it->second.runtime->getIndexType()) {
       return id_it->second;
     }
   }
@@ -599,9 +840,14 @@ FusionKernelRuntime* FusionExecutorCache::getKernelRuntimeFor(
       });
 
   FusionKernelRuntime* kernel_runtime = nullptr;
+  std::shared_ptr<const FusionKernelRuntime::LaunchConstraints>
+      launch_constraints;
   if (reuse_it != kernel_runtimes.end()) {
     kernel_runtime = reuse_it->get();
-    kernel_runtime->updateHeuristicsLaunchParams(new_heuristics.get());
+    launch_constraints =
+        std::make_shared<const FusionKernelRuntime::LaunchConstraints>(
+            kernel_runtime->getLaunchConstraints(*new_heuristics));
+    runtime_stats_.runtimes_reused++;
   } else {
     // cache miss, need to re-build an optimized graph for this case
 
@@ -631,11 +877,22 @@ FusionKernelRuntime* FusionExecutorCache::getKernelRuntimeFor(
       fusion->printMath();
     }
     kernel_runtimes.emplace_back(std::make_unique<FusionKernelRuntime>(
-        std::move(fusion), args, forced_index_type));
+        std::move(fusion),
+        args,
+        forced_index_type,
+        alignment_agnostic_,
+        shape_buckets_));
     kernel_runtime = kernel_runtimes.back().get();
+    runtime_stats_.runtimes_created++;
     if (profiling_) {
       kernel_runtime->profile(true);
     }
+    if (horizontal_fusion_) {
+      kernel_runtime->enableHorizontalFusion(true);
+    }
+    if (collect_lower_pass_stats_) {
+      kernel_runtime->collectLowerPassStats(true);
+    }
   }
 
   if (initial_info.hasDynamicTransforms()) {
@@ -645,35 +902,63 @@ FusionKernelRuntime* FusionExecutorCache::getKernelRuntimeFor(
     fusion_->stopManaging(conc_info_index);
   }
 
-  id_to_kernel_runtime_[unique_id] = kernel_runtime;
-  return kernel_runtime;
+  RuntimeEntry entry{kernel_runtime, std::move(launch_constraints)};
+  id_to_kernel_runtime_[unique_id] = entry;
+  return entry;
 }
 
 FusionKernelRuntime::FusionKernelRuntime(
     std::unique_ptr<Fusion> fusion,
     const KernelArgumentHolder& args,
-    std::optional<PrimDataType> forced_index_type) {
+    std::optional<PrimDataType> forced_index_type,
+    bool alignment_agnostic,
+    ShapeBuckets shape_buckets)
+    : alignment_agnostic_(alignment_agnostic),
+      shape_buckets_(std::move(shape_buckets)) {
   FUSER_PERF_SCOPE("FusionKernelRuntime::FusionKernelRuntime");
 
   TORCH_INTERNAL_ASSERT(
       !fusion->hasDynamicTransform(),
       "Fusion must be concretized before constructing FusionKernelRuntime");
 
+  // Reductions that would synchronize the whole grid may run as two
+  // segments instead, reading one input with different sizes
+  split_reduction_input_ =
+      SegmentCandidateFinder::getSplitReduction(fusion.get(), args);
+  if (split_reduction_input_.has_value()) {
+    // Kept to choose the number of chunks for the inputs of later runs
+    unsplit_fusion_ = std::make_unique<Fusion>(*fusion);
+    SegmentCandidateFinder::splitReductionInFusion(
+        fusion.get(), split_reduction_input_.value());
+  }
+  KernelArgumentHolder fusion_args = args;
+  reshapeSplitReductionInput(fusion_args);
+
   all_tvs_ = ir_utils::allTvs(fusion.get());
 
   // Run segmentation on the copied fusion
   SchedulerRuntimeInfo runtime_info(
-      fusion.get(), args, nullptr, all_tvs_, forced_index_type);
+      fusion.get(),
+      fusion_args,
+      nullptr,
+      all_tvs_,
+      forced_index_type,
+      alignment_agnostic_,
+      &shape_buckets_);
 
   // Initialize the evaluator simplifer
   precomputed_values_ = std::make_unique<PrecomputedValues>(fusion.get());
 
-  segmented_fusion_ =
-      SegmentCandidateFinder::segment(std::move(fusion), args, runtime_info);
+  segmented_fusion_ = SegmentCandidateFinder::segment(
+      std::move(fusion), fusion_args, runtime_info);
 
-  heuristics_ = segmented_fusion_->makeInitialHeuristics(args, runtime_info);
+  heuristics_ =
+      segmented_fusion_->makeInitialHeuristics(fusion_args, runtime_info);
 
   executors_ = std::vector<FusionExecutor>(segmented_fusion_->groups().size());
+  scalar_fallbacks_.resize(segmented_fusion_->groups().size());
+  published_scalar_fallbacks_ = std::vector<std::atomic<ScalarFallback*>>(
+      segmented_fusion_->groups().size());
   if (isDebugDumpEnabled(DebugDumpOption::FusionSegments)) {
     segmented_fusion_->print();
   }
@@ -688,11 +973,27 @@ FusionKernelRuntime::FusionKernelRuntime(
   prepareRuntimeOrder();
 }
 
+void FusionKernelRuntime::reshapeSplitReductionInput(
+    KernelArgumentHolder& args) const {
+  if (!split_reduction_input_.has_value()) {
+    return;
+  }
+  const auto input_index = split_reduction_input_->input_index;
+  auto tensor_arg = dynamic_cast<const TensorArgAbstract*>(args[input_index]);
+  TORCH_INTERNAL_ASSERT(
+      tensor_arg != nullptr, "Split reduction input must be a tensor");
+  const auto& tensor = tensor_arg->getTensor();
+  KernelArgumentHolder split_arg;
+  split_arg.push(tensor.reshape(
+      split_reduction_input_->splitSizes(tensor.sizes().vec())));
+  args.swap((int)input_index, split_arg.back());
+}
+
 std::vector<at::Tensor> FusionKernelRuntime::runKernelWithInput(
     KernelArgumentHolder& args,
-    SegmentedGroup* sg) {
+    SegmentedGroup* sg,
+    const LaunchConstraints* launch_constraints) {
   FUSER_PERF_SCOPE("FusionKernelRuntime::runKernelWithInput");
-  std::lock_guard<std::mutex> guard(mutex_);
   // This function will be called once on un-segmented fusion,
   // for segmented fusion, this function will be called on each segment
   // In the case of segmented fusion, segmented group needs to be given so
@@ -700,12 +1001,27 @@ std::vector<at::Tensor> FusionKernelRuntime::runKernelWithInput(
   // In the case of complete fusion, sg = nullptr, and the original fusion
   // is complied and run.
   TORCH_INTERNAL_ASSERT(sg, "runKernelWithInput: need valid group to run");
-  auto [launch_params, compile_params] = getKernelConfig(args, sg);
+  auto [launch_params, compile_params] =
+      getKernelConfig(sg, launch_constraints);
   auto group_id = sg->groupId();
   auto scheduler_entry = schedulers().at(group_id).get();
-  auto& executor = executors_.at(group_id);
+  auto executor_ptr = &executors_.at(group_id);
+
+  // The main kernel of an alignment-agnostic runtime may vectorize inputs
+  // that are not aligned for this run. Use the scalar fallback kernel.
+  if (alignment_agnostic_ &&
+      !executor_ptr->hasAlignedVectorizedTensors(args)) {
+    auto& fallback = getScalarFallback(args, sg);
+    scheduler_entry = fallback.scheduler_entry.get();
+    executor_ptr = &fallback.executor;
+    launch_params = scheduler_entry->params()->lparams;
+    compile_params = scheduler_entry->params()->cparams;
+    num_scalar_fallback_launches_.fetch_add(1, std::memory_order_relaxed);
+  }
+  auto& executor = *executor_ptr;
 
   if (profiling_) {
+    std::lock_guard<std::mutex> guard(mutex_);
     most_recent_executor_log_.fusion_executor = &executor;
     most_recent_executor_log_.params = scheduler_entry->params()->clone();
   }
@@ -720,10 +1036,9 @@ std::vector<at::Tensor> FusionKernelRuntime::runKernelWithInput(
   // Print relevant information all at once for easy debuging of perf
   if (isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose)) {
     std::cout << "\nRun kernel:\n";
-    if (sg) {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
       segmented_fusion_->makeFusion(sg)->printMath();
-    } else {
-      segmented_fusion_->completeFusion()->printMath();
     }
     std::cout << "With inputs:\n";
     for (auto i : c10::irange(args.size())) {
@@ -745,10 +1060,68 @@ std::vector<at::Tensor> FusionKernelRuntime::runKernelWithInput(
   return outputs;
 }
 
+FusionKernelRuntime::ScalarFallback& FusionKernelRuntime::getScalarFallback(
+    const KernelArgumentHolder& args,
+    SegmentedGroup* sg) {
+  FUSER_PERF_SCOPE("FusionKernelRuntime::getScalarFallback");
+  const auto group_id = sg->groupId();
+  auto& published = published_scalar_fallbacks_.at(group_id);
+  if (auto fallback = published.load(std::memory_order_acquire)) {
+    return *fallback;
+  }
+
+  auto fallback_params =
+      makeScalarFallbackParams(*schedulers().at(group_id)->params());
+  TORCH_INTERNAL_ASSERT(
+      fallback_params != nullptr,
+      "Misaligned vectorized inputs of a kernel without vectorization");
+
+  std::unique_ptr<Fusion> fusion_to_run;
+  {
+    // Making the fusion of a segment reads the complete fusion, which
+    // getMaybeHeuristicsFor narrows in place
+    std::lock_guard<std::mutex> guard(mutex_);
+    fusion_to_run = segmented_fusion_->makeFusion(sg);
+  }
+
+  // Compile without the lock, so that runs not needing this fallback
+  // aren't blocked
+  FusionGuard fg(fusion_to_run.get());
+  SchedulerRuntimeInfo runtime_info(
+      fusion_to_run.get(),
+      args,
+      nullptr,
+      {},
+      fallback_params->cparams.index_type);
+  auto fallback = std::make_unique<ScalarFallback>();
+  fallback->executor.setCollectLowerPassStats(collect_lower_pass_stats_);
+  fallback->scheduler_entry = SchedulerEntry::makeEntryWithParams(
+      sg->heuristic(), fusion_to_run.get(), runtime_info, fallback_params);
+  fallback->scheduler_entry->schedule(fusion_to_run.get());
+  setHeuristicParams(fallback->executor, fallback->scheduler_entry.get());
+  fallback->executor.compileFusion(
+      fusion_to_run.get(),
+      args,
+      fallback_params->lparams,
+      fallback_params->cparams);
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  // Another thread may have published its fallback in the meantime
+  if (scalar_fallbacks_.at(group_id) == nullptr) {
+    scalar_fallbacks_.at(group_id) = std::move(fallback);
+    published.store(
+        scalar_fallbacks_.at(group_id).get(), std::memory_order_release);
+  }
+  return *scalar_fallbacks_.at(group_id);
+}
+
 void FusionKernelRuntime::prepareRuntimeOrder() {
   // Setup group run order:
   std::unordered_set<Val*> available_input;
 
+  runtime_workspace_.fusion_inputs = segmented_fusion_->inputs();
+  runtime_workspace_.fusion_outputs = segmented_fusion_->outputs();
+
   // setup the order tensor dimensions are bound
   for (const size_t i : c10::irange(segmented_fusion_->inputs().size())) {
     auto input_val = segmented_fusion_->inputs()[i];
@@ -804,17 +1177,27 @@ void FusionKernelRuntime::prepareRuntimeOrder() {
 
 // passing args by value because we will be modify this
 void FusionKernelRuntime::compileFusionParallel(KernelArgumentHolder args) {
-  std::lock_guard<std::mutex> guard(mutex_);
+  // Runs of this runtime wait for the first call to compile it, runs of
+  // other runtimes don't
+  std::call_once(compile_once_, [&]() {
+    compileSegments(args);
+    compiled_.store(true, std::memory_order_release);
+  });
+}
+
+void FusionKernelRuntime::compileSegments(KernelArgumentHolder& args) {
+  FUSER_PERF_SCOPE("FusionKernelRuntime::compileSegments");
+  reshapeSplitReductionInput(args);
 
+  const auto& fusion_inputs = runtime_workspace_.fusion_inputs;
   TORCH_INTERNAL_ASSERT(
-      args.size() == segmented_fusion_->inputs().size(),
+      args.size() == fusion_inputs.size(),
       "Inputs were not set up correctly, received ",
       args.size(),
       " inputs but expecting ",
-      segmented_fusion_->inputs().size());
+      fusion_inputs.size());
 
-  ArgumentManager args_manager(
-      args, runtime_workspace_, segmented_fusion_->inputs());
+  ArgumentManager args_manager(args, runtime_workspace_, fusion_inputs);
 
   // group should share cache id.
   auto group_cache_id = args.getCacheId();
@@ -835,15 +1218,26 @@ void FusionKernelRuntime::compileFusionParallel(KernelArgumentHolder args) {
       group_runtime_inputs.push(args_manager.checkTensorMap(input));
     }
 
-    // launch compileKernel thread here
-    getThreadPool()->run([=]() {
+    // The complete fusion is copied under the lock, see getMaybeHeuristicsFor
+    std::shared_ptr<Fusion> fusion_to_compile;
+    std::unique_ptr<Fusion> fusion_to_run;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      fusion_to_compile = segmented_fusion_->makeFusion(group_to_run);
+      fusion_to_run = segmented_fusion_->makeFusion(group_to_run);
+    }
+
+    // launch compileKernel thread here. The injected device profile outlives
+    // the workers, which are waited for below.
+    getThreadPool()->run([=, profile = injectedDeviceProfile()]() {
       FUSER_PERF_SCOPE("FusionKernelRuntime::compileFusionParallel");
+      DeviceProfileGuard profile_guard(profile);
       c10::cuda::CUDAGuard dg(args.getDeviceIndex());
       c10::Device device(c10::DeviceType::CUDA, args.getDeviceIndex());
-      compileKernel(group_runtime_inputs, group_to_run);
+      compileKernel(
+          group_runtime_inputs, group_to_run, fusion_to_compile.get());
     });
 
-    auto fusion_to_run = segmented_fusion_->makeFusion(group_to_run);
     auto group_runtime_outputs =
         executors_[group_to_run->groupId()].inferOutputSizes(
             fusion_to_run.get(), group_runtime_inputs);
@@ -860,7 +1254,8 @@ void FusionKernelRuntime::compileFusionParallel(KernelArgumentHolder args) {
 
 void FusionKernelRuntime::compileKernel(
     const KernelArgumentHolder& args,
-    SegmentedGroup* sg) {
+    SegmentedGroup* sg,
+    Fusion* fusion_to_run) {
   FUSER_PERF_SCOPE("FusionKernelRuntime::compileKernel");
   auto group_id = sg->groupId();
   auto scheduler_entry = schedulers().at(group_id).get();
@@ -869,24 +1264,24 @@ void FusionKernelRuntime::compileKernel(
   TORCH_INTERNAL_ASSERT(!sg || scheduler_entry->heuristic() == sg->heuristic());
   TORCH_INTERNAL_ASSERT(!executors_.at(group_id).compiled());
 
-  // Running a segment group as a single kernel,
-  // make a fusion to run from segmented fusion
-  auto fusion_to_run = segmented_fusion_->makeFusion(sg);
-  FusionGuard fg(fusion_to_run.get());
-  scheduler_entry->schedule(fusion_to_run.get());
+  // Running a segment group as a single kernel, fusion_to_run is a fusion
+  // made from segmented fusion
+  FusionGuard fg(fusion_to_run);
+  scheduler_entry->schedule(fusion_to_run);
   TORCH_INTERNAL_ASSERT(
       scheduler_entry->params()->cparams.index_type.has_value(),
       "Kernel index type is not defined.");
+  setHeuristicParams(executors_.at(group_id), scheduler_entry);
   executors_.at(group_id).compileFusion(
-      fusion_to_run.get(),
+      fusion_to_run,
       args,
       scheduler_entry->params()->lparams,
       scheduler_entry->params()->cparams);
 }
 
 std::pair<LaunchParams, CompileParams> FusionKernelRuntime::getKernelConfig(
-    const KernelArgumentHolder& args,
-    SegmentedGroup* sg) {
+    SegmentedGroup* sg,
+    const LaunchConstraints* launch_constraints) {
   FUSER_PERF_SCOPE("FusionKernelRuntime::getKernelConfig");
   auto group_id = sg->groupId();
   auto scheduler_entry = schedulers().at(group_id).get();
@@ -896,11 +1291,14 @@ std::pair<LaunchParams, CompileParams> FusionKernelRuntime::getKernelConfig(
   TORCH_INTERNAL_ASSERT(executors_.at(group_id).compiled());
 
   return std::make_pair(
-      scheduler_entry->params()->lparams, scheduler_entry->params()->cparams);
+      launch_constraints != nullptr ? launch_constraints->at(group_id)
+                                    : scheduler_entry->params()->lparams,
+      scheduler_entry->params()->cparams);
 }
 
 std::vector<at::Tensor> FusionKernelRuntime::runWithInputs(
-    KernelArgumentHolder& args) {
+    KernelArgumentHolder& args,
+    const LaunchConstraints* launch_constraints) {
   FUSER_PERF_SCOPE("FusionKernelRuntime::runWithInputs");
 
   if (isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose)) {
@@ -909,7 +1307,13 @@ std::vector<at::Tensor> FusionKernelRuntime::runWithInputs(
   }
 
   c10::Device device(c10::DeviceType::CUDA, (int8_t)args.getDeviceIndex());
-  const auto& tensor_map = runSegmentsWithInputs(args);
+  std::optional<KernelArgumentHolder> split_args;
+  if (split_reduction_input_.has_value()) {
+    split_args = args;
+    reshapeSplitReductionInput(split_args.value());
+  }
+  const auto& tensor_map = runSegmentsWithInputs(
+      split_args.has_value() ? split_args.value() : args, launch_constraints);
 
   if (isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose)) {
     std::cout << "============= FINISHED RUNNING FUSION SEGMENTS ============"
@@ -918,7 +1322,7 @@ std::vector<at::Tensor> FusionKernelRuntime::runWithInputs(
 
   // Produce final global output
   std::vector<at::Tensor> fusion_outputs;
-  for (auto output : segmented_fusion_->outputs()) {
+  for (auto output : runtime_workspace_.fusion_outputs) {
     const auto iter = tensor_map.find(output);
     if (iter != tensor_map.end()) {
       // Note [ trivial forwarding ]
@@ -980,64 +1384,163 @@ std::vector<at::Tensor> FusionKernelRuntime::runWithInputs(
 }
 
 std::unordered_map<Val*, const ArgAbstract*> FusionKernelRuntime::
-    runSegmentsWithInputs(KernelArgumentHolder& args) {
+    runSegmentsWithInputs(
+        KernelArgumentHolder& args,
+        const LaunchConstraints* launch_constraints) {
+  const auto& fusion_inputs = runtime_workspace_.fusion_inputs;
   TORCH_INTERNAL_ASSERT(
-      args.size() == segmented_fusion_->inputs().size(),
+      args.size() == fusion_inputs.size(),
       "Inputs were not set up correctly, received ",
       args.size(),
       " inputs but expected ",
-      segmented_fusion_->inputs().size());
+      fusion_inputs.size());
 
-  ArgumentManager args_manager(
-      args, runtime_workspace_, segmented_fusion_->inputs());
+  ArgumentManager args_manager(args, runtime_workspace_, fusion_inputs);
 
   // group should share cache id.
   auto group_cache_id = args.getCacheId();
-  const int64_t num_groups = (int64_t)runtime_workspace_.group_run_order.size();
-  num_live_args_after_segment_runs_.reserve(num_groups);
-  for (auto group_id : c10::irange(num_groups)) {
-    // TODO: index mode should be updated per segmented kernel
-    // Prepare input vector
-    auto group_to_run = runtime_workspace_.group_run_order.at(group_id);
+  auto groupInputs = [&](SegmentedGroup* group) {
     KernelArgumentHolder group_runtime_inputs;
     group_runtime_inputs.setDeviceIndex(args.getDeviceIndex());
     if (group_cache_id.has_value()) {
       group_runtime_inputs.setCacheId(group_cache_id.value());
     }
-    for (auto input : group_to_run->inputs()) {
+    for (auto input : group->inputs()) {
       group_runtime_inputs.push(args_manager.checkTensorMap(input));
     }
+    return group_runtime_inputs;
+  };
+
+  // Packs are launched through the runtime, bypassing the per-segment
+  // profiling and timing of runKernelWithInput
+  const bool use_horizontal_packs = horizontal_fusion_ && is_segmented_ &&
+      !profiling_ && !measure_kernel_time_ &&
+      !isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose);
+  if (use_horizontal_packs &&
+      !horizontal_fusion_planned_.load(std::memory_order_acquire)) {
+    planHorizontalFusion();
+  }
+
+  const int64_t num_groups = (int64_t)runtime_workspace_.group_run_order.size();
+  // Segments of concurrent runs are launched in turn, so the number of
+  // arguments of this run is only recorded at the end
+  std::vector<int64_t> num_live_args;
+  num_live_args.reserve(num_groups);
+  for (int64_t group_id = 0; group_id < num_groups;) {
+    auto pack_it = horizontal_packs_.end();
+    if (use_horizontal_packs) {
+      pack_it = horizontal_packs_.find(group_id);
+    }
+    if (pack_it != horizontal_packs_.end()) {
+      auto& pack = pack_it->second;
+      // Inputs of all segments are gathered first, as arguments are
+      // erased once the segment that last uses them has run
+      std::vector<KernelArgumentHolder> pack_inputs;
+      std::vector<LaunchParams> pack_launch_params;
+      std::vector<CompileParams> pack_compile_params;
+      std::vector<std::vector<at::Tensor>> pack_outputs;
+      bool aligned = true;
+      for (auto group : pack.groups) {
+        pack_inputs.push_back(groupInputs(group));
+        auto [launch_params, compile_params] =
+            getKernelConfig(group, launch_constraints);
+        pack_launch_params.push_back(launch_params);
+        pack_compile_params.push_back(compile_params);
+        aligned = aligned &&
+            (!alignment_agnostic_ ||
+             executors_.at(group->groupId())
+                 .hasAlignedVectorizedTensors(pack_inputs.back()));
+      }
+      // Misaligned segments need their scalar fallback kernels
+      if (aligned) {
+        pack_outputs = pack.kernel->run(
+            pack_inputs, pack_launch_params, pack_compile_params);
+      }
+      if (aligned) {
+        for (auto i : c10::irange(pack.groups.size())) {
+          args_manager.updateWithSegmentOutputs(
+              pack.groups[i]->outputs(), pack_outputs[i], group_id);
+          num_live_args.push_back((int64_t)args.size());
+          group_id++;
+        }
+        continue;
+      }
+    }
+
+    // TODO: index mode should be updated per segmented kernel
+    // Prepare input vector
+    auto group_to_run = runtime_workspace_.group_run_order.at(group_id);
+    KernelArgumentHolder group_runtime_inputs = groupInputs(group_to_run);
 
     // TODO: currently we are still outputing PyTorch tensors, instead of
     // something abstract. This is quite unsatisfying.
 
     // Run graph segment
-    std::vector<at::Tensor> group_runtime_outputs =
-        runKernelWithInput(group_runtime_inputs, group_to_run);
+    std::vector<at::Tensor> group_runtime_outputs = runKernelWithInput(
+        group_runtime_inputs, group_to_run, launch_constraints);
     args_manager.updateWithSegmentOutputs(
         group_to_run->outputs(), group_runtime_outputs, group_id);
-    num_live_args_after_segment_runs_.push_back((int64_t)args.size());
+    num_live_args.push_back((int64_t)args.size());
+    group_id++;
   }
 
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    num_live_args_after_segment_runs_.insert(
+        num_live_args_after_segment_runs_.end(),
+        num_live_args.begin(),
+        num_live_args.end());
+  }
   return args_manager.getTensorMap();
 }
 
+void FusionKernelRuntime::planHorizontalFusion() {
+  FUSER_PERF_SCOPE("FusionKernelRuntime::planHorizontalFusion");
+  std::lock_guard<std::mutex> guard(mutex_);
+  // Another thread may have planned while this one waited for the lock
+  if (horizontal_fusion_planned_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  const auto& run_order = runtime_workspace_.group_run_order;
+  auto packs = planHorizontalPacks(run_order, [&](SegmentedGroup* group) {
+    const auto& executor = executors_.at(group->groupId());
+    return executor.compiled() &&
+        horizontalPackingBlocker(executor.kernel()).empty();
+  });
+
+  for (auto& groups : packs) {
+    const auto first_position = std::distance(
+        run_order.begin(),
+        std::find(run_order.begin(), run_order.end(), groups.front()));
+    std::vector<FusionExecutor*> pack_executors;
+    for (auto group : groups) {
+      pack_executors.push_back(&executors_.at(group->groupId()));
+    }
+    horizontal_packs_[first_position] = HorizontalPack{
+        std::move(groups),
+        std::make_unique<HorizontalKernel>(std::move(pack_executors))};
+  }
+  // Publish the packs to the threads reading them without the lock
+  horizontal_fusion_planned_.store(true, std::memory_order_release);
+}
+
 const std::vector<FusionKernelRuntime::SchedulerEntryPtr>& FusionKernelRuntime::
     schedulers() const {
   return heuristics_->heuristicsList();
 }
 
-void FusionKernelRuntime::updateHeuristicsLaunchParams(
-    FusionHeuristics* update_heuristics) {
-  FUSER_PERF_SCOPE("FusionKernelRuntime::updateHeuristicsLaunchParams");
+FusionKernelRuntime::LaunchConstraints FusionKernelRuntime::
+    getLaunchConstraints(const FusionHeuristics& update_heuristics) const {
+  FUSER_PERF_SCOPE("FusionKernelRuntime::getLaunchConstraints");
   auto scheduler_list_length = heuristics_->heuristicsList().size();
   TORCH_INTERNAL_ASSERT(
-      update_heuristics->heuristicsList().size() == scheduler_list_length);
-  for (const auto i : c10::irange(scheduler_list_length)) {
-    auto& schedulerPtr = heuristics_->heuristicsList()[i];
-    schedulerPtr->updateLaunchConstraint(
-        update_heuristics->heuristicsList()[i]->params()->lparams);
+      update_heuristics.heuristicsList().size() == scheduler_list_length);
+  LaunchConstraints launch_constraints;
+  launch_constraints.reserve(scheduler_list_length);
+  for (const auto& scheduler_entry : update_heuristics.heuristicsList()) {
+    launch_constraints.push_back(scheduler_entry->params()->lparams);
   }
+  return launch_constraints;
 }
 
 c10::optional<FusionKernelRuntime::HeuristicsPtr> FusionKernelRuntime::
@@ -1045,15 +1548,36 @@ c10::optional<FusionKernelRuntime::HeuristicsPtr> FusionKernelRuntime::
         const KernelArgumentHolder& args,
         std::optional<PrimDataType> forced_index_type) {
   FUSER_PERF_SCOPE("FusionKernelRuntime::getMaybeHeuristicsFor");
+  // The segments narrow the complete fusion to compute their heuristics, so
+  // it must not be copied meanwhile. Runs read the inputs and outputs of the
+  // fusion from runtime_workspace_ instead.
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  // A two-stage reduction serves the inputs for which the same number of
+  // chunks is chosen
+  std::optional<KernelArgumentHolder> split_args;
+  if (split_reduction_input_.has_value()) {
+    auto split_reduction_input =
+        SegmentCandidateFinder::getSplitReduction(unsplit_fusion_.get(), args);
+    if (split_reduction_input != split_reduction_input_) {
+      return c10::nullopt;
+    }
+    split_args = args;
+    reshapeSplitReductionInput(split_args.value());
+  }
+  const auto& fusion_args = split_args.has_value() ? split_args.value() : args;
+
   auto complete_fusion = segmented_fusion_->completeFusion();
-  precomputed_values_->bindInputs(args);
+  precomputed_values_->bindInputs(fusion_args);
   precomputed_values_->evaluate();
   SchedulerRuntimeInfo runtime_info(
       complete_fusion,
-      args,
+      fusion_args,
       precomputed_values_.get(),
       all_tvs_,
-      forced_index_type);
+      forced_index_type,
+      alignment_agnostic_,
+      &shape_buckets_);
 
   c10::optional<FusionKernelRuntime::HeuristicsPtr> ret;
   ret = std::make_unique<FusionHeuristics>();
@@ -12,12 +12,15 @@
 #include <executor.h>
 #include <fusion.h>
 #include <fusion_segmenter.h>
+#include <horizontal_fusion.h>
+#include <kernel_bundle.h>
 #include <scheduler/all_schedulers.h>
 #include <scheduler/registry.h>
 
 #include <c10/macros/Export.h>
 #include <c10/util/ArrayRef.h>
 
+#include <atomic>
 #include <mutex>
 #include <type_traits>
 #include <unordered_map>
@@ -40,6 +43,11 @@ struct RuntimeWorkSpace {
 
   //! Pre-determined order to bind tensor input meta data
   std::vector<Val*> group_extent_binding_order;
+
+  //! Inputs and outputs of the complete fusion. The complete fusion itself
+  //! is narrowed to single segments while their heuristics are computed.
+  std::vector<Val*> fusion_inputs;
+  std::vector<Val*> fusion_outputs;
 };
 //! Simple hasher for pair<T, U>. There is no default hasher for pairs, since
 //! there are a lot of options how to combine hashes. In a case where one
@@ -65,30 +73,46 @@ struct SimplePairHash {
 //!  single-kernel and multi-kernel caching/compiling/launching
 class TORCH_CUDA_CU_API FusionKernelRuntime {
  public:
+  //! If alignment_agnostic is true, heuristics assume that all inputs are
+  //! aligned, and segments are run with a scalar fallback kernel when their
+  //! inputs are not aligned for the vectorized accesses of the main kernel.
+  //! The fallback uses the same heuristics with vectorization replaced by
+  //! unrolling and is compiled the first time it is needed. This way the
+  //! runtime works for all alignments of its inputs.
+  //!
+  //! Heuristics are computed for input extents snapped to shape_buckets,
+  //! see ShapeBuckets.
   explicit FusionKernelRuntime(
       std::unique_ptr<Fusion> fusion,
       const KernelArgumentHolder& inputs,
-      std::optional<PrimDataType> forced_index_type = std::nullopt);
+      std::optional<PrimDataType> forced_index_type = std::nullopt,
+      bool alignment_agnostic = false,
+      ShapeBuckets shape_buckets = {});
 
   //! Type notations within FusionKernelRuntime Context
   using HashType = size_t;
   using SchedulerEntryPtr = std::unique_ptr<SchedulerEntry>;
+  //! Launch parameters of each segment, indexed by group id
+  using LaunchConstraints = std::vector<LaunchParams>;
 
   //! Evicts internally cached parameters based on input sizes.
   //!  An interface used by runtime caches.
   void evictCache(size_t input_id) {
+    // Scalar fallbacks are created concurrently
+    std::lock_guard<std::mutex> guard(mutex_);
     for (auto& fe : executors_) {
       fe.evictCache(input_id);
     }
+    for (auto& fallback : scalar_fallbacks_) {
+      if (fallback != nullptr) {
+        fallback->executor.evictCache(input_id);
+      }
+    }
   }
 
   //! query if we already have a compiled kernel for execution
-  bool isCompiled() {
-    std::lock_guard<std::mutex> guard(mutex_);
-    return std::all_of(
-        executors_.begin(), executors_.end(), [](const auto& executor) {
-          return executor.compiled();
-        });
+  bool isCompiled() const {
+    return compiled_.load(std::memory_order_acquire);
   }
 
   //! Note that all heuristics use the same index type.
@@ -103,11 +127,17 @@ class TORCH_CUDA_CU_API FusionKernelRuntime {
     return index_type.value();
   }
 
-  //! Unified interface to run the managed kernels with given input
-  std::vector<at::Tensor> runWithInputs(KernelArgumentHolder& args);
+  //! Unified interface to run the managed kernels with given input. The
+  //! segments are launched with launch_constraints if given, and with the
+  //! launch parameters of the heuristics of this runtime otherwise. Several
+  //! threads may run the runtime concurrently.
+  std::vector<at::Tensor> runWithInputs(
+      KernelArgumentHolder& args,
+      const LaunchConstraints* launch_constraints = nullptr);
 
   //! Compile a kernel executor for given inputs. Note: The compilation is
   //! multithreaded. The segments in the fusion are compiled independently.
+  //! Only the first call compiles, concurrent calls wait for it to finish.
   void compileFusionParallel(KernelArgumentHolder args);
 
   const std::vector<int64_t>& getArgsNumAfterSegmentRuns() {
@@ -135,6 +165,35 @@ class TORCH_CUDA_CU_API FusionKernelRuntime {
     for (auto& executor : executors_) {
       executor.setExecuteKernelFlag(false);
     }
+    // Packed kernels are launched by the runtime, not by the executors
+    horizontal_fusion_ = false;
+  }
+
+  //! Launch consecutive independent segments with a single kernel, see
+  //! HorizontalKernel. Segments are packed on the next run.
+  void enableHorizontalFusion(bool enabled = true) {
+    horizontal_fusion_ = enabled;
+  }
+
+  //! Collect the per-pass lowering statistics of the segments compiled from
+  //! now on
+  void collectLowerPassStats(bool collect = true) {
+    collect_lower_pass_stats_ = collect;
+    for (auto& executor : executors_) {
+      executor.setCollectLowerPassStats(collect);
+    }
+  }
+
+  //! Number of runs of packed segments with a single launch
+  int64_t numHorizontalLaunches() const {
+    int64_t num_launches = 0;
+    if (!horizontal_fusion_planned_.load(std::memory_order_acquire)) {
+      return num_launches;
+    }
+    for (const auto& it : horizontal_packs_) {
+      num_launches += it.second.kernel->numPackedLaunches();
+    }
+    return num_launches;
   }
 
   //! Returns if this runtime is segmented
@@ -159,6 +218,7 @@ class TORCH_CUDA_CU_API FusionKernelRuntime {
   ExecutorLog getMostRecentExecutorLog() {
     TORCH_INTERNAL_ASSERT(
         profiling_, "Executor log is only produced in profiling mode");
+    std::lock_guard<std::mutex> guard(mutex_);
     return most_recent_executor_log_;
   }
 
@@ -172,41 +232,88 @@ class TORCH_CUDA_CU_API FusionKernelRuntime {
       const KernelArgumentHolder& args,
       std::optional<PrimDataType> forced_index_type = std::nullopt);
 
-  //! Copy the launch params given in the parameter heuristics to prepare
-  //!  for kernel launch for a new input dimension but same heuristics
-  void updateHeuristicsLaunchParams(FusionHeuristics* update_heuristics);
+  //! The launch params given in the parameter heuristics, to launch the
+  //!  segments for a new input dimension but same heuristics. The
+  //!  heuristics of the runtime are not updated, as other threads may be
+  //!  running it, see runWithInputs.
+  LaunchConstraints getLaunchConstraints(
+      const FusionHeuristics& update_heuristics) const;
 
   const std::vector<FusionExecutor>& executors() const {
     return executors_;
   }
 
+  bool isAlignmentAgnostic() const {
+    return alignment_agnostic_;
+  }
+
+  //! Number of segment launches that used a scalar fallback kernel
+  int64_t numScalarFallbackLaunches() const {
+    return num_scalar_fallback_launches_.load(std::memory_order_relaxed);
+  }
+
+  //! Input read with split sizes if the fusion was rewritten into a
+  //! two-stage reduction, see SegmentCandidateFinder::splitReductionInFusion
+  const std::optional<SplitReductionInput>& splitReductionInput() const {
+    return split_reduction_input_;
+  }
+
  private:
   //! Runs each fusion segment given arguments. The outputs for a fusion are
   //! added back to the arguments, so they can be used as inputs to successive
   //! segments. Returns a map that links each NvFuser Val to its corresponding
   //! tensor.
   std::unordered_map<Val*, const ArgAbstract*> runSegmentsWithInputs(
-      KernelArgumentHolder& args);
+      KernelArgumentHolder& args,
+      const LaunchConstraints* launch_constraints);
 
   //! Interface to run a single kernel, either one kernel for single-kernel
   //! fusions, or a kernel for a segmentedGrouup in a segmented fusion. Returns
   //! the kernel outputs.
   std::vector<at::Tensor> runKernelWithInput(
       KernelArgumentHolder& args,
-      SegmentedGroup* sg);
+      SegmentedGroup* sg,
+      const LaunchConstraints* launch_constraints);
 
   //! Interface to compile a single kernel. It is either a single kernel for a
-  //! fusion or a kernel for a segmentedGrouup in a segmented fusion. Returns
-  //! launch and compile parameters for kernel.
-  void compileKernel(const KernelArgumentHolder& args, SegmentedGroup* sg);
+  //! fusion or a kernel for a segmentedGrouup in a segmented fusion.
+  //! fusion_to_run is the fusion made from the group, which is scheduled.
+  void compileKernel(
+      const KernelArgumentHolder& args,
+      SegmentedGroup* sg,
+      Fusion* fusion_to_run);
+
+  //! Compiles all segments, see compileFusionParallel
+  void compileSegments(KernelArgumentHolder& args);
 
   std::pair<LaunchParams, CompileParams> getKernelConfig(
+      SegmentedGroup* sg,
+      const LaunchConstraints* launch_constraints);
+
+  //! Kernel of a segment without vectorization, used for misaligned inputs
+  struct ScalarFallback {
+    std::unique_ptr<SchedulerEntry> scheduler_entry;
+    FusionExecutor executor;
+  };
+
+  //! Returns the scalar fallback of a segment. It is compiled on first use
+  //! without holding mutex_, and published with double-checked locking. If
+  //! several threads compile it at once, the first one to publish wins.
+  ScalarFallback& getScalarFallback(
       const KernelArgumentHolder& args,
       SegmentedGroup* sg);
 
   //! Access the list of schedulers maintained in this runtime instance
   const std::vector<SchedulerEntryPtr>& schedulers() const;
 
+  //! Reshapes the split reduction input in args to the sizes the complete
+  //! fusion reads it with
+  void reshapeSplitReductionInput(KernelArgumentHolder& args) const;
+
+  //! Plans the packs of segments launched with a single kernel. Segments
+  //! must be compiled. Only the first call plans.
+  void planHorizontalFusion();
+
   void prepareRuntimeOrder();
 
  private:
@@ -214,6 +321,40 @@ class TORCH_CUDA_CU_API FusionKernelRuntime {
   //! Executors holding compiled kernels
   std::vector<FusionExecutor> executors_;
 
+  //! Entries indexed by groupID, nullptr until a fallback is needed. Only
+  //! used by alignment-agnostic runtimes. Guarded by mutex_.
+  std::vector<std::unique_ptr<ScalarFallback>> scalar_fallbacks_;
+
+  //! Fallbacks of scalar_fallbacks_, published once compiled so that runs
+  //! look them up without the lock
+  std::vector<std::atomic<ScalarFallback*>> published_scalar_fallbacks_;
+
+  bool alignment_agnostic_ = false;
+  std::atomic<int64_t> num_scalar_fallback_launches_ = 0;
+
+  bool collect_lower_pass_stats_ = false;
+
+  ShapeBuckets shape_buckets_;
+
+  std::optional<SplitReductionInput> split_reduction_input_;
+  //! The fusion before it was rewritten for split_reduction_input_. Guarded
+  //! by mutex_.
+  std::unique_ptr<Fusion> unsplit_fusion_;
+
+  //! Segments launched with a single kernel
+  struct HorizontalPack {
+    std::vector<SegmentedGroup*> groups;
+    std::unique_ptr<HorizontalKernel> kernel;
+  };
+
+  bool horizontal_fusion_ = false;
+  //! Set once horizontal_packs_ is complete, which is immutable afterwards
+  std::atomic<bool> horizontal_fusion_planned_ = false;
+  //! Packs indexed by the position of their first segment in
+  //! runtime_workspace_.group_run_order. Only read once
+  //! horizontal_fusion_planned_ is set.
+  std::unordered_map<int64_t, HorizontalPack> horizontal_packs_;
+
   //! Heuristics object holding scheduler entries for all segments
   std::unique_ptr<FusionHeuristics> heuristics_;
 
@@ -242,9 +383,16 @@ class TORCH_CUDA_CU_API FusionKernelRuntime {
   bool profiling_ = false;
   bool measure_kernel_time_ = false;
 
+  //! Compiles the executors once, see compileFusionParallel
+  std::once_flag compile_once_;
+  std::atomic<bool> compiled_ = false;
+
+  //! Guards the creation of scalar fallbacks, the planning of horizontal
+  //! packs and the bookkeeping of runs. Kernels are launched without it.
   std::mutex mutex_;
 
-  // The heuristics and executor for most recent kernel launch
+  // The heuristics and executor for most recent kernel launch. Guarded by
+  // mutex_.
   ExecutorLog most_recent_executor_log_;
 };
 
@@ -299,9 +447,23 @@ class TORCH_CUDA_CU_API InputsIdLookup : public NonCopyable {
   //! However, if scalar_inputs_to_record is provided, then the values of scalar
   //! inputs at the integer locations specified in that argument will affect the
   //! returned ID.
+  //!
+  //! The alignment of the data pointers of input tensors is part of the id
+  //! unless encode_alignment is false, which is only valid for runtimes that
+  //! handle misaligned inputs (see FusionKernelRuntime).
   IdLookupReturn lookupId(
       const at::ArrayRef<c10::IValue>& inputs,
-      const std::unordered_set<size_t>& scalar_inputs_to_record = {});
+      const std::unordered_set<size_t>& scalar_inputs_to_record = {},
+      bool encode_alignment = true);
+
+  //! Same as above, but encodes the arguments already captured from the
+  //! inputs, so the inputs aren't walked again.  Encodings of IValues and of
+  //! arguments are not comparable, a lookup table should only be used with
+  //! one of them.
+  IdLookupReturn lookupId(
+      const KernelArgumentHolder& args,
+      const std::unordered_set<size_t>& scalar_inputs_to_record = {},
+      bool encode_alignment = true);
 
   //! debugging API that returns the size of lookup table
   size_t size() const {
@@ -309,6 +471,12 @@ class TORCH_CUDA_CU_API InputsIdLookup : public NonCopyable {
   }
 
  private:
+  //! Appends the sizes, strides, alignment and device of a tensor to encoding_
+  void encodeTensor(const at::Tensor& input_tensor, bool encode_alignment);
+
+  //! Looks up the id of encoding_, the caller must hold mutex_
+  IdLookupReturn lookupEncoding();
+
   // string to store encoded input meta information. Reuse the buffer instead of
   // stringtream gives few us perf gain.
   std::string encoding_; // Note: shared state, guarded by mutex_
@@ -431,6 +599,13 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
   //! fusion executor is taking the ownership of `fusion`
   explicit FusionExecutorCache(std::unique_ptr<Fusion> fusion);
 
+  //! Load kernels generated ahead of time by the kernel bundle builder, see
+  //! kernel_bundle.h. Any FusionExecutorCache that schedules a fusion like
+  //! the builder did then reuses the bundled kernel instead of compiling it.
+  //! The bundle given by PYTORCH_NVFUSER_KERNEL_BUNDLE is preloaded when the
+  //! first FusionExecutorCache is created.
+  static KernelBundleStats preloadKernelBundle(const std::string& bundle_dir);
+
   //! Execute fusion graph with given inputs, create `FusionExecutor` as needed
   //! Note this function also handles permutation & input update outside of
   //! codegen.
@@ -445,6 +620,21 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
       std::optional<PrimDataType> forced_index_type = std::nullopt,
       std::optional<int8_t> selected_device = std::nullopt);
 
+  //! Same as runFusionWithInputs, with the arguments already captured from
+  //! the inputs, which avoids walking the inputs again.  The device of the
+  //! arguments must be set.  Inputs that the fusion permutes are replaced in
+  //! args, and the cache id of args is set.
+  std::vector<at::Tensor> runFusionWithArgs(
+      KernelArgumentHolder& args,
+      std::optional<PrimDataType> forced_index_type = std::nullopt);
+
+  //! Compiles the kernels for the arguments without running them, e.g., to
+  //! generate kernels ahead of time.  The tensor arguments may be proxies
+  //! that hold no data, see KernelArgumentHolder::pushTensorProxy.
+  void compileFusionWithArgs(
+      KernelArgumentHolder& args,
+      std::optional<PrimDataType> forced_index_type = std::nullopt);
+
   //! Converts inputs from IValue to KernelArgumentHolder, also handles cache
   //! lookup
   KernelArgumentHolder prepareInputs(
@@ -491,6 +681,13 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
       const at::ArrayRef<c10::IValue>& inputs,
       bool tensor_transforms = false);
 
+  //! Gets the per-pass lowering statistics of all segments of the
+  //! associated runtime as a JSON array with one entry per segment, see
+  //! collectLowerPassStats
+  std::string getLowerPassStats(FusionKernelRuntime* kernel_runtime) const;
+  //! Get the lowering statistics of the most recently executed runtime
+  std::string getMostRecentLowerPassStats() const;
+
   // TODO: in a follow up we need a global logging structure
   //  to capture runtime profiling info. We also need to define
   //  a suitable profiling window / buffer size.
@@ -513,6 +710,69 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
     }
   }
 
+  //! Collect the per-pass lowering statistics of the kernels compiled from
+  //! now on, see getLowerPassStats. When the collection is turned on, the
+  //! runtimes compiled without it are dropped, so that the next runs lower
+  //! their segments again.
+  void collectLowerPassStats(bool collect);
+
+  //! Launch independent consecutive segments with a single kernel, see
+  //! HorizontalKernel. Defaults to the horizontal_fusion option of
+  //! PYTORCH_NVFUSER_ENABLE.
+  void setHorizontalFusion(bool horizontal_fusion) {
+    horizontal_fusion_ = horizontal_fusion;
+    for (auto& it : kernel_runtimes_) {
+      for (auto& kernel_runtime : it.second) {
+        kernel_runtime->enableHorizontalFusion(horizontal_fusion);
+      }
+    }
+  }
+
+  bool isHorizontalFusionEnabled() const {
+    return horizontal_fusion_;
+  }
+
+  //! Don't compile new kernels when only the alignment of the inputs
+  //! changes, see FusionKernelRuntime. Defaults to the alignment_agnostic
+  //! option of PYTORCH_NVFUSER_ENABLE. Must be set before the first run.
+  void setAlignmentAgnostic(bool alignment_agnostic) {
+    TORCH_CHECK(
+        kernel_runtimes_.empty(),
+        "Alignment-agnostic mode must be set before the first run");
+    alignment_agnostic_ = alignment_agnostic;
+  }
+
+  bool isAlignmentAgnostic() const {
+    return alignment_agnostic_;
+  }
+
+  //! Snap input extents to shape_buckets before computing heuristics, so
+  //! inputs whose extents fall in the same buckets reuse the same kernels.
+  //! Defaults to the shape_buckets option of PYTORCH_NVFUSER_ENABLE. Must be
+  //! set before the first run.
+  void setShapeBuckets(ShapeBuckets shape_buckets) {
+    TORCH_CHECK(
+        kernel_runtimes_.empty(),
+        "Shape buckets must be set before the first run");
+    shape_buckets_ = std::move(shape_buckets);
+  }
+
+  const ShapeBuckets& shapeBuckets() const {
+    return shape_buckets_;
+  }
+
+  //! How the inputs with new ids were served
+  struct RuntimeStats {
+    //! Runtimes created, each compiles kernels for all of its segments
+    int64_t runtimes_created = 0;
+    //! Inputs served by an existing runtime with the same heuristics
+    int64_t runtimes_reused = 0;
+  };
+
+  const RuntimeStats& runtimeStats() const {
+    return runtime_stats_;
+  }
+
   //! Internal knob for profiling shape inference
   void disableLaunchParamCache() {
     for (auto& it : kernel_runtimes_) {
@@ -536,12 +796,35 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
   //! entry in `FusionExecutor`
   void evictCache(size_t cache_id);
 
+  //! Looks up the cache id of the arguments, and evicts the runtime of the
+  //! evicted id. The caller must hold mutex_.
+  void setCacheId(KernelArgumentHolder& args);
+
+  //! Kernel runtime serving an input id
+  struct RuntimeEntry {
+    FusionKernelRuntime* runtime = nullptr;
+    //! Launch parameters of the segments for the inputs if they differ from
+    //! the heuristics of the runtime, see FusionKernelRuntime::runWithInputs
+    std::shared_ptr<const FusionKernelRuntime::LaunchConstraints>
+        launch_constraints;
+  };
+
+  //! Permutes the inputs, sets the cache id of args and returns the compiled
+  //! kernel runtime for them
+  RuntimeEntry getCompiledKernelRuntimeFor(
+      KernelArgumentHolder& args,
+      std::optional<PrimDataType> forced_index_type);
+
   //! The index type of forced_index_type is used to get a kernel
-  //! runtime no matter what sizes inputs have
-  FusionKernelRuntime* getKernelRuntimeFor(
+  //! runtime no matter what sizes inputs have. The caller must hold mutex_.
+  RuntimeEntry getKernelRuntimeFor(
       const KernelArgumentHolder& inputs,
       std::optional<PrimDataType> forced_index_type = std::nullopt);
 
+  //! Looks up the kernel runtime for inputs, without compiling it
+  FusionKernelRuntime* lookUpKernelRuntime(
+      const at::ArrayRef<c10::IValue>& inputs);
+
   //! Get initial concretization info (without inputs). This computes the info
   //! if it has not yet been computed, then caches it for later use. This means
   //! this method should not be called until the definition of the Fusion is
@@ -556,6 +839,17 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
   //! inputs to unique_id lookup table;
   InputsIdLookup inputs_id_lookup_;
 
+  //! See setAlignmentAgnostic
+  bool alignment_agnostic_ = isOptionEnabled(EnableOption::AlignmentAgnostic);
+
+  //! See setShapeBuckets
+  ShapeBuckets shape_buckets_ = ShapeBuckets::fromOptions();
+
+  //! See setHorizontalFusion
+  bool horizontal_fusion_ = isOptionEnabled(EnableOption::HorizontalFusion);
+
+  RuntimeStats runtime_stats_;
+
   //! Holds FusionKernelRuntime for scheduled, static Fusions. The key in this
   //! map is a (device, concretization info) pair. In case fusion_ contains
   //! no dynamic transforms, the second part of the key is null. When a new set
@@ -572,11 +866,18 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
   //! Logging state for most recent compilation
   bool profiling_ = false;
 
+  //! Whether new runtimes collect lowering pass statistics
+  bool collect_lower_pass_stats_ = false;
+
+  //! Runtimes dropped by collectLowerPassStats, which are kept alive for the
+  //! threads that may still be running them
+  std::vector<std::unique_ptr<FusionKernelRuntime>> dropped_runtimes_;
+
   //! Logging state for most recent compilation
   ExecutorLog most_recent_executor_log_;
 
   //! short-cut for cache hit
-  std::unordered_map<size_t, FusionKernelRuntime*> id_to_kernel_runtime_;
+  std::unordered_map<size_t, RuntimeEntry> id_to_kernel_runtime_;
 
   //! Profiling info:
   //! TODO: this can be largely expanded to look at complete
@@ -585,6 +886,12 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
 
   //! Initial concretization info
   std::optional<DynamicTransformInitialInfo> initial_info_ = std::nullopt;
+
+  //! Guards the lookup and creation of kernel runtimes, and
+  //! most_recent_runtime_. It is not held while runtimes compile or run:
+  //! runtimes compile once and can be run by several threads, see
+  //! FusionKernelRuntime::runWithInputs.
+  std::mutex mutex_;
 };
 
 //! [ Note -- 2 level cache implementation ]
@@ -622,7 +929,8 @@ class GraphCache {
   //! Fusion IR.
   explicit GraphCache(const std::shared_ptr<torch::jit::Graph>& graph);
 
-  //! execute graph with given inputs
+  //! execute graph with given inputs. Thread safe, as FusionExecutorCache
+  //! only serializes the compilation of its kernels.
   std::vector<at::Tensor> runGraphWithInputs(
       const at::ArrayRef<c10::IValue>& inputs);
 
@@ -13,8 +13,8 @@
 #include <manager.h>
 #include <parser.h>
 #include <scheduler/all_schedulers.h>
+#include <torch/csrc/jit/ir/node_hashing.h>
 #include <torch/csrc/jit/jit_log.h>
-#include <torch/csrc/jit/passes/canonicalize.h>
 #include <torch/csrc/jit/passes/cuda_graph_fuser.h>
 #include <torch/csrc/jit/passes/shape_analysis.h>
 #include <torch/csrc/jit/passes/symbolic_shape_analysis.h>
@@ -25,8 +25,13 @@
 
 #include <ATen/DimVector.h>
 #include <c10/core/DeviceType.h>
+#include <c10/util/hash.h>
 #include <c10/util/irange.h>
 
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <unordered_map>
 
 namespace nvfuser {
@@ -37,23 +42,42 @@ namespace nvfuser {
 //! node, including selection, construction and execution of FusionExecutors.
 //!
 //! CudaFusionManager bridges PyTorch IR node CudaFusionGroup to GraphCache.
-//! Therefore, we want to cache on stringified graph. But it is expensive to
-//! stringify and hash on a computational graph, we cache the hash of a
-//! stringified graph on node via cache_id.
+//! Therefore, we want to cache on the structure of the graph: node kinds,
+//! schemas, constants and the types of all values, which include the
+//! contiguity of tensors. Values are identified by their position in the
+//! graph, so debug names don't matter. As it is expensive to hash a
+//! computational graph, we cache the resulting id on node via cache_id.
 //!
 //! CudaFusionGroup node stores:
 //!     i.  a PyTorch IR in `attr::Subgraph`
 //!     ii. an int in `attr::cache_id`, (a cached hash value of
 //!     `attr::Subgraph`)
 //!
-//! We have 2 unordered_map at CudaFusionGroup:
-//!   std::unordered_map<std::string, int32_t> graph_cache_ids_;
-//!   std::unordered_map<int64_t, std::unique_ptr<GraphCache>> graph_cache_;
+//! We have 3 unordered_map at CudaFusionManager:
+//!   std::unordered_map<size_t, std::vector<RegisteredGraph>>
+//!       graph_cache_ids_;
+//!   std::unordered_map<const torch::jit::Graph*, MemoizedGraph>
+//!       memoized_graphs_;
+//!   std::unordered_map<int64_t, std::shared_ptr<GraphCache>> graph_cache_;
 //!
-//! Mapping from std::string to graph_cache_id ensures that we assign the same
-//! cache_id to CudaFusionGroup with identical computational grah, allowing
-//! kernel reuse; Direct mapping from cache_id to GraphCache allows efficient
+//! Mapping from the structural hash to graph_cache_id ensures that we assign
+//! the same cache_id to CudaFusionGroup with identical computational grah,
+//! allowing kernel reuse. Graphs with the same hash are compared structurally
+//! to rule out collisions. The subgraphs of fusion nodes compiled before map
+//! directly to their cache_id, as copies of a fusion node share its
+//! subgraph. Direct mapping from cache_id to GraphCache allows efficient
 //! graph_cache indexing;
+//!
+//! [ Note -- CudaFusionManager concurrency ]
+//!
+//! The maps are read far more often than they are written, so they are
+//! guarded by a shared mutex which is only held while looking up or inserting
+//! entries. Running a fusion only holds a reference to its GraphCache. Its
+//! FusionExecutorCache only locks to look up or create the kernel runtime
+//! for the inputs. Each runtime compiles once, which only blocks the runs
+//! that need that runtime, and compiled runtimes are run without locks. Runs
+//! of the same fusion group, with the same or other shapes, proceed
+//! concurrently.
 
 namespace {
 
@@ -89,6 +113,178 @@ void enableAliasCopyNodes(
   }
 }
 
+size_t hashType(const c10::TypePtr& type) {
+  size_t hash = std::hash<int>()((int)type->kind());
+  if (auto tensor_type = type->cast<c10::TensorType>()) {
+    auto scalar_type = tensor_type->scalarType();
+    auto dim = tensor_type->dim();
+    hash = c10::hash_combine(
+        hash, scalar_type.has_value() ? (size_t)*scalar_type + 1 : 0);
+    hash = c10::hash_combine(hash, dim.has_value() ? *dim + 1 : 0);
+  }
+  return hash;
+}
+
+// Values are numbered in the order they are defined
+size_t hashBlock(
+    const torch::jit::Block* block,
+    std::unordered_map<const torch::jit::Value*, size_t>& value_ids) {
+  auto define = [&](const torch::jit::Value* value) {
+    value_ids.emplace(value, value_ids.size());
+  };
+  size_t hash = block->inputs().size();
+  for (auto input : block->inputs()) {
+    define(input);
+    hash = c10::hash_combine(hash, hashType(input->type()));
+  }
+  for (auto node : block->nodes()) {
+    hash = c10::hash_combine(hash, (size_t)(c10::unique_t)node->kind());
+    if (node->kind() == at::prim::Constant) {
+      hash = c10::hash_combine(hash, torch::jit::HashNode()(node));
+    }
+    for (auto input : node->inputs()) {
+      hash = c10::hash_combine(hash, value_ids.at(input));
+    }
+    for (auto node_block : node->blocks()) {
+      hash = c10::hash_combine(hash, hashBlock(node_block, value_ids));
+    }
+    for (auto output : node->outputs()) {
+      define(output);
+      hash = c10::hash_combine(hash, hashType(output->type()));
+    }
+  }
+  for (auto output : block->outputs()) {
+    hash = c10::hash_combine(hash, value_ids.at(output));
+  }
+  return hash;
+}
+
+//! Structural hash of a graph, see Note [ cache entry indexing ]
+size_t hashGraph(const torch::jit::Graph& graph) {
+  std::unordered_map<const torch::jit::Value*, size_t> value_ids;
+  return hashBlock(graph.block(), value_ids);
+}
+
+// Attributes other than numbers and strings are conservatively considered
+// different
+bool sameAttributes(const torch::jit::Node* a, const torch::jit::Node* b) {
+  if (a->kind() == at::prim::Constant) {
+    return torch::jit::EqualNode()(a, b);
+  }
+  const auto names = a->attributeNames();
+  if (names != b->attributeNames()) {
+    return false;
+  }
+  for (auto name : names) {
+    if (a->kindOf(name) != b->kindOf(name)) {
+      return false;
+    }
+    switch (a->kindOf(name)) {
+      case torch::jit::AttributeKind::i:
+        if (a->i(name) != b->i(name)) {
+          return false;
+        }
+        break;
+      case torch::jit::AttributeKind::f:
+        if (a->f(name) != b->f(name)) {
+          return false;
+        }
+        break;
+      case torch::jit::AttributeKind::s:
+        if (a->s(name) != b->s(name)) {
+          return false;
+        }
+        break;
+      case torch::jit::AttributeKind::is:
+        if (a->is(name) != b->is(name)) {
+          return false;
+        }
+        break;
+      case torch::jit::AttributeKind::fs:
+        if (a->fs(name) != b->fs(name)) {
+          return false;
+        }
+        break;
+      case torch::jit::AttributeKind::ss:
+        if (a->ss(name) != b->ss(name)) {
+          return false;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+bool sameBlock(
+    const torch::jit::Block* a,
+    const torch::jit::Block* b,
+    std::unordered_map<const torch::jit::Value*, const torch::jit::Value*>&
+        a_to_b) {
+  auto same_values = [&](const auto& a_values, const auto& b_values) {
+    if (a_values.size() != b_values.size()) {
+      return false;
+    }
+    for (auto i : c10::irange(a_values.size())) {
+      auto it = a_to_b.find(a_values[i]);
+      if (it == a_to_b.end() || it->second != b_values[i]) {
+        return false;
+      }
+    }
+    return true;
+  };
+  auto define = [&](const auto& a_values, const auto& b_values) {
+    if (a_values.size() != b_values.size()) {
+      return false;
+    }
+    for (auto i : c10::irange(a_values.size())) {
+      if (!(*a_values[i]->type() == *b_values[i]->type())) {
+        return false;
+      }
+      a_to_b.emplace(a_values[i], b_values[i]);
+    }
+    return true;
+  };
+
+  if (!define(a->inputs(), b->inputs())) {
+    return false;
+  }
+  auto a_it = a->nodes().begin();
+  auto b_it = b->nodes().begin();
+  for (; a_it != a->nodes().end() && b_it != b->nodes().end();
+       ++a_it, ++b_it) {
+    auto a_node = *a_it;
+    auto b_node = *b_it;
+    if (a_node->kind() != b_node->kind() ||
+        !same_values(a_node->inputs(), b_node->inputs()) ||
+        a_node->maybeSchema() != b_node->maybeSchema() ||
+        a_node->blocks().size() != b_node->blocks().size()) {
+      return false;
+    }
+    if ((a_node->hasAttributes() || b_node->hasAttributes()) &&
+        !sameAttributes(a_node, b_node)) {
+      return false;
+    }
+    for (auto i : c10::irange(a_node->blocks().size())) {
+      if (!sameBlock(a_node->blocks()[i], b_node->blocks()[i], a_to_b)) {
+        return false;
+      }
+    }
+    if (!define(a_node->outputs(), b_node->outputs())) {
+      return false;
+    }
+  }
+  return a_it == a->nodes().end() && b_it == b->nodes().end() &&
+      same_values(a->outputs(), b->outputs());
+}
+
+//! Structural equality of graphs, consistent with hashGraph
+bool sameGraph(const torch::jit::Graph& a, const torch::jit::Graph& b) {
+  std::unordered_map<const torch::jit::Value*, const torch::jit::Value*> a_to_b;
+  return sameBlock(a.block(), b.block(), a_to_b);
+}
+
 static std::unique_ptr<torch::jit::Code> createFallbackCode(
     const torch::jit::Node* fusion_node) {
   auto copied_graph = fusion_node->g(at::attr::Subgraph)->copy();
@@ -99,9 +295,7 @@ static std::unique_ptr<torch::jit::Code> createFallbackCode(
   return code;
 }
 
-// CudaFusionManager is not thread safe!
-// TODO: we should make the tradeoff here to use thread_local instead of global
-// singleton;
+// See Note [ CudaFusionManager concurrency ]
 // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
 class CudaFusionManager {
  public:
@@ -110,60 +304,115 @@ class CudaFusionManager {
     return cuda_fusion_manager_;
   };
 
-  // TODO: I'm assuming we have stride information in `graph->toString`
-  //       We need to make sure stride information is in the final string, as we
-  //       want to AVOID kernel reuse between different fusion_node, unless they
-  //       have identical contiguity information! (So identical stride + shape
-  //       is even more restricting in a good way)
-  int32_t registerOrGetCacheId(std::shared_ptr<torch::jit::Graph>& graph) {
+  // Types of values include stride information. We want to AVOID kernel
+  // reuse between different fusion_node, unless they have identical
+  // contiguity information! (So identical stride + shape is even more
+  // restricting in a good way)
+  //
+  // graph is the prepared copy of subgraph, the subgraph of the fusion node.
+  // Subgraphs are assumed not to be modified once they are registered.
+  int32_t registerOrGetCacheId(
+      std::shared_ptr<torch::jit::Graph>& graph,
+      const std::shared_ptr<torch::jit::Graph>& subgraph) {
     // prepare graph for lowering;
     // We should not call `EraseShapeInformation(graph);`, graph representation
     // does not incorporate static sizes, but just rank of input tensors, which
     // is exactly what we wanted.
-    auto canonical_graph = Canonicalize(graph, false);
-    auto repr = canonical_graph->toString(false);
+    const auto hash = hashGraph(*graph);
+    std::optional<int32_t> kernel_id;
+    {
+      std::shared_lock<std::shared_mutex> guard(mutex_);
+      kernel_id = findCacheId(hash, *graph);
+    }
 
-    std::lock_guard<std::mutex> guard(mutex_);
+    // Translating the graph doesn't need the lock. If another thread
+    // registers the same graph meanwhile, its entry is kept.
+    std::shared_ptr<GraphCache> graph_cache;
+    if (!kernel_id.has_value()) {
+      graph_cache = std::make_shared<GraphCache>(graph);
+    }
+
+    std::unique_lock<std::shared_mutex> guard(mutex_);
+    if (!kernel_id.has_value()) {
+      kernel_id = findCacheId(hash, *graph);
+    }
     // create new graph_cache_ids_ entry if none existed yet;
-    if (graph_cache_ids_.count(repr) == 0) {
-      int32_t kernel_id = getNextUniqueID();
-      graph_cache_ids_[repr] = kernel_id;
+    if (!kernel_id.has_value()) {
+      kernel_id = getNextUniqueID();
       TORCH_CHECK(
-          graph_cache_.emplace(kernel_id, std::make_unique<GraphCache>(graph))
-              .second);
+          graph_cache_.emplace(*kernel_id, std::move(graph_cache)).second);
+      graph_cache_ids_[hash].push_back({graph->copy(), *kernel_id});
     }
-    return graph_cache_ids_[repr];
+    memoize(subgraph, *kernel_id);
+    return *kernel_id;
   };
 
+  // Cache id of a fusion node whose subgraph was registered before
+  std::optional<int32_t> memoizedCacheId(
+      const std::shared_ptr<torch::jit::Graph>& subgraph) {
+    std::shared_lock<std::shared_mutex> guard(mutex_);
+    auto it = memoized_graphs_.find(subgraph.get());
+    if (it != memoized_graphs_.end() && it->second.graph.lock() == subgraph) {
+      return it->second.kernel_id;
+    }
+    return std::nullopt;
+  }
+
   // get fallback kernel id
   int32_t getFallbackKernelId() {
-    std::lock_guard<std::mutex> guard(mutex_);
+    std::unique_lock<std::shared_mutex> guard(mutex_);
     return getNextUniqueID();
   }
 
   void unregisterCacheId(std::shared_ptr<torch::jit::Graph>& graph) {
-    auto canonical_graph = Canonicalize(graph, false);
-    auto repr = canonical_graph->toString(false);
+    const auto hash = hashGraph(*graph);
 
-    // create new graph_cache_ids_ entry if none existed yet;
-    if (graph_cache_ids_.count(repr) > 0) {
-      int32_t kernel_id = graph_cache_ids_[repr];
-      graph_cache_.erase(kernel_id);
-      graph_cache_ids_.erase(repr);
+    std::unique_lock<std::shared_mutex> guard(mutex_);
+    auto it = graph_cache_ids_.find(hash);
+    if (it == graph_cache_ids_.end()) {
+      return;
+    }
+    auto& registered = it->second;
+    auto entry = std::find_if(
+        registered.begin(), registered.end(), [&](const auto& entry) {
+          return sameGraph(*entry.graph, *graph);
+        });
+    if (entry == registered.end()) {
+      return;
+    }
+    const auto kernel_id = entry->kernel_id;
+    // Runs in flight keep their own reference to the GraphCache
+    graph_cache_.erase(kernel_id);
+    registered.erase(entry);
+    if (registered.empty()) {
+      graph_cache_ids_.erase(it);
+    }
+    for (auto memo_it = memoized_graphs_.begin();
+         memo_it != memoized_graphs_.end();) {
+      if (memo_it->second.kernel_id == kernel_id) {
+        memo_it = memoized_graphs_.erase(memo_it);
+      } else {
+        ++memo_it;
+      }
     }
   }
 
   std::vector<at::Tensor> runFusionNode(
       int32_t kernel_id,
       const at::ArrayRef<c10::IValue> inputs) {
-    std::lock_guard<std::mutex> guard(mutex_);
-    TORCH_INTERNAL_ASSERT(
-        graph_cache_.count(kernel_id) > 0, "graph cache miss at run time");
-    return graph_cache_[kernel_id]->runGraphWithInputs(inputs);
+    std::shared_ptr<GraphCache> graph_cache;
+    {
+      std::shared_lock<std::shared_mutex> guard(mutex_);
+      auto it = graph_cache_.find(kernel_id);
+      TORCH_INTERNAL_ASSERT(
+          it != graph_cache_.end(), "graph cache miss at run time");
+      graph_cache = it->second;
+    }
+    return graph_cache->runGraphWithInputs(inputs);
   }
 
   bool hasFallbackCode(int32_t kernel_id) {
-    std::lock_guard<std::mutex> guard(mutex_);
+    std::shared_lock<std::shared_mutex> guard(mutex_);
     return fallback_cache_.count(kernel_id);
   }
 
@@ -171,7 +420,7 @@ class CudaFusionManager {
       int32_t kernel_id,
       const torch::jit::Node* fusion_node) {
     {
-      std::lock_guard<std::mutex> guard(mutex_);
+      std::shared_lock<std::shared_mutex> guard(mutex_);
       auto it = fallback_cache_.find(kernel_id);
       if (it != fallback_cache_.end()) {
         return it->second.get();
@@ -180,7 +429,7 @@ class CudaFusionManager {
 
     std::unique_ptr<torch::jit::Code> code = createFallbackCode(fusion_node);
 
-    std::lock_guard<std::mutex> guard(mutex_);
+    std::unique_lock<std::shared_mutex> guard(mutex_);
     auto it = fallback_cache_.insert({kernel_id, std::move(code)}).first;
     return it->second.get();
   }
@@ -200,7 +449,8 @@ class CudaFusionManager {
   }
 
  private:
-  std::mutex mutex_;
+  // Guards the maps below, but not the GraphCaches themselves
+  std::shared_mutex mutex_;
 
   void runCudaKernel(
       int32_t key,
@@ -211,8 +461,57 @@ class CudaFusionManager {
     return next_unique_id_++;
   };
 
-  std::unordered_map<std::string, int32_t> graph_cache_ids_;
-  std::unordered_map<int64_t, std::unique_ptr<GraphCache>> graph_cache_;
+  // Needs mutex_ to be held
+  std::optional<int32_t> findCacheId(
+      size_t hash,
+      const torch::jit::Graph& graph) const {
+    auto it = graph_cache_ids_.find(hash);
+    if (it == graph_cache_ids_.end()) {
+      return std::nullopt;
+    }
+    for (const auto& entry : it->second) {
+      if (sameGraph(*entry.graph, graph)) {
+        return entry.kernel_id;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Needs mutex_ to be held exclusively
+  void memoize(
+      const std::shared_ptr<torch::jit::Graph>& subgraph,
+      int32_t id) {
+    // Entries of graphs that don't exist anymore are dropped every time the
+    // number of entries doubles
+    if (memoized_graphs_.size() >= 2 * num_live_memoized_graphs_) {
+      for (auto it = memoized_graphs_.begin(); it != memoized_graphs_.end();) {
+        if (it->second.graph.expired()) {
+          it = memoized_graphs_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      num_live_memoized_graphs_ = std::max<size_t>(memoized_graphs_.size(), 1);
+    }
+    memoized_graphs_[subgraph.get()] = {subgraph, id};
+  }
+
+  struct RegisteredGraph {
+    // Copy of the registered graph, to tell apart graphs with the same hash
+    std::shared_ptr<torch::jit::Graph> graph;
+    int32_t kernel_id;
+  };
+  std::unordered_map<size_t, std::vector<RegisteredGraph>> graph_cache_ids_;
+
+  // Keyed on the subgraph of the fusion node, before it is copied and
+  // prepared for registration
+  struct MemoizedGraph {
+    std::weak_ptr<torch::jit::Graph> graph;
+    int32_t kernel_id;
+  };
+  std::unordered_map<const torch::jit::Graph*, MemoizedGraph> memoized_graphs_;
+  size_t num_live_memoized_graphs_ = 1;
+  std::unordered_map<int64_t, std::shared_ptr<GraphCache>> graph_cache_;
   std::unordered_map<int64_t, std::unique_ptr<torch::jit::Code>>
       fallback_cache_;
 
@@ -230,8 +529,16 @@ void compileCudaFusionGroup(torch::jit::Node* fusion_node) {
   if (fusion_node->hasAttribute(at::attr::cache_id)) {
     TORCH_WARN("Double registration of CudaFusionGroup on CudaFusionManager");
   }
+  const auto& subgraph = fusion_node->g(at::attr::Subgraph);
+  // Copies of a compiled fusion node share its subgraph
+  if (auto kernel_id =
+          CudaFusionManager::getManager().memoizedCacheId(subgraph)) {
+    fusion_node->i_(at::attr::cache_id, *kernel_id);
+    return;
+  }
+
   // This is not a critical code path, it's OK to do graph copy here;
-  auto graph = fusion_node->g(at::attr::Subgraph)->copy();
+  auto graph = subgraph->copy();
 
   auto compile_fusion = [&]() {
     // type propagation is needed, as the protocol only requires scalar type on
@@ -243,7 +550,7 @@ void compileCudaFusionGroup(torch::jit::Node* fusion_node) {
     TypePropagate(graph);
 
     int32_t fusion_cache_id =
-        CudaFusionManager::getManager().registerOrGetCacheId(graph);
+        CudaFusionManager::getManager().registerOrGetCacheId(graph, subgraph);
     fusion_node->i_(at::attr::cache_id, fusion_cache_id);
   };
 
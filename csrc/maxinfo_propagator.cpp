@@ -5,8 +5,14 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 // clang-format on
+#include <fusion.h>
 #include <maxinfo_propagator.h>
 #include <root_domain_map.h>
+#include <utils.h>
+
+#include <algorithm>
+#include <any>
+#include <memory>
 
 namespace nvfuser {
 
@@ -227,6 +233,77 @@ std::unordered_set<IterDomain*> mapRFactorToRoot(
 
 } // namespace
 
+// Spanning tree paths and root domain maps computed on a fusion. Both only
+// depend on the TensorView graph and on the root and rfactor domains of the
+// tensors, which are not changed by scheduling transformations, so schedulers
+// propagating from the same reference several times only compute them once.
+// Everything is dropped when the TensorView graph of the fusion changes.
+struct MaxRootDomainInfoSpanningTree::Cache {
+  int64_t tv_graph_version = -1;
+
+  // Paths computed without a selector, for each reference tensor and
+  // reference info
+  std::unordered_map<
+      TensorView*,
+      std::vector<std::pair<std::vector<RootIDInfo>, std::vector<NextHop>>>>
+      paths;
+
+  // Producer to consumer and consumer to producer root domain maps
+  std::unordered_map<
+      TensorView*,
+      std::unordered_map<
+          TensorView*,
+          std::unordered_map<IterDomain*, IterDomain*>>>
+      p2c_maps;
+  std::unordered_map<
+      TensorView*,
+      std::unordered_map<
+          TensorView*,
+          std::unordered_map<IterDomain*, IterDomain*>>>
+      c2p_maps;
+
+  static Cache* get(Fusion* fusion) {
+    if (fusion == nullptr ||
+        isOptionDisabled(DisableOption::SpanningTreeCache)) {
+      return nullptr;
+    }
+    static const std::string key = "max_root_domain_info_spanning_tree_cache";
+    if (!fusion->hasManaged(key)) {
+      // Cached paths refer to the tensors of this fusion, so copies start
+      // with an empty cache
+      fusion->manage(
+          key,
+          std::make_shared<Cache>(),
+          [](IrCloner&, std::any) -> std::any {
+            return std::make_shared<Cache>();
+          });
+    }
+    auto cache = fusion->getManaged<std::shared_ptr<Cache>>(key).get();
+    if (cache->tv_graph_version != fusion->tvGraphVersion()) {
+      cache->paths.clear();
+      cache->p2c_maps.clear();
+      cache->c2p_maps.clear();
+      cache->tv_graph_version = fusion->tvGraphVersion();
+    }
+    return cache;
+  }
+
+  static bool sameInfo(
+      const std::vector<RootIDInfo>& l,
+      const std::vector<RootIDInfo>& r) {
+    return std::equal(
+        l.begin(),
+        l.end(),
+        r.begin(),
+        r.end(),
+        [](const RootIDInfo& l_info, const RootIDInfo& r_info) {
+          return l_info.mapped_ids == r_info.mapped_ids &&
+              l_info.is_complete == r_info.is_complete &&
+              l_info.is_rfactor == r_info.is_rfactor;
+        });
+  }
+};
+
 // Given the preserved reference root ID info of a producer, compute
 // the corresponding info in consumer. The given info may be represented by
 // producer's root domain, or rfactor domain, depending on how we reached the
@@ -248,9 +325,15 @@ std::shared_ptr<MaxInfoSpanningTree::Information> MaxRootDomainInfoSpanningTree:
   const auto& producer_root_id_info =
       std::dynamic_pointer_cast<RootDomainInfo>(from_info)->info;
 
-  auto pairwise_map = PairwiseRootDomainMap(producer, consumer);
-  auto p2c_map = pairwise_map.mapProducerToConsumer(
-      producer->domain(), consumer->domain());
+  auto cache = Cache::get(producer->fusion());
+  std::unordered_map<IterDomain*, IterDomain*> uncached_p2c_map;
+  auto& p2c_map = cache == nullptr ? uncached_p2c_map
+                                   : cache->p2c_maps[producer][consumer];
+  if (cache == nullptr || p2c_map.empty()) {
+    p2c_map = PairwiseRootDomainMap(producer, consumer)
+                  .mapProducerToConsumer(
+                      producer->domain(), consumer->domain());
+  }
 
   for (auto& info : producer_root_id_info) {
     RootIDInfo consumer_info;
@@ -305,9 +388,15 @@ std::shared_ptr<MaxInfoSpanningTree::Information> MaxRootDomainInfoSpanningTree:
   const auto& consumer_root_id_info =
       std::dynamic_pointer_cast<RootDomainInfo>(from_info)->info;
 
-  auto pairwise_map = PairwiseRootDomainMap(producer, consumer);
-  auto c2p_map = pairwise_map.mapConsumerToProducer(
-      consumer->domain(), producer->domain());
+  auto cache = Cache::get(producer->fusion());
+  std::unordered_map<IterDomain*, IterDomain*> uncached_c2p_map;
+  auto& c2p_map = cache == nullptr ? uncached_c2p_map
+                                   : cache->c2p_maps[consumer][producer];
+  if (cache == nullptr || c2p_map.empty()) {
+    c2p_map = PairwiseRootDomainMap(producer, consumer)
+                  .mapConsumerToProducer(
+                      consumer->domain(), producer->domain());
+  }
 
   for (auto& info : consumer_root_id_info) {
     RootIDInfo producer_info;
@@ -361,6 +450,27 @@ std::shared_ptr<MaxInfoSpanningTree::Information> MaxRootDomainInfoSpanningTree:
   return std::make_shared<RootDomainInfo>(std::move(result));
 }
 
+void MaxRootDomainInfoSpanningTree::compute_spanning_tree() {
+  // Selectors are stateful, so only paths over the whole graph are cached
+  auto cache =
+      selector_ == nullptr ? Cache::get(reference_->fusion()) : nullptr;
+  if (cache == nullptr) {
+    MaxInfoSpanningTree::compute_spanning_tree();
+    return;
+  }
+  const auto& reference_info =
+      std::dynamic_pointer_cast<RootDomainInfo>(reference_info_)->info;
+  auto& paths = cache->paths[reference_];
+  for (const auto& [info, path] : paths) {
+    if (Cache::sameInfo(info, reference_info)) {
+      path_ = path;
+      return;
+    }
+  }
+  MaxInfoSpanningTree::compute_spanning_tree();
+  paths.emplace_back(reference_info, path_);
+}
+
 std::shared_ptr<MaxRootDomainInfoSpanningTree::RootDomainInfo>
 MaxRootDomainInfoSpanningTree::getReferenceRootIDInfo(TensorView* tv) {
   RootDomainInfo result;
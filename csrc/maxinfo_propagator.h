@@ -80,7 +80,7 @@ class TORCH_CUDA_CU_API MaxInfoSpanningTree {
     virtual ~Information() = default;
   };
 
- private:
+ protected:
   enum class NextHopType {
     SIBLING,
     C_AS_P,
@@ -124,9 +124,8 @@ class TORCH_CUDA_CU_API MaxInfoSpanningTree {
   std::vector<NextHop> path_;
   Selector* selector_;
 
-  void compute_spanning_tree();
+  virtual void compute_spanning_tree();
 
- protected:
   virtual std::shared_ptr<Information> computeInfoC2P(
       TensorView* from,
       TensorView* to,
@@ -226,7 +225,15 @@ class TORCH_CUDA_CU_API MaxRootDomainInfoSpanningTree
       TensorView* to,
       std::shared_ptr<Information> from_info) override;
 
+  // Reuses the path computed for the same reference and reference info, if
+  // the TensorView graph has not changed since then.
+  void compute_spanning_tree() override;
+
  private:
+  // Paths and root domain maps computed on a fusion, see
+  // maxinfo_propagator.cpp
+  struct Cache;
+
   static std::shared_ptr<RootDomainInfo> getReferenceRootIDInfo(TensorView* tv);
   static std::shared_ptr<RootDomainInfo> getReferenceRootIDInfo(
       TensorView* tv,
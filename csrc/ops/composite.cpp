@@ -5,7 +5,7 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 // clang-format on
-#include <ATen/cuda/CUDAContext.h>
+#include <device_profile.h>
 #include <ir/builder.h>
 #include <ops/all_ops.h>
 #include <transform_view.h>
@@ -56,9 +56,8 @@ TensorView* dropout_backward(TensorView* dy, TensorView* mask, Val* scale) {
 TensorView* _matmul_nn(TensorView* a, TensorView* b) {
   TORCH_CHECK(
       a->nDims() == 2 && b->nDims() == 2, "Only 2-D Tensors are supported!");
-  const auto device_prop = at::cuda::getCurrentDeviceProperties();
   TORCH_CHECK(
-      device_prop->major == 8,
+      currentDeviceProfile()->major == 8,
       "Only the Ampere MMA Op is currently supported!");
   auto tv0t = transpose(a, 0, 1);
   auto tv0b = broadcast(tv0t, {false, true, false});
@@ -69,9 +68,8 @@ TensorView* _matmul_nn(TensorView* a, TensorView* b) {
 TensorView* _matmul_nt(TensorView* a, TensorView* b) {
   TORCH_CHECK(
       a->nDims() == 2 && b->nDims() == 2, "Only 2-D Tensors are supported!");
-  const auto device_prop = at::cuda::getCurrentDeviceProperties();
   TORCH_CHECK(
-      device_prop->major == 8,
+      currentDeviceProfile()->major == 8,
       "Only the Ampere MMA Op is currently supported!");
   auto tv0t = transpose(a, 0, 1);
   auto tv1t = transpose(b, 0, 1);
@@ -83,9 +81,8 @@ TensorView* _matmul_nt(TensorView* a, TensorView* b) {
 TensorView* _matmul_tn(TensorView* a, TensorView* b) {
   TORCH_CHECK(
       a->nDims() == 2 && b->nDims() == 2, "Only 2-D Tensors are supported!");
-  const auto device_prop = at::cuda::getCurrentDeviceProperties();
   TORCH_CHECK(
-      device_prop->major == 8,
+      currentDeviceProfile()->major == 8,
       "Only the Ampere MMA Op is currently supported!");
   auto tv0b = broadcast(a, {false, true, false});
   auto tv1b = broadcast(b, {true, false, false});
@@ -95,9 +92,8 @@ TensorView* _matmul_tn(TensorView* a, TensorView* b) {
 TensorView* _matmul_tt(TensorView* a, TensorView* b) {
   TORCH_CHECK(
       a->nDims() == 2 && b->nDims() == 2, "Only 2-D Tensors are supported!");
-  const auto device_prop = at::cuda::getCurrentDeviceProperties();
   TORCH_CHECK(
-      device_prop->major == 8,
+      currentDeviceProfile()->major == 8,
       "Only the Ampere MMA Op is currently supported!");
   auto tv1t = transpose(b, 0, 1);
   auto tv0b = broadcast(a, {false, true, false});
@@ -18,12 +18,15 @@
 
 #include <torch/csrc/jit/frontend/function_schema_parser.h>
 #include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/runtime/operator.h>
 
 #include <ATen/native/Activation.h>
 
 #include <c10/util/CallOnce.h>
 
+#include <atomic>
 #include <complex>
+#include <memory>
 #include <unordered_map>
 #include <utility>
 
@@ -805,57 +808,79 @@ class IrParser {
     return fusion;
   }
 
+  // Note [ Parser registry concurrency ]
+  //
+  // `parser_symbol_set_` and `jit_operator_registry_` are only written by
+  // `initRegistry`, so lookups after initialization don't need any lock.
+  // `parser_skip_set_` and `cached_registry_lookup_` are immutable snapshots
+  // which are replaced by an updated copy, under `parser_mutex_`, in the rare
+  // cases they change. Readers load the current snapshot atomically.
+  // Schemas missing from the snapshot of `cached_registry_lookup_`, i.e.,
+  // registered after `initRegistry`, are looked up in
+  // `uncached_registry_lookup_` under `parser_mutex_`.
+
   static bool lookupInSymbolSet(const torch::jit::Node* node) {
     initRegistry();
 
-    std::lock_guard<std::mutex> lock(parser_mutex_);
     return parser_symbol_set_.count(node->kind()) != 0;
   }
 
   // return nullptr if entry does not exist
   static const RegistrationEntry* lookupInRegistry(
       const torch::jit::Node* node) {
-    std::lock_guard<std::mutex> lock(parser_mutex_);
-
-    if (parser_skip_set_.count(node->kind()) != 0) {
+    if (std::atomic_load(&parser_skip_set_)->count(node->kind()) != 0) {
       return nullptr;
     }
     // we need to use maybeSchema for nodes like prim::Constant, which doesn't
     // have a schema
     auto schema_ptr = node->maybeSchema();
-    if (schema_ptr != nullptr) {
-      // search cached entry first
-      auto cache_it = cached_registry_lookup_.find(schema_ptr);
-      if (cache_it != cached_registry_lookup_.end()) {
-        return cache_it->second;
-      } else {
-        // match signature
-        auto schema_str = torch::jit::canonicalSchemaString(*schema_ptr);
-
-        auto iter = jit_operator_registry_.find(schema_str);
-        if (iter != jit_operator_registry_.end()) {
-          // update cache entry
-          cached_registry_lookup_.insert(cache_it, {schema_ptr, &iter->second});
-          return &iter->second;
-        }
-      }
+    if (schema_ptr == nullptr) {
+      return nullptr;
     }
-    return nullptr;
+    // only the schemas of registered symbols have an entry
+    if (parser_symbol_set_.count(node->kind()) == 0) {
+      return nullptr;
+    }
+    // search cached entry first
+    auto cached_lookup = std::atomic_load(&cached_registry_lookup_);
+    auto cache_it = cached_lookup->find(schema_ptr);
+    if (cache_it != cached_lookup->end()) {
+      return cache_it->second;
+    }
+
+    std::lock_guard<std::mutex> lock(parser_mutex_);
+    auto uncached_it = uncached_registry_lookup_.find(schema_ptr);
+    if (uncached_it != uncached_registry_lookup_.end()) {
+      return uncached_it->second;
+    }
+
+    // match signature, schemas that aren't registered are cached too
+    auto schema_str = torch::jit::canonicalSchemaString(*schema_ptr);
+    auto iter = jit_operator_registry_.find(schema_str);
+    const RegistrationEntry* entry =
+        iter != jit_operator_registry_.end() ? &iter->second : nullptr;
+    uncached_registry_lookup_.emplace(schema_ptr, entry);
+    return entry;
   }
 
   static bool querySkipSymbolSet(c10::Symbol symbol, bool flip) {
     initRegistry();
 
     std::lock_guard<std::mutex> lock(parser_mutex_);
-    // no need to init registry here (unlike `lookupInSymbolSet`, as
-    // `parser_skip_set_` is not initialized via initialization
-    bool ret = parser_skip_set_.count(symbol) != 0;
+    auto skip_set = std::atomic_load(&parser_skip_set_);
+    bool ret = skip_set->count(symbol) != 0;
     if (flip) {
+      auto updated_skip_set =
+          std::make_shared<std::unordered_set<c10::Symbol>>(*skip_set);
       if (ret) {
-        parser_skip_set_.erase(symbol);
+        updated_skip_set->erase(symbol);
       } else {
-        parser_skip_set_.insert(symbol);
+        updated_skip_set->insert(symbol);
       }
+      std::atomic_store(
+          &parser_skip_set_,
+          std::shared_ptr<const std::unordered_set<c10::Symbol>>(
+              std::move(updated_skip_set)));
     }
     return ret;
   }
@@ -864,6 +889,22 @@ class IrParser {
     c10::call_once(once_flag_, []() {
       std::lock_guard<std::mutex> lock(parser_mutex_);
       registerJitOperator();
+
+      // Pre-populate the lookup cache with all the overloads of registered
+      // operators, so that lookups of their nodes never update the cache
+      auto lookup = std::make_shared<RegistryLookup>();
+      for (auto symbol : parser_symbol_set_) {
+        for (const auto& op : torch::jit::getAllOperatorsFor(symbol)) {
+          auto iter = jit_operator_registry_.find(
+              torch::jit::canonicalSchemaString(op->schema()));
+          lookup->emplace(
+              &op->schema(),
+              iter != jit_operator_registry_.end() ? &iter->second : nullptr);
+        }
+      }
+      std::atomic_store(
+          &cached_registry_lookup_,
+          std::shared_ptr<const RegistryLookup>(std::move(lookup)));
     });
   }
 
@@ -3793,31 +3834,41 @@ class IrParser {
   // maps from JitValue::unique() to fusion Val;
   std::unordered_map<size_t, ValueHolder> value_map_;
 
+  // See Note [ Parser registry concurrency ]
   static std::unordered_set<c10::Symbol> parser_symbol_set_;
-  static std::unordered_set<c10::Symbol> parser_skip_set_;
+  static std::shared_ptr<const std::unordered_set<c10::Symbol>>
+      parser_skip_set_;
   static std::mutex parser_mutex_;
 
   // parsing rule registry.
   static std::unordered_map<std::string, RegistrationEntry>
       jit_operator_registry_; // NOLINT
 
-  // pointing cached entry stored in `jit_operator_registry_`
-  static std::
-      unordered_map<const torch::jit::FunctionSchema*, const RegistrationEntry*>
-          cached_registry_lookup_; // NOLINT
+  // pointing cached entry stored in `jit_operator_registry_`, or nullptr for
+  // schemas without an entry
+  using RegistryLookup = std::unordered_map<
+      const torch::jit::FunctionSchema*,
+      const RegistrationEntry*>;
+  static std::shared_ptr<const RegistryLookup>
+      cached_registry_lookup_; // NOLINT
+  // entries of schemas that weren't pre-populated in
+  // `cached_registry_lookup_`, guarded by `parser_mutex_`
+  static RegistryLookup uncached_registry_lookup_; // NOLINT
 
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
   static c10::once_flag once_flag_;
 };
 std::unordered_set<c10::Symbol> IrParser::parser_symbol_set_; // NOLINT
-std::unordered_set<c10::Symbol> IrParser::parser_skip_set_; // NOLINT
+std::shared_ptr<const std::unordered_set<c10::Symbol>>
+    IrParser::parser_skip_set_ =
+        std::make_shared<const std::unordered_set<c10::Symbol>>(); // NOLINT
 std::mutex IrParser::parser_mutex_;
 std::unordered_map<std::string, IrParser::RegistrationEntry>
     IrParser::jit_operator_registry_; // NOLINT
-std::unordered_map<
-    const torch::jit::FunctionSchema*,
-    const IrParser::RegistrationEntry*>
-    IrParser::cached_registry_lookup_; // NOLINT
+std::shared_ptr<const IrParser::RegistryLookup>
+    IrParser::cached_registry_lookup_ =
+        std::make_shared<const IrParser::RegistryLookup>(); // NOLINT
+IrParser::RegistryLookup IrParser::uncached_registry_lookup_; // NOLINT
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
 c10::once_flag IrParser::once_flag_;
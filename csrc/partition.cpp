@@ -10,6 +10,7 @@
 #include <ATen/core/jit_type.h>
 #include <ATen/cuda/CUDAContext.h>
 #include <c10/util/irange.h>
+#include <device_profile.h>
 #include <instrumentation.h>
 #include <parser.h>
 #include <torch/csrc/jit/jit_log.h>
@@ -121,7 +122,10 @@ static bool isDeviceCompatible(
     GRAPH_UPDATE("rejecting node (non-cuda device): ", *node);
     return false;
   }
-  const auto major = at::cuda::getDeviceProperties(device.index())->major;
+  const auto major =
+      deviceProfile(
+          device.has_index() ? device.index() : at::cuda::current_device())
+          ->major;
   // disable non-elementwise fusion on pre-volta devices
   if (major < 7 && hasNonElementWiseOperation(node)) {
     GRAPH_UPDATE(
@@ -9,11 +9,25 @@
 #include <python_frontend/fusion_cache.h>
 #include <serde/fusion_record_serde.h>
 
+#include <algorithm>
 #include <filesystem>
+#include <thread>
+#include <unordered_set>
 namespace fs = std::filesystem;
 
 namespace nvfuser::python_frontend {
 
+namespace {
+
+constexpr size_t kDefaultMaxFusions = 8192;
+//! The low bits of a fusion id are its slot, see FusionCache::fusionSlot
+constexpr size_t kFusionSlotBits = 32;
+//! Number of the least recently visited fusions among which the least visited
+//! one is evicted
+constexpr size_t kEvictionCandidates = 8;
+
+} // namespace
+
 // FusionCache static data member definitions for singleton usage
 std::mutex FusionCache::singleton_lock_;
 FusionCache* FusionCache::singleton_ = nullptr;
@@ -28,37 +42,120 @@ FusionSchedules::FusionSchedules()
       user_def_schedules(),
       last_user_def_scheduled_ir(nullptr),
       last_user_def_executor(nullptr),
-      scheds_lock() {
+      scheds_lock(),
+      exec_lock(),
+      fusion_id(0),
+      evicted(false) {
   auto_gen_schedules =
       std::make_unique<FusionExecutorCache>(std::make_unique<Fusion>());
 }
 
+FusionSchedules::~FusionSchedules() {
+  // The CompiledKernelCache keeps the kernels alive after the executors are
+  // destroyed, e.g., when the fusion is evicted
+  std::unordered_set<const CompiledKernelEntry*> kernels;
+  auto collect = [&](const FusionExecutor& executor) {
+    if (executor.sharedKernel() != nullptr) {
+      kernels.insert(executor.sharedKernel());
+    }
+  };
+  for (auto& runtimes : auto_gen_schedules->getKernelRuntimes()) {
+    for (auto& runtime : runtimes.second) {
+      for (auto& executor : runtime->executors()) {
+        collect(executor);
+      }
+    }
+  }
+  for (auto& user_scheds : user_def_schedules) {
+    for (auto& user_sched : user_scheds.second) {
+      if (user_sched.executor != nullptr) {
+        collect(*user_sched.executor);
+      }
+    }
+  }
+  if (kernels.empty()) {
+    return;
+  }
+  last_user_def_executor = nullptr;
+  user_def_schedules.clear();
+  auto_gen_schedules.reset();
+  CompiledKernelCache::get().releaseUnused(kernels);
+}
+
 Fusion* FusionSchedules::preschedFusion() {
   auto fusion = auto_gen_schedules->fusion();
   TORCH_CHECK(fusion != nullptr, "Prescheduled Fusion is unexpectedly null!");
   return fusion;
 }
 
-TrieNode::TrieNode(RecordFunctor* rec, TrieNode* _parent, size_t _fusion_id)
+std::pair<size_t, size_t> FusionSchedules::compiledKernels() {
+  std::lock_guard<std::mutex> guard(exec_lock);
+  size_t num_kernels = 0;
+  size_t code_bytes = 0;
+  auto count = [&](const FusionExecutor& executor) {
+    if (executor.compiled()) {
+      ++num_kernels;
+      code_bytes += executor.kernelString().size();
+    }
+  };
+  for (auto& runtimes : auto_gen_schedules->getKernelRuntimes()) {
+    for (auto& runtime : runtimes.second) {
+      for (auto& executor : runtime->executors()) {
+        count(executor);
+      }
+    }
+  }
+  std::lock_guard<std::mutex> scheds_guard(scheds_lock);
+  for (auto& user_scheds : user_def_schedules) {
+    for (auto& user_sched : user_scheds.second) {
+      if (user_sched.executor != nullptr) {
+        count(*user_sched.executor);
+      }
+    }
+  }
+  return {num_kernels, code_bytes};
+}
+
+TrieNode::TrieNode(
+    RecordFunctor* rec,
+    std::shared_ptr<TrieNode> _parent,
+    size_t _fusion_id)
     : record(rec),
-      children(),
       fusion_id(_fusion_id),
+      schedules(nullptr),
       visits(0),
-      parent(_parent),
-      trie_node_lock() {}
+      lru_position(),
+      in_lru(false),
+      parent(std::move(_parent)),
+      trie_node_lock(),
+      pruned(false),
+      children_(std::make_shared<const ChildMap>()) {}
 
 bool TrieNode::isTerminal() const {
   return (record.get()->recordType() == serde::RecordType_End);
 }
 
+std::shared_ptr<const TrieNode::ChildMap> TrieNode::children() const {
+  return std::atomic_load(&children_);
+}
+
+void TrieNode::setChildren(std::shared_ptr<const ChildMap> children) {
+  std::atomic_store(&children_, std::move(children));
+}
+
+bool TrieNode::isEvicted() const {
+  return schedules != nullptr && schedules->evicted;
+}
+
 flatbuffers::Offset<serde::TrieNode> TrieNode::serialize(
     flatbuffers::FlatBufferBuilder& builder,
     const std::map<RecordFunctor*, size_t>&
         map_record_functor_to_trie_node_id) {
   // Map children TrieNode to its corresponding Integer index
+  auto node_children = children();
   std::vector<size_t> children_trie_node_ids;
-  children_trie_node_ids.reserve(children.size());
-  for (auto&& c : children) {
+  children_trie_node_ids.reserve(node_children->size());
+  for (auto&& c : *node_children) {
     size_t id = map_record_functor_to_trie_node_id.at(c.first);
     children_trie_node_ids.push_back(id);
   }
@@ -68,44 +165,47 @@ flatbuffers::Offset<serde::TrieNode> TrieNode::serialize(
       record->serialize(builder),
       &children_trie_node_ids,
       fusion_id,
-      visits,
+      visits.load(),
       isTerminal());
 }
 
-FusionCache* FusionCache::get(size_t max_fusions) {
+FusionCache* FusionCache::get(c10::optional<size_t> max_fusions) {
   FUSER_PERF_SCOPE("FusionCache::get");
   std::lock_guard<std::mutex> guard(singleton_lock_);
   if (singleton_ == nullptr) {
-    singleton_ = new FusionCache(max_fusions);
+    singleton_ = new FusionCache(max_fusions.value_or(kDefaultMaxFusions));
+  }
+  if (max_fusions.has_value()) {
+    singleton_->max_fusions_ = max_fusions.value();
+    // The fusions above the new max are evicted like on a full cache
+    while (singleton_->num_fusions_ > max_fusions.value()) {
+      singleton_->evictFusion();
+    }
   }
-  TORCH_CHECK(
-      max_fusions >= singleton_->fusions_.size(),
-      "The max fusions is set less than the number of fusions in the cache.");
-  singleton_->max_fusions_ = max_fusions;
   return singleton_;
 }
 
 size_t FusionCache::numFusions() const {
-  return fusions_.size();
+  return num_fusions_;
 }
 
 void FusionCache::print(std::ostream& os) const {
   os << "Fusions by id:" << std::endl;
-  std::vector<TrieNode*> stack;
-  stack.push_back(root_.get());
+  std::vector<std::shared_ptr<TrieNode>> stack;
+  stack.push_back(root_);
 
   while (!stack.empty()) {
-    TrieNode* node = stack.back();
+    auto node = stack.back();
     stack.pop_back();
 
     if (node->isTerminal()) {
       std::vector<TrieNode*> rev_fusion_records;
-      TrieNode* end = node->parent;
+      TrieNode* end = node->parent.get();
       while (end) {
         if (end->record->recordType() != serde::RecordType_Start) {
           rev_fusion_records.emplace_back(end);
         }
-        end = end->parent;
+        end = end->parent.get();
       }
 
       os << node->fusion_id << ":" << std::endl;
@@ -118,39 +218,54 @@ void FusionCache::print(std::ostream& os) const {
             os << std::endl;
           });
     } else {
-      for (auto& iter : node->children) {
-        stack.push_back(iter.second.get());
+      for (auto& iter : *node->children()) {
+        stack.push_back(iter.second);
       }
     }
   }
 }
 
 void FusionCache::stats(std::ostream& os) const {
-  os << "Total Fusions: " << fusions_.size() << "\n";
+  os << "Total Fusions: " << numFusions() << "\n";
 
   // Does not make sense to print stats if the cache is disabled.
-  if (!fusions_.empty()) {
+  if (numFusions() > 0) {
     os << "Cache Hits by Fusion Id:\n";
     size_t total_cache_hits = 0;
+    size_t num_kernels = 0;
+    size_t source_bytes = 0;
     for (size_t i = 0; i < terminal_nodes_.size(); ++i) {
+      auto node = std::atomic_load(&terminal_nodes_.at(i));
+      if (node == nullptr) {
+        continue;
+      }
       // The first visit is a miss!
-      auto visits = terminal_nodes_[i]->visits - 1;
+      auto visits = node->visits - 1;
       total_cache_hits += visits;
-      os << "\t" << i << " -> " << visits << " hits\n";
+      os << "\t" << node->fusion_id << " -> " << visits << " hits\n";
+      auto [fusion_kernels, fusion_source_bytes] =
+          node->schedules->compiledKernels();
+      num_kernels += fusion_kernels;
+      source_bytes += fusion_source_bytes;
     }
 
+    size_t lookups = root_->visits;
     auto hit_rate = static_cast<float>(total_cache_hits) /
-        static_cast<float>(root_->visits) * 100.0;
-    os << "Cache Lookups: " << root_->visits;
+        static_cast<float>(lookups) * 100.0;
+    os << "Cache Lookups: " << lookups;
     os << " Cache Hits: " << total_cache_hits;
     os << " Hit Rate: " << hit_rate << "%\n";
+    os << "Definition Key Hits: " << definition_key_hits_ << "\n";
+    os << "Evictions: " << num_evictions_ << "\n";
+    os << "Compiled Kernels: " << num_kernels << " (" << source_bytes
+       << " bytes of CUDA source)\n";
   }
 }
 
 void FusionCache::reset() {
   std::lock_guard<std::mutex> guard(singleton_lock_);
   if (singleton_ != nullptr) {
-    auto max_fusions = singleton_->max_fusions_;
+    auto max_fusions = singleton_->max_fusions_.load();
     delete singleton_;
     singleton_ = new FusionCache(max_fusions);
   }
@@ -161,46 +276,97 @@ FusionCache::FusionCache(size_t max_fusions)
       root_(nullptr),
       fusions_(),
       terminal_nodes_(),
-      user_def_input_encodings_() {
+      free_fusion_ids_(),
+      fusions_lock_(),
+      num_fusions_(0),
+      num_evictions_(0),
+      lru_(),
+      lru_lock_(),
+      definition_keys_(std::make_shared<const DefinitionKeyMap>()),
+      definition_key_hits_(0),
+      definition_keys_lock_(),
+      user_def_input_encodings_(),
+      user_def_input_encodings_lock_() {
   RecordFunctor* start = new StartRecord();
-  root_ = std::make_unique<TrieNode>(start);
+  root_ = std::make_shared<TrieNode>(start);
+}
+
+FusionCache::~FusionCache() {
+  // Children hold their parents, so the trie is unlinked from the root down
+  // for its nodes to be released.
+  std::vector<std::shared_ptr<TrieNode>> stack = {root_};
+  while (!stack.empty()) {
+    auto node = stack.back();
+    stack.pop_back();
+    for (auto& child : *node->children()) {
+      stack.push_back(child.second);
+    }
+    node->setChildren(std::make_shared<const TrieNode::ChildMap>());
+  }
+}
+
+size_t FusionCache::fusionSlot(size_t fusion_id) {
+  return fusion_id & ((size_t(1) << kFusionSlotBits) - 1);
 }
 
-// In order to keep queries fast, this method does not lock.
-// In the worst case, the query should fail and if you try to create a child,
-// it should give you back an already created child if two threads are walking
-// the trie at the same time with the same definition.
-c10::optional<TrieNode*> FusionCache::queryChildren(
-    TrieNode* node,
-    RecordFunctor* rec) const {
+void FusionCache::visitTerminal(TrieNode* node) {
+  ++(node->visits);
+  // A lookup doesn't wait for another thread to update the recency list, the
+  // fusion is visited often enough for the miss not to matter
+  std::unique_lock<std::mutex> guard(lru_lock_, std::try_to_lock);
+  if (guard.owns_lock() && node->in_lru) {
+    lru_.splice(lru_.begin(), lru_, node->lru_position);
+  }
+}
+
+// In order to keep queries fast, this method does not lock.  It reads the
+// current table of children, which is never modified once published.  In the
+// worst case, the query fails because another thread is inserting the child,
+// and creating the child gives back the child the other thread created.
+c10::optional<std::shared_ptr<TrieNode>> FusionCache::queryChildren(
+    const std::shared_ptr<TrieNode>& node,
+    RecordFunctor* rec) {
   TORCH_CHECK(
       !node->isTerminal(), "There should be no children from a Terminal Node!");
   TORCH_CHECK(rec, "Record is null!");
-  auto trie_node = node->children.find(rec);
-  if (trie_node == std::end(node->children)) {
+  auto children = node->children();
+  auto trie_node = children->find(rec);
+  if (trie_node == std::end(*children) || trie_node->second->isEvicted()) {
     return c10::nullopt;
   } else {
-    ++(trie_node->second.get()->visits);
-    return c10::optional<TrieNode*>(trie_node->second.get());
+    if (trie_node->second->isTerminal()) {
+      visitTerminal(trie_node->second.get());
+    } else {
+      ++(trie_node->second->visits);
+    }
+    return c10::optional<std::shared_ptr<TrieNode>>(trie_node->second);
   }
 }
-FusionSchedules* FusionCache::queryFusionSchedules(size_t fusion_id) const {
+std::shared_ptr<FusionSchedules> FusionCache::queryFusionSchedules(
+    size_t fusion_id) const {
   TORCH_CHECK(
-      fusion_id < fusions_.size(),
+      fusionSlot(fusion_id) < fusions_.size(),
       "Invalid scheduler query for id:",
       fusion_id);
-  FusionSchedules* ptr = fusions_.at(fusion_id).get();
-  TORCH_CHECK(ptr != nullptr, "Unexpected null FusionSchedules object.");
+  auto ptr = std::atomic_load(&fusions_.at(fusionSlot(fusion_id)));
+  TORCH_CHECK(
+      ptr != nullptr && ptr->fusion_id == fusion_id,
+      "Fusion ",
+      fusion_id,
+      " was evicted.");
   return ptr;
 }
 c10::optional<size_t> FusionCache::queryUserScheduleId(
     const FusionSchedules* scheds,
-    const at::ArrayRef<c10::IValue>& inputs) {
+    const KernelArgumentHolder& args) {
   c10::optional<size_t> result = c10::nullopt;
 
+  std::lock_guard<std::mutex> guard(scheds->scheds_lock);
   auto& user_scheds = scheds->user_def_schedules;
   if (!user_scheds.empty()) {
-    auto input_id = user_def_input_encodings_.lookupId(inputs);
+    std::lock_guard<std::mutex> encodings_guard(
+        user_def_input_encodings_lock_);
+    auto input_id = user_def_input_encodings_.lookupId(args);
     auto user_sched = user_scheds.find(input_id.id);
     if (user_sched != user_scheds.end()) {
       return c10::optional<size_t>(user_sched->first);
@@ -212,6 +378,7 @@ const UserSchedule& FusionCache::queryUserSchedule(
     const FusionSchedules* scheds,
     size_t id,
     int device) const {
+  std::lock_guard<std::mutex> guard(scheds->scheds_lock);
   auto& user_scheds = scheds->user_def_schedules;
   TORCH_CHECK(
       !user_scheds.empty(),
@@ -222,54 +389,201 @@ const UserSchedule& FusionCache::queryUserSchedule(
   return user_sched->second.at(device);
 }
 
-TrieNode* FusionCache::createChild(TrieNode* node, RecordFunctor* rec) {
+std::shared_ptr<TrieNode> FusionCache::createChild(
+    const std::shared_ptr<TrieNode>& node,
+    RecordFunctor* rec,
+    const std::function<void(Fusion*)>& build_fusion_ir) {
   FUSER_PERF_SCOPE("FusionCache::createChild");
-  TrieNode* child = nullptr;
   TORCH_CHECK(
       !node->isTerminal(), "Cannot create a trie node from a terminal node!");
   TORCH_CHECK(rec, "Record is null!");
 
-  std::lock_guard<std::mutex> guard(node->trie_node_lock);
+  // Other threads can use the Fusion as soon as they find the terminal node,
+  // so the Fusion IR is built before the node is inserted.
+  const bool is_terminal = rec->recordType() == serde::RecordType_End;
+  std::shared_ptr<FusionSchedules> scheds;
+  if (is_terminal) {
+    scheds = std::make_shared<FusionSchedules>();
+    if (build_fusion_ir) {
+      build_fusion_ir(scheds->preschedFusion());
+    }
+  }
 
-  // As a thread-safety compromise for fast queries, the node is re-queried
-  // prior to child creation incase another thread slipped in the node.
-  auto child_node = queryChildren(node, rec);
-  if (child_node.has_value()) {
-    child = child_node.value();
-  } else {
-    size_t fusion_id = 0;
-    if (rec->recordType() == serde::RecordType_End) {
-      TORCH_CHECK(
-          (fusions_.size() + 1) <= max_fusions_,
-          "The number of fusions in nvfuser has exceeded ",
-          max_fusions_,
-          "fusions.  The max_fusions for the FusionCache might need to be ",
-          "increased if the max number is not being exceeded due to an error.");
-      fusions_.emplace_back(std::make_unique<FusionSchedules>());
-      fusion_id = fusions_.size() - 1;
+  std::unique_lock<std::mutex> guard(node->trie_node_lock);
+  while (true) {
+    // As a thread-safety compromise for fast queries, the node is re-queried
+    // prior to child creation incase another thread slipped in the node.
+    auto child_node = node->pruned ? c10::nullopt : queryChildren(node, rec);
+    if (node->pruned || child_node.has_value()) {
+      return node->pruned ? nullptr : child_node.value();
+    }
+    if (!is_terminal) {
+      break;
     }
+    auto fusion_id = tryAcquireFusionId();
+    if (fusion_id.has_value()) {
+      scheds->fusion_id = fusion_id.value();
+      break;
+    }
+    // An eviction locks the nodes it prunes, so the node is unlocked while
+    // evicting, and re-queried afterwards
+    guard.unlock();
+    evictFusion();
+    guard.lock();
+  }
 
-    // Copying the record owned by the FusionDefinition that calls this function
-    // so the trie owns a copy when the FusionDefinition gets destroyed rather
-    // than managing a shared pointer that would only share with
-    // FusionDefinition that creates a trie node but not cache lookups
-    RecordFunctor* new_rec = rec->clone();
-    node->children[new_rec] =
-        std::make_unique<TrieNode>(new_rec, node, fusion_id);
-    child = node->children[new_rec].get();
-    TORCH_CHECK(child, "Created child of TrieNode should not be null!");
+  // Copying the record owned by the FusionDefinition that calls this function
+  // so the trie owns a copy when the FusionDefinition gets destroyed rather
+  // than managing a shared pointer that would only share with
+  // FusionDefinition that creates a trie node but not cache lookups
+  std::shared_ptr<TrieNode> child;
+  if (is_terminal) {
+    child = std::make_shared<TrieNode>(rec->clone(), node, scheds->fusion_id);
+    child->schedules = scheds;
+    auto slot = fusionSlot(scheds->fusion_id);
+    std::atomic_store(&fusions_.at(slot), scheds);
+    std::atomic_store(&terminal_nodes_.at(slot), child);
+    {
+      std::lock_guard<std::mutex> lru_guard(lru_lock_);
+      child->lru_position = lru_.insert(lru_.begin(), child.get());
+      child->in_lru = true;
+    }
     ++(child->visits);
-    if (rec->recordType() == serde::RecordType_End) {
-      terminal_nodes_.push_back(node->children[new_rec].get());
+  } else {
+    child = std::make_shared<TrieNode>(rec->clone(), node);
+    ++(child->visits);
+  }
+
+  // Readers of the current table of children are not disturbed by the insert.
+  // A terminal node of an evicted fusion that is not pruned yet is replaced.
+  auto children = std::make_shared<TrieNode::ChildMap>(*node->children());
+  children->erase(child->record.get());
+  children->emplace(child->record.get(), child);
+  node->setChildren(std::move(children));
+
+  if (isDebugDumpEnabled(DebugDumpOption::PythonFrontendDebug)) {
+    std::stringstream ss;
+    child->record->print(ss);
+    std::cout << "\nFusionDefinition: Create new trie node for: " << ss.str()
+              << "\n";
+  }
+  return child;
+}
+
+c10::optional<size_t> FusionCache::tryAcquireFusionId() {
+  std::lock_guard<std::mutex> guard(fusions_lock_);
+  TORCH_CHECK(max_fusions_ > 0, "The FusionCache is set to hold no fusions!");
+  if (num_fusions_ >= max_fusions_) {
+    return c10::nullopt;
+  }
+  ++num_fusions_;
+  if (!free_fusion_ids_.empty()) {
+    auto fusion_id = free_fusion_ids_.back();
+    free_fusion_ids_.pop_back();
+    return fusion_id;
+  }
+  auto fusion_id = fusions_.push_back(nullptr);
+  terminal_nodes_.push_back(nullptr);
+  return fusion_id;
+}
+
+void FusionCache::evictFusion() {
+  std::shared_ptr<TrieNode> victim;
+  {
+    std::lock_guard<std::mutex> guard(fusions_lock_);
+    // Another thread may have freed a slot in the meantime
+    if (num_fusions_ < max_fusions_) {
+      return;
     }
-    if (isDebugDumpEnabled(DebugDumpOption::PythonFrontendDebug)) {
-      std::stringstream ss;
-      new_rec->print(ss);
-      std::cout << "\nFusionDefinition: Create new trie node for: " << ss.str()
-                << "\n";
+    victim = selectEvictionVictim();
+    if (victim != nullptr) {
+      victim->schedules->evicted = true;
+      auto slot = fusionSlot(victim->fusion_id);
+      std::atomic_store(&fusions_.at(slot), std::shared_ptr<FusionSchedules>());
+      std::atomic_store(&terminal_nodes_.at(slot), std::shared_ptr<TrieNode>());
+      ++num_evictions_;
     }
   }
-  return child;
+  // Every id is reserved by a fusion that another thread is inserting
+  if (victim == nullptr) {
+    std::this_thread::yield();
+    return;
+  }
+  if (isDebugDumpEnabled(DebugDumpOption::PythonFrontendDebug)) {
+    std::cout << "\nFusionCache: Evicting fusion " << victim->fusion_id
+              << " with " << victim->visits << " visits.\n";
+  }
+  pruneEvicted(victim);
+  // The slot of the evicted fusion is free to be taken over by a new fusion
+  releaseFusionId(victim->fusion_id);
+}
+
+void FusionCache::releaseFusionId(size_t fusion_id) {
+  std::lock_guard<std::mutex> guard(fusions_lock_);
+  // The next fusion in the slot gets the id of the next generation
+  free_fusion_ids_.push_back(fusion_id + (size_t(1) << kFusionSlotBits));
+  --num_fusions_;
+}
+
+std::shared_ptr<TrieNode> FusionCache::selectEvictionVictim() {
+  // Candidates are the fusions that were visited the least recently.  Among
+  // them, the fusion with the fewest visits is evicted, so that frequently
+  // used fusions survive a burst of one-off definitions.
+  std::lock_guard<std::mutex> guard(lru_lock_);
+  if (lru_.empty()) {
+    return nullptr;
+  }
+  auto victim = std::prev(lru_.end());
+  auto candidate = victim;
+  for (size_t i = 1; i < kEvictionCandidates && candidate != lru_.begin();
+       ++i) {
+    --candidate;
+    if ((*candidate)->visits < (*victim)->visits) {
+      victim = candidate;
+    }
+  }
+  auto node =
+      std::atomic_load(&terminal_nodes_.at(fusionSlot((*victim)->fusion_id)));
+  TORCH_INTERNAL_ASSERT(
+      node.get() == *victim, "The recency list holds an evicted fusion!");
+  node->in_lru = false;
+  lru_.erase(victim);
+  return node;
+}
+
+void FusionCache::pruneEvicted(std::shared_ptr<TrieNode> terminal) {
+  // Nodes are locked after their parent, the same order as creating a child
+  // and pruning another branch.
+  auto node = std::move(terminal);
+  while (node->parent != nullptr) {
+    auto parent = node->parent;
+    std::lock_guard<std::mutex> parent_guard(parent->trie_node_lock);
+    std::lock_guard<std::mutex> guard(node->trie_node_lock);
+    if (parent->pruned || node->pruned || !node->children()->empty()) {
+      break;
+    }
+    auto children = std::make_shared<TrieNode::ChildMap>(*parent->children());
+    auto entry = children->find(node->record.get());
+    if (entry != children->end() && entry->second == node) {
+      children->erase(entry);
+      parent->setChildren(std::move(children));
+    }
+    node->pruned = true;
+    node = parent;
+  }
+
+  std::lock_guard<std::mutex> guard(definition_keys_lock_);
+  auto definition_keys = std::make_shared<DefinitionKeyMap>();
+  for (auto& entry : *definition_keys_) {
+    if (!entry.second->isEvicted()) {
+      definition_keys->emplace(entry);
+    }
+  }
+  if (definition_keys->size() < definition_keys_->size()) {
+    std::atomic_store(
+        &definition_keys_,
+        std::shared_ptr<const DefinitionKeyMap>(std::move(definition_keys)));
+  }
 }
 
 UserSchedule* FusionCache::createUserSchedule(
@@ -277,9 +591,11 @@ UserSchedule* FusionCache::createUserSchedule(
     const at::ArrayRef<c10::IValue>& inputs,
     int device) {
   FUSER_PERF_SCOPE("FusionCache::createUserSchedule");
+  auto args = KernelArgumentHolder::createKernelArgumentHolder(inputs);
   std::lock_guard<std::mutex> guard(scheds->scheds_lock);
   auto& user_scheds = scheds->user_def_schedules;
-  auto input_id = user_def_input_encodings_.lookupId(inputs);
+  std::lock_guard<std::mutex> encodings_guard(user_def_input_encodings_lock_);
+  auto input_id = user_def_input_encodings_.lookupId(args);
   auto user_sched = user_scheds.find(input_id.id);
   if (user_sched == user_scheds.end()) {
     user_scheds[input_id.id] = std::vector<UserSchedule>(device + 1);
@@ -295,12 +611,62 @@ UserSchedule* FusionCache::createUserSchedule(
   return &user_scheds[input_id.id].at(device);
 }
 
-TrieNode* FusionCache::rootTriePtr() {
+std::shared_ptr<TrieNode> FusionCache::rootTriePtr() {
   ++(root_.get()->visits);
-  return root_.get();
+  return root_;
+}
+
+std::shared_ptr<TrieNode> FusionCache::queryDefinitionKey(
+    const std::string& key) {
+  FUSER_PERF_SCOPE("FusionCache::queryDefinitionKey");
+  auto definition_keys = std::atomic_load(&definition_keys_);
+  auto entry = definition_keys->find(key);
+  if (entry == definition_keys->end() || entry->second->isEvicted()) {
+    return nullptr;
+  }
+  // Keep the stats of the trie as if the definition was walked
+  ++(root_.get()->visits);
+  visitTerminal(entry->second.get());
+  ++definition_key_hits_;
+  return entry->second;
+}
+
+void FusionCache::recordDefinitionKey(
+    const std::string& key,
+    const std::shared_ptr<TrieNode>& terminal) {
+  TORCH_CHECK(
+      terminal != nullptr && terminal->isTerminal(),
+      "A definition key must be recorded for a terminal node!");
+  std::lock_guard<std::mutex> guard(definition_keys_lock_);
+  if (terminal->isEvicted()) {
+    return;
+  }
+  auto entry = definition_keys_->find(key);
+  if (entry != definition_keys_->end() && !entry->second->isEvicted()) {
+    TORCH_CHECK(
+        entry->second == terminal,
+        "Definition key ",
+        key,
+        " is already recorded for fusion ",
+        entry->second->fusion_id,
+        " and can't be recorded for fusion ",
+        terminal->fusion_id);
+    return;
+  }
+  auto definition_keys =
+      std::make_shared<DefinitionKeyMap>(*definition_keys_);
+  (*definition_keys)[key] = terminal;
+  std::atomic_store(
+      &definition_keys_,
+      std::shared_ptr<const DefinitionKeyMap>(std::move(definition_keys)));
 }
 
 void FusionCache::serialize(std::string filename) const {
+  // The serialized terminal nodes are indexed by fusion id, which can't
+  // express the holes left by evicted fusions.
+  TORCH_CHECK(
+      num_evictions_ == 0,
+      "Serializing a FusionCache after evicting fusions is not supported.");
   flatbuffers::FlatBufferBuilder builder(1024);
   // TODO: Serialize Fusion IR containers
 
@@ -317,7 +683,7 @@ void FusionCache::serialize(std::string filename) const {
         current_node->record.get(), bfs_order.size());
     bfs_order.push_back(current_node);
 
-    for (auto&& child : current_node->children) {
+    for (auto&& child : *current_node->children()) {
       queue.push_back(child.second.get());
     }
   }
@@ -343,9 +709,12 @@ void FusionCache::serialize(std::string filename) const {
   // 4. Map the terminal nodes to their BFS positions.
   std::vector<size_t> terminal_node_idx;
   terminal_node_idx.reserve(terminal_nodes_.size());
-  for (auto node : terminal_nodes_) {
+  for (size_t i = 0; i < terminal_nodes_.size(); ++i) {
+    auto terminal_node = std::atomic_load(&terminal_nodes_.at(i));
+    TORCH_CHECK(
+        terminal_node != nullptr, "Fusion ", i, " is missing from the trie.");
     terminal_node_idx.push_back(
-        map_record_functor_to_trie_node_id.at(node->record.get()));
+        map_record_functor_to_trie_node_id.at(terminal_node->record.get()));
   }
 
   // 5. Build FusionCache flatbuffer object
@@ -355,7 +724,7 @@ void FusionCache::serialize(std::string filename) const {
   //  terminal_nodes: [ulong];
   // }
   auto fusion_cache = serde::CreateFusionCacheDirect(
-      builder, max_fusions_, &fb_nodes, &terminal_node_idx);
+      builder, max_fusions_.load(), &fb_nodes, &terminal_node_idx);
   builder.Finish(fusion_cache, "NV00" /* file_identifier */);
 
   // 6. Write flatbuffer binary to file
@@ -419,16 +788,18 @@ void FusionCache::deserialize(std::string filename) {
   max_fusions_ = fusion_cache_buffer->max_fusions();
 
   // 2. Deserialize fusions: (Fusion) and structure: (TrieNode) fields
-  std::generate_n(
-      std::back_inserter(fusions_),
-      fusion_cache_buffer->terminal_nodes()->size(),
-      [] { return std::make_unique<FusionSchedules>(); });
+  for (size_t i = 0; i < fusion_cache_buffer->terminal_nodes()->size(); ++i) {
+    auto scheds = std::make_shared<FusionSchedules>();
+    scheds->fusion_id = i;
+    fusions_.push_back(std::move(scheds));
+  }
+  num_fusions_ = fusions_.size();
 
   serde::RecordFunctorFactory record_functor_factory;
 
-  using BfsState = std::pair<TrieNode*, size_t>;
+  using BfsState = std::pair<std::shared_ptr<TrieNode>, size_t>;
   std::deque<BfsState> queue = {
-      {root_.get() /* TrieNode pointer */, 0 /* structure_idx */}};
+      {root_ /* TrieNode pointer */, 0 /* structure_idx */}};
 
   // state_queue holds the FusionState for each BfsState in the queue.
   std::deque<std::unique_ptr<FusionState>> state_queue;
@@ -439,7 +810,7 @@ void FusionCache::deserialize(std::string filename) {
   // bfs_order is used to map indices in the structure field to their
   // corresponding TrieNode pointers. It is used to reconstruct the
   // terminal_nodes vector.
-  std::vector<TrieNode*> bfs_order;
+  std::vector<std::shared_ptr<TrieNode>> bfs_order;
 
   // Starting from the root node, we build the Trie structure in breadth-first
   // (BFS) order.
@@ -471,13 +842,13 @@ void FusionCache::deserialize(std::string filename) {
       TORCH_CHECK(
           trie_ptr->fusion_id == fb_trie_node->fusion_id(),
           "The fusion id for this TrieNode should already be set.")
-      Fusion* fusion =
-          queryFusionSchedules(fb_trie_node->fusion_id())->preschedFusion();
-      state->buildFusionIr(fusion);
+      trie_ptr->schedules = queryFusionSchedules(fb_trie_node->fusion_id());
+      state->buildFusionIr(trie_ptr->schedules->preschedFusion());
     }
 
     // Table TrieNode => Field: children: [ulong]
     // Create Children TrieNode
+    auto children = std::make_shared<TrieNode::ChildMap>();
     for (auto child_bfs_idx : *fb_trie_node->children()) {
       auto fb_child_trie_node =
           fusion_cache_buffer->structure()->Get(child_bfs_idx);
@@ -488,9 +859,9 @@ void FusionCache::deserialize(std::string filename) {
           record_functor_factory.parse(serde_buffer->type(), serde_buffer);
 
       // Deserialize the record and fusion id fields in the TrieNode table
-      auto status = trie_ptr->children.emplace(
+      auto status = children->emplace(
           rec,
-          std::make_unique<TrieNode>(
+          std::make_shared<TrieNode>(
               rec, trie_ptr, fb_child_trie_node->fusion_id()));
       TORCH_CHECK(
           status.second,
@@ -498,9 +869,10 @@ void FusionCache::deserialize(std::string filename) {
 
       // Add child TrieNode to BFS queue
       queue.emplace_back(
-          status.first->second.get() /* TrieNode pointer */, child_bfs_idx);
+          status.first->second /* TrieNode pointer */, child_bfs_idx);
       state_queue.emplace_back(state->clone());
     }
+    trie_ptr->setChildren(std::move(children));
 
     // Destroy current fusion state
     queue.pop_front();
@@ -508,8 +880,12 @@ void FusionCache::deserialize(std::string filename) {
   }
 
   // Deserialize terminal_nodes field in the FusionCache table
+  std::lock_guard<std::mutex> lru_guard(lru_lock_);
   for (auto idx : *fusion_cache_buffer->terminal_nodes()) {
-    terminal_nodes_.push_back(bfs_order.at(idx));
+    auto& terminal_node = bfs_order.at(idx);
+    terminal_nodes_.push_back(terminal_node);
+    terminal_node->lru_position = lru_.insert(lru_.end(), terminal_node.get());
+    terminal_node->in_lru = true;
   }
 }
 
@@ -11,11 +11,103 @@
 #include <kernel_cache.h>
 #include <python_frontend/fusion_record.h>
 
+#include <array>
+#include <atomic>
+#include <functional>
+#include <list>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
 
 namespace nvfuser::python_frontend {
 
+//! \class AppendOnlyVector
+//! \brief A vector that is only appended to and whose elements never move,
+//! so that readers can index it without locking while a writer appends.
+//!
+//! The elements are stored in chunks of doubling size that are never
+//! reallocated.  Appends are serialized by a lock, and an element is published
+//! to readers by the release store of the size after the element is written.
+template <typename T>
+class AppendOnlyVector {
+ public:
+  AppendOnlyVector() : size_(0) {
+    for (auto& chunk : chunks_) {
+      chunk.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+  AppendOnlyVector(const AppendOnlyVector&) = delete;
+  AppendOnlyVector& operator=(const AppendOnlyVector&) = delete;
+  ~AppendOnlyVector() {
+    for (auto& chunk : chunks_) {
+      delete[] chunk.load(std::memory_order_relaxed);
+    }
+  }
+
+  //! Thread-Safe: Number of elements visible to readers
+  size_t size() const {
+    return size_.load(std::memory_order_acquire);
+  }
+  bool empty() const {
+    return size() == 0;
+  }
+
+  //! Thread-Safe: Access an appended element.  Concurrent writes and reads of
+  //! the same element must be synchronized by the caller.
+  T& at(size_t index) {
+    return const_cast<T&>(std::as_const(*this).at(index));
+  }
+  const T& at(size_t index) const {
+    TORCH_CHECK(
+        index < size(),
+        "Index ",
+        index,
+        " is out of range of ",
+        size(),
+        " elements.");
+    auto [chunk, offset] = locate(index);
+    return chunks_[chunk].load(std::memory_order_acquire)[offset];
+  }
+
+  //! Thread-Safe: Appends an element and returns its index
+  size_t push_back(T value) {
+    std::lock_guard<std::mutex> guard(append_lock_);
+    auto index = size_.load(std::memory_order_relaxed);
+    auto [chunk, offset] = locate(index);
+    TORCH_CHECK(chunk < kNumChunks, "AppendOnlyVector is full!");
+    T* storage = chunks_[chunk].load(std::memory_order_relaxed);
+    if (storage == nullptr) {
+      storage = new T[kFirstChunkSize << chunk];
+      chunks_[chunk].store(storage, std::memory_order_release);
+    }
+    storage[offset] = std::move(value);
+    size_.store(index + 1, std::memory_order_release);
+    return index;
+  }
+
+ private:
+  //! Chunk c holds kFirstChunkSize * 2^c elements, starting at the element
+  //! kFirstChunkSize * (2^c - 1).
+  static std::pair<size_t, size_t> locate(size_t index) {
+    size_t chunk = 0;
+    size_t chunk_begin = 0;
+    while (index >= chunk_begin + (kFirstChunkSize << chunk)) {
+      chunk_begin += kFirstChunkSize << chunk;
+      ++chunk;
+    }
+    return {chunk, index - chunk_begin};
+  }
+
+  static constexpr size_t kFirstChunkSize = 16;
+  static constexpr size_t kNumChunks = 32;
+
+  std::array<std::atomic<T*>, kNumChunks> chunks_;
+  std::atomic<size_t> size_;
+  std::mutex append_lock_;
+};
+
 //! \struct UserSchedule
 //! \brief A container to hold a scheduled Fusion IR as well as an executor
 //! to contain the corresponding generated kernel.
@@ -33,7 +125,11 @@ struct UserSchedule {
 //! that correspond to compiled kernels for each complete Fusion Definition.
 struct FusionSchedules {
   FusionSchedules();
+  //! Drops the kernels in CompiledKernelCache only this fusion used
+  ~FusionSchedules();
   Fusion* preschedFusion();
+  //! Number of compiled kernels and the bytes of their CUDA source
+  std::pair<size_t, size_t> compiledKernels();
 
   //! Schedules Automatically generated by nvFuser for dynamic inputs. (default)
   //! NOTE: The FusionExecutorCache also holds the Unscheduled Fusion IR
@@ -49,7 +145,16 @@ struct FusionSchedules {
   //! Keeps a pointer to the last executed executor for printing its cuda kernel
   FusionExecutor* last_user_def_executor;
   //! For thread-Safe locking of Fusion Schedules
-  std::mutex scheds_lock;
+  mutable std::mutex scheds_lock;
+  //! For thread-Safe execution of the schedules, as executors and the
+  //! FusionExecutorCache can't run the same fusion concurrently
+  std::mutex exec_lock;
+  //! Id of the fusion in the FusionCache, see FusionCache::fusionSlot
+  size_t fusion_id;
+  //! Set when the fusion is evicted from the FusionCache, which no longer
+  //! returns the schedules.  The schedules, and their kernels, are released
+  //! once no FusionDefinition refers to them.
+  std::atomic<bool> evicted;
 };
 
 //! \struct TrieNode
@@ -58,14 +163,25 @@ struct FusionSchedules {
 //! the leaf Nodes represent a complete Fusion that is cached.
 
 struct TORCH_CUDA_CU_API TrieNode {
+  //! A hash map of children.  The hash map hashes a pointer to a RecordFunctor
+  //! because the hash function is virtual.
+  using ChildMap =
+      std::unordered_map<RecordFunctor*, std::shared_ptr<TrieNode>>;
+
   TrieNode(
       RecordFunctor* rec,
-      TrieNode* _parent = nullptr,
+      std::shared_ptr<TrieNode> _parent = nullptr,
       size_t _fusion_id = 0);
 
   // Queries whether the entry denotes a leaf node which also represents
   // a the end of Fusion entry in the cache.
   bool isTerminal() const;
+  //! Thread-Safe: Returns the current table of children, which is immutable
+  std::shared_ptr<const ChildMap> children() const;
+  //! Replaces the table of children.  Writers must hold the trie_node_lock.
+  void setChildren(std::shared_ptr<const ChildMap> children);
+  //! Queries whether the fusion of a terminal node was evicted
+  bool isEvicted() const;
   //! Serialize TrieNode using flatbuffers
   flatbuffers::Offset<serde::TrieNode> serialize(
       flatbuffers::FlatBufferBuilder& builder,
@@ -74,19 +190,32 @@ struct TORCH_CUDA_CU_API TrieNode {
 
   //! An entry's primary data is the record it holds
   std::unique_ptr<RecordFunctor> record;
-  //! A hash map of the children for the current node.
-  //! The hash map hashes a pointer to a RecordFunctor because
-  //! the hash function is virtual.
-  std::unordered_map<RecordFunctor*, std::unique_ptr<TrieNode>> children;
   //! An index into FusionCache's vector of nvFuser object that holds an
   //! unscheduled Fusion.  The id is only valid if the entry is terminal.
   size_t fusion_id;
+  //! The schedules of the Fusion of a terminal entry, null otherwise
+  std::shared_ptr<FusionSchedules> schedules;
   //! Count of times the Entry is traversed
-  size_t visits;
-  //! Parent node for printing
-  TrieNode* parent;
+  std::atomic<size_t> visits;
+  //! Position of a terminal entry in the FusionCache's recency list, only
+  //! valid while in_lru is set.  Both are guarded by the FusionCache's
+  //! lru_lock_.
+  std::list<TrieNode*>::iterator lru_position;
+  bool in_lru;
+  //! Parent node for printing.  Holding a node keeps the records of its
+  //! definition alive after an eviction pruned it from the trie.
+  std::shared_ptr<TrieNode> parent;
   //! For thread-Safe locking of a node
   std::mutex trie_node_lock;
+  //! Set under the trie_node_lock when an eviction removes the node from the
+  //! trie.  No children are created under a pruned node.
+  bool pruned;
+
+ private:
+  //! The children of the current node.  Readers never lock, a child is
+  //! inserted by copying the table and atomically swapping in the copy.
+  //! Readers holding the previous table keep its nodes alive.
+  std::shared_ptr<const ChildMap> children_;
 };
 
 //! \class FusionCache
@@ -97,16 +226,23 @@ struct TORCH_CUDA_CU_API TrieNode {
 //! cache fusions.  A leaf of the tree with a terminal node contains a
 //! container for caching the kernels generated for specific fusions.
 //!
-//! \todo
-//! Add the ability to evict a fusion.  There is currently a max number
-//! of fusions that is checked to prevent a runaway case.
+//! When the cache holds max_fusions fusions, creating a fusion evicts the
+//! least visited fusion among the least recently visited ones.  The terminal
+//! node of the evicted fusion, and the ancestors left without children, are
+//! pruned from the trie.  The slot of the fusion is reused under a new fusion
+//! id, and the schedules and their kernels are released once no
+//! FusionDefinition refers to them.
 //!
 //! \note
-//! Thread-Safety is assured by the Python GIL.  If a no-GIL python is used
-//! then further scrutiny needs to be applied to the mutexes used to limit
-//! acccess to the singleton pointer, node creation, and user schedule
-//! creation.  Otherwise, the Python GIL provides a natural thread based mutex
-//! that does not allow for multiple threads to interact.
+//! Thread-Safety: Cache lookups never block, a lookup that finds the recency
+//! list locked doesn't move its fusion to the front.  The children of a trie
+//! node are an immutable table that is replaced as a whole when a child is
+//! created under the node's lock, and the fusions are held by append-only
+//! vectors.
+//! The Fusion IR of a new terminal node is built before the node is visible
+//! to other threads.  Trie nodes and schedules are shared, so that holding a
+//! node keeps it valid after an eviction.  Reset and (de)serialization are
+//! not thread-safe.
 
 class TORCH_CUDA_CU_API FusionCache {
   //! The constructor is private given the FusionCache is only constructed
@@ -118,12 +254,15 @@ class TORCH_CUDA_CU_API FusionCache {
   //! clang-tidy: deleted member function should be public
   FusionCache(const FusionCache&) = delete;
   FusionCache& operator=(const FusionCache&) = delete;
+  ~FusionCache();
 
   //! The next 4 public methods are the python interface methods
 
-  //! Gets a pointer to the singleton and creates a new one if necessary
-  static FusionCache* get(size_t max_fusions = 8192);
-  //! Number of fusions cached
+  //! Gets a pointer to the singleton and creates a new one if necessary.  If
+  //! given, max_fusions replaces the max allowed number of fusions, and the
+  //! fusions above a smaller max are evicted.
+  static FusionCache* get(c10::optional<size_t> max_fusions = c10::nullopt);
+  //! Number of fusions cached, not counting evicted fusions
   size_t numFusions() const;
   //! print cache contents
   void print(std::ostream& os) const;
@@ -138,49 +277,121 @@ class TORCH_CUDA_CU_API FusionCache {
 
   //! The rest of the public methods are only used in C++
 
-  //! Thread-Unsafe: Queries the current trie node to see if a record matches
-  //! one of its children
-  c10::optional<TrieNode*> queryChildren(TrieNode* node, RecordFunctor* rec)
-      const;
-  //! Query a Fusion's Schedules based on fusion id or cache id
-  FusionSchedules* queryFusionSchedules(size_t fusion_id) const;
+  //! Thread-Safe: Queries the current trie node to see if a record matches
+  //! one of its children.  A terminal child of an evicted fusion is a miss.
+  c10::optional<std::shared_ptr<TrieNode>> queryChildren(
+      const std::shared_ptr<TrieNode>& node,
+      RecordFunctor* rec);
+  //! Query a Fusion's Schedules based on fusion id.  The id of an evicted
+  //! fusion is an error, even if a newer fusion took over its slot.
+  std::shared_ptr<FusionSchedules> queryFusionSchedules(
+      size_t fusion_id) const;
   //! Lookup the User Schedule Id and return null if one does not exist.
   //! NOTE: this method cannot be const because the InputsIdLookup can
   //! cause a modification to that data member for cache eviction.
   c10::optional<size_t> queryUserScheduleId(
       const FusionSchedules* scheds,
-      const at::ArrayRef<c10::IValue>& inputs);
+      const KernelArgumentHolder& args);
   //! Lookup the User Schedule based on Id
   const UserSchedule& queryUserSchedule(
       const FusionSchedules* scheds,
       size_t id,
       int device) const;
-  //! Thread-Safe: Creates a child node for the current cache entry and an
-  //! optional fusion_id is returned if the new entry is terminal
-  TrieNode* createChild(TrieNode* node, RecordFunctor* rec);
+  //! Thread-Safe: Creates a child node for the current cache entry, or returns
+  //! the child another thread created for the same record.  A new terminal
+  //! entry gets a fusion_id, and its Fusion IR is built by build_fusion_ir
+  //! before the entry is visible to other threads.  Returns null if an
+  //! eviction pruned the current entry, in which case the definition needs to
+  //! be walked again from the root.
+  std::shared_ptr<TrieNode> createChild(
+      const std::shared_ptr<TrieNode>& node,
+      RecordFunctor* rec,
+      const std::function<void(Fusion*)>& build_fusion_ir = nullptr);
   //! Lookup the User Schedule based on Id
   UserSchedule* createUserSchedule(
       FusionSchedules* scheds,
       const at::ArrayRef<c10::IValue>& inputs,
       int device);
   //! Get the root Trie ptr
-  TrieNode* rootTriePtr();
+  std::shared_ptr<TrieNode> rootTriePtr();
+
+  //! Thread-Safe: Look up the terminal node recorded for a definition key,
+  //! null on a miss.  A hit counts as a visit of the whole definition in the
+  //! cache stats.
+  std::shared_ptr<TrieNode> queryDefinitionKey(const std::string& key);
+  //! Thread-Safe: Record the terminal node of a complete definition for a key
+  void recordDefinitionKey(
+      const std::string& key,
+      const std::shared_ptr<TrieNode>& terminal);
 
  private:
+  //! Index of a fusion id in fusions_ and terminal_nodes_.  The upper bits
+  //! of the id count the fusions that previously took the slot, so the id of
+  //! an evicted fusion never refers to the fusion that reuses its slot.
+  static size_t fusionSlot(size_t fusion_id);
+  //! Thread-Safe: Counts a visit of a terminal node and moves it to the front
+  //! of the recency list, unless another thread holds the list
+  void visitTerminal(TrieNode* node);
+  //! Thread-Safe: Reserves an id for a new fusion, nullopt if the cache is
+  //! full
+  c10::optional<size_t> tryAcquireFusionId();
+  //! Thread-Safe: Evicts a fusion and frees its slot, unless the cache holds
+  //! fewer than max_fusions fusions
+  void evictFusion();
+  //! Thread-Safe: Frees the slot of a fusion that is no longer cached
+  void releaseFusionId(size_t fusion_id);
+  //! Selects the fusion to evict and removes it from the recency list, null
+  //! if none is resident.  The caller must hold the fusions_lock_.
+  std::shared_ptr<TrieNode> selectEvictionVictim();
+  //! Thread-Safe: Removes the terminal node of an evicted fusion from the
+  //! trie, along with the ancestors that are left without children, and
+  //! drops its definition keys
+  void pruneEvicted(std::shared_ptr<TrieNode> terminal);
+
   //! The static pointer to the FusionCache
   static FusionCache* singleton_;
   //! Lock for accessing the singleton by multiple threads
   static std::mutex singleton_lock_;
 
   //! The max allowed number of fusions in the cache
-  size_t max_fusions_;
+  std::atomic<size_t> max_fusions_;
   //! The root (start) of the prefix tree to start a cache look up of a given
   //! fusion definition.
-  std::unique_ptr<TrieNode> root_;
-  //! A vector of nvFuser Fusion IR fusions.
-  std::vector<std::unique_ptr<FusionSchedules>> fusions_;
-  //! A vector of Terminal trie nodes for Stats collection
-  std::vector<TrieNode*> terminal_nodes_;
+  std::shared_ptr<TrieNode> root_;
+  //! A vector of nvFuser Fusion IR fusions indexed by fusion slot.  The
+  //! entries are accessed atomically, and are null for evicted fusions.
+  AppendOnlyVector<std::shared_ptr<FusionSchedules>> fusions_;
+  //! A vector of Terminal trie nodes for Stats collection, accessed like
+  //! fusions_
+  AppendOnlyVector<std::shared_ptr<TrieNode>> terminal_nodes_;
+  //! Ids the next fusion taking the slot of an evicted fusion gets
+  std::vector<size_t> free_fusion_ids_;
+  //! Guards the reservation of fusion ids and the eviction of fusions
+  std::mutex fusions_lock_;
+  //! Number of fusions that are reserved or cached
+  std::atomic<size_t> num_fusions_;
+  //! Number of fusions evicted
+  std::atomic<size_t> num_evictions_;
+  //! Terminal nodes of the cached fusions, from the most to the least
+  //! recently visited
+  std::list<TrieNode*> lru_;
+  //! Guards lru_ and the positions of the terminal nodes in it.  Taken after
+  //! the fusions_lock_.
+  std::mutex lru_lock_;
+
+  //! Definition-level keys that map straight to a terminal node, so a repeated
+  //! definition can skip the record by record trie walk. The keys are opaque
+  //! to the cache, the user is responsible for a key identifying a single
+  //! definition.
+  //! Like the children of a trie node, the map is immutable and replaced as a
+  //! whole when a key is recorded.
+  using DefinitionKeyMap =
+      std::unordered_map<std::string, std::shared_ptr<TrieNode>>;
+  std::shared_ptr<const DefinitionKeyMap> definition_keys_;
+  //! Number of lookups that hit a definition key
+  std::atomic<size_t> definition_key_hits_;
+  //! For thread-Safe recording of the definition keys
+  std::mutex definition_keys_lock_;
 
   //! Items specifically to aid user defined schedules these data members
   //! are for the mechanics of user schedule usage and don't make sense as
@@ -190,6 +401,8 @@ class TORCH_CUDA_CU_API FusionCache {
   // NOTE: I would prefer this be per FusionSchedules object but the container
   // is not allowed to be copied or moved.
   InputsIdLookup user_def_input_encodings_;
+  //! For thread-Safe locking of the input encodings
+  std::mutex user_def_input_encodings_lock_;
 };
 
 } // namespace nvfuser::python_frontend
@@ -50,6 +50,11 @@ FusionDefinition::FusionDefinition(c10::optional<size_t> id, size_t max_length)
       fusion_id_(id),
       fusion_cache_(FusionCache::get()),
       trie_node_(nullptr),
+      scheds_(nullptr),
+      defined_by_key_(false),
+      num_inputs_(0),
+      parameters_(),
+      collect_lower_pass_stats_(false),
       prev_fusion_(nullptr),
       user_sched_(nullptr),
       ops(this),
@@ -61,6 +66,47 @@ FusionCache* FusionDefinition::fusionCache() const {
   return fusion_cache_;
 }
 
+FusionSchedules* FusionDefinition::fusionSchedules() const {
+  return schedules().get();
+}
+
+std::shared_ptr<FusionSchedules> FusionDefinition::schedules() const {
+  TORCH_CHECK(id().has_value(), "FusionDefinition definition does not exist!");
+  if (scheds_ == nullptr) {
+    scheds_ = fusionCache()->queryFusionSchedules(id().value());
+  }
+  return scheds_;
+}
+
+std::shared_ptr<TrieNode> FusionDefinition::createTrieNode(
+    RecordFunctor* rec,
+    const std::function<void(Fusion*)>& build_fusion_ir) {
+  auto child_node =
+      fusionCache()->createChild(trie_node_, rec, build_fusion_ir);
+  while (child_node == nullptr) {
+    // An eviction pruned the current node from the trie, so the records that
+    // precede rec are walked again from the root.
+    if (isDebugDumpEnabled(DebugDumpOption::PythonFrontendDebug)) {
+      std::cout << "\nFusionDefinition: Trie node was evicted, walking the "
+                << "definition again.\n";
+    }
+    trie_node_ = fusionCache()->rootTriePtr();
+    for (auto& record : recording_) {
+      if (trie_node_ == nullptr || record.get() == rec) {
+        break;
+      }
+      auto node = fusionCache()->queryChildren(trie_node_, record.get());
+      trie_node_ = node.has_value()
+          ? node.value()
+          : fusionCache()->createChild(trie_node_, record.get());
+    }
+    if (trie_node_ != nullptr) {
+      child_node = fusionCache()->createChild(trie_node_, rec, build_fusion_ir);
+    }
+  }
+  return child_node;
+}
+
 FusionDefinition* FusionDefinition::setupDefinition() {
   TORCH_CHECK(max_length_ > 0, "Can't make a FusionDefinition with 0 records!");
   TORCH_CHECK(!id().has_value(), "Fusion Schedule is already found!");
@@ -75,17 +121,23 @@ void FusionDefinition::finalizeDefinition() {
     if (isDebugDumpEnabled(DebugDumpOption::PythonFrontendDebug)) {
       std::cout << "\nFusionDefinition: Terminal Node not found.\n";
     }
-    trie_node_ = fusionCache()->createChild(trie_node_, end_record_.get());
+    // Another thread may create the terminal node first, in which case the
+    // Fusion IR built here is discarded
+    Fusion* built_fusion = nullptr;
+    trie_node_ = createTrieNode(end_record_.get(), [&](Fusion* fusion) {
+      buildFusionIr(fusion);
+      built_fusion = fusion;
+    });
     fusion_id_ = c10::optional<size_t>(trie_node_->fusion_id);
+    scheds_ = trie_node_->schedules;
     TORCH_CHECK(id().has_value(), "Invalid fusion id!");
 
     if (isDebugDumpEnabled(DebugDumpOption::PythonDefinition)) {
       print(std::cout);
     }
 
-    buildFusionIr(preschedFusion());
-
-    if (isDebugDumpEnabled(DebugDumpOption::FusionIrPresched)) {
+    if (built_fusion == preschedFusion() &&
+        isDebugDumpEnabled(DebugDumpOption::FusionIrPresched)) {
       printIr();
     }
   } else {
@@ -94,18 +146,58 @@ void FusionDefinition::finalizeDefinition() {
     }
     trie_node_ = child_node.value();
     fusion_id_ = c10::optional<size_t>(trie_node_->fusion_id);
+    scheds_ = trie_node_->schedules;
+  }
+}
+
+bool FusionDefinition::setupDefinitionFromKey(const std::string& key) {
+  FUSER_PERF_SCOPE("FusionDefinition::setupDefinitionFromKey");
+  TORCH_CHECK(!id().has_value(), "Fusion Schedule is already found!");
+  TORCH_CHECK(
+      recording_.empty(), "The definition has already started recording!");
+  auto terminal_node = fusionCache()->queryDefinitionKey(key);
+  if (terminal_node == nullptr) {
+    return false;
   }
+  if (isDebugDumpEnabled(DebugDumpOption::PythonFrontendDebug)) {
+    std::cout << "\nFusionDefinition: Definition key hit in Fusion Cache.\n";
+  }
+  trie_node_ = terminal_node;
+  fusion_id_ = c10::optional<size_t>(trie_node_->fusion_id);
+  scheds_ = trie_node_->schedules;
+  defined_by_key_ = true;
+  return true;
+}
+
+void FusionDefinition::recordDefinitionKey(const std::string& key) {
+  TORCH_CHECK(id().has_value(), "FusionDefinition definition does not exist!");
+  TORCH_CHECK(
+      trie_node_ != nullptr && trie_node_->isTerminal(),
+      "Only a definition walked through the FusionCache can record a key!");
+  // The key doesn't capture the values of parameterized constants, so such a
+  // definition is always recorded and reaches its Fusion through the trie.
+  if (!parameters_.empty()) {
+    return;
+  }
+  fusionCache()->recordDefinitionKey(key, trie_node_);
 }
 
 void FusionDefinition::setupSchedule(const at::ArrayRef<c10::IValue>& inputs) {
   FUSER_PERF_SCOPE("FusionDefinition::setupSchedule");
   TORCH_CHECK(id().has_value(), "FusionDefinition definition does not exist!");
-  auto scheds = fusionCache()->queryFusionSchedules(id().value());
-  auto device = getCommonDeviceCUDA(inputs);
   TORCH_CHECK(
-      inputs.empty() || device > -1, "Inputs are not all on the same device!");
+      !defined_by_key_,
+      "A definition looked up by key has no records to schedule!");
+  auto scheds = fusionSchedules();
+  std::vector<c10::IValue> storage;
+  auto fusion_inputs = fusionInputs(inputs, storage);
+  auto device = getCommonDeviceCUDA(fusion_inputs);
+  TORCH_CHECK(
+      fusion_inputs.empty() || device > -1,
+      "Inputs are not all on the same device!");
   TORCH_CHECK(user_sched_ == nullptr, "Expected User Scheduler to be null!");
-  user_sched_ = fusionCache()->createUserSchedule(scheds, inputs, device);
+  user_sched_ =
+      fusionCache()->createUserSchedule(scheds, fusion_inputs, device);
 
   // Building a new Fusion container for scheduling with definition such that
   // the definition's tensor data members refer to the corresponding IR objects
@@ -125,7 +217,10 @@ void FusionDefinition::finalizeSchedule(
   FusionGuard::setCurFusion(prev_fusion_);
   prev_fusion_ = nullptr;
 
-  user_sched_->executor->compileFusion(user_sched_->schedule.get(), inputs);
+  std::vector<c10::IValue> storage;
+  user_sched_->executor->setCollectLowerPassStats(collect_lower_pass_stats_);
+  user_sched_->executor->compileFusion(
+      user_sched_->schedule.get(), fusionInputs(inputs, storage));
   user_sched_ = nullptr;
 }
 
@@ -137,10 +232,26 @@ void FusionDefinition::print(std::ostream& os) const {
   }
   os << "(fd : FusionDefinition) -> None :\n";
   os << std::dec;
-  for (auto& rec : recording_) {
-    os << "    ";
-    rec->print(os);
-    os << "\n";
+  if (defined_by_key_) {
+    // The records of a definition looked up by key are only held by the trie
+    std::vector<RecordFunctor*> records;
+    for (TrieNode* node = trie_node_->parent.get(); node != nullptr;
+         node = node->parent.get()) {
+      if (node->record->recordType() != serde::RecordType_Start) {
+        records.push_back(node->record.get());
+      }
+    }
+    std::for_each(records.rbegin(), records.rend(), [&os](auto rec) {
+      os << "    ";
+      rec->print(os);
+      os << "\n";
+    });
+  } else {
+    for (auto& rec : recording_) {
+      os << "    ";
+      rec->print(os);
+      os << "\n";
+    }
   }
   os << std::endl;
 }
@@ -151,25 +262,35 @@ std::vector<at::Tensor> FusionDefinition::execute(
     std::optional<int8_t> selected_device) const {
   TORCH_CHECK(id().has_value(), "Valid fusion schedule is not available!");
 
-  auto scheds = fusionCache()->queryFusionSchedules(id().value());
+  auto scheds = fusionSchedules();
+  std::lock_guard<std::mutex> guard(scheds->exec_lock);
+  if (collect_lower_pass_stats_) {
+    scheds->auto_gen_schedules->collectLowerPassStats(true);
+  }
+
+  // The inputs are only walked here.  The common device, the schedule lookups
+  // and the kernels read the arguments captured from them.
+  std::vector<c10::IValue> storage;
+  auto fusion_inputs = fusionInputs(inputs, storage);
+  KernelArgumentHolder args = KernelArgumentHolder::createKernelArgumentHolder(
+      fusion_inputs, selected_device);
 
   if (!override_user_schedule) {
-    auto device = getCommonDeviceCUDA(inputs, selected_device);
+    auto device = args.getDeviceIndex();
     TORCH_CHECK(
-        inputs.empty() || device > -1,
+        fusion_inputs.empty() || device > -1,
         "Inputs are not all on the same device or don't match selection!");
-    auto user_sched_id = fusionCache()->queryUserScheduleId(scheds, inputs);
+    auto user_sched_id = fusionCache()->queryUserScheduleId(scheds, args);
     if (user_sched_id.has_value()) {
       auto& user_sched = fusionCache()->queryUserSchedule(
           scheds, user_sched_id.value(), device);
       scheds->last_user_def_scheduled_ir = user_sched.schedule.get();
       scheds->last_user_def_executor = user_sched.executor.get();
-      return user_sched.executor->runFusion(inputs);
+      return user_sched.executor->runFusion(args);
     }
   }
 
-  return scheds->auto_gen_schedules->runFusionWithInputs(
-      inputs, std::nullopt, selected_device);
+  return scheds->auto_gen_schedules->runFusionWithArgs(args);
 }
 
 std::string FusionDefinition::fusionIr() {
@@ -184,13 +305,12 @@ std::string FusionDefinition::lastCudaCode(
     bool override_user_schedule) const {
   std::string result;
   TORCH_CHECK(id().has_value(), "Invalid fusion definition!");
-  auto scheds = fusionCache()->queryFusionSchedules(id().value());
+  auto scheds = fusionSchedules();
   auto user_exec = scheds->last_user_def_executor;
 
   if (!override_user_schedule && (user_exec != nullptr)) {
     if (intrinsic_code) {
-      result = user_exec->getStructuredCode(
-          user_exec->kernelString(), user_exec->kernel()->indexType());
+      result = user_exec->getStructuredCode();
     } else {
       result = user_exec->kernelString();
     }
@@ -205,27 +325,30 @@ std::string FusionDefinition::cudaCodeFor(
     bool intrinsic_code,
     bool override_user_schedule) const {
   TORCH_CHECK(id().has_value(), "Invalid fusion definition!");
-  auto scheds = fusionCache()->queryFusionSchedules(id().value());
+  auto scheds = fusionSchedules();
+
+  std::vector<c10::IValue> storage;
+  auto fusion_inputs = fusionInputs(inputs, storage);
 
   if (!override_user_schedule) {
-    auto device = getCommonDeviceCUDA(inputs);
+    auto args = KernelArgumentHolder::createKernelArgumentHolder(fusion_inputs);
+    auto device = args.getDeviceIndex();
     TORCH_CHECK(
-        inputs.empty() || device > -1,
+        fusion_inputs.empty() || device > -1,
         "Inputs are not all on the same device!");
-    auto user_sched_id = fusionCache()->queryUserScheduleId(scheds, inputs);
+    auto user_sched_id = fusionCache()->queryUserScheduleId(scheds, args);
     if (user_sched_id.has_value()) {
       auto& user_sched = fusionCache()->queryUserSchedule(
           scheds, user_sched_id.value(), device);
       auto user_exec = user_sched.executor.get();
       if (intrinsic_code) {
-        return user_exec->getStructuredCode(
-            user_exec->kernelString(), user_exec->kernel()->indexType());
+        return user_exec->getStructuredCode();
       } else {
         return user_exec->kernelString();
       }
     }
   }
-  return scheds->auto_gen_schedules->getCodeFor(inputs, intrinsic_code);
+  return scheds->auto_gen_schedules->getCodeFor(fusion_inputs, intrinsic_code);
 }
 
 std::string FusionDefinition::lastScheduledFusionIr(
@@ -233,7 +356,7 @@ std::string FusionDefinition::lastScheduledFusionIr(
     bool override_user_schedule) const {
   std::string result;
   TORCH_CHECK(id().has_value(), "Invalid fusion definition!");
-  auto scheds = fusionCache()->queryFusionSchedules(id().value());
+  auto scheds = fusionSchedules();
   auto user_sched_ir = scheds->last_user_def_scheduled_ir;
 
   if (!override_user_schedule && (user_sched_ir != nullptr)) {
@@ -252,14 +375,18 @@ std::string FusionDefinition::scheduledFusionIrFor(
     bool tensor_transforms,
     bool override_user_schedule) const {
   TORCH_CHECK(id().has_value(), "Invalid fusion definition!");
-  auto scheds = fusionCache()->queryFusionSchedules(id().value());
+  auto scheds = fusionSchedules();
+
+  std::vector<c10::IValue> storage;
+  auto fusion_inputs = fusionInputs(inputs, storage);
 
   if (!override_user_schedule) {
-    auto device = getCommonDeviceCUDA(inputs);
+    auto args = KernelArgumentHolder::createKernelArgumentHolder(fusion_inputs);
+    auto device = args.getDeviceIndex();
     TORCH_CHECK(
-        inputs.empty() || device > -1,
+        fusion_inputs.empty() || device > -1,
         "Inputs are not all on the same device!");
-    auto user_sched_id = fusionCache()->queryUserScheduleId(scheds, inputs);
+    auto user_sched_id = fusionCache()->queryUserScheduleId(scheds, args);
     if (user_sched_id.has_value()) {
       auto& user_sched = fusionCache()->queryUserSchedule(
           scheds, user_sched_id.value(), device);
@@ -270,7 +397,19 @@ std::string FusionDefinition::scheduledFusionIrFor(
     }
   }
   return scheds->auto_gen_schedules->getScheduledIrFor(
-      inputs, tensor_transforms);
+      fusion_inputs, tensor_transforms);
+}
+
+std::string FusionDefinition::lastLowerPassStats(
+    bool override_user_schedule) const {
+  TORCH_CHECK(id().has_value(), "Invalid fusion definition!");
+  auto scheds = fusionSchedules();
+  auto user_exec = scheds->last_user_def_executor;
+
+  if (!override_user_schedule && (user_exec != nullptr)) {
+    return "[\n" + lowerPassStatsToJson(user_exec->lowerPassStats()) + "\n]";
+  }
+  return scheds->auto_gen_schedules->getMostRecentLowerPassStats();
 }
 
 c10::optional<size_t> FusionDefinition::id() const {
@@ -300,6 +439,10 @@ void FusionDefinition::defineRecord(RecordFunctor* record) {
       "operations.  The max_length for FusionDefintion's might need to be ",
       "increased if the definition is created as expected.");
   addRecord(record);
+  if (record->recordType() == serde::RecordType_Tensor ||
+      record->recordType() == serde::RecordType_Scalar) {
+    ++num_inputs_;
+  }
   auto child_node =
       fusionCache()->queryChildren(trie_node_, recording_.back().get());
   // If the Record is found in the cache, the FusionDefinition and the Cache
@@ -317,18 +460,46 @@ void FusionDefinition::defineRecord(RecordFunctor* record) {
       std::cout << "\nFusionDefinition: Record (hash: 0x" << std::hex
                 << record->hash() << ") missed in Fusion Cache.\n";
     }
-    trie_node_ =
-        fusionCache()->createChild(trie_node_, recording_.back().get());
+    trie_node_ = createTrieNode(recording_.back().get());
+  }
+}
+
+void FusionDefinition::defineParameter(const c10::IValue& value) {
+  TORCH_CHECK(
+      !id().has_value(), "Attempting to add to a completed definition!");
+  parameters_.emplace_back(num_inputs_++, value);
+}
+
+at::ArrayRef<c10::IValue> FusionDefinition::fusionInputs(
+    const at::ArrayRef<c10::IValue>& inputs,
+    std::vector<c10::IValue>& storage) const {
+  if (parameters_.empty()) {
+    return inputs;
+  }
+  TORCH_CHECK(
+      inputs.size() + parameters_.size() == num_inputs_,
+      "Expected ",
+      num_inputs_ - parameters_.size(),
+      " inputs, but got ",
+      inputs.size(),
+      "!");
+  storage.reserve(num_inputs_);
+  auto input = inputs.begin();
+  for (const auto& [position, value] : parameters_) {
+    while (storage.size() < position) {
+      storage.push_back(*input++);
+    }
+    storage.push_back(value);
   }
+  storage.insert(storage.end(), input, inputs.end());
+  return storage;
 }
 
 Fusion* FusionDefinition::preschedFusion() {
   TORCH_CHECK(
       fusion_id_.has_value(),
       "FusionDefinition does not contain a definition, yet!");
-  return fusionCache()
-      ->queryFusionSchedules(fusion_id_.value())
-      ->preschedFusion();
+  return fusionSchedules()->preschedFusion();
 }
 
 void FusionDefinition::printMathIr() {
@@ -6,7 +6,11 @@
  */
 // clang-format on
 #pragma once
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include <c10/macros/Export.h>
 #include <kernel_cache.h>
@@ -18,6 +22,7 @@ class FusionCache;
 class FusionDefinition;
 class FusionInterface;
 class FusionState;
+struct FusionSchedules;
 struct RecordFunctor;
 struct UserSchedule;
 struct TrieNode;
@@ -113,6 +118,13 @@ class TORCH_CUDA_CU_API FusionDefinition : public FusionState {
   //! Exit Python Context Manager -- Triggers Fusion IR build if it is not
   //! cached
   void finalizeDefinition();
+  //! Look up a complete definition by a definition-level key instead of
+  //! recording it. Returns true on a hit, in which case the definition is
+  //! complete and must not be recorded.
+  bool setupDefinitionFromKey(const std::string& key);
+  //! Associate a key with the Fusion of a finalized definition so that
+  //! setupDefinitionFromKey can find it.
+  void recordDefinitionKey(const std::string& key);
   //! Setup user scheduling of a fusion
   //! Copies fusion object and sets up FusionGuard
   void setupSchedule(const at::ArrayRef<c10::IValue>& inputs);
@@ -145,8 +157,26 @@ class TORCH_CUDA_CU_API FusionDefinition : public FusionState {
       const at::ArrayRef<c10::IValue>& inputs,
       bool tensor_transforms,
       bool override_user_schedule) const;
+  //! Return the per-pass lowering statistics of the last executed set of
+  //! inputs as JSON, with one array of passes per kernel. The arrays are
+  //! empty unless the kernels collected them, see collectLowerPassStats.
+  std::string lastLowerPassStats(bool override_user_schedule) const;
+  //! Collect the per-pass lowering statistics of the kernels compiled by
+  //! later user schedules and executions. The lower_pass_stats dump option
+  //! collects them for all kernels.
+  void collectLowerPassStats(bool collect) {
+    collect_lower_pass_stats_ = collect;
+  }
   //! Return fusion id of defined FusionDefinition
   c10::optional<size_t> id() const;
+  //! Returns the schedules of the defined Fusion, which stay usable after the
+  //! FusionCache evicted the Fusion
+  std::shared_ptr<FusionSchedules> schedules() const;
+  //! Values of the parameterized constants, with the position of the Fusion
+  //! input each one is passed as, in increasing order of position
+  const std::vector<std::pair<size_t, c10::IValue>>& parameters() const {
+    return parameters_;
+  }
   //! Prints the Prescheduled Fusion IR representation
   void printMathIr();
 
@@ -163,14 +193,30 @@ class TORCH_CUDA_CU_API FusionDefinition : public FusionState {
   //! Defines a Record that records the operation required to
   //! build the corresponding Fusion IR operation on cache miss.
   void defineRecord(RecordFunctor* record);
+  //! Records the value of a parameterized constant.  The constant's record,
+  //! defined next, passes it to the Fusion as an input.
+  void defineParameter(const c10::IValue& value);
   //! Gets a Record State object
   State recordingState(size_t index) const;
 
  private:
   //! Returns the FusionCache Ptr that holds the cache of Fusions
   FusionCache* fusionCache() const;
+  //! Returns the schedules of the defined Fusion
+  FusionSchedules* fusionSchedules() const;
+  //! Creates a child of the current trie node.  The definition is walked
+  //! again from the root if an eviction pruned the current node.
+  std::shared_ptr<TrieNode> createTrieNode(
+      RecordFunctor* rec,
+      const std::function<void(Fusion*)>& build_fusion_ir = nullptr);
   //! Return a prescheduled Fusion object
   Fusion* preschedFusion();
+  //! Returns the inputs of the Fusion, which are the user inputs with the
+  //! values of the parameterized constants inserted.  storage holds them if
+  //! the definition has parameters.
+  at::ArrayRef<c10::IValue> fusionInputs(
+      const at::ArrayRef<c10::IValue>& inputs,
+      std::vector<c10::IValue>& storage) const;
 
   //! Holds the defined maximum length of a FusionDefinition in order to
   //! prevent a run away error. The user should feel free to increase this
@@ -181,7 +227,19 @@ class TORCH_CUDA_CU_API FusionDefinition : public FusionState {
   //! A pointer to the FusionCache.
   FusionCache* fusion_cache_;
   //! Current pointer to node in FusionCache.
-  TrieNode* trie_node_;
+  std::shared_ptr<TrieNode> trie_node_;
+  //! Schedules of the defined Fusion.  Holding them keeps the Fusion usable
+  //! after the FusionCache evicted it.
+  mutable std::shared_ptr<FusionSchedules> scheds_;
+  //! The definition was looked up by key and holds no records
+  bool defined_by_key_;
+  //! Number of Fusion inputs defined by the recorded records
+  size_t num_inputs_;
+  //! Values of the parameterized constants, with the position of the Fusion
+  //! input each one is passed as
+  std::vector<std::pair<size_t, c10::IValue>> parameters_;
+  //! Kernels compiled for this definition collect lowering pass statistics
+  bool collect_lower_pass_stats_;
 
   // Book keeping data members for user created schedules
 
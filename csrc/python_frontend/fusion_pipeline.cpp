@@ -0,0 +1,181 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <instrumentation.h>
+#include <python_frontend/fusion_cache.h>
+#include <python_frontend/fusion_pipeline.h>
+
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+// Require namespace for perf scope instrumentation
+using namespace nvfuser::inst;
+
+namespace nvfuser::python_frontend {
+
+FusionPipeline::FusionPipeline(
+    std::vector<PipelineStep> steps,
+    std::vector<PipelineValue> outputs,
+    Launcher launcher)
+    : steps_(std::move(steps)),
+      outputs_(std::move(outputs)),
+      launcher_(std::move(launcher)),
+      schedules_(),
+      used_outputs_(steps_.size()),
+      releases_(steps_.size()),
+      num_inputs_(0) {
+  // The last step reading each step output, the pipeline outputs are never
+  // released
+  std::map<std::pair<int64_t, size_t>, size_t> last_reads;
+  auto mark_used = [&](const PipelineValue& value, size_t reader) {
+    auto& used = used_outputs_.at(value.step);
+    if (used.size() <= value.index) {
+      used.resize(value.index + 1, false);
+    }
+    used[value.index] = true;
+    last_reads[{value.step, value.index}] = reader;
+  };
+
+  for (auto i : c10::irange(steps_.size())) {
+    const auto& parameters = steps_[i].parameters;
+    for (auto p : c10::irange(parameters.size())) {
+      TORCH_CHECK(
+          parameters[p].first < steps_[i].inputs.size() + parameters.size() &&
+              (p == 0 || parameters[p].first > parameters[p - 1].first),
+          "Step ",
+          i,
+          " passes a parameter as fusion input ",
+          parameters[p].first,
+          ", which doesn't match its ",
+          steps_[i].inputs.size(),
+          " inputs!");
+    }
+    for (const auto& input : steps_[i].inputs) {
+      if (input.step == PipelineValue::kPipelineInput) {
+        num_inputs_ = std::max(num_inputs_, input.index + 1);
+        continue;
+      }
+      TORCH_CHECK(
+          input.step >= 0 && input.step < (int64_t)i,
+          "Step ",
+          i,
+          " reads an output of step ",
+          input.step,
+          ", which doesn't run before it!");
+      mark_used(input, i);
+    }
+  }
+  for (const auto& output : outputs_) {
+    TORCH_CHECK(
+        output.step >= 0 && output.step < (int64_t)steps_.size(),
+        "Pipeline outputs must be outputs of a step!");
+    mark_used(output, steps_.size());
+  }
+  for (const auto& [value, last_read] : last_reads) {
+    if (last_read < steps_.size()) {
+      releases_.at(last_read).push_back({value.first, value.second});
+    }
+  }
+
+  if (launcher_ == nullptr) {
+    auto fusion_cache = FusionCache::get();
+    schedules_.reserve(steps_.size());
+    for (const auto& step : steps_) {
+      schedules_.push_back(
+          step.schedules != nullptr
+              ? step.schedules
+              : fusion_cache->queryFusionSchedules(step.fusion_id));
+    }
+    launcher_ = [this](size_t step, const std::vector<c10::IValue>& inputs) {
+      return launchFusion(step, inputs);
+    };
+  }
+}
+
+std::vector<at::Tensor> FusionPipeline::launchFusion(
+    size_t step,
+    const std::vector<c10::IValue>& inputs) {
+  auto scheds = schedules_.at(step).get();
+  std::lock_guard<std::mutex> guard(scheds->exec_lock);
+  KernelArgumentHolder args =
+      KernelArgumentHolder::createKernelArgumentHolder(inputs);
+  TORCH_CHECK(
+      inputs.empty() || args.getDeviceIndex() > -1,
+      "Inputs of step ",
+      step,
+      " are not all on the same device!");
+  return scheds->auto_gen_schedules->runFusionWithArgs(args);
+}
+
+std::vector<at::Tensor> FusionPipeline::run(
+    const at::ArrayRef<c10::IValue>& inputs) {
+  FUSER_PERF_SCOPE("FusionPipeline::run");
+  TORCH_CHECK(
+      inputs.size() >= num_inputs_,
+      "Expected ",
+      num_inputs_,
+      " pipeline inputs, but got ",
+      inputs.size(),
+      "!");
+
+  std::vector<std::vector<at::Tensor>> values(steps_.size());
+  std::vector<c10::IValue> step_inputs;
+  for (auto i : c10::irange(steps_.size())) {
+    const auto& step = steps_[i];
+    step_inputs.reserve(step.inputs.size() + step.parameters.size());
+    // Parameters are inserted like FusionDefinition::fusionInputs does
+    auto parameter = step.parameters.begin();
+    for (const auto& input : step.inputs) {
+      while (parameter != step.parameters.end() &&
+             parameter->first == step_inputs.size()) {
+        step_inputs.push_back(parameter++->second);
+      }
+      if (input.step == PipelineValue::kPipelineInput) {
+        step_inputs.push_back(inputs[input.index]);
+      } else {
+        step_inputs.emplace_back(values[input.step][input.index]);
+      }
+    }
+    for (; parameter != step.parameters.end(); ++parameter) {
+      step_inputs.push_back(parameter->second);
+    }
+
+    values[i] = launcher_(i, step_inputs);
+    step_inputs.clear();
+
+    const auto& used = used_outputs_[i];
+    TORCH_CHECK(
+        used.size() <= values[i].size(),
+        "Step ",
+        i,
+        " has ",
+        values[i].size(),
+        " outputs, but output ",
+        used.size() - 1,
+        " is read!");
+    for (auto output : c10::irange(values[i].size())) {
+      if (output >= used.size() || !used[output]) {
+        values[i][output] = at::Tensor();
+      }
+    }
+    for (const auto& value : releases_[i]) {
+      values[value.step][value.index] = at::Tensor();
+    }
+  }
+
+  std::vector<at::Tensor> outputs;
+  outputs.reserve(outputs_.size());
+  for (const auto& output : outputs_) {
+    outputs.push_back(values[output.step][output.index]);
+  }
+  return outputs;
+}
+
+} // namespace nvfuser::python_frontend
@@ -0,0 +1,121 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+#include <c10/macros/Export.h>
+
+#include <ATen/core/ivalue.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace nvfuser::python_frontend {
+
+struct FusionSchedules;
+
+//! A value flowing through a FusionPipeline, which is either an input of the
+//! pipeline or an output of one of its steps.
+struct TORCH_CUDA_CU_API PipelineValue {
+  //! The step value refers to the inputs of the pipeline
+  static constexpr int64_t kPipelineInput = -1;
+
+  //! Index of the step producing the value, or kPipelineInput
+  int64_t step;
+  //! Index of the value among the outputs of the step or the pipeline inputs
+  size_t index;
+};
+
+//! \struct PipelineStep
+//! \brief A cached fusion run by a FusionPipeline, with the values it takes
+//! as inputs.
+struct TORCH_CUDA_CU_API PipelineStep {
+  //! Id of the fusion in the FusionCache
+  size_t fusion_id;
+  //! Inputs of the fusion, which only refer to outputs of earlier steps
+  std::vector<PipelineValue> inputs;
+  //! Values of the parameterized constants of the fusion, which are inserted
+  //! among the inputs, see FusionDefinition::parameters
+  std::vector<std::pair<size_t, c10::IValue>> parameters;
+  //! Schedules of the fusion, which stay usable after the FusionCache evicted
+  //! the fusion.  If null, the schedules are looked up by fusion_id.
+  std::shared_ptr<FusionSchedules> schedules;
+};
+
+//! \class FusionPipeline
+//! \brief Runs a sequence of cached fusions, whose inputs may be outputs of
+//! earlier fusions, with a single call from the host.
+//!
+//! Running the fusions one FusionDefinition::execute call at a time converts
+//! the inputs of every fusion from python, looks up its schedules and hands
+//! the intermediate tensors back to python.  The pipeline validates the data
+//! dependencies and looks up the schedules once, and then passes the
+//! intermediate tensors from step to step.  Kernel launches are asynchronous,
+//! so the arguments of a step are prepared while the kernels of the previous
+//! step run on the device.
+//!
+//! An intermediate tensor is released after the last step that reads it, so
+//! the CUDA caching allocator reuses its memory for the outputs of the later
+//! steps.
+//!
+//! Steps are launched by a Launcher, which runs the automatically scheduled
+//! kernels of the step's fusion by default.  Another Launcher, like one that
+//! computes the steps with ATen on the CPU, lets the pipeline run without a
+//! GPU.
+class TORCH_CUDA_CU_API FusionPipeline {
+ public:
+  //! Runs a step on its fusion inputs, i.e., with its parameters inserted,
+  //! and returns its outputs
+  using Launcher = std::function<std::vector<at::Tensor>(
+      size_t step,
+      const std::vector<c10::IValue>& inputs)>;
+
+  FusionPipeline(
+      std::vector<PipelineStep> steps,
+      std::vector<PipelineValue> outputs,
+      Launcher launcher = nullptr);
+
+  // The default Launcher refers to the pipeline
+  FusionPipeline(const FusionPipeline&) = delete;
+  FusionPipeline& operator=(const FusionPipeline&) = delete;
+
+  //! Runs the steps in order and returns the outputs of the pipeline
+  std::vector<at::Tensor> run(const at::ArrayRef<c10::IValue>& inputs);
+
+  const std::vector<PipelineStep>& steps() const {
+    return steps_;
+  }
+
+  //! Number of pipeline inputs the steps refer to
+  size_t numInputs() const {
+    return num_inputs_;
+  }
+
+ private:
+  //! Runs a step with the automatically generated schedules of its fusion
+  std::vector<at::Tensor> launchFusion(
+      size_t step,
+      const std::vector<c10::IValue>& inputs);
+
+  std::vector<PipelineStep> steps_;
+  std::vector<PipelineValue> outputs_;
+  Launcher launcher_;
+  //! Schedules of the fusion of each step when launched by launchFusion.
+  //! Holding them keeps the fusions usable after the FusionCache evicted
+  //! them.
+  std::vector<std::shared_ptr<FusionSchedules>> schedules_;
+  //! Whether each output of each step is read by a later step or is an
+  //! output of the pipeline.  Other outputs are dropped right away.
+  std::vector<std::vector<bool>> used_outputs_;
+  //! Values that are released after each step, as no later step reads them
+  std::vector<std::vector<PipelineValue>> releases_;
+  size_t num_inputs_;
+};
+
+} // namespace nvfuser::python_frontend
@@ -1247,6 +1247,12 @@ struct CatOpRecord : RecordFunctor {
 };
 
 //! Specialized Record Functor for recording FusionDefinition constant state.
+//!
+//! A parameterized constant is passed to the Fusion as a scalar input rather
+//! than inlined into it.  Its value is not part of the record's identity, so
+//! definitions that only differ in the values of parameterized constants
+//! share a Fusion and its kernels.  The FusionDefinition supplies the values
+//! at execution.
 
 template <typename ExprType, typename ValueType>
 struct ConstantRecord : RecordFunctor {
@@ -1254,10 +1260,12 @@ struct ConstantRecord : RecordFunctor {
       std::vector<State> _outputs,
       serde::RecordType record_type,
       ValueType val,
-      PrimDataType dtype)
+      PrimDataType dtype,
+      bool parameterized = false)
       : RecordFunctor({}, std::move(_outputs), "define_constant", record_type),
         value_(val),
-        dtype_(dtype) {}
+        dtype_(dtype),
+        parameterized_(parameterized) {}
   ~ConstantRecord() override = default;
   RecordFunctor* clone() final {
     return new ConstantRecord(*this);
@@ -1266,16 +1274,22 @@ struct ConstantRecord : RecordFunctor {
   //! Going to start out hashing nothing extra since hashing a complex number
   //! seems complicated.  Initially, the thought was to simply static cast the
   //! value_
+  //! | 31 --- 24 | 23 ---------------------------  1 | 0             |
+  //! | Dtype     |                                   | Parameterized |
   size_t hash() const final {
     auto result = RecordFunctor::hash();
-    return result;
+    result |= ((static_cast<size_t>(dtype_) & 0xff) << 24);
+    return result | static_cast<size_t>(parameterized_);
   }
 
   bool operator==(const RecordFunctor& other) const final {
     auto result = false;
     if (auto child_ptr = dynamic_cast<const ConstantRecord*>(&other)) {
-      result = RecordFunctor::operator==(other);
-      if (result) {
+      result = RecordFunctor::operator==(other) &&
+          (dtype_ == child_ptr->dtype_) &&
+          (parameterized_ == child_ptr->parameterized_);
+      // The values of parameterized constants are supplied at execution
+      if (result && !parameterized_) {
         if constexpr (
             std::is_same_v<ValueType, float> ||
             std::is_same_v<ValueType, double>) {
@@ -1293,7 +1307,16 @@ struct ConstantRecord : RecordFunctor {
   }
 
   void operator()(FusionState& fd) final {
-    Val* output = IrBuilder::create<ExprType>(value_, dtype_);
+    Val* output = nullptr;
+    if (parameterized_) {
+      output = IrBuilder::create<ExprType>();
+      fd.addInput(output);
+      if (dtype_ != ExprType::kDefaultDataType) {
+        output = castOp(dtype_, output);
+      }
+    } else {
+      output = IrBuilder::create<ExprType>(value_, dtype_);
+    }
     fd.setFusionState(outputs_.at(0).index, output);
   }
 
@@ -1325,6 +1348,9 @@ struct ConstantRecord : RecordFunctor {
     }
 
     os << ", dtype=" << dtypeToPyString(dtype_);
+    if (parameterized_) {
+      os << ", parameterize=True";
+    }
 
     if (close_function) {
       os << ")";
@@ -1346,6 +1372,9 @@ struct ConstantRecord : RecordFunctor {
 
   //! The DataType provided
   PrimDataType dtype_;
+
+  //! The constant is a scalar input of the Fusion
+  bool parameterized_;
 };
 
 //! valueRecordData Specializations used by recordData()
@@ -1355,7 +1384,9 @@ inline std::pair<serde::RecordData, flatbuffers::Offset<void>> ConstantRecord<
     Bool,
     bool>::valueRecordData(flatbuffers::FlatBufferBuilder& builder, bool value)
     const {
-  return {serde::RecordData_Bool, serde::CreateBool(builder, value).Union()};
+  return {
+      serde::RecordData_Bool,
+      serde::CreateBool(builder, value, parameterized_).Union()};
 }
 
 template <>
@@ -1368,7 +1399,11 @@ inline std::pair<serde::RecordData, flatbuffers::Offset<void>> ConstantRecord<
   return {
       serde::RecordData_ComplexDouble,
       serde::CreateComplexDouble(
-          builder, value.real(), value.imag(), serde::mapToSerdeDtype(dtype_))
+          builder,
+          value.real(),
+          value.imag(),
+          serde::mapToSerdeDtype(dtype_),
+          parameterized_)
           .Union()};
 }
 
@@ -1380,7 +1415,8 @@ inline std::pair<serde::RecordData, flatbuffers::Offset<void>> ConstantRecord<
         const {
   return {
       serde::RecordData_Double,
-      serde::CreateDouble(builder, value, serde::mapToSerdeDtype(dtype_))
+      serde::CreateDouble(
+          builder, value, serde::mapToSerdeDtype(dtype_), parameterized_)
           .Union()};
 }
 
@@ -1392,7 +1428,8 @@ inline std::pair<serde::RecordData, flatbuffers::Offset<void>> ConstantRecord<
         const {
   return {
       serde::RecordData_Long,
-      serde::CreateLong(builder, value, serde::mapToSerdeDtype(dtype_))
+      serde::CreateLong(
+          builder, value, serde::mapToSerdeDtype(dtype_), parameterized_)
           .Union()};
 }
 
@@ -16,11 +16,14 @@
 #include <ops/all_ops.h>
 #include <python_frontend/fusion_cache.h>
 #include <python_frontend/fusion_definition.h>
+#include <python_frontend/fusion_pipeline.h>
 #include <python_frontend/fusion_record.h>
 #include <python_frontend/python_bindings.h>
 #include <torch/csrc/jit/python/pybind_utils.h>
+#include <algorithm>
 #include <complex>
 #include <iostream>
+#include <iterator>
 #include <optional>
 #include <tuple>
 
@@ -70,6 +73,30 @@ std::vector<std::optional<bool>> computeContiguity(
   return contiguity;
 }
 
+namespace {
+
+// Converts an input of a fusion to an IValue.  Tensors and python scalars,
+// which are nearly all inputs, skip the type inference of toIValue.
+c10::IValue toFusionInput(py::handle obj) {
+  PyObject* ptr = obj.ptr();
+  if (THPVariable_Check(ptr)) {
+    return THPVariable_Unpack(ptr);
+  } else if (PyBool_Check(ptr)) {
+    return ptr == Py_True;
+  } else if (PyFloat_Check(ptr)) {
+    return PyFloat_AS_DOUBLE(ptr);
+  } else if (PyLong_Check(ptr)) {
+    int overflow = 0;
+    int64_t val = PyLong_AsLongLongAndOverflow(ptr, &overflow);
+    if (overflow == 0) {
+      return val;
+    }
+  }
+  return torch::jit::toIValue(obj, c10::AnyType::get());
+}
+
+} // namespace
+
 void initNvFuserPythonBindings(PyObject* module) {
   auto nvfuser = py::handle(module).cast<py::module>();
 
@@ -96,7 +123,7 @@ void initNvFuserPythonBindings(PyObject* module) {
       .def_static(
           "get",
           &FusionCache::get,
-          py::arg("max_fusions") = int(8192),
+          py::arg("max_fusions") = py::none(),
           py::return_value_policy::reference)
       .def("num_fusions", &FusionCache::numFusions)
       .def_static(
@@ -128,6 +155,56 @@ void initNvFuserPythonBindings(PyObject* module) {
         return ss.str();
       });
 
+  //! The steps and values of the pipeline are given as tuples, which the
+  //! python FusionPipeline class builds.
+  using ValueTuple = std::pair<int64_t, size_t>;
+  using StepTuple = std::pair<FusionDefinition*, std::vector<ValueTuple>>;
+  py::class_<FusionPipeline> fusion_pipeline(nvfuser, "_FusionPipeline");
+  fusion_pipeline
+      .def(
+          py::init([](const std::vector<StepTuple>& steps,
+                      const std::vector<ValueTuple>& outputs) {
+            auto to_value = [](const ValueTuple& value) {
+              return PipelineValue{value.first, value.second};
+            };
+            std::vector<PipelineStep> pipeline_steps;
+            pipeline_steps.reserve(steps.size());
+            for (const auto& [fd, inputs] : steps) {
+              TORCH_CHECK(
+                  fd->id().has_value(),
+                  "The FusionDefinition of a pipeline step must be defined!");
+              PipelineStep step{
+                  fd->id().value(), {}, fd->parameters(), fd->schedules()};
+              std::transform(
+                  inputs.begin(),
+                  inputs.end(),
+                  std::back_inserter(step.inputs),
+                  to_value);
+              pipeline_steps.push_back(std::move(step));
+            }
+            std::vector<PipelineValue> pipeline_outputs;
+            std::transform(
+                outputs.begin(),
+                outputs.end(),
+                std::back_inserter(pipeline_outputs),
+                to_value);
+            return std::make_unique<FusionPipeline>(
+                std::move(pipeline_steps), std::move(pipeline_outputs));
+          }),
+          py::arg("steps"),
+          py::arg("outputs"))
+      .def("num_inputs", &FusionPipeline::numInputs)
+      .def(
+          "run",
+          [](FusionPipeline& self, const py::iterable& iter) {
+            std::vector<c10::IValue> inputs;
+            for (py::handle obj : iter) {
+              inputs.push_back(toFusionInput(obj));
+            }
+            return self.run(inputs);
+          },
+          py::arg("inputs"));
+
   //! These are the FusionDefinition supported object types that are either
   //! defined as inputs or the output of an operation.
   py::class_<Tensor> tensor_class(nvfuser, "Tensor");
@@ -189,6 +266,18 @@ void initNvFuserPythonBindings(PyObject* module) {
             // Mark the end of a definition
             inst::Trace::instance()->endEvent(nullptr);
           })
+      .def(
+          "_setup_definition_from_key",
+          [](FusionDefinition& self, const std::string& key) {
+            return self.setupDefinitionFromKey(key);
+          },
+          py::arg("key"))
+      .def(
+          "_record_definition_key",
+          [](FusionDefinition& self, const std::string& key) {
+            self.recordDefinitionKey(key);
+          },
+          py::arg("key"))
       .def(
           "_setup_schedule",
           [](FusionDefinition& self, const py::iterable& iter) {
@@ -226,7 +315,7 @@ void initNvFuserPythonBindings(PyObject* module) {
              std::optional<int64_t> device) {
             std::vector<c10::IValue> inputs;
             for (py::handle obj : iter) {
-              inputs.push_back(torch::jit::toIValue(obj, c10::AnyType::get()));
+              inputs.push_back(toFusionInput(obj));
             }
             std::optional<int8_t> int8_device = std::nullopt;
             if (device.has_value()) {
@@ -240,6 +329,12 @@ void initNvFuserPythonBindings(PyObject* module) {
           py::kw_only(),
           py::arg("device") = py::none(),
           py::return_value_policy::reference)
+      .def(
+          "_collect_lower_pass_stats",
+          [](FusionDefinition& self, bool collect) {
+            self.collectLowerPassStats(collect);
+          },
+          py::arg("collect"))
       .def(
           "_fusion_ir",
           [](FusionDefinition& self) { return self.fusionIr(); },
@@ -299,6 +394,12 @@ void initNvFuserPythonBindings(PyObject* module) {
           py::arg("tensor_transforms") = false,
           py::arg("override_user_schedule") = false,
           py::return_value_policy::reference)
+      .def(
+          "_last_lower_pass_stats",
+          [](FusionDefinition& self, bool override_user_schedule) {
+            return self.lastLowerPassStats(override_user_schedule);
+          },
+          py::arg("override_user_schedule") = false)
       .def(
           "id",
           [](FusionDefinition& self) -> c10::optional<size_t> {
@@ -474,82 +575,106 @@ void initNvFuserPythonBindings(PyObject* module) {
           "define_constant",
           [](FusionDefinition& self,
              double val,
-             PrimDataType dtype = DataType::Double) -> Scalar {
+             PrimDataType dtype = DataType::Double,
+             bool parameterize = false) -> Scalar {
             FUSER_PERF_SCOPE("FusionDefinition.define_constant (double)");
             TORCH_CHECK(
                 !self.completed(),
                 "Attempting to add to a completed definition!");
+            if (parameterize) {
+              self.defineParameter(val);
+            }
             Scalar out = self.defineScalar();
             self.defineRecord(new ConstantRecord<Double, double>(
                 {self.recordingState(out())},
                 serde::RecordType_ConstantDouble,
                 val,
-                dtype));
+                dtype,
+                parameterize));
             return out;
           },
           py::arg("val"),
           py::arg("dtype") = DataType::Double,
+          py::arg("parameterize") = false,
           py::return_value_policy::reference)
       .def(
           "define_constant",
           [](FusionDefinition& self,
              std::complex<double> val,
-             PrimDataType dtype = DataType::ComplexDouble) -> Scalar {
+             PrimDataType dtype = DataType::ComplexDouble,
+             bool parameterize = false) -> Scalar {
             FUSER_PERF_SCOPE("FusionDefinition.define_constant (complex)");
             TORCH_CHECK(
                 !self.completed(),
                 "Attempting to add to a completed definition!");
+            if (parameterize) {
+              self.defineParameter(c10::complex<double>(val));
+            }
             Scalar out = self.defineScalar();
             self.defineRecord(
                 new ConstantRecord<ComplexDouble, std::complex<double>>(
                     {self.recordingState(out())},
                     serde::RecordType_ConstantComplexDouble,
                     val,
-                    dtype));
+                    dtype,
+                    parameterize));
             return out;
           },
           py::arg("val"),
           py::arg("dtype") = DataType::ComplexDouble,
+          py::arg("parameterize") = false,
           py::return_value_policy::reference)
       .def(
           "define_constant",
           [](FusionDefinition& self,
              bool val,
-             PrimDataType dtype = DataType::Bool) -> Scalar {
+             PrimDataType dtype = DataType::Bool,
+             bool parameterize = false) -> Scalar {
             FUSER_PERF_SCOPE("FusionDefinition.define_constant (bool)");
             TORCH_CHECK(
                 !self.completed(),
                 "Attempting to add to a completed definition!");
+            if (parameterize) {
+              self.defineParameter(val);
+            }
             Scalar out = self.defineScalar();
             self.defineRecord(new ConstantRecord<Bool, bool>(
                 {self.recordingState(out())},
                 serde::RecordType_ConstantBool,
                 val,
-                dtype));
+                dtype,
+                parameterize));
             return out;
           },
           py::arg("val"),
           py::arg("dtype") = DataType::Bool,
+          py::arg("parameterize") = false,
           py::return_value_policy::reference)
       .def(
           "define_constant",
           [](FusionDefinition& self,
              int64_t val,
-             PrimDataType dtype = DataType::Int) -> Scalar {
+             PrimDataType dtype = DataType::Int,
+             bool parameterize = false) -> Scalar {
             FUSER_PERF_SCOPE("FusionDefinition.define_constant (int)");
             TORCH_CHECK(
                 !self.completed(),
                 "Attempting to add to a completed definition!");
+            if (parameterize) {
+              self.defineParameter(val);
+            }
             Scalar out = self.defineScalar();
             self.defineRecord(new ConstantRecord<Int, int64_t>(
                 {self.recordingState(out())},
                 serde::RecordType_ConstantLong,
                 val,
-                dtype));
+                dtype,
+                parameterize));
             return out;
           },
           py::arg("val"),
           py::arg("dtype") = DataType::Int,
+          py::arg("parameterize") = false,
           py::return_value_policy::reference)
       .def(
           "define_scalar",
@@ -10,13 +10,49 @@
 
 #include <torch/torch.h>
 
+#include <c10/util/irange.h>
 #include <python_frontend/fusion_cache.h>
+#include <python_frontend/fusion_definition.h>
+#include <python_frontend/fusion_pipeline.h>
 #include <test/utils.h>
 #include <test/validator.h>
 
+#include <thread>
+
 namespace nvfuser {
 using namespace nvfuser::python_frontend;
 
+namespace {
+
+// Records a definition that adds a scalar to a tensor num_adds times
+std::unique_ptr<FusionDefinition> defineAdds(int64_t num_adds) {
+  auto fd = std::make_unique<FusionDefinition>(c10::nullopt);
+  fd->setupDefinition();
+  auto t = fd->defineTensor(1);
+  fd->defineRecord(new TensorRecord(
+      {fd->recordingState(t())}, {-1}, {true}, DataType::Float));
+  auto s = fd->defineScalar();
+  fd->defineRecord(
+      new ScalarRecord({fd->recordingState(s())}, DataType::Double));
+  for (auto i : c10::irange(num_adds)) {
+    (void)i;
+    auto out = fd->defineTensor(1);
+    fd->defineRecord(new OpRecord<TensorView*, TensorView*, Val*>(
+        {fd->recordingState(t()), fd->recordingState(s())},
+        {fd->recordingState(out())},
+        "ops.add",
+        serde::RecordType_Binary_TV_VAL,
+        static_cast<TensorView* (*)(TensorView*, Val*)>(add)));
+    t = out;
+  }
+  fd->defineRecord(new OutputRecord<TensorView>(
+      {fd->recordingState(t())}, serde::RecordType_OutputTv));
+  fd->finalizeDefinition();
+  return fd;
+}
+
+} // namespace
+
 // RUN CMD: bin/test_jit --gtest_filter="NVFuserTest*PyFusionCache*"
 TEST_F(NVFuserTest, PyFusionCache_CUDA) {
   // Reset cache before testing.
@@ -36,7 +72,7 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
   // Check that cache methods all assert when presented with a null record.
   {
     std::unique_ptr<RecordFunctor> null_record(nullptr);
-    TrieNode* node = fc->rootTriePtr();
+    auto node = fc->rootTriePtr();
 
     try {
       fc->queryChildren(node, null_record.get());
@@ -58,8 +94,8 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
   {
     std::unique_ptr<RecordFunctor> test_record(new TensorRecord(
         {State(0, serde::StateType_Tensor)}, {3}, {true}, DataType::Float));
-    TrieNode* root = fc->rootTriePtr();
-    TrieNode* node = nullptr;
+    auto root = fc->rootTriePtr();
+    std::shared_ptr<TrieNode> node;
 
     // Check Methods prior to adding an entry to the cache
 
@@ -116,8 +152,8 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
         {State(0, serde::StateType_Tensor)}, {3}, {true}, DataType::Float));
     std::unique_ptr<RecordFunctor> new_record(
         new ScalarRecord({State(1, serde::StateType_Scalar)}, DataType::Float));
-    TrieNode* root = fc->rootTriePtr();
-    TrieNode* node = nullptr;
+    auto root = fc->rootTriePtr();
+    std::shared_ptr<TrieNode> node;
 
     try {
       auto child_node = fc->queryChildren(root, cached_record.get());
@@ -143,13 +179,15 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
       FAIL() << "An unexpected assert on Cache Entry creation!" << e.what();
     }
 
+    // The cache is full, so the first fusion is evicted
     std::unique_ptr<RecordFunctor> end_record(new EndRecord());
     try {
       fc->createChild(node, end_record.get());
-      FAIL() << "Expected the cache to assert because it is full!";
-    } catch (...) {
       SUCCEED();
+    } catch (const std::exception& e) {
+      FAIL() << "An unexpected assert on a full cache!" << e.what();
     }
+    ASSERT_TRUE(fc->numFusions() == 1);
   }
 
   // Verify proper cache lookup up of complete fusion already cached.
@@ -159,8 +197,8 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
         {State(0, serde::StateType_Tensor)}, {3}, {true}, DataType::Float));
     std::unique_ptr<RecordFunctor> dummy_record(new TensorRecord(
         {State(0, serde::StateType_Tensor)}, {3}, {true}, DataType::Float));
-    TrieNode* root = fc->rootTriePtr();
-    TrieNode* node = nullptr;
+    auto root = fc->rootTriePtr();
+    std::shared_ptr<TrieNode> node;
 
     try {
       auto child_node = fc->queryChildren(root, test_record.get());
@@ -181,4 +219,267 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
   }
 }
 
+// Several threads record overlapping sets of definitions through the shared
+// cache while others query it.  Threads recording the same definition must
+// find the same, completely built, fusion.  Run with TSAN to check the cache
+// for data races.
+TEST_F(NVFuserTest, PyFusionCacheMultithreaded_CUDA) {
+  constexpr int64_t num_threads = 8;
+  constexpr int64_t num_definitions = 12;
+  constexpr int64_t num_iterations = 24;
+
+  FusionCache::reset();
+  FusionCache* fc = FusionCache::get(num_definitions);
+
+  std::vector<std::vector<size_t>> fusion_ids(
+      num_threads, std::vector<size_t>(num_definitions, 0));
+  std::vector<std::thread> threads;
+  for (auto tid : c10::irange(num_threads)) {
+    threads.emplace_back([&, tid]() {
+      for (auto it : c10::irange(num_iterations)) {
+        auto definition = (tid + it) % num_definitions;
+        auto fusion_id = defineAdds(definition + 1)->id().value();
+        fusion_ids[tid][definition] = fusion_id;
+
+        auto fusion = fc->queryFusionSchedules(fusion_id)->preschedFusion();
+        EXPECT_EQ(fusion->inputs().size(), 2u);
+        EXPECT_EQ(fusion->outputs().size(), 1u);
+        std::stringstream ss;
+        fc->stats(ss);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(fc->numFusions(), (size_t)num_definitions);
+  for (auto definition : c10::irange(num_definitions)) {
+    for (auto tid : c10::irange(num_threads)) {
+      EXPECT_EQ(fusion_ids[tid][definition], fusion_ids[0][definition]);
+    }
+  }
+}
+
+// A full cache evicts a fusion that is rarely used rather than failing.  The
+// evicted fusion stays usable by the definitions that hold it.
+TEST_F(NVFuserTest, PyFusionCacheEviction_CUDA) {
+  FusionCache::reset();
+  FusionCache* fc = FusionCache::get(2);
+
+  auto fd_a = defineAdds(1);
+  auto fd_b = defineAdds(2);
+  for (auto i : c10::irange(3)) {
+    (void)i;
+    EXPECT_EQ(defineAdds(1)->id(), fd_a->id());
+  }
+  EXPECT_EQ(fc->numFusions(), 2u);
+
+  // Defining a third fusion evicts the one that was used the least.  The
+  // new fusion gets a new id, so the id of the evicted one isn't found.
+  auto fd_c = defineAdds(3);
+  EXPECT_NE(fd_c->id(), fd_b->id());
+  EXPECT_EQ(fc->numFusions(), 2u);
+  EXPECT_EQ(defineAdds(1)->id(), fd_a->id());
+  EXPECT_EQ(defineAdds(3)->id(), fd_c->id());
+  EXPECT_NE(fd_b->fusionIr().find("T"), std::string::npos);
+  EXPECT_THAT(
+      [&]() { fc->queryFusionSchedules(fd_b->id().value()); },
+      ::testing::ThrowsMessage<c10::Error>(::testing::HasSubstr("evicted")));
+
+  std::stringstream ss;
+  fc->stats(ss);
+  EXPECT_THAT(ss.str(), ::testing::HasSubstr("Evictions: 1\n"));
+
+  // The evicted definition is recorded again as a new fusion
+  EXPECT_TRUE(defineAdds(2)->completed());
+  EXPECT_EQ(fc->numFusions(), 2u);
+}
+
+// Lowering the max number of fusions evicts the fusions above it
+TEST_F(NVFuserTest, PyFusionCacheShrink_CUDA) {
+  FusionCache::reset();
+  FusionCache* fc = FusionCache::get(3);
+  auto fd_a = defineAdds(1);
+  defineAdds(2);
+  defineAdds(3);
+  for (auto i : c10::irange(3)) {
+    (void)i;
+    EXPECT_EQ(defineAdds(1)->id(), fd_a->id());
+  }
+  EXPECT_EQ(fc->numFusions(), 3u);
+
+  EXPECT_EQ(FusionCache::get(1), fc);
+  EXPECT_EQ(fc->numFusions(), 1u);
+  EXPECT_EQ(defineAdds(1)->id(), fd_a->id());
+  std::stringstream ss;
+  fc->stats(ss);
+  EXPECT_THAT(ss.str(), ::testing::HasSubstr("Evictions: 2\n"));
+
+  // Getting the cache without a max keeps the current one
+  FusionCache::get();
+  defineAdds(2);
+  EXPECT_EQ(fc->numFusions(), 1u);
+}
+
+// The kernels of an evicted fusion are dropped from the CompiledKernelCache
+// once no definition holds the fusion
+TEST_F(NVFuserTest, PyFusionCacheEvictionReleasesKernels_CUDA) {
+  FusionCache::reset();
+  FusionCache* fc = FusionCache::get(1);
+  auto& kernel_cache = CompiledKernelCache::get();
+  kernel_cache.clear();
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({128}, options);
+
+  auto fd_a = defineAdds(1);
+  fc->queryFusionSchedules(fd_a->id().value())
+      ->auto_gen_schedules->runFusionWithInputs({t0, 1.0});
+  EXPECT_EQ(kernel_cache.stats().entries, 1);
+
+  // The definition keeps the evicted fusion, and its kernel, alive
+  auto fd_b = defineAdds(2);
+  EXPECT_EQ(kernel_cache.stats().entries, 1);
+  fd_a.reset();
+  EXPECT_EQ(kernel_cache.stats().entries, 0);
+
+  // Evicting a fusion without definitions releases its kernel right away
+  fc->queryFusionSchedules(fd_b->id().value())
+      ->auto_gen_schedules->runFusionWithInputs({t0, 1.0});
+  EXPECT_EQ(kernel_cache.stats().entries, 1);
+  fd_b.reset();
+  EXPECT_EQ(kernel_cache.stats().entries, 1);
+  defineAdds(3);
+  EXPECT_EQ(kernel_cache.stats().entries, 0);
+}
+
+// Threads keep recording more definitions than the cache can hold
+TEST_F(NVFuserTest, PyFusionCacheEvictionMultithreaded_CUDA) {
+  FusionCache::reset();
+  constexpr size_t max_fusions = 4;
+  FusionCache* fc = FusionCache::get(max_fusions);
+
+  constexpr int64_t num_threads = 8;
+  constexpr int64_t num_definitions = 12;
+  constexpr int64_t num_iterations = 24;
+
+  std::vector<std::thread> threads;
+  for (auto tid : c10::irange(num_threads)) {
+    threads.emplace_back([&, tid]() {
+      for (auto it : c10::irange(num_iterations)) {
+        auto definition = (tid * 5 + it) % num_definitions;
+        auto fd = defineAdds(definition + 1);
+        EXPECT_TRUE(fd->completed());
+        EXPECT_LE(fc->numFusions(), max_fusions);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_LE(fc->numFusions(), max_fusions);
+  std::stringstream ss;
+  fc->stats(ss);
+  EXPECT_THAT(ss.str(), ::testing::Not(::testing::HasSubstr("Evictions: 0")));
+}
+
+// The steps of a pipeline are computed on the CPU by a mock launcher
+TEST(PyFusionPipelineTest, MockLaunch_CPU) {
+  constexpr auto in = PipelineValue::kPipelineInput;
+  // out0 = in0 + in1, and out1 = out0 * in1 with an unused second output,
+  // and out2 = out1 - out0, and out3 = out2 * scale where scale is a
+  // parameter passed as the second fusion input
+  std::vector<PipelineStep> steps = {
+      {0, {{in, 0}, {in, 1}}},
+      {1, {{0, 0}, {in, 1}}},
+      {2, {{1, 0}, {0, 0}}},
+      {3, {{2, 0}}, {{1, 3.0}}}};
+
+  c10::WeakIValue step0_output;
+  c10::WeakIValue unused_output;
+  std::vector<size_t> launched;
+  auto launcher = [&](size_t step, const std::vector<c10::IValue>& inputs) {
+    launched.push_back(step);
+    auto a = inputs.at(0).toTensor();
+    switch (step) {
+      case 0: {
+        auto out = a + inputs.at(1).toTensor();
+        step0_output = c10::WeakIValue(c10::IValue(out));
+        return std::vector<at::Tensor>{out};
+      }
+      case 1: {
+        auto unused = at::zeros_like(a);
+        unused_output = c10::WeakIValue(c10::IValue(unused));
+        return std::vector<at::Tensor>{a * inputs.at(1).toTensor(), unused};
+      }
+      case 2:
+        // The unused output is dropped once its step ran, and the output
+        // of step 0 is still read by this step
+        EXPECT_EQ(unused_output.use_count(), 0u);
+        EXPECT_GT(step0_output.use_count(), 0u);
+        return std::vector<at::Tensor>{a - inputs.at(1).toTensor()};
+      default:
+        // The output of step 0 is released after its last read by step 2
+        EXPECT_EQ(step0_output.use_count(), 0u);
+        EXPECT_EQ(inputs.size(), 2u);
+        return std::vector<at::Tensor>{a * inputs.at(1).toDouble()};
+    }
+  };
+
+  FusionPipeline pipeline(steps, {{3, 0}}, launcher);
+  EXPECT_EQ(pipeline.numInputs(), 2u);
+
+  auto t0 = at::randn({8, 4});
+  auto t1 = at::randn({8, 4});
+  auto outputs = pipeline.run({t0, t1});
+  EXPECT_EQ(launched, std::vector<size_t>({0, 1, 2, 3}));
+  ASSERT_EQ(outputs.size(), 1u);
+  EXPECT_TRUE(outputs[0].allclose(((t0 + t1) * t1 - (t0 + t1)) * 3.0));
+
+  // A step can only read outputs of the steps before it
+  EXPECT_THAT(
+      [&]() { FusionPipeline({{0, {{0, 0}}}}, {{0, 0}}, launcher); },
+      ::testing::ThrowsMessage<c10::Error>(
+          ::testing::HasSubstr("which doesn't run before it")));
+  // Parameters must be passed among the fusion inputs
+  EXPECT_THAT(
+      [&]() {
+        FusionPipeline({{0, {{in, 0}}, {{2, 1.0}}}}, {{0, 0}}, launcher);
+      },
+      ::testing::ThrowsMessage<c10::Error>(
+          ::testing::HasSubstr("which doesn't match its 1 inputs")));
+}
+
+// A pipeline runs cached fusions like consecutive execute calls do.  The
+// steps hold their fusions, which stay usable after an eviction.
+TEST_F(NVFuserTest, PyFusionPipeline_CUDA) {
+  FusionCache::reset();
+  FusionCache::get(1);
+  auto fd_a = defineAdds(1);
+  auto fd_b = defineAdds(2);
+
+  constexpr auto in = PipelineValue::kPipelineInput;
+  FusionPipeline pipeline(
+      {{fd_a->id().value(), {{in, 0}, {in, 1}}, {}, fd_a->schedules()},
+       {fd_b->id().value(), {{0, 0}, {in, 1}}, {}, fd_b->schedules()}},
+      {{0, 0}, {1, 0}});
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({1024}, options);
+  std::vector<c10::IValue> inputs = {t0, 2.0};
+  for (auto i : c10::irange(2)) {
+    (void)i;
+    auto outputs = pipeline.run(inputs);
+    ASSERT_EQ(outputs.size(), 2u);
+
+    auto out_a = fd_a->execute(inputs, false, std::nullopt);
+    auto out_b = fd_b->execute({out_a[0], 2.0}, false, std::nullopt);
+    EXPECT_TRUE(outputs[0].equal(out_a[0]));
+    EXPECT_TRUE(outputs[1].equal(out_b[0]));
+    EXPECT_TRUE(outputs[1].allclose(t0 + 6.0));
+  }
+}
+
 } // namespace nvfuser
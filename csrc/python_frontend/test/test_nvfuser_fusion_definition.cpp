@@ -170,6 +170,21 @@ TEST_F(NVFuserTest, FusionDefinition_CUDA) {
       FAIL() << "Unexpected assert during creation of a new Fusion! "
              << e.what();
     }
+
+    // Map a definition key to the fusion of the complete definition
+    fd.recordDefinitionKey("add_key");
+  }
+
+  // Look up a FusionDefinition by its definition key
+  {
+    FusionDefinition fd(c10::nullopt, 4);
+    EXPECT_FALSE(fd.setupDefinitionFromKey("missing_key"));
+    EXPECT_FALSE(fd.completed());
+    ASSERT_TRUE(fd.setupDefinitionFromKey("add_key"));
+    ASSERT_TRUE(fd.completed());
+    std::stringstream ss;
+    fd.print(ss);
+    EXPECT_NE(ss.str().find("fd.ops.add"), std::string::npos);
   }
 }
 
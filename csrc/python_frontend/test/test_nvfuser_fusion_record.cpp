@@ -11,6 +11,7 @@
 #include <torch/torch.h>
 
 #include <python_frontend/fusion_record.h>
+#include <serde/fusion_record_serde.h>
 #include <test/utils.h>
 #include <test/validator.h>
 
@@ -131,6 +132,53 @@ TEST_F(NVFuserTest, RecordFunctorEquality_CUDA) {
     EXPECT_TRUE(*test_record1 == *test_record3);
     EXPECT_TRUE(*test_record2 == *test_record3);
   }
+
+  // ConstantRecord Equality Check
+  {
+    auto out = State(0, serde::StateType_Scalar);
+    auto make_record = [&](double value,
+                           bool parameterized,
+                           PrimDataType dtype = DataType::Double) {
+      return std::unique_ptr<RecordFunctor>(new ConstantRecord<Double, double>(
+          {out},
+          serde::RecordType_ConstantDouble,
+          value,
+          dtype,
+          parameterized));
+    };
+    auto test_record1 = make_record(1.0, false);
+    auto test_record2 = make_record(2.0, false);
+    auto test_record3 = make_record(1.0, true);
+    auto test_record4 = make_record(2.0, true);
+
+    EXPECT_FALSE(*test_record1 == *test_record2);
+    EXPECT_FALSE(*test_record1 == *test_record3);
+    // The values of parameterized constants are ignored
+    EXPECT_TRUE(*test_record3 == *test_record4);
+    EXPECT_EQ(test_record3->hash(), test_record4->hash());
+    EXPECT_NE(test_record1->hash(), test_record3->hash());
+
+    // Constants of different types are different, parameterized or not
+    auto test_record5 = make_record(1.0, false, DataType::Float);
+    auto test_record6 = make_record(2.0, true, DataType::Float);
+    EXPECT_FALSE(*test_record1 == *test_record5);
+    EXPECT_FALSE(*test_record4 == *test_record6);
+    EXPECT_NE(test_record1->hash(), test_record5->hash());
+    EXPECT_NE(test_record4->hash(), test_record6->hash());
+
+    // Parameterized constants stay parameterized through serialization
+    serde::RecordFunctorFactory factory;
+    for (auto record : {test_record1.get(), test_record3.get()}) {
+      flatbuffers::FlatBufferBuilder builder(1024);
+      builder.Finish(record->serialize(builder));
+      auto buffer = flatbuffers::GetRoot<serde::RecordFunctor>(
+          builder.GetBufferPointer());
+      std::unique_ptr<RecordFunctor> parsed(
+          factory.parse(buffer->type(), buffer));
+      EXPECT_TRUE(*parsed == *record);
+      EXPECT_EQ(parsed->hash(), record->hash());
+    }
+  }
 }
 
 } // namespace nvfuser
@@ -0,0 +1,653 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <scheduler/autotune.h>
+
+#include <device_lower/lower2device.h>
+#include <device_profile.h>
+#include <executor.h>
+#include <executor_utils.h>
+#include <expr_evaluator.h>
+#include <instrumentation.h>
+#include <ir/all_nodes.h>
+#include <ir/utils.h>
+#include <scheduler/matmul_heuristic.h>
+#include <scheduler/pointwise_heuristic.h>
+#include <scheduler/reduction_heuristic.h>
+#include <scheduler/registry.h>
+#include <scheduler/transpose_heuristic.h>
+#include <utils.h>
+
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <sstream>
+
+namespace nvfuser {
+
+namespace {
+
+bool isPowerOfTwo(int64_t value) {
+  return value > 0 && (value & (value - 1)) == 0;
+}
+
+//! Values of a knob: the value of the seed, followed by the values of the
+//! space that pass filter
+template <typename T, typename Filter>
+std::vector<T> knobValues(
+    T seed_value,
+    const std::vector<T>& space_values,
+    Filter filter) {
+  std::vector<T> values = {seed_value};
+  for (auto value : space_values) {
+    if (filter(value) &&
+        std::find(values.begin(), values.end(), value) == values.end()) {
+      values.push_back(value);
+    }
+  }
+  return values;
+}
+
+template <typename T>
+std::vector<T> knobValues(T seed_value, const std::vector<T>& space_values) {
+  return knobValues(seed_value, space_values, [](T) { return true; });
+}
+
+//! Unroll factors to try in place of seed_factor. If the seed vectorizes,
+//! only smaller powers of two are valid vectorization factors.
+std::vector<int64_t> unrollValues(
+    int64_t seed_factor,
+    bool seed_vectorizes,
+    const std::vector<int64_t>& space_values) {
+  return knobValues(seed_factor, space_values, [&](int64_t factor) {
+    return factor >= 1 &&
+        (!seed_vectorizes || (isPowerOfTwo(factor) && factor <= seed_factor));
+  });
+}
+
+//! Copy of lparams with the dimension of parallel_type replaced
+LaunchParams withDim(
+    const LaunchParams& lparams,
+    ParallelType parallel_type,
+    int64_t value) {
+  std::array<int64_t, kParallelTypeThreads.size()> dims = {};
+  for (auto i : c10::irange(kParallelTypeThreads.size())) {
+    dims[i] = kParallelTypeThreads[i] == parallel_type
+        ? value
+        : lparams.getRawVal(kParallelTypeThreads[i]);
+  }
+  LaunchParams result(dims[0], dims[1], dims[2], dims[3], dims[4], dims[5]);
+  result.setSmem(lparams.smem());
+  return result;
+}
+
+//! Variants of the block shape of lparams. Only the block dimensions that
+//! lparams sets are changed.
+std::vector<LaunchParams> blockShapes(
+    const LaunchParams& lparams,
+    const TuningSpace& space) {
+  auto dimValues = [&](ParallelType parallel_type,
+                       const std::vector<int64_t>& space_values) {
+    if (!lparams.hasDim(parallel_type)) {
+      return std::vector<int64_t>{LaunchParams::UNINITIALIZED_VAL};
+    }
+    return knobValues(
+        lparams.getRawVal(parallel_type), space_values, [](int64_t value) {
+          return value > 0;
+        });
+  };
+  const auto max_threads = currentDeviceProfile()->max_threads_per_block;
+  std::vector<LaunchParams> shapes;
+  for (auto bdimx : dimValues(ParallelType::TIDx, space.block_dims_x)) {
+    for (auto bdimy : dimValues(ParallelType::TIDy, space.block_dims_y)) {
+      if (std::max(bdimx, (int64_t)1) * std::max(bdimy, (int64_t)1) *
+              lparams.bdimz() >
+          max_threads) {
+        continue;
+      }
+      shapes.push_back(withDim(
+          withDim(lparams, ParallelType::TIDx, bdimx),
+          ParallelType::TIDy,
+          bdimy));
+    }
+  }
+  return shapes;
+}
+
+bool sameVariant(
+    const std::shared_ptr<HeuristicParams>& params,
+    const std::shared_ptr<HeuristicParams>& other) {
+  return params->sameAs(other) && params->cparams == other->cparams &&
+      params->lparams == other->lparams;
+}
+
+//! Collects unique variants up to a limit
+class VariantList {
+ public:
+  explicit VariantList(int64_t max_variants) : max_variants_(max_variants) {}
+
+  void add(std::shared_ptr<HeuristicParams> params) {
+    if (full() ||
+        std::any_of(variants_.begin(), variants_.end(), [&](const auto& v) {
+          return sameVariant(v, params);
+        })) {
+      return;
+    }
+    variants_.push_back(std::move(params));
+  }
+
+  bool full() const {
+    return (int64_t)variants_.size() >= max_variants_;
+  }
+
+  std::vector<std::shared_ptr<HeuristicParams>>& variants() {
+    return variants_;
+  }
+
+ private:
+  int64_t max_variants_ = 0;
+  std::vector<std::shared_ptr<HeuristicParams>> variants_;
+};
+
+void addPointwiseVariants(
+    const PointwiseParams& seed,
+    const TuningSpace& space,
+    VariantList& variants) {
+  for (auto unroll : unrollValues(
+           (int64_t)seed.unroll_factor, seed.vectorize, space.unroll_factors)) {
+    for (const auto& lparams : blockShapes(seed.lparams, space)) {
+      auto params = std::make_shared<PointwiseParams>(seed);
+      params->unroll_factor = (size_t)unroll;
+      params->vectorize = seed.vectorize && unroll > 1;
+      params->lparams = lparams;
+      variants.add(params);
+    }
+  }
+}
+
+void addReductionVariants(
+    const ReductionParams& seed,
+    const TuningSpace& space,
+    VariantList& variants) {
+  // Persistent kernels hold batches of the inner or outer reduction
+  // dimension in registers. The persistence of combined inner and outer
+  // reductions is fixed by the scheduler.
+  const bool tune_batches =
+      seed.persistent_kernel && !seed.combined_inner_outer;
+  const auto seed_batches = seed.fastest_dim
+      ? seed.batches_per_block_inner_reduction
+      : seed.batches_per_block_outer_reduction;
+  const auto batches_values = tune_batches
+      ? knobValues(
+            seed_batches,
+            space.persistent_batches,
+            [](int64_t batches) { return batches >= 1; })
+      : std::vector<int64_t>{seed_batches};
+
+  for (auto inner_unroll : unrollValues(
+           seed.unroll_factor_inner_reduction,
+           seed.vectorize_inner_reduction,
+           space.unroll_factors)) {
+    for (auto iter_unroll : unrollValues(
+             seed.unroll_factor_iter_dom,
+             seed.vectorize_iter_dom,
+             space.iter_unroll_factors)) {
+      for (auto batches : batches_values) {
+        for (const auto& lparams : blockShapes(seed.lparams, space)) {
+          auto params = std::make_shared<ReductionParams>(seed);
+          params->unroll_factor_inner_reduction = inner_unroll;
+          params->vectorize_inner_reduction =
+              seed.vectorize_inner_reduction && inner_unroll > 1;
+          params->unroll_factor_iter_dom = iter_unroll;
+          params->vectorize_iter_dom =
+              seed.vectorize_iter_dom && iter_unroll > 1;
+          if (seed.fastest_dim) {
+            params->batches_per_block_inner_reduction = batches;
+          } else {
+            params->batches_per_block_outer_reduction = batches;
+          }
+          params->lparams = lparams;
+          variants.add(params);
+        }
+      }
+    }
+  }
+}
+
+void addTransposeVariants(
+    const TransposeParams& seed,
+    const TuningSpace& space,
+    VariantList& variants) {
+  auto vectorizeValues = [&](size_t seed_factor) {
+    return knobValues(
+        seed_factor,
+        std::vector<size_t>(
+            space.unroll_factors.begin(), space.unroll_factors.end()),
+        [&](size_t factor) {
+          return isPowerOfTwo((int64_t)factor) && factor <= seed_factor;
+        });
+  };
+  for (auto tile_size1 :
+       knobValues(seed.tile_size1, space.transpose_tile_sizes)) {
+    for (auto tile_size2 :
+         knobValues(seed.tile_size2, space.transpose_tile_sizes)) {
+      for (auto vectorize_factor1 : vectorizeValues(seed.vectorize_factor1)) {
+        for (auto vectorize_factor2 :
+             vectorizeValues(seed.vectorize_factor2)) {
+          auto params = std::make_shared<TransposeParams>(seed);
+          params->tile_size1 = tile_size1;
+          params->tile_size2 = tile_size2;
+          params->vectorize_factor1 = vectorize_factor1;
+          params->vectorize_factor2 = vectorize_factor2;
+          // The block size is derived from the tiles as in the heuristic
+          params->lparams = withDim(
+              seed.lparams, ParallelType::TIDx, params->getThreadsPerBlock());
+          variants.add(params);
+        }
+      }
+    }
+  }
+}
+
+void addMatmulVariants(
+    const MatmulParams& seed,
+    const TuningSpace& space,
+    VariantList& variants) {
+  const auto& seed_double_buffer = seed.double_buffer_options;
+  const bool double_buffered = seed_double_buffer.double_buffer_smem_write ||
+      seed_double_buffer.double_buffer_smem_read;
+  const auto stages = double_buffered
+      ? knobValues(
+            seed_double_buffer.smem_double_buffer_stage,
+            space.smem_double_buffer_stages,
+            [](int stage) { return stage >= 2; })
+      : std::vector<int>{seed_double_buffer.smem_double_buffer_stage};
+  const auto other_order =
+      seed.cta_order == MatmulParams::TileRasterizationOrder::RowMajor
+      ? MatmulParams::TileRasterizationOrder::ColumnMajor
+      : MatmulParams::TileRasterizationOrder::RowMajor;
+
+  for (auto stage : stages) {
+    for (auto swizzle : knobValues(
+             seed.grid_swizzle_factor,
+             space.grid_swizzle_factors,
+             [](int factor) { return factor >= 1; })) {
+      for (auto cta_order : {seed.cta_order, other_order}) {
+        auto params = std::make_shared<MatmulParams>(seed);
+        params->double_buffer_options.smem_double_buffer_stage = stage;
+        params->grid_swizzle_factor = swizzle;
+        params->cta_order = cta_order;
+        variants.add(params);
+      }
+    }
+  }
+}
+
+//! Whether scheduling reads the launch dimension of parallel_type from the
+//! parameters, in which case it must not be dropped from them
+bool schedulingReadsLaunchDim(
+    const HeuristicParams& params,
+    ParallelType parallel_type) {
+  auto rparams = dynamic_cast<const ReductionParams*>(&params);
+  if (rparams == nullptr) {
+    return false;
+  }
+  return (parallel_type == ParallelType::TIDx &&
+          (rparams->static_bdimx || rparams->combined_inner_outer)) ||
+      (parallel_type == ParallelType::TIDy && rparams->static_bdimy);
+}
+
+//! Schedules a copy of fusion with candidate.params and checks that the
+//! kernel can be lowered and launched for args on the current device, the
+//! same way FusionExecutor::computeLaunchParams resolves the launch
+//! configuration. Launch constraints the kernel does not need, because the
+//! launch dimension can be inferred from the inputs, are dropped from
+//! candidate.params. This way recorded parameters do not carry dimensions
+//! that are only valid for the tuned inputs, and variants that only differ
+//! in such dimensions resolve to the same candidate.
+//!
+//! Returns the scheduled fusion, or nullptr with reason set if the
+//! candidate is illegal.
+std::unique_ptr<Fusion> scheduleCandidate(
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info,
+    const KernelArgumentHolder& args,
+    TuningCandidate& candidate,
+    std::string& reason) {
+  FUSER_PERF_SCOPE("autotune::scheduleCandidate");
+  auto& params = *candidate.params;
+  auto scheduled_fusion = std::make_unique<Fusion>(*fusion);
+  std::unique_ptr<GpuLower> lower;
+  try {
+    auto entry = SchedulerEntry::makeEntryWithParams(
+        candidate.heuristic, fusion, runtime_info, candidate.params);
+    entry->schedule(scheduled_fusion.get());
+    lower = std::make_unique<GpuLower>(scheduled_fusion.get(), params.cparams);
+  } catch (const c10::Error& e) {
+    reason = "cannot be scheduled: " + e.msg();
+    return nullptr;
+  }
+
+  const auto kernel = lower->kernel();
+  LaunchParams constraints;
+  LaunchParams launch_params;
+  int64_t smem_size = 0;
+  try {
+    auto expr_eval = executor_utils::bindInputs(args, kernel);
+    auto used_vals = kernel->usedMathVals();
+    auto used_tvs_range = ir_utils::filterByType<TensorView>(used_vals);
+    std::vector<TensorView*> used_tvs(
+        used_tvs_range.begin(), used_tvs_range.end());
+    auto parallel_binding_ids =
+        executor_utils::getParallelBindingsIterDomains(lower.get(), used_tvs);
+    auto parallel_iter_extents =
+        executor_utils::getParallelIterExtents(parallel_binding_ids);
+
+    // A constraint is needed if the scheduler split a domain by the
+    // symbolic launch dimension
+    for (auto parallel_type : kParallelTypeThreads) {
+      if (!params.lparams.hasDim(parallel_type)) {
+        continue;
+      }
+      auto extents_it = parallel_iter_extents->find(parallel_type);
+      const bool split_by_dim =
+          extents_it != parallel_iter_extents->end() &&
+          std::any_of(
+              extents_it->second.begin(),
+              extents_it->second.end(),
+              [&](const Val* extent) {
+                auto named_scalar = dynamic_cast<const NamedScalar*>(extent);
+                return named_scalar != nullptr &&
+                    named_scalar->getParallelDim() == parallel_type;
+              });
+      if (!split_by_dim &&
+          !schedulingReadsLaunchDim(params, parallel_type)) {
+        continue;
+      }
+      const auto dim = params.lparams.getDim(parallel_type);
+      constraints.bind(dim, parallel_type);
+      if (extents_it == parallel_iter_extents->end()) {
+        continue;
+      }
+      for (auto extent : extents_it->second) {
+        if (!expr_eval.evaluate(extent).has_value()) {
+          expr_eval.bind(extent, dim);
+        }
+      }
+      launch_params.bind(dim, parallel_type);
+      expr_eval.bind(parallel_type, dim);
+    }
+
+    for (auto [parallel_type, extent] :
+         lower->parallelDimensionMap().getMap()) {
+      auto dim = expr_eval.evaluate(extent);
+      if (!dim.has_value()) {
+        reason = "cannot infer the launch dimension " +
+            stringifyThread(parallel_type) + " = " + extent->toInlineString();
+        return nullptr;
+      }
+      if (dim->as<int64_t>() > 0) {
+        expr_eval.bind(parallel_type, dim->as<int64_t>());
+        launch_params.bind(dim->as<int64_t>(), parallel_type);
+      }
+    }
+
+    // Workspace of block and grid reductions and broadcasts, see
+    // FusionExecutor::computeLaunchParams
+    const auto& summary = kernel->summary();
+    if ((summary.has_block_reductions || summary.has_grid_reductions ||
+         summary.has_block_broadcasts || summary.has_grid_broadcasts) &&
+        summary.largest_smem_data_type != DataType::Null) {
+      const int64_t welford_factor =
+          summary.has_block_welford || summary.has_grid_welford ? 3 : 1;
+      smem_size = (int64_t)dataTypeSize(summary.largest_smem_data_type) *
+          welford_factor * launch_params.nThreads();
+      if (summary.has_outer_grouped_grid_welford) {
+        smem_size = std::max(
+            smem_size,
+            (int64_t)summary.outer_grouped_grid_welford_largest_smem_size);
+      }
+    }
+    for (auto alloc : summary.dynamic_smem_allocations) {
+      if (alloc->alias() != nullptr) {
+        continue;
+      }
+      auto size = expr_eval.evaluate(alloc->size());
+      if (!size.has_value()) {
+        reason = "cannot infer the size of shared memory buffer T" +
+            std::to_string(alloc->buffer()->name());
+        return nullptr;
+      }
+      smem_size = ceilDiv(smem_size, (int64_t)16) * 16 +
+          size->as<int64_t>() *
+              (int64_t)dataTypeSize(alloc->buffer()->dtype());
+    }
+  } catch (const c10::Error& e) {
+    reason = "invalid launch configuration: " + e.msg();
+    return nullptr;
+  }
+
+  const auto profile = currentDeviceProfile();
+  if (launch_params.nThreads() > profile->max_threads_per_block) {
+    reason = "too many threads per block: " +
+        std::to_string(launch_params.nThreads());
+    return nullptr;
+  }
+  if (smem_size > profile->shared_mem_per_block_optin) {
+    reason = "too much shared memory: " + std::to_string(smem_size);
+    return nullptr;
+  }
+
+  constraints.setSmem(params.lparams.smem());
+  params.lparams = constraints;
+  launch_params.setSmem(smem_size);
+  candidate.launch_params = launch_params;
+  return scheduled_fusion;
+}
+
+} // namespace
+
+std::string TuningCandidate::toString() const {
+  std::stringstream ss;
+  ss << nvfuser::toString(heuristic) << " candidate, launch "
+     << launch_params.toString();
+  if (params != nullptr) {
+    ss << params->toString();
+  }
+  return ss.str();
+}
+
+KernelTimeTuningBackend::KernelTimeTuningBackend(
+    int64_t warmup_iterations,
+    int64_t iterations)
+    : warmup_iterations_(warmup_iterations), iterations_(iterations) {
+  TORCH_CHECK(iterations_ > 0, "At least one measured iteration is needed");
+}
+
+std::optional<double> KernelTimeTuningBackend::measure(
+    const TuningCandidate& candidate,
+    Fusion* scheduled_fusion,
+    const KernelArgumentHolder& args) {
+  FUSER_PERF_SCOPE("KernelTimeTuningBackend::measure");
+  const auto& params = *candidate.params;
+  std::vector<double> times;
+  try {
+    FusionExecutor fe;
+    fe.compileFusion(scheduled_fusion, args, params.lparams, params.cparams);
+    fe.setMeasureKernelTimeFlag(true);
+    for (auto i : c10::irange(warmup_iterations_ + iterations_)) {
+      KernelArgumentHolder run_args(args);
+      fe.runFusion(run_args, params.lparams, params.cparams);
+      if (i >= warmup_iterations_) {
+        times.push_back(fe.kernelTimeMs());
+      }
+    }
+  } catch (const c10::Error& e) {
+    if (isDebugDumpEnabled(DebugDumpOption::SchedulerDebug)) {
+      std::cout << "Failed to measure " << candidate.toString() << ": "
+                << e.msg() << std::endl;
+    }
+    return std::nullopt;
+  }
+  std::nth_element(
+      times.begin(), times.begin() + (int64_t)times.size() / 2, times.end());
+  return times.at(times.size() / 2);
+}
+
+ModelTuningBackend::ModelTuningBackend(Model model) : model_(std::move(model)) {
+  TORCH_CHECK(model_ != nullptr, "A model is required");
+}
+
+std::optional<double> ModelTuningBackend::measure(
+    const TuningCandidate& candidate,
+    Fusion* scheduled_fusion,
+    const KernelArgumentHolder& args) {
+  num_measured_++;
+  return model_(candidate);
+}
+
+std::string TuningReport::toString() const {
+  std::stringstream ss;
+  ss << "Tuning report: " << num_variants << " variants, " << num_pruned
+     << " pruned, " << num_duplicates << " duplicates, " << num_failed
+     << " failed, " << measured.size() << " measured\n";
+  if (best.has_value()) {
+    ss << "Best: " << best_time_ms << " ms, " << best->toString();
+  } else {
+    ss << "No candidate could be measured\n";
+  }
+  return ss.str();
+}
+
+std::vector<std::shared_ptr<HeuristicParams>> enumerateTuningVariants(
+    ScheduleHeuristic heuristic,
+    const HeuristicParams& seed,
+    const TuningSpace& space) {
+  VariantList variants(space.max_variants_per_heuristic);
+  variants.add(seed.clone());
+  switch (heuristic) {
+    case ScheduleHeuristic::PointWise: {
+      auto pparams = dynamic_cast<const PointwiseParams*>(&seed);
+      TORCH_INTERNAL_ASSERT(pparams != nullptr, "Expected pointwise params");
+      addPointwiseVariants(*pparams, space, variants);
+      break;
+    }
+    case ScheduleHeuristic::Reduction:
+    case ScheduleHeuristic::Persistent: {
+      auto rparams = dynamic_cast<const ReductionParams*>(&seed);
+      TORCH_INTERNAL_ASSERT(rparams != nullptr, "Expected reduction params");
+      addReductionVariants(*rparams, space, variants);
+      break;
+    }
+    case ScheduleHeuristic::Transpose: {
+      auto tparams = dynamic_cast<const TransposeParams*>(&seed);
+      TORCH_INTERNAL_ASSERT(tparams != nullptr, "Expected transpose params");
+      addTransposeVariants(*tparams, space, variants);
+      break;
+    }
+    case ScheduleHeuristic::Matmul: {
+      auto mparams = dynamic_cast<const MatmulParams*>(&seed);
+      TORCH_INTERNAL_ASSERT(mparams != nullptr, "Expected matmul params");
+      addMatmulVariants(*mparams, space, variants);
+      break;
+    }
+    default:
+      TORCH_INTERNAL_ASSERT(
+          false, "Cannot tune the parameters of heuristic ", heuristic);
+  }
+  return variants.variants();
+}
+
+TuningReport autotuneFusion(
+    Fusion* fusion,
+    const KernelArgumentHolder& args,
+    TuningBackend& backend,
+    const TuningSpace& space,
+    TuningDatabase* db) {
+  FUSER_PERF_SCOPE("autotuneFusion");
+  SchedulerRuntimeInfo runtime_info(fusion, args);
+
+  // NoOp has no parameters to tune
+  auto heuristics = space.heuristics;
+  if (heuristics.empty()) {
+    heuristics = {
+        ScheduleHeuristic::PointWise,
+        ScheduleHeuristic::Reduction,
+        ScheduleHeuristic::Persistent,
+        ScheduleHeuristic::Transpose,
+        ScheduleHeuristic::Matmul};
+  }
+
+  const bool debug = isDebugDumpEnabled(DebugDumpOption::SchedulerDebug);
+  TuningReport report;
+  std::vector<TuningCandidate> legal_candidates;
+  for (auto heuristic : heuristics) {
+    if (heuristic == ScheduleHeuristic::NoOp ||
+        !SchedulerEntry::canSchedule(heuristic, fusion, runtime_info)) {
+      continue;
+    }
+    auto seed = SchedulerEntry::makeEntryWithParams(
+                    heuristic, fusion, runtime_info, nullptr)
+                    ->params();
+    for (auto& params : enumerateTuningVariants(heuristic, *seed, space)) {
+      report.num_variants++;
+      TuningCandidate candidate;
+      candidate.heuristic = heuristic;
+      candidate.params = params;
+
+      std::string reason;
+      auto scheduled_fusion =
+          scheduleCandidate(fusion, runtime_info, args, candidate, reason);
+      if (scheduled_fusion == nullptr) {
+        report.num_pruned++;
+        if (debug) {
+          std::cout << "Pruned " << candidate.toString() << ": " << reason
+                    << std::endl;
+        }
+        continue;
+      }
+
+      if (std::any_of(
+              legal_candidates.begin(),
+              legal_candidates.end(),
+              [&](const TuningCandidate& other) {
+                return other.heuristic == heuristic &&
+                    sameVariant(other.params, params);
+              })) {
+        report.num_duplicates++;
+        continue;
+      }
+      legal_candidates.push_back(candidate);
+
+      auto time = backend.measure(candidate, scheduled_fusion.get(), args);
+      if (!time.has_value()) {
+        report.num_failed++;
+        continue;
+      }
+      report.measured.emplace_back(candidate, time.value());
+      if (!report.best.has_value() || time.value() < report.best_time_ms) {
+        report.best = candidate;
+        report.best_time_ms = time.value();
+      }
+    }
+  }
+
+  if (debug) {
+    std::cout << report.toString() << std::endl;
+  }
+
+  if (db != nullptr && report.best.has_value()) {
+    db->record(
+        makeTuningKey(report.best->heuristic, fusion, runtime_info),
+        *report.best->params);
+  }
+  return report;
+}
+
+} // namespace nvfuser
@@ -0,0 +1,170 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <c10/macros/Export.h>
+
+#include <executor_kernel_arg.h>
+#include <executor_params.h>
+#include <fusion.h>
+#include <scheduler/heuristic.h>
+#include <scheduler/tuning_db.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace nvfuser {
+
+//! Searches the parameter space of the schedulers for the fastest schedule
+//! of a fusion and records it in a TuningDatabase.
+//!
+//! The analytical parameters of every heuristic that can schedule the fusion
+//! are used as seeds, and variants of the seeds are enumerated by changing
+//! the knobs of TuningSpace. Variants are pruned if the fusion cannot be
+//! scheduled or lowered with them, or if the launch configuration they
+//! produce for the given inputs is not valid on the current device (see
+//! currentDeviceProfile). None of this needs a GPU. The remaining variants
+//! are measured with a TuningBackend, which is either the GPU or a
+//! deterministic model of it.
+//!
+//! Choosing between the reduction and persistent heuristics is part of the
+//! search, as both are seeds when they can schedule the fusion.
+
+//! Values tried for each knob. Knobs only apply to the parameters that have
+//! them, and the value of the seed is always tried.
+struct TORCH_CUDA_CU_API TuningSpace {
+  //! Unroll factors of pointwise kernels and of the inner reduction
+  //! dimension. Vectorization factors larger than the one of the seed are
+  //! skipped, as the seed vectorizes as wide as the inputs allow.
+  std::vector<int64_t> unroll_factors = {1, 2, 4, 8};
+  //! Unroll factors of the iteration dimension of reductions
+  std::vector<int64_t> iter_unroll_factors = {1, 2, 4};
+  //! Batches per block of persistent kernels
+  std::vector<int64_t> persistent_batches = {1, 2, 4, 8, 16};
+  //! Block sizes tried for blockDim.x and blockDim.y when the seed sets them
+  std::vector<int64_t> block_dims_x = {32, 64, 128, 256, 512, 1024};
+  std::vector<int64_t> block_dims_y = {1, 2, 4, 8, 16};
+  //! Tile sizes of the transpose scheduler
+  std::vector<size_t> transpose_tile_sizes = {16, 32, 64};
+  //! Circular buffering stages and grid swizzles of matmuls
+  std::vector<int> smem_double_buffer_stages = {2, 3, 4};
+  std::vector<int> grid_swizzle_factors = {1, 2, 4};
+  //! Heuristics to tune. All heuristics that can schedule the fusion are
+  //! tuned if empty.
+  std::vector<ScheduleHeuristic> heuristics;
+  //! Variants of a heuristic beyond this many are not enumerated
+  int64_t max_variants_per_heuristic = 512;
+};
+
+struct TORCH_CUDA_CU_API TuningCandidate {
+  ScheduleHeuristic heuristic = ScheduleHeuristic::None;
+  std::shared_ptr<HeuristicParams> params;
+  //! Launch configuration of the scheduled kernel for the tuned inputs. Only
+  //! set for candidates that passed the legality checks.
+  LaunchParams launch_params;
+
+  std::string toString() const;
+};
+
+//! Measures candidates that passed the legality checks
+class TORCH_CUDA_CU_API TuningBackend {
+ public:
+  virtual ~TuningBackend() = default;
+
+  //! Time in ms of one run of scheduled_fusion, which is the fusion
+  //! scheduled with candidate, for args. Returns std::nullopt if the
+  //! candidate cannot be measured, e.g., because it fails to compile.
+  virtual std::optional<double> measure(
+      const TuningCandidate& candidate,
+      Fusion* scheduled_fusion,
+      const KernelArgumentHolder& args) = 0;
+};
+
+//! Compiles and runs candidates on the current GPU and returns the median of
+//! the kernel times measured with CUDA events
+class TORCH_CUDA_CU_API KernelTimeTuningBackend : public TuningBackend {
+ public:
+  explicit KernelTimeTuningBackend(
+      int64_t warmup_iterations = 2,
+      int64_t iterations = 10);
+
+  std::optional<double> measure(
+      const TuningCandidate& candidate,
+      Fusion* scheduled_fusion,
+      const KernelArgumentHolder& args) override;
+
+ private:
+  int64_t warmup_iterations_ = 2;
+  int64_t iterations_ = 10;
+};
+
+//! Returns the time a model predicts for a candidate, so that the search
+//! can be run and tested without a GPU
+class TORCH_CUDA_CU_API ModelTuningBackend : public TuningBackend {
+ public:
+  using Model = std::function<std::optional<double>(const TuningCandidate&)>;
+
+  explicit ModelTuningBackend(Model model);
+
+  std::optional<double> measure(
+      const TuningCandidate& candidate,
+      Fusion* scheduled_fusion,
+      const KernelArgumentHolder& args) override;
+
+  //! Number of candidates measured so far
+  int64_t numMeasured() const {
+    return num_measured_;
+  }
+
+ private:
+  Model model_;
+  int64_t num_measured_ = 0;
+};
+
+struct TORCH_CUDA_CU_API TuningReport {
+  //! Fastest candidate, std::nullopt if no candidate could be measured
+  std::optional<TuningCandidate> best;
+  double best_time_ms = 0;
+  //! All measured candidates and their times, in the order of measurement
+  std::vector<std::pair<TuningCandidate, double>> measured;
+  //! Enumerated variants of all heuristics
+  int64_t num_variants = 0;
+  //! Variants that failed the legality checks
+  int64_t num_pruned = 0;
+  //! Variants that resolved to the same kernel as an earlier variant
+  int64_t num_duplicates = 0;
+  //! Variants the backend could not measure
+  int64_t num_failed = 0;
+
+  std::string toString() const;
+};
+
+//! Variants of seed, the parameters of heuristic, with the knobs of space
+//! changed. The first variant is a copy of the seed. Variants are not
+//! checked for legality.
+TORCH_CUDA_CU_API std::vector<std::shared_ptr<HeuristicParams>>
+enumerateTuningVariants(
+    ScheduleHeuristic heuristic,
+    const HeuristicParams& seed,
+    const TuningSpace& space);
+
+//! Tunes fusion, which must be an unscheduled fusion that can be scheduled
+//! as a single kernel, for args. The best candidate is recorded in db
+//! unless db is nullptr. Fusion is not modified.
+TORCH_CUDA_CU_API TuningReport autotuneFusion(
+    Fusion* fusion,
+    const KernelArgumentHolder& args,
+    TuningBackend& backend,
+    const TuningSpace& space = {},
+    TuningDatabase* db = &TuningDatabase::get());
+
+} // namespace nvfuser
@@ -11,6 +11,7 @@
 
 // NOTE: included to avoid compilation error caused by missing destructor in
 // 'SchedulerRuntimeInfo'
+#include <device_profile.h>
 #include <executor_utils.h>
 #include <ir/base_nodes.h>
 #include <ir/interface_nodes.h>
@@ -23,7 +24,6 @@
 #include <memory>
 #include <type_traits>
 #include <utility>
-#include "ATen/cuda/CUDAContext.h"
 #include "mma_type.h"
 #include "type.h"
 #include "utils.h"
@@ -500,9 +500,8 @@ std::shared_ptr<MatmulParams> getMatmulHeuristics(
   TORCH_INTERNAL_ASSERT(
       problem_shape.has_value(), "Failed to acquire problem shape.");
 
-  const auto device_prop = at::cuda::getCurrentDeviceProperties();
   const auto mma_op = getMmaOp(
-      device_prop->major * 10 + device_prop->minor, problem_shape.value());
+      currentDeviceProfile()->computeCapability(), problem_shape.value());
   TORCH_INTERNAL_ASSERT(
       mma_op.has_value(), "Can not determine MMA op for problem.");
 
@@ -7,6 +7,7 @@
 // clang-format on
 #include <scheduler/reduction.h>
 
+#include <device_profile.h>
 #include <executor_utils.h>
 #include <grouped_reduction.h>
 #include <inlining.h>
@@ -21,8 +22,6 @@
 #include <scheduler/vectorize_helper.h>
 #include <transform_replay.h>
 
-#include <ATen/cuda/CUDAContext.h>
-
 #include <cmath>
 
 namespace nvfuser {
@@ -127,16 +126,16 @@ std::shared_ptr<ReductionParams> innerOuterPersistentHeuristic(
         threads_per_sm / warp_size, allocated_warps_per_block);
   };
 
-  const auto dev_prop = at::cuda::getCurrentDeviceProperties();
+  const auto dev_profile = currentDeviceProfile();
   const int64_t device_multiprocessor_count =
-      (int64_t)dev_prop->multiProcessorCount;
+      dev_profile->multi_processor_count;
 
   // Step-1, set InnerParams reduction dim: inner_vect, inner_batch,
   // threads_per_block (bdimx * bdimy). Start threads_per_block from a quarter
   // warp, gradually increase it. Runtime checkCombinedReductionShape ensures
   // inner_dim_numel is dividable by the multiplication of a quarter warp and
   // vectorize_factor.
-  int64_t threads_per_block = dev_prop->warpSize / 4;
+  int64_t threads_per_block = dev_profile->warp_size / 4;
   iop.inner_vect = (int64_t)vectorize_factor;
   iop.inner_batch = inner_dim_numel / iop.inner_vect / threads_per_block;
   TORCH_INTERNAL_ASSERT(
@@ -173,7 +172,7 @@ std::shared_ptr<ReductionParams> innerOuterPersistentHeuristic(
       getEstimatedRegisterUsage(iop.inner_vect * iop.inner_batch);
   int64_t threads_per_sm = getThreadsPerSMGivenRegPerThread(reg_per_thread);
   int64_t blocks_per_sm =
-      getBlocksPerSM(threads_per_sm, threads_per_block, dev_prop->warpSize);
+      getBlocksPerSM(threads_per_sm, threads_per_block, dev_profile->warp_size);
   iop.gdimy = blocks_per_sm * device_multiprocessor_count;
   const int64_t outer_iter_min = 8;
   const int64_t gdimy_max = scheduler_utils::roundUpToN(
@@ -221,7 +220,7 @@ std::shared_ptr<ReductionParams> innerOuterPersistentHeuristic(
         getEstimatedRegisterUsage(iop.inner_vect * iop.inner_batch);
     threads_per_sm = getThreadsPerSMGivenRegPerThread(reg_per_thread);
     blocks_per_sm = getBlocksPerSM(
-        threads_per_sm, threads_per_block_mrpb, dev_prop->warpSize);
+        threads_per_sm, threads_per_block_mrpb, dev_profile->warp_size);
     iop.gdimy = blocks_per_sm * device_multiprocessor_count;
 
     // Step-3, OuterParams, Iteration dim: vectorization_factor_outer(reuse),
@@ -235,7 +234,7 @@ std::shared_ptr<ReductionParams> innerOuterPersistentHeuristic(
 
     // Step-4, OuterParams, Reduction dim: bdimx (already done)
 
-    if (iop.bdimx % dev_prop->warpSize == 0) {
+    if (iop.bdimx % dev_profile->warp_size == 0) {
       rparams->pad_inner_reduction_to_warp = true;
       rparams->pad_outer_reduction_to_warp = true;
     }
@@ -300,6 +299,7 @@ std::shared_ptr<ReductionParams> innerPersistentHeuristic(
     const int64_t n_tensor_inputs,
     const int64_t max_input_dtype_size,
     const int64_t max_persistent_buffer_size,
+    const int64_t smem_persistent_buffer_size,
     const size_t vectorize_factor) {
   // Set some targets for parallelization
   const int64_t n_elems = total_reduction_numel * total_iteration_numel;
@@ -307,14 +307,14 @@ std::shared_ptr<ReductionParams> innerPersistentHeuristic(
   const int64_t outer_reduction_numel =
       total_reduction_numel / inner_most_dimension_numel;
 
-  const auto dev_prop = at::cuda::getCurrentDeviceProperties();
+  const auto dev_profile = currentDeviceProfile();
   // WARNING: At some point we may want to generate heuristics for another
   // device that is not the current device.
   const int64_t device_max_threads_per_multiprocessor =
-      (int64_t)dev_prop->maxThreadsPerMultiProcessor;
+      dev_profile->max_threads_per_multi_processor;
 
   const int64_t device_multiprocessor_count =
-      (int64_t)dev_prop->multiProcessorCount;
+      dev_profile->multi_processor_count;
 
   auto const max_unroll = ceilDiv(
       // Available unrolling based on size of data type
@@ -332,7 +332,8 @@ std::shared_ptr<ReductionParams> innerPersistentHeuristic(
   // we can use a smaller warp size. While thread local data fits in l1, and
   // reduction dim is really small, we can use <32 threads per warp.
   const bool fits_in_l2 =
-      n_elems * max_input_dtype_size * n_tensor_inputs < dev_prop->l2CacheSize;
+      n_elems * max_input_dtype_size * n_tensor_inputs <
+      dev_profile->l2_cache_size;
 
   // If it fits in l2, we just want to make sure each warp uses 32Bytes. Set
   // minimum warp as 16 threads instead of 32 as if we have a small reduction
@@ -420,7 +421,7 @@ std::shared_ptr<ReductionParams> innerPersistentHeuristic(
       // reductions
       max_threads_in_block = std::min(
           ceilDiv(n_elems, target_blocks * target_unroll),
-          (int64_t)dev_prop->maxThreadsPerBlock);
+          dev_profile->max_threads_per_block);
     } else {
       // targetting 4 waves, so try to use a quarter of available threads
       max_threads_in_block = std::min(
@@ -433,15 +434,23 @@ std::shared_ptr<ReductionParams> innerPersistentHeuristic(
   if (max_threads_in_block % warp_size != 0) {
     max_threads_in_block += warp_size - max_threads_in_block % warp_size;
     max_threads_in_block =
-        std::min(max_threads_in_block, (int64_t)dev_prop->maxThreadsPerBlock);
+        std::min(max_threads_in_block, dev_profile->max_threads_per_block);
   }
   // Compute maximum number of reductions we could do in the same kernel based
   // on persistent buffer size. Bounded by the wave count for utilization of
-  // SMs.
-  const int64_t max_multi_reduction_factor = std::min(
+  // SMs, and by shared memory if some of the buffers are kept there.
+  int64_t max_multi_reduction_factor = std::min(
       scheduler_utils::safeDiv(
           scheduler_utils::register_file_size, max_persistent_buffer_size),
       ceilDiv(total_iteration_numel, device_multiprocessor_count));
+  if (smem_persistent_buffer_size > 0) {
+    max_multi_reduction_factor = std::min(
+        max_multi_reduction_factor,
+        scheduler_utils::safeDiv(
+            normalization_scheduler_utils::
+                availableSharedMemoryPersistenceSize(),
+            smem_persistent_buffer_size));
+  }
 
   // To get to target threads:
   // Prioritize
@@ -518,7 +527,7 @@ std::shared_ptr<ReductionParams> innerPersistentHeuristic(
   constexpr int64_t scheduler_per_sm = 4;
   if (outer_reduction_numel == 1 && vectorize) {
     bdimx = std::min(
-        scheduler_per_sm * dev_prop->warpSize, threads_after_vectorize);
+        scheduler_per_sm * dev_profile->warp_size, threads_after_vectorize);
   }
 
   // If we don't have a full warp, let's do multiple reductions per block.
@@ -527,7 +536,7 @@ std::shared_ptr<ReductionParams> innerPersistentHeuristic(
   if (bdimx * bdimy * bdimz < warp_size) {
     bdimy = std::min(
         scheduler_utils::safeDiv(
-            scheduler_per_sm * dev_prop->warpSize, bdimx * bdimz),
+            scheduler_per_sm * dev_profile->warp_size, bdimx * bdimz),
         max_multi_reduction_factor);
   }
 
@@ -645,13 +654,13 @@ std::shared_ptr<ReductionParams> innerPersistentHeuristic(
     batches_per_block_outer_reduction /= 2l;
   }
 
-  auto device_warp_size = (int64_t)at::cuda::warp_size();
+  auto device_warp_size = currentDeviceProfile()->warp_size;
   auto padded_bdimx = bdimx % device_warp_size == 0
       ? bdimx
       : bdimx + (device_warp_size - bdimx % device_warp_size);
 
   bool pad_bdimx = bdimx > 16 &&
-      padded_bdimx * bdimy * bdimz < (int64_t)dev_prop->maxThreadsPerBlock;
+      padded_bdimx * bdimy * bdimz < dev_profile->max_threads_per_block;
 
   // estimate register usage and occupancy raito.
   // If occupancy raito is less than a preset occupancy_ratio, reduce register
@@ -716,7 +725,7 @@ std::shared_ptr<ReductionParams> innerPersistentHeuristic(
     constexpr double occupancy_ratio = 0.4;
     const int64_t blocks_per_sm_wanted = ceilDiv(
         static_cast<int64_t>(
-            dev_prop->maxThreadsPerMultiProcessor * occupancy_ratio),
+            dev_profile->max_threads_per_multi_processor * occupancy_ratio),
         threads_per_block);
 
     // if estimated blocks is smaller than wanted and decrease register usage
@@ -810,6 +819,8 @@ std::shared_ptr<ReductionParams> innerPersistentHeuristic(
               << "max_input_dtype_size: " << max_input_dtype_size << "\n"
               << "max_persistent_buffer_size: " << max_persistent_buffer_size
               << "\n"
+              << "smem_persistent_buffer_size: " << smem_persistent_buffer_size
+              << "\n"
               << "max_multi_reduction_factor: " << max_multi_reduction_factor
               << "\n"
               << "block(" << (pad_bdimx ? padded_bdimx : bdimx) << ", " << bdimy
@@ -906,22 +917,21 @@ std::shared_ptr<ReductionParams> outerPersistentHeuristic(
 
   // WARNING: Current device for codegen may not be the target device
   const int64_t device_max_threads_per_multiprocessor =
-      (int64_t)at::cuda::getCurrentDeviceProperties()
-          ->maxThreadsPerMultiProcessor;
+      currentDeviceProfile()->max_threads_per_multi_processor;
 
   const int64_t device_multiprocessor_count =
-      (int64_t)at::cuda::getCurrentDeviceProperties()->multiProcessorCount;
+      currentDeviceProfile()->multi_processor_count;
 
   // If it fits in l2, we just want to make sure each warp uses 32Bytes. Set
   // minimum warp as 16 threads instead of 32 as if we have a small reduction
   // dim going a bit smaller than 32 usually helps.
   const int64_t warp_size = n_elems * max_input_dtype_size * n_tensor_inputs <
-          at::cuda::getCurrentDeviceProperties()->l2CacheSize
+          currentDeviceProfile()->l2_cache_size
       ? (int64_t)32 / max_input_dtype_size
       : 16;
 
   const auto register_file_size =
-      at::cuda::getCurrentDeviceProperties()->regsPerBlock * sizeof(int);
+      currentDeviceProfile()->regs_per_block * sizeof(int);
 
   // Each block runs N reductions, where N is defined as:
   // vectorize_factor * blockDim.x. The minimum number of SMs to run
@@ -1198,6 +1208,7 @@ std::shared_ptr<ReductionParams> persistentHeuristic(
     const size_t max_input_dtype_size,
     const size_t tmp_gmem_dtype_size,
     const int64_t max_persistent_buffer_size,
+    const int64_t smem_persistent_buffer_size,
     size_t vectorize_factor,
     bool project_persistent_buffers,
     const bool combined_inner_outer_reduction) {
@@ -1219,6 +1230,7 @@ std::shared_ptr<ReductionParams> persistentHeuristic(
         (int64_t)n_tensor_inputs,
         (int64_t)max_input_dtype_size,
         max_persistent_buffer_size,
+        smem_persistent_buffer_size,
         vectorize_factor);
   } else {
     rparams = outerPersistentHeuristic(
@@ -1369,6 +1381,24 @@ std::shared_ptr<ReductionParams> getPersistentHeuristics(
     }
   }
 
+  // Inner normalizations whose buffers don't fit in registers keep some of
+  // the buffers in shared memory
+  normalization_scheduler_utils::SharedMemoryPersistence smem_persistence;
+  if (!combined_inner_outer_reduction && properties.fastest_dim_reduction) {
+    const bool projected = project_persistent_buffers &&
+        ir_utils::getViewOps(fusion).empty();
+    auto plan = normalization_scheduler_utils::planSharedMemoryPersistence(
+        projected ? persistent_buffer_size_info.projected_buffer_sizes
+                  : persistent_buffer_size_info.buffer_sizes,
+        max_persistent_size,
+        scheduler_utils::register_file_size,
+        normalization_scheduler_utils::availableSharedMemoryPersistenceSize());
+    if (plan.has_value()) {
+      smem_persistence = plan.value();
+      max_persistent_size = smem_persistence.register_buffer_size;
+    }
+  }
+
   auto unrollable_inputs_outputs_entry =
       HeuristicSummaryEntry<HeuristicCompileTime::UnrollableInputsAndOutputs>(
           data_cache, [&first_red_tv]() {
@@ -1421,9 +1451,11 @@ std::shared_ptr<ReductionParams> getPersistentHeuristics(
       max_dtype_size,
       tmp_gmem_dtype_size,
       max_persistent_size,
+      smem_persistence.smem_buffer_size,
       vectorize_factor,
       project_persistent_buffers,
       combined_inner_outer_reduction);
+  heuristic->smem_persistent_buffers = smem_persistence.n_smem_buffers;
   heuristic->cparams.index_type = runtime_info.getIndexType();
   return heuristic;
 }
@@ -1545,6 +1577,23 @@ void schedulePersistentKernel(Fusion* fusion, const ReductionParams& rparams) {
       reduction_tvs,
       cached_outputs);
 
+  // Buffers are projected and cached at this point, so these are the buffers
+  // the heuristics chose from
+  std::vector<TensorView*> smem_persistent_buffers;
+  if (rparams.smem_persistent_buffers > 0) {
+    smem_persistent_buffers =
+        normalization_scheduler_utils::sharedMemoryPersistenceOrder(
+            scheduler_utils::persistentBuffers(fusion).persistent_buffers);
+    TORCH_INTERNAL_ASSERT(
+        (int64_t)smem_persistent_buffers.size() >=
+            rparams.smem_persistent_buffers,
+        "Expected at least ",
+        rparams.smem_persistent_buffers,
+        " persistent buffers but found ",
+        smem_persistent_buffers.size());
+    smem_persistent_buffers.resize(rparams.smem_persistent_buffers);
+  }
+
   TensorView* reference_tv =
       scheduleReductionGeneral(fusion, rparams, reduction_tvs);
 
@@ -1584,6 +1633,12 @@ void schedulePersistentKernel(Fusion* fusion, const ReductionParams& rparams) {
     }
   }
 
+  // Lowering allocates and indexes the buffers across the threads of the
+  // block
+  for (auto buffer : smem_persistent_buffers) {
+    buffer->setMemoryType(MemoryType::Shared);
+  }
+
   scheduler_utils::promoteProducerMemoryTypes(fusion, cached_inputs);
 }
 
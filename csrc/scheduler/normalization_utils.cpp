@@ -5,13 +5,16 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 // clang-format on
+#include <device_profile.h>
 #include <expr_evaluator.h>
 #include <scheduler/debug_utils.h>
 #include <scheduler/normalization_utils.h>
 #include <scheduler/registry.h>
 #include <utils.h>
 
-#include <ATen/cuda/CUDAContext.h>
+#include <algorithm>
+#include <unordered_map>
+
 namespace nvfuser {
 namespace normalization_scheduler_utils {
 
@@ -59,7 +62,7 @@ bool PreferredLaunchConfig::setBdimx(int bdimx, bool dry_run) {
 void PreferredLaunchConfig::initValidGdims() {
   std::vector<std::pair<int, int>> grid_dims;
   const int num_sms =
-      at::cuda::getCurrentDeviceProperties()->multiProcessorCount;
+      currentDeviceProfile()->multi_processor_count;
   const int max_first_half =
       static_cast<int>(std::sqrt(static_cast<float>(num_sms)));
   for (int gdimy = 2; gdimy <= max_first_half; ++gdimy) {
@@ -452,8 +455,8 @@ std::optional<GridOuterNormalizationParams> getGridOuterNormalizationParams(
     int64_t adjusted_gdimy = -1;
     int64_t adjusted_buffer_size = -1;
     bool last_block_work_reduced = false;
-    const auto major_ver = at::cuda::getCurrentDeviceProperties()->major;
-    const auto minor_ver = at::cuda::getCurrentDeviceProperties()->minor;
+    const auto major_ver = currentDeviceProfile()->major;
+    const auto minor_ver = currentDeviceProfile()->minor;
     if (major_ver == 7 && minor_ver == 5) {
       adjusted_gdimy = launch_cfg.gdimy();
       adjusted_buffer_size = getMinPersistentBufferSize(
@@ -625,5 +628,66 @@ int64_t partialReductionBufferSize(
   return partial_reduction_buffer_size;
 }
 
+std::vector<TensorView*> sharedMemoryPersistenceOrder(
+    std::vector<TensorView*> buffers) {
+  std::stable_sort(
+      buffers.begin(), buffers.end(), [](TensorView* a, TensorView* b) {
+        return dataTypeSize(a->getDataType().value()) >
+            dataTypeSize(b->getDataType().value());
+      });
+  return buffers;
+}
+
+int64_t availableSharedMemoryPersistenceSize() {
+  const auto dev_profile = currentDeviceProfile();
+  const int64_t smem_per_block = dev_profile->shared_mem_per_block_optin > 0
+      ? dev_profile->shared_mem_per_block_optin
+      : dev_profile->shared_mem_per_block;
+  // Room for a block Welford reduction of doubles, which is the largest
+  // reduction workspace
+  const int64_t reduction_workspace_size = dev_profile->max_threads_per_block *
+      3 * (int64_t)dataTypeSize(DataType::Double);
+  return std::max(smem_per_block - reduction_workspace_size, (int64_t)0);
+}
+
+std::optional<SharedMemoryPersistence> planSharedMemoryPersistence(
+    const std::vector<std::pair<TensorView*, int64_t>>& buffer_sizes,
+    int64_t persistent_buffer_size,
+    int64_t register_size,
+    int64_t smem_size) {
+  SharedMemoryPersistence plan;
+  plan.register_buffer_size = persistent_buffer_size;
+  if (persistent_buffer_size <= register_size) {
+    return plan;
+  }
+  if (isOptionDisabled(DisableOption::SmemPersistence)) {
+    return std::nullopt;
+  }
+
+  std::vector<TensorView*> buffers;
+  std::unordered_map<TensorView*, int64_t> sizes;
+  for (const auto& [buffer, size] : buffer_sizes) {
+    buffers.push_back(buffer);
+    sizes[buffer] = size;
+  }
+  for (auto buffer : sharedMemoryPersistenceOrder(buffers)) {
+    if (plan.register_buffer_size <= register_size) {
+      break;
+    }
+    plan.n_smem_buffers++;
+    plan.smem_buffer_size += sizes.at(buffer);
+    // Not all buffers are necessarily alive at the same time, so this
+    // may underestimate the registers left in use
+    plan.register_buffer_size =
+        std::max(plan.register_buffer_size - sizes.at(buffer), (int64_t)0);
+  }
+
+  if (plan.register_buffer_size > register_size ||
+      plan.smem_buffer_size > smem_size) {
+    return std::nullopt;
+  }
+  return plan;
+}
+
 } // namespace normalization_scheduler_utils
 } // namespace nvfuser
@@ -180,5 +180,39 @@ bool isConnectedOnlyThroughReductionProducer(
 int64_t partialReductionBufferSize(
     const std::vector<TensorView*>& outer_reduction_tvs,
     SchedulerRuntimeInfo& runtime_info);
+
+//! Persistent buffers of an inner normalization kept in shared memory
+//! because not all of the buffers fit in registers
+struct SharedMemoryPersistence {
+  //! Number of buffers in shared memory, taken in the order of
+  //! sharedMemoryPersistenceOrder
+  int64_t n_smem_buffers = 0;
+  //! Bytes of the buffers of one normalization in shared memory
+  int64_t smem_buffer_size = 0;
+  //! Bytes of the buffers of one normalization left in registers
+  int64_t register_buffer_size = 0;
+};
+
+//! Order in which persistent buffers are moved to shared memory. Buffers of
+//! an inner normalization persist along the same reduction domain, so
+//! buffers with larger elements are moved first, which doesn't need their
+//! runtime sizes when scheduling.
+std::vector<TensorView*> sharedMemoryPersistenceOrder(
+    std::vector<TensorView*> buffers);
+
+//! Shared memory of a block available for persistent buffers, leaving room
+//! for the workspace of block reductions
+int64_t availableSharedMemoryPersistenceSize();
+
+//! Moves persistent buffers to shared memory until the rest fits in
+//! register_size bytes. buffer_sizes are the sizes of the persistent buffers
+//! and persistent_buffer_size the size of those alive at the same time.
+//! Returns nullopt if the moved buffers don't fit in smem_size bytes either,
+//! or if shared memory persistence is disabled.
+std::optional<SharedMemoryPersistence> planSharedMemoryPersistence(
+    const std::vector<std::pair<TensorView*, int64_t>>& buffer_sizes,
+    int64_t persistent_buffer_size,
+    int64_t register_size,
+    int64_t smem_size);
 } // namespace normalization_scheduler_utils
 } // namespace nvfuser
@@ -8,6 +8,7 @@
 #include <scheduler/pointwise.h>
 
 #include <device_lower/utils.h>
+#include <device_profile.h>
 #include <executor_utils.h>
 #include <inlining.h>
 #include <instrumentation.h>
@@ -20,8 +21,6 @@
 #include <transform_replay.h>
 #include <utils.h>
 
-#include <ATen/cuda/CUDAContext.h>
-
 #include <algorithm>
 #include <unordered_map>
 
@@ -103,7 +102,7 @@ std::shared_ptr<PointwiseParams> getPointwiseHeuristics(
   TORCH_INTERNAL_ASSERT(largest_out != nullptr);
 
   const int64_t device_multiprocessor_count =
-      (int64_t)at::cuda::getCurrentDeviceProperties()->multiProcessorCount;
+      currentDeviceProfile()->multi_processor_count;
 
   // TODO: Set to 1?
   int64_t max_input_dtype_size = 2;
@@ -311,14 +310,14 @@ std::shared_ptr<PointwiseParams> getPointwiseHeuristics(
         // Need to be able to parallelize, don't use break if there's not
         // at least an unrolled warp.
         if (ceilDiv(cur_right_elem_count, max_unroll_factor) <=
-            at::cuda::getCurrentDeviceProperties()->warpSize) {
+            currentDeviceProfile()->warp_size) {
           continue;
         }
 
         // If outer broadcast, or balanced broadcast:
         if (lhs_byte_multiple <= rhs_byte_multiple &&
             // If right transfer size is bigger than half of L2
-            at::cuda::getCurrentDeviceProperties()->l2CacheSize <
+            currentDeviceProfile()->l2_cache_size <
                 right_transfer_size * 2) {
           // flip BIDx and BIDy bindings
           flip_grid_binding = true;
@@ -7,6 +7,7 @@
 // clang-format on
 #include <scheduler/reduction.h>
 
+#include <device_profile.h>
 #include <executor_utils.h>
 #include <instrumentation.h>
 #include <ir/all_nodes.h>
@@ -19,7 +20,6 @@
 
 #include <ir/iostream.h>
 
-#include <ATen/cuda/CUDAContext.h>
 
 namespace nvfuser {
 
@@ -77,14 +77,13 @@ std::shared_ptr<ReductionParams> innerReductionHeuristic(
 
   const int64_t n_elems = total_reduction_numel * total_iteration_numel;
 
-  // WARNING: At some point we may want to generate heuristics for another
-  // device that is not the current device.
+  // Heuristics target the current device profile, which can be injected to
+  // generate heuristics for a device that is not the current device
   const int64_t device_max_threads_per_multiprocessor =
-      (int64_t)at::cuda::getCurrentDeviceProperties()
-          ->maxThreadsPerMultiProcessor;
+      currentDeviceProfile()->max_threads_per_multi_processor;
 
   const int64_t device_multiprocessor_count =
-      (int64_t)at::cuda::getCurrentDeviceProperties()->multiProcessorCount;
+      currentDeviceProfile()->multi_processor_count;
 
   auto const max_unroll = ceilDiv(
       // Available unrolling based on size of data type
@@ -103,7 +102,7 @@ std::shared_ptr<ReductionParams> innerReductionHeuristic(
   // we can use a smaller warp size. While thread local data fits in l1, and
   // reduction dim is really small, we can use <32 threads per warp.
   const bool fits_in_l2 = n_elems * max_input_dtype_size * n_tensor_inputs <
-      at::cuda::getCurrentDeviceProperties()->l2CacheSize;
+      currentDeviceProfile()->l2_cache_size;
 
   // If it fits in l2, we just want to make sure each warp uses 32Bytes. Set
   // minimum warp as 16 threads instead of 32 as if we have a small reduction
@@ -389,7 +388,7 @@ std::shared_ptr<ReductionParams> innerReductionHeuristic(
   rparams->multiple_reds_per_blk = bdimy > 1;
   bool pad_bdimx = bdimx > 16 &&
       bdimx * bdimy <
-          (int64_t)at::cuda::getCurrentDeviceProperties()->maxThreadsPerBlock;
+          currentDeviceProfile()->max_threads_per_block;
   // If barely just covering reduction dim, don't pad to the next warp
   pad_bdimx = pad_bdimx &&
       bdimx * inner_reduction_unroll_factor != inner_most_dimension_numel;
@@ -398,7 +397,7 @@ std::shared_ptr<ReductionParams> innerReductionHeuristic(
   if (rparams->pad_inner_reduction_to_warp) {
     // Adjust bdimx based on padding
     auto min_warp_size =
-        (int64_t)at::cuda::getCurrentDeviceProperties()->warpSize;
+        currentDeviceProfile()->warp_size;
     bdimx = bdimx % min_warp_size == 0
         ? bdimx
         : bdimx + min_warp_size - bdimx % min_warp_size;
@@ -516,13 +515,13 @@ std::shared_ptr<ReductionParams> outerReductionHeuristic(
     const int64_t n_tensor_inputs,
     const int64_t max_input_dtype_size,
     const size_t vectorize_factor) {
-  // WARNING: Current device for codegen may not be the target device
+  // Heuristics target the current device profile, which can be injected to
+  // generate heuristics for a device that is not the current device
   const int64_t device_max_threads_per_multiprocessor =
-      (int64_t)at::cuda::getCurrentDeviceProperties()
-          ->maxThreadsPerMultiProcessor;
+      currentDeviceProfile()->max_threads_per_multi_processor;
 
   const int64_t device_multiprocessor_count =
-      (int64_t)at::cuda::getCurrentDeviceProperties()->multiProcessorCount;
+      currentDeviceProfile()->multi_processor_count;
 
   auto const max_unroll = ceilDiv(
       // Available unrolling based on size of data type
@@ -540,7 +539,7 @@ std::shared_ptr<ReductionParams> outerReductionHeuristic(
   // TODO: Could get a much more accurate estimation of it the problem fits in
   // L2
   const bool fits_in_l2 = n_elems * max_input_dtype_size * n_tensor_inputs <
-      at::cuda::getCurrentDeviceProperties()->l2CacheSize;
+      currentDeviceProfile()->l2_cache_size;
 
   const int64_t min_warp_size = fits_in_l2 ? 16 : 32;
 
@@ -977,6 +976,63 @@ std::shared_ptr<ReductionParams> getReductionHeuristics(
   return heuristic;
 }
 
+namespace {
+
+// Cost model of two-stage reductions, in microseconds. The last block of
+// each output of a grid reduction waits for the partial results of the
+// other blocks, which arrive one at a time through a semaphore in global
+// memory. A two-stage reduction instead pays for a second kernel launch and
+// for moving the partial results through a workspace.
+constexpr double kGridSyncUsPerBlock = 0.02;
+constexpr double kKernelLaunchUs = 5.0;
+constexpr double kWorkspaceBytesPerUs = 5.0e5;
+
+} // namespace
+
+int64_t splitReductionFactor(
+    const ReductionParams& rparams,
+    int64_t total_iteration_numel,
+    int64_t partial_result_size) {
+  if (!rparams.cross_grid_inner_reduction &&
+      !rparams.cross_grid_outer_reduction) {
+    return 1;
+  }
+
+  // Blocks that cooperate on each output of the grid reduction
+  int64_t blocks_per_output = 1;
+  for (auto ptype :
+       {rparams.grid_dim_inner_reduction, rparams.grid_dim_outer_reduction}) {
+    if (isParallelTypeBlockDim(ptype) && rparams.lparams.hasDim(ptype)) {
+      blocks_per_output *= rparams.lparams.getDim(ptype);
+    }
+  }
+  if (blocks_per_output <= 1) {
+    return 1;
+  }
+
+  const double grid_cost = (double)blocks_per_output * kGridSyncUsPerBlock;
+  // The workspace is written by the first kernel and read by the second
+  const double workspace_bytes = 2.0 *
+      (double)(total_iteration_numel * blocks_per_output *
+               partial_result_size);
+  const double split_cost =
+      kKernelLaunchUs + workspace_bytes / kWorkspaceBytesPerUs;
+  return grid_cost > split_cost ? blocks_per_output : 1;
+}
+
+std::vector<int64_t> SplitReductionInput::splitSizes(
+    const std::vector<int64_t>& sizes) const {
+  TORCH_INTERNAL_ASSERT(
+      reduction_axis < (int64_t)sizes.size() &&
+          sizes.at(reduction_axis) % chunks == 0,
+      "Reduction extent must be a multiple of ",
+      chunks);
+  auto split_sizes = sizes;
+  split_sizes.at(reduction_axis) /= chunks;
+  split_sizes.insert(split_sizes.begin() + reduction_axis, chunks);
+  return split_sizes;
+}
+
 // fusion is the input IR that will be modified by this function
 void scheduleReduction(Fusion* fusion, const ReductionParams& rparams) {
   FUSER_PERF_SCOPE("scheduleReduction");
@@ -12,6 +12,8 @@
 #include <fusion.h>
 #include <scheduler/reduction_heuristic.h>
 
+#include <vector>
+
 namespace nvfuser {
 
 class SchedulerRuntimeInfo;
@@ -30,4 +32,39 @@ TORCH_CUDA_CU_API std::shared_ptr<ReductionParams> getReductionHeuristics(
 TORCH_CUDA_CU_API void scheduleReduction(
     Fusion* fusion,
     const ReductionParams& rparams);
+
+//! Number of chunks to split the reduction domain into so that the fusion
+//! runs as two kernels instead of the single grid reduction kernel of
+//! rparams: a partial reduction of each chunk into a workspace, and a
+//! reduction of the partial results. Returns 1 if the single kernel is
+//! expected to be faster or doesn't reduce across the grid. Partial results
+//! are partial_result_size bytes each.
+TORCH_CUDA_CU_API int64_t splitReductionFactor(
+    const ReductionParams& rparams,
+    int64_t total_iteration_numel,
+    int64_t partial_result_size);
+
+//! A fusion input that a fusion rewritten for a two-stage reduction reads
+//! with different sizes, see SegmentCandidateFinder::splitReductionInFusion
+struct TORCH_CUDA_CU_API SplitReductionInput {
+  //! Position of the input in the inputs of the fusion
+  int64_t input_index = 0;
+  //! Axis of the input that is reduced
+  int64_t reduction_axis = 0;
+  //! Number of chunks the first stage reduces the reduction axis in
+  int64_t chunks = 1;
+
+  //! Sizes the rewritten fusion reads an input of the given sizes with. The
+  //! reduction axis is split into the chunks and their elements.
+  std::vector<int64_t> splitSizes(const std::vector<int64_t>& sizes) const;
+
+  bool operator==(const SplitReductionInput& other) const {
+    return input_index == other.input_index &&
+        reduction_axis == other.reduction_axis && chunks == other.chunks;
+  }
+
+  bool operator!=(const SplitReductionInput& other) const {
+    return !(*this == other);
+  }
+};
 } // namespace nvfuser
@@ -28,6 +28,10 @@ class ReductionParams : public HeuristicParams {
   // Project persistent buffers back to inputs to reduce persistent buffer size
   bool project_persistent_buffers = false;
 
+  // Number of persistent buffers kept in shared memory instead of registers,
+  // see normalization_scheduler_utils::sharedMemoryPersistenceOrder
+  int64_t smem_persistent_buffers = 0;
+
   // Are we treating the scheduling as 3 dimensional, can be useful for patterns
   // like [reduction, iteration, reduction].
   bool schedule_3D = false;
@@ -148,6 +152,7 @@ class ReductionParams : public HeuristicParams {
         other.fastest_dim == fastest_dim &&
         other.persistent_kernel == persistent_kernel &&
         other.project_persistent_buffers == project_persistent_buffers &&
+        other.smem_persistent_buffers == smem_persistent_buffers &&
         other.schedule_3D == schedule_3D && other.flip_grid == flip_grid &&
         other.cross_block_inner_reduction == cross_block_inner_reduction &&
         other.cross_grid_inner_reduction == cross_grid_inner_reduction &&
@@ -195,6 +200,10 @@ class ReductionParams : public HeuristicParams {
        << (fastest_dim ? "Red On Fastest Dim\n" : "Red On Slow Dim\n")
        << (persistent_kernel ? "Persistent Kernel\n" : "")
        << (project_persistent_buffers ? "Project Persistent Buffers\n" : "");
+    if (smem_persistent_buffers > 0) {
+      ss << "Shared memory persistent buffers: " << smem_persistent_buffers
+         << "\n";
+    }
     if (batches_per_block_inner_reduction > 1 || persistent_kernel) {
       ss << "Batches per block: " << batches_per_block_inner_reduction << "\n";
     }
@@ -300,7 +309,8 @@ class ReductionParams : public HeuristicParams {
         static_cast<size_t>(batches_per_block_outer_reduction) << (bits - 21) ^
         static_cast<size_t>(unroll_factor_outer_reduction) << (bits - 22) ^
         static_cast<size_t>(compute_persistent_buffer_with_first_consumer)
-            << (bits - 23);
+            << (bits - 23) ^
+        static_cast<size_t>(smem_persistent_buffers) << (bits - 24);
     return attr_hash;
   }
 
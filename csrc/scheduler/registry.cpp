@@ -6,6 +6,7 @@
  */
 // clang-format on
 #include <c10/util/irange.h>
+#include <device_profile.h>
 #include <disjoint_set.h>
 #include <executor_utils.h>
 #include <expr_evaluator.h>
@@ -19,11 +20,11 @@
 #include <scheduler/pointwise.h>
 #include <scheduler/registry.h>
 #include <scheduler/transpose.h>
+#include <scheduler/tuning_db.h>
 #include <scheduler/utils.h>
 
 #include <limits>
 
-#include <ATen/cuda/CUDAContext.h>
 
 namespace nvfuser {
 
@@ -927,12 +928,80 @@ PrimDataType getIndexTypeOfKernel(
 
 } // namespace
 
+ShapeBuckets ShapeBuckets::powersOfTwo() {
+  ShapeBuckets buckets;
+  buckets.enabled = true;
+  return buckets;
+}
+
+ShapeBuckets ShapeBuckets::fromBoundaries(std::vector<int64_t> boundaries) {
+  TORCH_CHECK(!boundaries.empty(), "Shape buckets need at least one boundary");
+  std::sort(boundaries.begin(), boundaries.end());
+  boundaries.erase(
+      std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+  TORCH_CHECK(
+      boundaries.front() > 0,
+      "Shape bucket boundaries must be positive, got ",
+      boundaries.front());
+  ShapeBuckets buckets;
+  buckets.enabled = true;
+  buckets.boundaries = std::move(boundaries);
+  return buckets;
+}
+
+ShapeBuckets ShapeBuckets::fromOptions() {
+  if (!isOptionEnabled(EnableOption::ShapeBuckets)) {
+    return {};
+  }
+  const auto& args = getEnableOptionArguments(EnableOption::ShapeBuckets);
+  if (args.empty()) {
+    return powersOfTwo();
+  }
+  std::vector<int64_t> boundaries;
+  boundaries.reserve(args.size());
+  for (const auto& arg : args) {
+    try {
+      boundaries.push_back(std::stoll(arg));
+    } catch (const std::exception&) {
+      TORCH_CHECK(false, "Invalid shape bucket boundary: ", arg);
+    }
+  }
+  return fromBoundaries(std::move(boundaries));
+}
+
+int64_t ShapeBuckets::snap(int64_t extent) const {
+  if (!enabled || extent <= 1) {
+    return extent;
+  }
+  int64_t upper = 1;
+  if (boundaries.empty()) {
+    while (upper < extent) {
+      upper *= 2;
+    }
+  } else {
+    auto it = std::lower_bound(boundaries.begin(), boundaries.end(), extent);
+    if (it == boundaries.end()) {
+      return extent;
+    }
+    upper = *it;
+  }
+  // The snapped extent must be congruent to extent modulo the smallest power
+  // of two that doesn't divide extent, up to 16
+  int64_t modulus = 2;
+  while (modulus < 16 && extent % modulus == 0) {
+    modulus *= 2;
+  }
+  return upper - (upper - extent) % modulus;
+}
+
 SchedulerRuntimeInfo::SchedulerRuntimeInfo(
     Fusion* complete_fusion,
     KernelArgumentHolder args,
     PrecomputedValues* precomputed_values,
     const std::vector<TensorView*>& all_tvs,
-    std::optional<PrimDataType> forced_index_type)
+    std::optional<PrimDataType> forced_index_type,
+    bool assume_aligned_inputs,
+    const ShapeBuckets* shape_buckets)
     : complete_fusion_(complete_fusion) {
   TORCH_INTERNAL_ASSERT(
       complete_fusion_->inputs().size() == args.size(),
@@ -965,7 +1034,10 @@ SchedulerRuntimeInfo::SchedulerRuntimeInfo(
     if (auto tensor_arg_abstract =
             dynamic_cast<const TensorArgAbstract*>(kernel_arg)) {
       auto fusion_inp = complete_fusion_->inputs()[inp_i];
-      input_ptrs_[fusion_inp] = tensor_arg_abstract->getPointerAddress();
+      // Inputs without a recorded pointer are treated as aligned, see ptrOf
+      if (!assume_aligned_inputs) {
+        input_ptrs_[fusion_inp] = tensor_arg_abstract->getPointerAddress();
+      }
 
       // find and push discontiguous stride
       auto dtype_size = dataTypeSize(tensor_arg_abstract->getDataType());
@@ -986,6 +1058,41 @@ SchedulerRuntimeInfo::SchedulerRuntimeInfo(
       }
     }
   }
+
+  if (shape_buckets != nullptr && shape_buckets->enabled) {
+    snapInputExtents(args, *shape_buckets);
+  }
+}
+
+void SchedulerRuntimeInfo::snapInputExtents(
+    const KernelArgumentHolder& args,
+    const ShapeBuckets& shape_buckets) {
+  FUSER_PERF_SCOPE("SchedulerRuntimeInfo::snapInputExtents");
+  // Start from a fresh evaluator, as the current one may hold values
+  // computed from the actual extents
+  auto snapped_evaluator = std::make_unique<ExpressionEvaluator>(
+      executor_utils::bindInputs(args, complete_fusion_));
+  for (auto tv :
+       ir_utils::filterByType<TensorView>(complete_fusion_->inputs())) {
+    for (auto id : TensorDomain::noReductions(tv->getMaybeRFactorDomain())) {
+      std::vector<Val*> extents{id->extent()};
+      if (id->hasExpandedExtent()) {
+        extents.push_back(id->expandedExtent());
+      }
+      for (auto extent : extents) {
+        if (extent->isConstScalar() || extent->definition() != nullptr) {
+          continue;
+        }
+        auto value = snapped_evaluator->evaluate(extent);
+        if (!value.has_value()) {
+          continue;
+        }
+        snapped_evaluator->bind(
+            extent, shape_buckets.snap(value->as<int64_t>()));
+      }
+    }
+  }
+  expression_evaluator_ = std::move(snapped_evaluator);
 }
 
 SchedulerRuntimeInfo::SchedulerRuntimeInfo(
@@ -1356,9 +1463,12 @@ class ReductionScheduler : public SchedulerEntry {
   explicit ReductionScheduler(
       Fusion* fusion,
       SchedulerRuntimeInfo& runtime_info,
-      HeuristicSummary* data_cache = nullptr)
-      : SchedulerEntry(ScheduleHeuristic::Reduction) {
-    computeHeuristics(fusion, runtime_info, data_cache);
+      HeuristicSummary* data_cache = nullptr,
+      std::shared_ptr<HeuristicParams> tuned_params = nullptr)
+      : SchedulerEntry(ScheduleHeuristic::Reduction, std::move(tuned_params)) {
+    if (params_ == nullptr) {
+      computeHeuristics(fusion, runtime_info, data_cache);
+    }
   }
 
   //! Check if the reduction heuristics apply in given fusion
@@ -1533,9 +1643,12 @@ class TransposeScheduler : public SchedulerEntry {
   explicit TransposeScheduler(
       Fusion* fusion,
       SchedulerRuntimeInfo& runtime_info,
-      HeuristicSummary* data_cache = nullptr)
-      : SchedulerEntry(ScheduleHeuristic::Transpose) {
-    computeHeuristics(fusion, runtime_info, data_cache);
+      HeuristicSummary* data_cache = nullptr,
+      std::shared_ptr<HeuristicParams> tuned_params = nullptr)
+      : SchedulerEntry(ScheduleHeuristic::Transpose, std::move(tuned_params)) {
+    if (params_ == nullptr) {
+      computeHeuristics(fusion, runtime_info, data_cache);
+    }
   }
 
   static bool canScheduleCompileTime(Fusion* fusion) {
@@ -1655,9 +1768,12 @@ class PointWiseScheduler : public SchedulerEntry {
   explicit PointWiseScheduler(
       Fusion* fusion,
       SchedulerRuntimeInfo& runtime_info,
-      HeuristicSummary* data_cache = nullptr)
-      : SchedulerEntry(ScheduleHeuristic::PointWise) {
-    computeHeuristics(fusion, runtime_info, data_cache);
+      HeuristicSummary* data_cache = nullptr,
+      std::shared_ptr<HeuristicParams> tuned_params = nullptr)
+      : SchedulerEntry(ScheduleHeuristic::PointWise, std::move(tuned_params)) {
+    if (params_ == nullptr) {
+      computeHeuristics(fusion, runtime_info, data_cache);
+    }
   }
 
   static bool canScheduleCompileTime(Fusion* fusion) {
@@ -1748,9 +1864,12 @@ class PersistentKernelScheduler : public SchedulerEntry {
   explicit PersistentKernelScheduler(
       Fusion* fusion,
       SchedulerRuntimeInfo& runtime_info,
-      HeuristicSummary* data_cache = nullptr)
-      : SchedulerEntry(ScheduleHeuristic::Persistent) {
-    computeHeuristics(fusion, runtime_info, data_cache);
+      HeuristicSummary* data_cache = nullptr,
+      std::shared_ptr<HeuristicParams> tuned_params = nullptr)
+      : SchedulerEntry(ScheduleHeuristic::Persistent, std::move(tuned_params)) {
+    if (params_ == nullptr) {
+      computeHeuristics(fusion, runtime_info, data_cache);
+    }
   }
 
   void schedule(Fusion* fusion) override {
@@ -1947,26 +2066,27 @@ class PersistentKernelScheduler : public SchedulerEntry {
           fusion, runtime_info, data_cache, reduction_tvs, properties);
     }
 
-    // pair of persistent_buffer_size and available_persistent_buffer_size
+    // pair of persistent_buffer_size, excluding buffers kept in shared
+    // memory, and available_persistent_buffer_size
     const std::pair<int64_t, int64_t> buffer_size = getPersistentBufferSize(
         fusion, runtime_info, data_cache, reduction_tvs);
     const int64_t persistent_buffer_size = buffer_size.first;
     const int64_t available_persistent_buffer_size = buffer_size.second;
 
     const int64_t device_multiprocessor_count =
-        (int64_t)at::cuda::getCurrentDeviceProperties()->multiProcessorCount;
+        currentDeviceProfile()->multi_processor_count;
 
     if (persistent_buffer_size > available_persistent_buffer_size) {
       scheduler_debug_utils::canScheduleRejectReason(
-          ScheduleHeuristic::Persistent, "not enough registers for persistece");
+          ScheduleHeuristic::Persistent,
+          "not enough registers or shared memory for persistence");
       return false;
     }
 
     const int64_t device_max_threads_per_multiprocessor =
-        (int64_t)at::cuda::getCurrentDeviceProperties()
-            ->maxThreadsPerMultiProcessor;
+        currentDeviceProfile()->max_threads_per_multi_processor;
 
-    const int64_t warp_size = at::cuda::warp_size();
+    const int64_t warp_size = currentDeviceProfile()->warp_size;
 
     // Maximum number of iteration dimensions we can have and still be
     // persistent.
@@ -2090,7 +2210,7 @@ class PersistentKernelScheduler : public SchedulerEntry {
     // quarter warp. So we have enough bdimx threads to cover the iteration
     // domain of the outer reductions to avoid low performance.
     const int64_t quarter_warp =
-        at::cuda::getCurrentDeviceProperties()->warpSize / 4;
+        currentDeviceProfile()->warp_size / 4;
     for (auto tv : reduction_tvs) {
       int64_t n_elements = 1;
       const int64_t vectorization_factor = 16 /
@@ -2170,6 +2290,27 @@ class PersistentKernelScheduler : public SchedulerEntry {
         ? scheduler_utils::register_file_size_full
         : scheduler_utils::register_file_size;
 
+    // Inner normalizations can keep some of the buffers in shared memory,
+    // like in getPersistentHeuristics. Only the buffers left in registers
+    // are returned.
+    const bool fastest_dim_reduction =
+        inner_reduction_count && !outer_reduction_count;
+    if (fastest_dim_reduction) {
+      const bool projected = persistent_buffer_size <
+          persistent_buffer_size_info.persistent_buffer_size;
+      auto smem_persistence =
+          normalization_scheduler_utils::planSharedMemoryPersistence(
+              projected ? persistent_buffer_size_info.projected_buffer_sizes
+                        : persistent_buffer_size_info.buffer_sizes,
+              persistent_buffer_size,
+              available_persistent_buffer_size,
+              normalization_scheduler_utils::
+                  availableSharedMemoryPersistenceSize());
+      if (smem_persistence.has_value()) {
+        persistent_buffer_size = smem_persistence->register_buffer_size;
+      }
+    }
+
     return std::make_pair(
         persistent_buffer_size, available_persistent_buffer_size);
   }
@@ -2183,10 +2324,10 @@ class PersistentKernelScheduler : public SchedulerEntry {
     FUSER_PERF_SCOPE("PersistentKernelScheduler::canScheduleRuntimeOuter");
     FusionGuard fg(fusion);
 
-    const auto device_prop = at::cuda::getCurrentDeviceProperties();
+    const auto device_profile = currentDeviceProfile();
 
     const int64_t sm_register_file_size =
-        static_cast<int64_t>(device_prop->regsPerBlock * sizeof(int));
+        static_cast<int64_t>(device_profile->regs_per_block * sizeof(int));
 
     auto persistent_buffer_info_entry =
         HeuristicSummaryEntry<HeuristicCompileTime::PersistentBufferInfo>(
@@ -2209,7 +2350,7 @@ class PersistentKernelScheduler : public SchedulerEntry {
               persistent_buffer_size_info.projected_persistent_buffer_size);
 
     const int64_t device_multiprocessor_count =
-        (int64_t)device_prop->multiProcessorCount;
+        device_profile->multi_processor_count;
 
     const auto available_persistent_buffer_size =
         sm_register_file_size * device_multiprocessor_count;
@@ -2325,7 +2466,7 @@ class PersistentKernelScheduler : public SchedulerEntry {
     }
 
     const int64_t device_max_threads_per_multiprocessor =
-        (int64_t)device_prop->maxThreadsPerMultiProcessor;
+        device_profile->max_threads_per_multi_processor;
     const int64_t min_fraction_of_sms =
         scheduler_utils::safeDiv(device_multiprocessor_count, 8);
     if (properties.total_reduction_numel >=
@@ -2364,7 +2505,7 @@ class PersistentKernelScheduler : public SchedulerEntry {
              (vectorization_factor * cross_grid_params->launch_params.bdimx() *
               cross_grid_params->launch_params.gdimx()) !=
          0) &&
-        device_prop->major == 7) {
+        device_profile->major == 7) {
       scheduler_debug_utils::canScheduleRejectReason(
           ScheduleHeuristic::Persistent, "iteration not evenly divided");
       return false;
@@ -2379,9 +2520,12 @@ class MatmulScheduler : public SchedulerEntry {
   explicit MatmulScheduler(
       Fusion* fusion,
       SchedulerRuntimeInfo& runtime_info,
-      HeuristicSummary* data_cache = nullptr)
-      : SchedulerEntry(ScheduleHeuristic::Matmul) {
-    computeHeuristics(fusion, runtime_info);
+      HeuristicSummary* data_cache = nullptr,
+      std::shared_ptr<HeuristicParams> tuned_params = nullptr)
+      : SchedulerEntry(ScheduleHeuristic::Matmul, std::move(tuned_params)) {
+    if (params_ == nullptr) {
+      computeHeuristics(fusion, runtime_info);
+    }
   }
 
   void schedule(Fusion* fusion) override {
@@ -2501,6 +2645,22 @@ std::unique_ptr<SchedulerEntry> SchedulerEntry::makeEntry(
     Fusion* fusion,
     SchedulerRuntimeInfo& runtime_info,
     HeuristicSummary* data_cache) {
+  // Parameters recorded in the tuning database take precedence over the
+  // analytical heuristics
+  return makeEntryWithParams(
+      sh,
+      fusion,
+      runtime_info,
+      TuningDatabase::get().lookup(sh, fusion, runtime_info),
+      data_cache);
+}
+
+std::unique_ptr<SchedulerEntry> SchedulerEntry::makeEntryWithParams(
+    ScheduleHeuristic sh,
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info,
+    std::shared_ptr<HeuristicParams> params,
+    HeuristicSummary* data_cache) {
   std::unique_ptr<SchedulerEntry> scheduler_entry = nullptr;
   switch (sh) {
     case ScheduleHeuristic::NoOp:
@@ -2509,23 +2669,23 @@ std::unique_ptr<SchedulerEntry> SchedulerEntry::makeEntry(
       break;
     case ScheduleHeuristic::PointWise:
       scheduler_entry = std::make_unique<PointWiseScheduler>(
-          fusion, runtime_info, data_cache);
+          fusion, runtime_info, data_cache, params);
       break;
     case ScheduleHeuristic::Reduction:
       scheduler_entry = std::make_unique<ReductionScheduler>(
-          fusion, runtime_info, data_cache);
+          fusion, runtime_info, data_cache, params);
       break;
     case ScheduleHeuristic::Persistent:
       scheduler_entry = std::make_unique<PersistentKernelScheduler>(
-          fusion, runtime_info, data_cache);
+          fusion, runtime_info, data_cache, params);
       break;
     case ScheduleHeuristic::Transpose:
       scheduler_entry = std::make_unique<TransposeScheduler>(
-          fusion, runtime_info, data_cache);
+          fusion, runtime_info, data_cache, params);
       break;
     case ScheduleHeuristic::Matmul:
-      scheduler_entry =
-          std::make_unique<MatmulScheduler>(fusion, runtime_info, data_cache);
+      scheduler_entry = std::make_unique<MatmulScheduler>(
+          fusion, runtime_info, data_cache, params);
       break;
     default:
       TORCH_INTERNAL_ASSERT(false, "unreachable");
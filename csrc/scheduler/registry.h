@@ -23,6 +23,34 @@ namespace nvfuser {
 class SegmentedGroup;
 class ExpressionEvaluator;
 
+//! Buckets of input extents. When enabled, the extents of the fusion inputs
+//! are snapped to the upper bound of their bucket before heuristics are
+//! computed, so all extents of a bucket get the same heuristics and can run
+//! the same kernels, which predicate the extents they are launched with.
+//! This bounds the number of kernels compiled for workloads with variable
+//! sizes, e.g., sequence lengths.
+struct TORCH_CUDA_CU_API ShapeBuckets {
+  bool enabled = false;
+  //! Upper bounds of the buckets in increasing order. Extents are snapped
+  //! to the next power of two if empty. Extents larger than the last
+  //! boundary are not snapped.
+  std::vector<int64_t> boundaries;
+
+  static ShapeBuckets powersOfTwo();
+  static ShapeBuckets fromBoundaries(std::vector<int64_t> boundaries);
+
+  //! Buckets of the shape_buckets option of PYTORCH_NVFUSER_ENABLE, e.g.,
+  //! shape_buckets for powers of two or shape_buckets(64,128,512) for
+  //! boundaries. Disabled if the option is not set.
+  static ShapeBuckets fromOptions();
+
+  //! Value heuristics see for extent. It is the largest value of the bucket
+  //! with the same divisibility by 2, 4, 8 and 16 as extent, so that the
+  //! vectorization factors of the heuristics are valid for extent. Extents
+  //! of 0 and 1 are not snapped.
+  int64_t snap(int64_t extent) const;
+};
+
 //!  SchedulerRuntimeInfo is the abstraction introduced in
 //! this PR for passing runtime input dependent information
 //! to the schedulers and kernel caches.
@@ -49,12 +77,23 @@ class TORCH_CUDA_CU_API SchedulerRuntimeInfo : public NonCopyable {
   //! The index type of forced_index_type is used if given, no matter
   //! how large the actual arguments and fusion tensors
   //! are. CORRECTNESS IS NOT GUARANTEED.
+  //!
+  //! If assume_aligned_inputs is true, the data pointers of the inputs are
+  //! assumed to be aligned to max_alignment_size_in_byte, so heuristics do
+  //! not depend on them. Kernels scheduled this way must only be launched
+  //! with aligned inputs, see FusionExecutor::hasAlignedVectorizedTensors.
+  //!
+  //! If shape_buckets is given and enabled, the expression evaluator binds
+  //! the extents of the inputs to their snapped values, see ShapeBuckets.
+  //! The index type is computed from the actual extents.
   SchedulerRuntimeInfo(
       Fusion* complete_fusion,
       KernelArgumentHolder args,
       PrecomputedValues* precomputed_values = nullptr,
       const std::vector<TensorView*>& all_tvs = {},
-      std::optional<PrimDataType> forced_index_type = std::nullopt);
+      std::optional<PrimDataType> forced_index_type = std::nullopt,
+      bool assume_aligned_inputs = false,
+      const ShapeBuckets* shape_buckets = nullptr);
 
   SchedulerRuntimeInfo(
       Fusion* complete_fusion,
@@ -97,6 +136,11 @@ class TORCH_CUDA_CU_API SchedulerRuntimeInfo : public NonCopyable {
       const KernelArgumentHolder& inputs,
       PrecomputedValues* precomputed_values);
 
+  // Rebind the extents of the input tensors to their bucketed values
+  void snapInputExtents(
+      const KernelArgumentHolder& args,
+      const ShapeBuckets& shape_buckets);
+
   bool isInputTv(TensorView* tv) {
     return std::find(
                complete_fusion_->inputs().begin(),
@@ -151,6 +195,16 @@ class TORCH_CUDA_CU_API SchedulerEntry {
       SchedulerRuntimeInfo& runtime_info,
       HeuristicSummary* data_cache = nullptr);
 
+  //! Builds a new entry with the given parameters, or with the parameters of
+  //!  the analytical heuristics if params is nullptr. Unlike makeEntry, the
+  //!  tuning database is not consulted.
+  static std::unique_ptr<SchedulerEntry> makeEntryWithParams(
+      ScheduleHeuristic sh,
+      Fusion* fusion,
+      SchedulerRuntimeInfo& runtime_info,
+      std::shared_ptr<HeuristicParams> params,
+      HeuristicSummary* data_cache = nullptr);
+
   virtual ~SchedulerEntry() = default;
 
   //! External access for canSchedule utilities through SchedulerEntry
@@ -217,8 +271,12 @@ class TORCH_CUDA_CU_API SchedulerEntry {
   }
 
  protected:
-  explicit SchedulerEntry(ScheduleHeuristic heuristic)
-      : heuristic_(heuristic) {}
+  //! params are the parameters recorded in the tuning database, if any.
+  //! The analytical heuristics are only computed without them.
+  explicit SchedulerEntry(
+      ScheduleHeuristic heuristic,
+      std::shared_ptr<HeuristicParams> params = nullptr)
+      : params_(std::move(params)), heuristic_(heuristic) {}
 
   //! Heuristic parameters if applicable
   std::shared_ptr<HeuristicParams> params_ = nullptr;
@@ -8,6 +8,7 @@
 #include <scheduler/transpose.h>
 
 #include <device_lower/utils.h>
+#include <device_profile.h>
 #include <executor_utils.h>
 #include <inlining.h>
 #include <instrumentation.h>
@@ -20,8 +21,6 @@
 #include <transform_replay.h>
 #include <utils.h>
 
-#include <ATen/cuda/CUDAContext.h>
-
 #include <algorithm>
 
 namespace nvfuser {
@@ -519,7 +518,7 @@ std::string getTransposeRuntimeRejectReason(
 
   // don't schedule with transpose scheduler if less than a full wave
   const int64_t device_multiprocessor_count =
-      (int64_t)at::cuda::getCurrentDeviceProperties()->multiProcessorCount;
+      currentDeviceProfile()->multi_processor_count;
   auto elements_per_wave = device_multiprocessor_count * default_tile_elements;
   if ((int64_t)elements_per_wave > n_elems) {
     return "Transpose scheduler does not perform well on small problem sizes.";
@@ -609,7 +608,7 @@ std::shared_ptr<TransposeParams> getTransposeHeuristics(
   auto& n_elems = pair.second;
 
   const int64_t device_multiprocessor_count =
-      (int64_t)at::cuda::getCurrentDeviceProperties()->multiProcessorCount;
+      currentDeviceProfile()->multi_processor_count;
 
   auto innermost_info_entry = getInnerMostDimInfoInReference(
       data_cache, reference_tensors, reference1, domain_map);
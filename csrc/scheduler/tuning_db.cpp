@@ -0,0 +1,727 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <scheduler/tuning_db.h>
+
+#include <device_profile.h>
+#include <instrumentation.h>
+#include <ir/all_nodes.h>
+#include <ir/utils.h>
+#include <kernel_db/utils.h>
+#include <scheduler/matmul_heuristic.h>
+#include <scheduler/pointwise_heuristic.h>
+#include <scheduler/reduction_heuristic.h>
+#include <scheduler/transpose_heuristic.h>
+
+#include <c10/util/hash.h>
+#include <c10/util/irange.h>
+
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <type_traits>
+
+namespace nvfuser {
+
+namespace {
+
+const std::string tuning_db_magic = "nvfuser_tuning_db";
+
+int64_t bucketExtent(int64_t extent) {
+  // Size-0 and size-1 dimensions are scheduled differently, so they get
+  // their own buckets
+  if (extent <= 1) {
+    return extent;
+  }
+  int64_t bucket = 2;
+  while (bucket < extent) {
+    bucket *= 2;
+  }
+  return bucket;
+}
+
+std::vector<std::string> split(const std::string& str, char delimiter) {
+  std::vector<std::string> tokens;
+  std::stringstream ss(str);
+  std::string token;
+  while (std::getline(ss, token, delimiter)) {
+    tokens.push_back(token);
+  }
+  return tokens;
+}
+
+//! Percent-encodes the characters that would break the csv format
+std::string escapeField(const std::string& str) {
+  std::stringstream ss;
+  for (char c : str) {
+    switch (c) {
+      case '%':
+        ss << "%25";
+        break;
+      case ',':
+        ss << "%2C";
+        break;
+      case '\r':
+        ss << "%0D";
+        break;
+      case '\n':
+        ss << "%0A";
+        break;
+      default:
+        ss << c;
+    }
+  }
+  return ss.str();
+}
+
+//! Inverse of escapeField
+std::string unescapeField(const std::string& str) {
+  std::string result;
+  result.reserve(str.size());
+  for (size_t i = 0; i < str.size(); ++i) {
+    if (str[i] == '%') {
+      TORCH_CHECK(
+          i + 2 < str.size(), "Corrupted tuning database fingerprint: ", str);
+      result += (char)std::stoi(str.substr(i + 1, 2), nullptr, 16);
+      i += 2;
+    } else {
+      result += str[i];
+    }
+  }
+  return result;
+}
+
+//! Widest vectorization, in elements, input tv allows
+int64_t inputVectorWidth(TensorView* tv, SchedulerRuntimeInfo& runtime_info) {
+  const auto dtype_size = (int64_t)dataTypeSize(tv->getDataType().value());
+  const auto vector_width = std::min(
+      (int64_t)runtime_info.getAlignmentSize(tv) / dtype_size,
+      (int64_t)runtime_info.getMaxVectorizableWidth(tv));
+  return std::max(vector_width, (int64_t)1);
+}
+
+bool isPowerOfTwo(int64_t value) {
+  return value > 0 && (value & (value - 1)) == 0;
+}
+
+//! Writes the visited fields as name=value pairs
+class ParamsWriter {
+ public:
+  template <typename T>
+  void operator()(const char* name, const T& value) {
+    ss_ << (first_ ? "" : " ") << name << "=";
+    first_ = false;
+    write(value);
+  }
+
+  std::string str() const {
+    return ss_.str();
+  }
+
+ private:
+  template <typename T>
+  void write(const T& value) {
+    if constexpr (std::is_enum_v<T>) {
+      ss_ << static_cast<int>(value);
+    } else {
+      ss_ << value;
+    }
+  }
+
+  void write(const GemmTile& tile) {
+    ss_ << tile.m << ":" << tile.n << ":" << tile.k;
+  }
+
+  void write(const std::vector<size_t>& values) {
+    ss_ << (values.empty() ? "-" : toDelimitedString(values, "/"));
+  }
+
+  void write(const std::vector<std::pair<size_t, size_t>>& values) {
+    if (values.empty()) {
+      ss_ << "-";
+    }
+    for (const auto i : c10::irange(values.size())) {
+      ss_ << (i == 0 ? "" : "/") << values[i].first << ":" << values[i].second;
+    }
+  }
+
+  std::stringstream ss_;
+  bool first_ = true;
+};
+
+//! Reads the visited fields from name=value pairs. Fields that are not
+//! given keep their values.
+class ParamsReader {
+ public:
+  explicit ParamsReader(const std::string& serialized) {
+    std::stringstream ss(serialized);
+    for (std::string token; ss >> token;) {
+      const auto eq = token.find('=');
+      TORCH_CHECK(
+          eq != std::string::npos, "Invalid heuristic parameter: ", token);
+      values_[token.substr(0, eq)] = token.substr(eq + 1);
+    }
+  }
+
+  template <typename T>
+  void operator()(const char* name, T& value) {
+    auto it = values_.find(name);
+    if (it != values_.end()) {
+      read(it->second, value);
+    }
+  }
+
+ private:
+  template <typename T>
+  void read(const std::string& str, T& value) {
+    if constexpr (std::is_enum_v<T>) {
+      value = static_cast<T>(std::stoi(str));
+    } else if constexpr (std::is_same_v<T, bool>) {
+      value = std::stoi(str) != 0;
+    } else {
+      static_assert(std::is_integral_v<T>, "Unsupported parameter type");
+      value = static_cast<T>(std::stoll(str));
+    }
+  }
+
+  void read(const std::string& str, GemmTile& tile) {
+    auto dims = split(str, ':');
+    TORCH_CHECK(dims.size() == 3, "Invalid gemm tile: ", str);
+    tile = GemmTile(std::stoi(dims[0]), std::stoi(dims[1]), std::stoi(dims[2]));
+  }
+
+  void read(const std::string& str, std::vector<size_t>& values) {
+    values.clear();
+    if (str == "-") {
+      return;
+    }
+    for (const auto& value : split(str, '/')) {
+      values.push_back(std::stoull(value));
+    }
+  }
+
+  void read(
+      const std::string& str,
+      std::vector<std::pair<size_t, size_t>>& values) {
+    values.clear();
+    if (str == "-") {
+      return;
+    }
+    for (const auto& value : split(str, '/')) {
+      auto pair = split(value, ':');
+      TORCH_CHECK(pair.size() == 2, "Invalid pair: ", value);
+      values.emplace_back(std::stoull(pair[0]), std::stoull(pair[1]));
+    }
+  }
+
+  std::unordered_map<std::string, std::string> values_;
+};
+
+//! Visits the fields shared by all heuristics. The tag is free-form text and
+//! is not visited. LaunchParams only exposes its dimensions through
+//! accessors, so they are visited as copies and written back.
+template <typename Visitor, typename Params>
+void visitCommonFields(Visitor& visitor, Params& params) {
+  int64_t index_type = params.cparams.index_type.has_value()
+      ? static_cast<int64_t>(params.cparams.index_type.value())
+      : -1;
+  visitor("index_type", index_type);
+  visitor("maxrregcount", params.cparams.maxrregcount);
+  visitor("enable_magic_zero", params.cparams.enable_magic_zero);
+
+  std::array<int64_t, 6> dims;
+  for (const auto i : c10::irange(dims.size())) {
+    dims[i] = params.lparams.getRawVal(kParallelTypeThreads[i]);
+  }
+  int64_t smem = params.lparams.smem();
+  visitor("gdimx", dims[0]);
+  visitor("gdimy", dims[1]);
+  visitor("gdimz", dims[2]);
+  visitor("bdimx", dims[3]);
+  visitor("bdimy", dims[4]);
+  visitor("bdimz", dims[5]);
+  visitor("smem", smem);
+
+  if constexpr (!std::is_const_v<Params>) {
+    params.cparams.index_type = index_type < 0
+        ? std::nullopt
+        : std::optional<PrimDataType>(static_cast<PrimDataType>(index_type));
+    params.lparams =
+        LaunchParams(dims[0], dims[1], dims[2], dims[3], dims[4], dims[5]);
+    params.lparams.setSmem(smem);
+  }
+}
+
+template <typename Visitor, typename Params>
+void visitFields(Visitor& visitor, Params& params) {
+  using P = std::remove_const_t<Params>;
+  if constexpr (std::is_same_v<P, ReductionParams>) {
+    visitor("fastest_dim", params.fastest_dim);
+    visitor("persistent_kernel", params.persistent_kernel);
+    visitor("project_persistent_buffers", params.project_persistent_buffers);
+    visitor("smem_persistent_buffers", params.smem_persistent_buffers);
+    visitor("schedule_3D", params.schedule_3D);
+    visitor("flip_grid", params.flip_grid);
+    visitor("cross_block_inner_reduction", params.cross_block_inner_reduction);
+    visitor("cross_grid_inner_reduction", params.cross_grid_inner_reduction);
+    visitor(
+        "unroll_factor_inner_reduction", params.unroll_factor_inner_reduction);
+    visitor("vectorize_inner_reduction", params.vectorize_inner_reduction);
+    visitor(
+        "split_grid_dim_inner_reduction",
+        params.split_grid_dim_inner_reduction);
+    visitor("pad_inner_reduction_to_warp", params.pad_inner_reduction_to_warp);
+    visitor(
+        "batches_per_block_inner_reduction",
+        params.batches_per_block_inner_reduction);
+    visitor("block_dim_inner_reduction", params.block_dim_inner_reduction);
+    visitor("grid_dim_inner_reduction", params.grid_dim_inner_reduction);
+    visitor("multiple_reds_per_blk", params.multiple_reds_per_blk);
+    visitor("unroll_factor_iter_dom", params.unroll_factor_iter_dom);
+    visitor("vectorize_iter_dom", params.vectorize_iter_dom);
+    visitor(
+        "split_grid_dim_iter_dom_inner", params.split_grid_dim_iter_dom_inner);
+    visitor(
+        "split_grid_dim_iter_dom_outer", params.split_grid_dim_iter_dom_outer);
+    visitor("block_dim_iter_dom", params.block_dim_iter_dom);
+    visitor("grid_dim_iter_dom", params.grid_dim_iter_dom);
+    visitor("cross_block_outer_reduction", params.cross_block_outer_reduction);
+    visitor("cross_grid_outer_reduction", params.cross_grid_outer_reduction);
+    visitor(
+        "split_grid_dim_outer_reduction",
+        params.split_grid_dim_outer_reduction);
+    visitor(
+        "batches_per_block_outer_reduction",
+        params.batches_per_block_outer_reduction);
+    visitor(
+        "unroll_factor_outer_reduction", params.unroll_factor_outer_reduction);
+    visitor("block_dim_outer_reduction", params.block_dim_outer_reduction);
+    visitor("grid_dim_outer_reduction", params.grid_dim_outer_reduction);
+    visitor(
+        "compute_persistent_buffer_with_first_consumer",
+        params.compute_persistent_buffer_with_first_consumer);
+    visitor("static_bdimx", params.static_bdimx);
+    visitor("static_bdimy", params.static_bdimy);
+    visitor("combined_inner_outer", params.combined_inner_outer);
+    visitor("tidx_for_outer_reduction", params.tidx_for_outer_reduction);
+    visitor("pad_outer_reduction_to_warp", params.pad_outer_reduction_to_warp);
+    visitor("vectorization_factor_outer", params.vectorization_factor_outer);
+    visitor(
+        "vectorization_factor_tmp_gmem_write",
+        params.vectorization_factor_tmp_gmem_write);
+    visitor(
+        "block_dim_inner_reduction_extra",
+        params.block_dim_inner_reduction_extra);
+  } else if constexpr (std::is_same_v<P, PointwiseParams>) {
+    visitor("vectorize", params.vectorize);
+    visitor("break_point", params.break_point);
+    visitor("split_block", params.split_block);
+    visitor("split_grid_y_dim", params.split_grid_y_dim);
+    visitor("flip_grid_binding", params.flip_grid_binding);
+    visitor("unroll_factor", params.unroll_factor);
+  } else if constexpr (std::is_same_v<P, TransposeParams>) {
+    visitor("split_before_tiling", params.split_before_tiling);
+    visitor("dims_merged_with_1", params.dims_merged_with_1);
+    visitor("dims_merged_with_2", params.dims_merged_with_2);
+    visitor("vectorize_factor1", params.vectorize_factor1);
+    visitor("vectorize_factor2", params.vectorize_factor2);
+    visitor("tile_size1", params.tile_size1);
+    visitor("tile_size2", params.tile_size2);
+  } else if constexpr (std::is_same_v<P, MatmulParams>) {
+    visitor(
+        "rotate_ldmatrix_out_of_main_loop",
+        params.rotate_ldmatrix_out_of_main_loop);
+    visitor("async_gmem_load_operands", params.async_gmem_load_operands);
+    visitor("cta_tile", params.tile_sizes.cta_tile);
+    visitor("warp_tile", params.tile_sizes.warp_tile);
+    visitor("instruction_tile", params.tile_sizes.instruction_tile);
+    visitor("mma_macro", params.mma_macro);
+    visitor("cta_order", params.cta_order);
+    visitor(
+        "double_buffer_smem_write",
+        params.double_buffer_options.double_buffer_smem_write);
+    visitor(
+        "double_buffer_smem_read",
+        params.double_buffer_options.double_buffer_smem_read);
+    visitor(
+        "smem_double_buffer_stage",
+        params.double_buffer_options.smem_double_buffer_stage);
+    visitor("grid_swizzle_factor", params.grid_swizzle_factor);
+  }
+  visitCommonFields(visitor, params);
+}
+
+std::shared_ptr<HeuristicParams> makeParams(ScheduleHeuristic heuristic) {
+  switch (heuristic) {
+    case ScheduleHeuristic::PointWise:
+      return std::make_shared<PointwiseParams>();
+    case ScheduleHeuristic::Reduction:
+    case ScheduleHeuristic::Persistent:
+      return std::make_shared<ReductionParams>();
+    case ScheduleHeuristic::Transpose:
+      return std::make_shared<TransposeParams>();
+    case ScheduleHeuristic::Matmul:
+      return std::make_shared<MatmulParams>();
+    default:
+      return nullptr;
+  }
+}
+
+ScheduleHeuristic heuristicFromString(const std::string& name) {
+  for (auto heuristic :
+       {ScheduleHeuristic::PointWise,
+        ScheduleHeuristic::Reduction,
+        ScheduleHeuristic::Persistent,
+        ScheduleHeuristic::Transpose,
+        ScheduleHeuristic::Matmul}) {
+    if (toString(heuristic) == name) {
+      return heuristic;
+    }
+  }
+  TORCH_CHECK(false, "Unknown heuristic in tuning database: ", name);
+  return ScheduleHeuristic::None;
+}
+
+} // namespace
+
+size_t TuningKeyHash::operator()(const TuningKey& key) const {
+  return c10::get_hash(
+      key.fingerprint.hash,
+      static_cast<int>(key.heuristic),
+      key.device_major,
+      key.device_minor,
+      key.multi_processor_count,
+      key.shape_signature);
+}
+
+std::string shapeSignature(
+    PrimDataType index_type,
+    const std::vector<TuningInputShape>& inputs) {
+  std::stringstream ss;
+  ss << (index_type == PrimDataType::Int32 ? "idx32" : "idx64");
+  for (const auto& input : inputs) {
+    ss << "|";
+    if (input.sizes.empty()) {
+      ss << "s";
+      continue;
+    }
+    for (const auto i : c10::irange(input.sizes.size())) {
+      ss << (i == 0 ? "" : "x") << bucketExtent(input.sizes[i]);
+    }
+    ss << "v" << input.vector_width;
+  }
+  return ss.str();
+}
+
+TuningKey makeTuningKey(
+    ScheduleHeuristic heuristic,
+    Fusion* fusion,
+    PrimDataType index_type,
+    const std::vector<TuningInputShape>& inputs) {
+  TuningKey key;
+  key.fingerprint = fingerprintFusion(fusion);
+  key.heuristic = heuristic;
+  const auto profile = currentDeviceProfile();
+  key.device_major = profile->major;
+  key.device_minor = profile->minor;
+  key.multi_processor_count = profile->multi_processor_count;
+  key.shape_signature = shapeSignature(index_type, inputs);
+  return key;
+}
+
+TuningKey makeTuningKey(
+    ScheduleHeuristic heuristic,
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info) {
+  std::vector<TuningInputShape> inputs;
+  inputs.reserve(fusion->inputs().size());
+  for (auto input : fusion->inputs()) {
+    TuningInputShape shape;
+    if (auto tv = dynamic_cast<TensorView*>(input)) {
+      for (auto id : TensorDomain::noReductions(tv->getMaybeRFactorDomain())) {
+        auto extent = runtime_info.expressionEvaluator().evaluate(id->extent());
+        TORCH_INTERNAL_ASSERT(
+            extent.has_value(),
+            "Error inferring size for tuning database: ",
+            id->extent()->toInlineString());
+        shape.sizes.push_back(extent->as<int64_t>());
+      }
+      shape.vector_width = inputVectorWidth(tv, runtime_info);
+    }
+    inputs.push_back(std::move(shape));
+  }
+  return makeTuningKey(
+      heuristic, fusion, runtime_info.getIndexType(), inputs);
+}
+
+std::string serializeHeuristicParams(const HeuristicParams& params) {
+  ParamsWriter writer;
+  if (auto rparams = dynamic_cast<const ReductionParams*>(&params)) {
+    visitFields(writer, *rparams);
+  } else if (auto pparams = dynamic_cast<const PointwiseParams*>(&params)) {
+    visitFields(writer, *pparams);
+  } else if (auto tparams = dynamic_cast<const TransposeParams*>(&params)) {
+    visitFields(writer, *tparams);
+  } else if (auto mparams = dynamic_cast<const MatmulParams*>(&params)) {
+    visitFields(writer, *mparams);
+  } else {
+    TORCH_CHECK(false, "Heuristic parameters cannot be serialized");
+  }
+  return writer.str();
+}
+
+std::shared_ptr<HeuristicParams> deserializeHeuristicParams(
+    ScheduleHeuristic heuristic,
+    const std::string& serialized) {
+  auto params = makeParams(heuristic);
+  TORCH_CHECK(
+      params != nullptr,
+      "Heuristic parameters of ",
+      toString(heuristic),
+      " cannot be deserialized");
+  params->tag = "Tuned " + toString(heuristic) + " heuristic.\n";
+  ParamsReader reader(serialized);
+  if (auto rparams = std::dynamic_pointer_cast<ReductionParams>(params)) {
+    visitFields(reader, *rparams);
+  } else if (
+      auto pparams = std::dynamic_pointer_cast<PointwiseParams>(params)) {
+    visitFields(reader, *pparams);
+  } else if (
+      auto tparams = std::dynamic_pointer_cast<TransposeParams>(params)) {
+    visitFields(reader, *tparams);
+  } else if (auto mparams = std::dynamic_pointer_cast<MatmulParams>(params)) {
+    visitFields(reader, *mparams);
+  }
+  return params;
+}
+
+std::string checkTunedParams(
+    ScheduleHeuristic heuristic,
+    const HeuristicParams& params,
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info) {
+  if (params.cparams.index_type.has_value() &&
+      params.cparams.index_type.value() != runtime_info.getIndexType()) {
+    return "index type does not match the inputs";
+  }
+  if (params.cparams.maxrregcount <= 0 || params.cparams.maxrregcount > 255) {
+    return "invalid register count " +
+        std::to_string(params.cparams.maxrregcount);
+  }
+
+  const auto profile = currentDeviceProfile();
+  const auto& lparams = params.lparams;
+  for (auto parallel_type : kParallelTypeThreads) {
+    if (lparams.hasDim(parallel_type) && lparams.getDim(parallel_type) <= 0) {
+      return "invalid launch dimension " + stringifyThread(parallel_type);
+    }
+  }
+  if (lparams.nThreads() > profile->max_threads_per_block) {
+    return "too many threads per block: " +
+        std::to_string(lparams.nThreads());
+  }
+  if (lparams.smem() > profile->shared_mem_per_block_optin) {
+    return "too much shared memory: " + std::to_string(lparams.smem());
+  }
+
+  // Schedulers don't vectorize wider than the widest input allows
+  int64_t max_vector_width = 1;
+  for (auto tv : ir_utils::filterByType<TensorView>(fusion->inputs())) {
+    max_vector_width =
+        std::max(max_vector_width, inputVectorWidth(tv, runtime_info));
+  }
+  auto check_vectorization = [&](int64_t factor) {
+    return isPowerOfTwo(factor) && factor <= max_vector_width;
+  };
+  bool vectorization_ok = true;
+  if (auto rparams = dynamic_cast<const ReductionParams*>(&params)) {
+    vectorization_ok =
+        (!rparams->vectorize_inner_reduction ||
+         check_vectorization(rparams->unroll_factor_inner_reduction)) &&
+        (!rparams->vectorize_iter_dom ||
+         check_vectorization(rparams->unroll_factor_iter_dom));
+  } else if (auto pparams = dynamic_cast<const PointwiseParams*>(&params)) {
+    vectorization_ok = !pparams->vectorize ||
+        check_vectorization((int64_t)pparams->unroll_factor);
+  } else if (auto tparams = dynamic_cast<const TransposeParams*>(&params)) {
+    vectorization_ok =
+        check_vectorization((int64_t)tparams->vectorize_factor1) &&
+        check_vectorization((int64_t)tparams->vectorize_factor2);
+  }
+  if (!vectorization_ok) {
+    return "vectorization wider than the inputs allow";
+  }
+  return "";
+}
+
+TuningDatabase& TuningDatabase::get() {
+  static TuningDatabase* singleton = []() {
+    auto db = new TuningDatabase();
+    if (const char* file = std::getenv("PYTORCH_NVFUSER_TUNING_DB")) {
+      db->load(file);
+    }
+    return db;
+  }();
+  return *singleton;
+}
+
+std::shared_ptr<HeuristicParams> TuningDatabase::lookup(const TuningKey& key) {
+  return lookup(key, nullptr);
+}
+
+std::shared_ptr<HeuristicParams> TuningDatabase::lookup(
+    const TuningKey& key,
+    const std::function<bool(const HeuristicParams&)>& is_legal) {
+  std::shared_ptr<const HeuristicParams> recorded;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      recorded = it->second;
+    }
+  }
+  const bool hit =
+      recorded != nullptr && (is_legal == nullptr || is_legal(*recorded));
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (!hit) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  return recorded->clone();
+}
+
+std::shared_ptr<HeuristicParams> TuningDatabase::lookup(
+    ScheduleHeuristic heuristic,
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    // No-op segments have no parameters to tune
+    if (entries_.empty() || heuristic == ScheduleHeuristic::NoOp) {
+      return nullptr;
+    }
+  }
+  FUSER_PERF_SCOPE("TuningDatabase::lookup");
+  return lookup(
+      makeTuningKey(heuristic, fusion, runtime_info),
+      [&](const HeuristicParams& params) {
+        const auto reason =
+            checkTunedParams(heuristic, params, fusion, runtime_info);
+        if (!reason.empty()) {
+          TORCH_WARN(
+              "Ignoring tuned ",
+              toString(heuristic),
+              " parameters that are not legal: ",
+              reason);
+        }
+        return reason.empty();
+      });
+}
+
+void TuningDatabase::record(
+    const TuningKey& key,
+    const HeuristicParams& params) {
+  // Round trip through the serialized form, so that the recorded entry is
+  // exactly what would be loaded from a file
+  auto recorded = deserializeHeuristicParams(
+      key.heuristic, serializeHeuristicParams(params));
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_[key] = std::move(recorded);
+}
+
+int64_t TuningDatabase::load(const std::string& file) {
+  FUSER_PERF_SCOPE("TuningDatabase::load");
+  std::ifstream in(file);
+  TORCH_CHECK(in, "Unable to open tuning database ", file);
+
+  std::string line;
+  std::getline(in, line);
+  auto header = split(line, ',');
+  TORCH_CHECK(
+      header.size() == 2 && header[0] == tuning_db_magic,
+      "Not a tuning database: ",
+      file);
+  TORCH_CHECK(
+      std::stoll(header[1]) == tuning_db_version,
+      "Tuning database version ",
+      header[1],
+      " is not supported, expected version ",
+      tuning_db_version);
+
+  std::vector<std::pair<TuningKey, std::shared_ptr<const HeuristicParams>>>
+      loaded;
+  while (std::getline(in, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    auto fields = split(line, ',');
+    TORCH_CHECK(
+        fields.size() == 7, "Corrupted tuning database entry: ", line);
+    TuningKey key;
+    key.heuristic = heuristicFromString(fields[0]);
+    key.device_major = std::stoi(fields[1]);
+    key.device_minor = std::stoi(fields[2]);
+    key.multi_processor_count = std::stoll(fields[3]);
+    key.shape_signature = fields[4];
+    key.fingerprint.canonical_ir = unescapeField(fields[6]);
+    key.fingerprint.hash =
+        std::hash<std::string>{}(key.fingerprint.canonical_ir);
+    loaded.emplace_back(
+        key, deserializeHeuristicParams(key.heuristic, fields[5]));
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto& [key, params] : loaded) {
+    entries_[key] = std::move(params);
+  }
+  return (int64_t)loaded.size();
+}
+
+void TuningDatabase::save(const std::string& file) const {
+  FUSER_PERF_SCOPE("TuningDatabase::save");
+  std::stringstream ss;
+  ss << tuning_db_magic << "," << tuning_db_version << "\n";
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (const auto& [key, params] : entries_) {
+      ss << toString(key.heuristic) << "," << key.device_major << ","
+         << key.device_minor << "," << key.multi_processor_count << ","
+         << key.shape_signature << "," << serializeHeuristicParams(*params)
+         << "," << escapeField(key.fingerprint.canonical_ir) << "\n";
+    }
+  }
+  TORCH_CHECK(
+      copy_to_text_file(file, ss.str()),
+      "Failed to write tuning database to ",
+      file);
+}
+
+TuningDatabase::Stats TuningDatabase::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.entries = (int64_t)entries_.size();
+  return stats;
+}
+
+std::vector<std::pair<TuningKey, std::shared_ptr<const HeuristicParams>>>
+TuningDatabase::entries() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return {entries_.begin(), entries_.end()};
+}
+
+void TuningDatabase::clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.clear();
+  hits_ = 0;
+  misses_ = 0;
+}
+
+} // namespace nvfuser
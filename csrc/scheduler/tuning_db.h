@@ -0,0 +1,196 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <c10/macros/Export.h>
+
+#include <compiled_kernel_cache.h>
+#include <fusion.h>
+#include <scheduler/all_schedulers.h>
+#include <scheduler/heuristic.h>
+#include <scheduler/registry.h>
+#include <type.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nvfuser {
+
+//! A tuning database holds heuristic parameters that were found to be better
+//! than the ones of the analytical heuristics, e.g., by measuring candidate
+//! schedules. SchedulerEntry::makeEntry consults it before running the
+//! analytical heuristics.
+//!
+//! Parameters are recorded for a fusion, a heuristic, a device and a bucket
+//! of input shapes. The fusion is identified by the structural fingerprint
+//! of the unscheduled fusion (see fingerprintFusion), so every segment with
+//! the same definition shares the entries. The device is identified by its
+//! compute capability and number of SMs, see currentDeviceProfile. Extents
+//! of input tensors are rounded up to the next power of two, and the
+//! vectorization limits of the inputs as well as the index type are matched
+//! exactly. Parameters recorded for one shape are reused for every shape of
+//! its bucket, so they should only be recorded when they are valid for the
+//! whole bucket. Recorded parameters that are not legal for the inputs and
+//! the device they are looked up for are ignored.
+//!
+//! The database is stored as a csv file. The first line is
+//! "nvfuser_tuning_db,<version>" and every other line holds one entry:
+//!   <heuristic>,<major>,<minor>,<SM count>,<shape signature>,<parameters>,
+//!   <fingerprint>
+//! where the parameters are a space separated list of name=value pairs.
+//! Missing parameters keep their default values. The fingerprint is the
+//! canonical IR of the fusion, with '%', ',', '\r' and '\n' percent-encoded.
+
+//! Version of the file format. Files of other versions are rejected.
+constexpr int64_t tuning_db_version = 2;
+
+//! Sizes and vectorization limit of a fusion input
+struct TuningInputShape {
+  //! Empty for scalars and 0-dim tensors
+  std::vector<int64_t> sizes;
+  //! Widest vectorization, in elements, the input allows
+  int64_t vector_width = 1;
+};
+
+struct TORCH_CUDA_CU_API TuningKey {
+  //! Fingerprint of the unscheduled fusion. The hash is only used to look
+  //! up entries, and is not stored in files.
+  KernelFingerprint fingerprint;
+  ScheduleHeuristic heuristic = ScheduleHeuristic::None;
+  //! Compute capability and number of SMs of the device
+  int device_major = 0;
+  int device_minor = 0;
+  int64_t multi_processor_count = 0;
+  //! See shapeSignature
+  std::string shape_signature;
+
+  bool operator==(const TuningKey& other) const {
+    return heuristic == other.heuristic &&
+        device_major == other.device_major &&
+        device_minor == other.device_minor &&
+        multi_processor_count == other.multi_processor_count &&
+        shape_signature == other.shape_signature &&
+        fingerprint == other.fingerprint;
+  }
+};
+
+struct TORCH_CUDA_CU_API TuningKeyHash {
+  size_t operator()(const TuningKey& key) const;
+};
+
+//! Bucketed signature of the fusion inputs, e.g., "idx64|128x1024v4|s" for
+//! a [100, 1000] tensor that can be vectorized by 4 and a scalar
+TORCH_CUDA_CU_API std::string shapeSignature(
+    PrimDataType index_type,
+    const std::vector<TuningInputShape>& inputs);
+
+//! Key of fusion for the given input shapes on the current device
+TORCH_CUDA_CU_API TuningKey makeTuningKey(
+    ScheduleHeuristic heuristic,
+    Fusion* fusion,
+    PrimDataType index_type,
+    const std::vector<TuningInputShape>& inputs);
+
+//! Key of fusion for the inputs bound in runtime_info on the current device.
+//! Fusion may be a segment of the fusion of runtime_info.
+TORCH_CUDA_CU_API TuningKey makeTuningKey(
+    ScheduleHeuristic heuristic,
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info);
+
+//! Serialize the parameters of the pointwise, reduction, persistent,
+//! transpose and matmul heuristics to name=value pairs
+TORCH_CUDA_CU_API std::string serializeHeuristicParams(
+    const HeuristicParams& params);
+
+//! Inverse of serializeHeuristicParams
+TORCH_CUDA_CU_API std::shared_ptr<HeuristicParams> deserializeHeuristicParams(
+    ScheduleHeuristic heuristic,
+    const std::string& serialized);
+
+//! Checks recorded parameters against the limits the schedulers respect
+//! when they compute parameters: the index type of the inputs, the
+//! vectorization the inputs allow, and the thread, register and shared
+//! memory limits of the current device. Returns an empty string if params
+//! are legal, and the reason otherwise.
+TORCH_CUDA_CU_API std::string checkTunedParams(
+    ScheduleHeuristic heuristic,
+    const HeuristicParams& params,
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info);
+
+class TORCH_CUDA_CU_API TuningDatabase {
+ public:
+  struct Stats {
+    //! Lookups that found recorded parameters
+    int64_t hits = 0;
+    //! Lookups that fell back to the analytical heuristics
+    int64_t misses = 0;
+    int64_t entries = 0;
+  };
+
+  //! Thread-safe Meyer's singleton. The file given by the
+  //! PYTORCH_NVFUSER_TUNING_DB environment variable is loaded on first use.
+  static TuningDatabase& get();
+
+  //! Returns a copy of the recorded parameters, or nullptr if there are none
+  std::shared_ptr<HeuristicParams> lookup(const TuningKey& key);
+
+  //! Returns a copy of the parameters recorded for fusion and the inputs
+  //! bound in runtime_info, or nullptr if there are none or they are not
+  //! legal (see checkTunedParams). Does not compute the key if the database
+  //! is empty.
+  std::shared_ptr<HeuristicParams> lookup(
+      ScheduleHeuristic heuristic,
+      Fusion* fusion,
+      SchedulerRuntimeInfo& runtime_info);
+
+  //! Returns a copy of the recorded parameters, or nullptr if there are none
+  //! or is_legal rejects them
+  std::shared_ptr<HeuristicParams> lookup(
+      const TuningKey& key,
+      const std::function<bool(const HeuristicParams&)>& is_legal);
+
+  //! Add or replace an entry
+  void record(const TuningKey& key, const HeuristicParams& params);
+
+  //! Merge the entries of file into the database. Entries of the file
+  //! replace existing ones. Returns the number of loaded entries.
+  int64_t load(const std::string& file);
+
+  //! Write all entries to file
+  void save(const std::string& file) const;
+
+  Stats stats() const;
+
+  //! All recorded entries
+  std::vector<std::pair<TuningKey, std::shared_ptr<const HeuristicParams>>>
+  entries() const;
+
+  //! Drop all entries and reset the statistics
+  void clear();
+
+ private:
+  TuningDatabase() = default;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<
+      TuningKey,
+      std::shared_ptr<const HeuristicParams>,
+      TuningKeyHash>
+      entries_;
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+};
+
+} // namespace nvfuser
@@ -888,6 +888,21 @@ PersistentBufferSizeReturn persistentBufferSize(
   persistent_buffer_size.persistent_buffer_size = max_persistence_size;
   persistent_buffer_size.projected_persistent_buffer_size =
       max_proj_persistence_size;
+
+  auto masked_sizes = [&](const std::vector<bool>& mask) {
+    std::vector<std::pair<TensorView*, int64_t>> sizes;
+    std::unordered_set<TensorView*> listed_buffers;
+    for (auto buffer_i : c10::irange(all_buffers.size())) {
+      if (mask[buffer_i] &&
+          listed_buffers.insert(all_buffers[buffer_i]).second) {
+        sizes.emplace_back(
+            all_buffers[buffer_i], persistent_buffer_sizes[buffer_i]);
+      }
+    }
+    return sizes;
+  };
+  persistent_buffer_size.buffer_sizes = masked_sizes(persistent_mask);
+  persistent_buffer_size.projected_buffer_sizes = masked_sizes(projected_mask);
   return persistent_buffer_size;
 }
 
@@ -210,6 +210,10 @@ TvProperties getProperties(
 struct PersistentBufferSizeReturn {
   int64_t persistent_buffer_size = 0;
   int64_t projected_persistent_buffer_size = 0;
+  // Size of each buffer that is persistent without projection, and with
+  // projection to inputs. Each buffer is listed once.
+  std::vector<std::pair<TensorView*, int64_t>> buffer_sizes;
+  std::vector<std::pair<TensorView*, int64_t>> projected_buffer_sizes;
 };
 
 // Compute the amount of register space would be needed to perform this kernel
@@ -627,14 +627,19 @@ FLATBUFFERS_STRUCT_END(State, 8);
 struct Bool FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   typedef BoolBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
-    VT_VALUE = 4
+    VT_VALUE = 4,
+    VT_PARAMETERIZED = 6
   };
   bool value() const {
     return GetField<uint8_t>(VT_VALUE, 0) != 0;
   }
+  bool parameterized() const {
+    return GetField<uint8_t>(VT_PARAMETERIZED, 0) != 0;
+  }
   bool Verify(::flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<uint8_t>(verifier, VT_VALUE, 1) &&
+           VerifyField<uint8_t>(verifier, VT_PARAMETERIZED, 1) &&
            verifier.EndTable();
   }
 };
@@ -646,6 +651,9 @@ struct BoolBuilder {
   void add_value(bool value) {
     fbb_.AddElement<uint8_t>(Bool::VT_VALUE, static_cast<uint8_t>(value), 0);
   }
+  void add_parameterized(bool parameterized) {
+    fbb_.AddElement<uint8_t>(Bool::VT_PARAMETERIZED, static_cast<uint8_t>(parameterized), 0);
+  }
   explicit BoolBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -659,9 +667,11 @@ struct BoolBuilder {
 
 inline ::flatbuffers::Offset<Bool> CreateBool(
     ::flatbuffers::FlatBufferBuilder &_fbb,
-    bool value = false) {
+    bool value = false,
+    bool parameterized = false) {
   BoolBuilder builder_(_fbb);
   builder_.add_value(value);
+  builder_.add_parameterized(parameterized);
   return builder_.Finish();
 }
 
@@ -669,7 +679,8 @@ struct Double FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   typedef DoubleBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
     VT_VALUE = 4,
-    VT_DTYPE = 6
+    VT_DTYPE = 6,
+    VT_PARAMETERIZED = 8
   };
   double value() const {
     return GetField<double>(VT_VALUE, 0.0);
@@ -677,10 +688,14 @@ struct Double FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   nvfuser::serde::DataType dtype() const {
     return static_cast<nvfuser::serde::DataType>(GetField<int32_t>(VT_DTYPE, 0));
   }
+  bool parameterized() const {
+    return GetField<uint8_t>(VT_PARAMETERIZED, 0) != 0;
+  }
   bool Verify(::flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<double>(verifier, VT_VALUE, 8) &&
            VerifyField<int32_t>(verifier, VT_DTYPE, 4) &&
+           VerifyField<uint8_t>(verifier, VT_PARAMETERIZED, 1) &&
            verifier.EndTable();
   }
 };
@@ -695,6 +710,9 @@ struct DoubleBuilder {
   void add_dtype(nvfuser::serde::DataType dtype) {
     fbb_.AddElement<int32_t>(Double::VT_DTYPE, static_cast<int32_t>(dtype), 0);
   }
+  void add_parameterized(bool parameterized) {
+    fbb_.AddElement<uint8_t>(Double::VT_PARAMETERIZED, static_cast<uint8_t>(parameterized), 0);
+  }
   explicit DoubleBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -709,10 +727,12 @@ struct DoubleBuilder {
 inline ::flatbuffers::Offset<Double> CreateDouble(
     ::flatbuffers::FlatBufferBuilder &_fbb,
     double value = 0.0,
-    nvfuser::serde::DataType dtype = nvfuser::serde::DataType_Double) {
+    nvfuser::serde::DataType dtype = nvfuser::serde::DataType_Double,
+    bool parameterized = false) {
   DoubleBuilder builder_(_fbb);
   builder_.add_value(value);
   builder_.add_dtype(dtype);
+  builder_.add_parameterized(parameterized);
   return builder_.Finish();
 }
 
@@ -720,7 +740,8 @@ struct Long FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   typedef LongBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
     VT_VALUE = 4,
-    VT_DTYPE = 6
+    VT_DTYPE = 6,
+    VT_PARAMETERIZED = 8
   };
   int64_t value() const {
     return GetField<int64_t>(VT_VALUE, 0);
@@ -728,10 +749,14 @@ struct Long FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   nvfuser::serde::DataType dtype() const {
     return static_cast<nvfuser::serde::DataType>(GetField<int32_t>(VT_DTYPE, 0));
   }
+  bool parameterized() const {
+    return GetField<uint8_t>(VT_PARAMETERIZED, 0) != 0;
+  }
   bool Verify(::flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<int64_t>(verifier, VT_VALUE, 8) &&
            VerifyField<int32_t>(verifier, VT_DTYPE, 4) &&
+           VerifyField<uint8_t>(verifier, VT_PARAMETERIZED, 1) &&
            verifier.EndTable();
   }
 };
@@ -746,6 +771,9 @@ struct LongBuilder {
   void add_dtype(nvfuser::serde::DataType dtype) {
     fbb_.AddElement<int32_t>(Long::VT_DTYPE, static_cast<int32_t>(dtype), 0);
   }
+  void add_parameterized(bool parameterized) {
+    fbb_.AddElement<uint8_t>(Long::VT_PARAMETERIZED, static_cast<uint8_t>(parameterized), 0);
+  }
   explicit LongBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -760,10 +788,12 @@ struct LongBuilder {
 inline ::flatbuffers::Offset<Long> CreateLong(
     ::flatbuffers::FlatBufferBuilder &_fbb,
     int64_t value = 0,
-    nvfuser::serde::DataType dtype = nvfuser::serde::DataType_Double) {
+    nvfuser::serde::DataType dtype = nvfuser::serde::DataType_Double,
+    bool parameterized = false) {
   LongBuilder builder_(_fbb);
   builder_.add_value(value);
   builder_.add_dtype(dtype);
+  builder_.add_parameterized(parameterized);
   return builder_.Finish();
 }
 
@@ -854,7 +884,8 @@ struct ComplexDouble FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
     VT_REAL = 4,
     VT_IMAG = 6,
-    VT_DTYPE = 8
+    VT_DTYPE = 8,
+    VT_PARAMETERIZED = 10
   };
   double real() const {
     return GetField<double>(VT_REAL, 0.0);
@@ -865,11 +896,15 @@ struct ComplexDouble FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   nvfuser::serde::DataType dtype() const {
     return static_cast<nvfuser::serde::DataType>(GetField<int32_t>(VT_DTYPE, 0));
   }
+  bool parameterized() const {
+    return GetField<uint8_t>(VT_PARAMETERIZED, 0) != 0;
+  }
   bool Verify(::flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<double>(verifier, VT_REAL, 8) &&
            VerifyField<double>(verifier, VT_IMAG, 8) &&
            VerifyField<int32_t>(verifier, VT_DTYPE, 4) &&
+           VerifyField<uint8_t>(verifier, VT_PARAMETERIZED, 1) &&
            verifier.EndTable();
   }
 };
@@ -887,6 +922,9 @@ struct ComplexDoubleBuilder {
   void add_dtype(nvfuser::serde::DataType dtype) {
     fbb_.AddElement<int32_t>(ComplexDouble::VT_DTYPE, static_cast<int32_t>(dtype), 0);
   }
+  void add_parameterized(bool parameterized) {
+    fbb_.AddElement<uint8_t>(ComplexDouble::VT_PARAMETERIZED, static_cast<uint8_t>(parameterized), 0);
+  }
   explicit ComplexDoubleBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -902,11 +940,13 @@ inline ::flatbuffers::Offset<ComplexDouble> CreateComplexDouble(
     ::flatbuffers::FlatBufferBuilder &_fbb,
     double real = 0.0,
     double imag = 0.0,
-    nvfuser::serde::DataType dtype = nvfuser::serde::DataType_Double) {
+    nvfuser::serde::DataType dtype = nvfuser::serde::DataType_Double,
+    bool parameterized = false) {
   ComplexDoubleBuilder builder_(_fbb);
   builder_.add_imag(imag);
   builder_.add_real(real);
   builder_.add_dtype(dtype);
+  builder_.add_parameterized(parameterized);
   return builder_.Finish();
 }
 
@@ -448,11 +448,13 @@ void RecordFunctorFactory::registerAllParsers() {
   registerParser(serde::RecordType_CastVal, deserializeCastValRecord);
 
   auto deserializeConstantBoolRecord = [](const serde::RecordFunctor* buffer) {
+    auto data = buffer->data_as_Bool();
     return new python_frontend::ConstantRecord<nvfuser::Bool, bool>(
         parseStateArgs(buffer->outputs()),
         serde::RecordType_ConstantBool,
-        buffer->data_as_Bool()->value(),
-        nvfuser::DataType::Bool);
+        data->value(),
+        nvfuser::DataType::Bool,
+        data->parameterized());
   };
   registerParser(serde::RecordType_ConstantBool, deserializeConstantBoolRecord);
 
@@ -463,7 +465,8 @@ void RecordFunctorFactory::registerAllParsers() {
             parseStateArgs(buffer->outputs()),
             serde::RecordType_ConstantDouble,
             data->value(),
-            mapToNvfuserDtype(data->dtype()));
+            mapToNvfuserDtype(data->dtype()),
+            data->parameterized());
       };
   registerParser(
       serde::RecordType_ConstantDouble, deserializeConstantDoubleRecord);
@@ -476,7 +479,8 @@ void RecordFunctorFactory::registerAllParsers() {
                 parseStateArgs(buffer->outputs()),
                 serde::RecordType_ConstantComplexDouble,
                 std::complex<double>(data->real(), data->imag()),
-                mapToNvfuserDtype(data->dtype()));
+                mapToNvfuserDtype(data->dtype()),
+                data->parameterized());
       };
   registerParser(
       serde::RecordType_ConstantComplexDouble,
@@ -488,7 +492,8 @@ void RecordFunctorFactory::registerAllParsers() {
         parseStateArgs(buffer->outputs()),
         serde::RecordType_ConstantLong,
         data->value(),
-        mapToNvfuserDtype(data->dtype()));
+        mapToNvfuserDtype(data->dtype()),
+        data->parameterized());
   };
   registerParser(serde::RecordType_ConstantLong, deserializeConstantLongRecord);
 
@@ -322,6 +322,17 @@ TensorView::TensorView(const TensorView* src, IrCloner* ir_cloner)
 // because these "scalars" should be type promoted as a tensor, but we want to
 // avoid explicit copying of the data, so we want to pass the data value as a
 // standard kernel argument value.
+void TensorView::setDomain(TensorDomain* td) {
+  // Information cached about the tensor graph depends on root and rfactor
+  // domains, which scheduling transformations leave unchanged
+  if (domain_ != nullptr &&
+      (td->root() != domain_->root() ||
+       td->maybeRFactor() != domain_->maybeRFactor())) {
+    fusion()->invalidateTvDomains();
+  }
+  domain_ = td;
+}
+
 void TensorView::setCpuScalar(bool is_cpu_scalar) {
   TORCH_INTERNAL_ASSERT(
       nDims() == 0, "Only 0-dim tensors can be marked as a cpu scalar.");
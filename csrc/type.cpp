@@ -7,7 +7,7 @@
 // clang-format on
 #include <type.h>
 
-#include <ATen/cuda/CUDAContext.h>
+#include <device_profile.h>
 
 #include <sstream>
 #include <stdexcept>
@@ -59,8 +59,7 @@ DataType getComplexTypeFromType(DataType dtype) {
 }
 
 bool isSupportedTypeByDevice(DataType dtype) {
-  auto prop = at::cuda::getCurrentDeviceProperties();
-  auto major_ver = prop->major;
+  auto major_ver = currentDeviceProfile()->major;
   if (dtype == DataType::BFloat16) {
     return major_ver >= 8;
   }
@@ -8,6 +8,7 @@
 #include <ATen/cuda/CUDAContext.h>
 #include <c10/util/string_view.h>
 #include <cuda_occupancy.h>
+#include <device_profile.h>
 #include <utils.h>
 
 #include <cstdlib>
@@ -141,6 +142,7 @@ auto parseDebugDumpOptions() {
       {"bank_conflict", DebugDumpOption::BankConflictInfo},
       {"sync_map", DebugDumpOption::SyncMap},
       {"lower_verbose", DebugDumpOption::LowerVerbose},
+      {"lower_pass_stats", DebugDumpOption::LowerPassStats},
       {"expr_simplify", DebugDumpOption::ExprSimplification},
       {"expr_sort", DebugDumpOption::ExprSort},
       {"loop_rotation", DebugDumpOption::LoopRotation},
@@ -162,9 +164,14 @@ auto parseDisableOptions() {
       {"grouped_grid_welford_outer_opt",
        DisableOption::GroupedGridWelfordOuterOpt},
       {"index_hoist", DisableOption::IndexHoist},
+      {"kernel_preamble_pruning", DisableOption::KernelPreamblePruning},
+      {"kernel_reuse", DisableOption::KernelReuse},
       {"expr_simplify", DisableOption::ExprSimplify},
       {"nvtx", DisableOption::Nvtx},
       {"predicate_elimination", DisableOption::PredicateElimination},
+      {"smem_persistence", DisableOption::SmemPersistence},
+      {"spanning_tree_cache", DisableOption::SpanningTreeCache},
+      {"split_reduction", DisableOption::SplitReduction},
       {"welford_vectorization", DisableOption::WelfordVectorization},
       {"magic_zero", DisableOption::MagicZero},
       {"var_name_remapping", DisableOption::VarNameRemapping}};
@@ -192,7 +199,10 @@ auto parseEnableOptions() {
       {"conv_decomposition", EnableOption::ConvDecomposition},
       {"graph_op_fusion", EnableOption::GraphOp},
       {"kernel_db", EnableOption::KernelDb},
-      {"warn_register_spill", EnableOption::WarnRegisterSpill}};
+      {"warn_register_spill", EnableOption::WarnRegisterSpill},
+      {"alignment_agnostic", EnableOption::AlignmentAgnostic},
+      {"shape_buckets", EnableOption::ShapeBuckets},
+      {"horizontal_fusion", EnableOption::HorizontalFusion}};
 
   return parseEnvOptions("PYTORCH_NVFUSER_ENABLE", available_options);
 }
@@ -370,22 +380,46 @@ std::vector<int64_t> getTensorSizes(at::TensorTypePtr const& tensor_type) {
   return optional_sizes.value();
 }
 
+namespace {
+
+// The occupancy calculator only reads the fields set here, so it works the
+// same for real devices and injected profiles
+cudaOccDeviceProp toOccupancyProperties(const DeviceProfile& profile) {
+  cudaOccDeviceProp occ_prop;
+  occ_prop.computeMajor = profile.major;
+  occ_prop.computeMinor = profile.minor;
+  occ_prop.maxThreadsPerBlock = (int)profile.max_threads_per_block;
+  occ_prop.maxThreadsPerMultiprocessor =
+      (int)profile.max_threads_per_multi_processor;
+  occ_prop.regsPerBlock = (int)profile.regs_per_block;
+  occ_prop.regsPerMultiprocessor = (int)profile.regs_per_multi_processor;
+  occ_prop.warpSize = (int)profile.warp_size;
+  occ_prop.sharedMemPerBlock = (size_t)profile.shared_mem_per_block;
+  occ_prop.sharedMemPerMultiprocessor =
+      (size_t)profile.shared_mem_per_multi_processor;
+  occ_prop.numSms = (int)profile.multi_processor_count;
+  occ_prop.sharedMemPerBlockOptin = (size_t)profile.shared_mem_per_block_optin;
+  return occ_prop;
+}
+
+} // namespace
+
 int64_t getRegPerThreadGivenThreadsPerSM(int64_t threads_per_sm) {
   int num_partition = 0;
   int reg_allocation_granularity = 0;
-  const auto prop = at::cuda::getCurrentDeviceProperties();
-  cudaOccDeviceProp occ_prop(*prop);
+  const auto profile = currentDeviceProfile();
+  cudaOccDeviceProp occ_prop = toOccupancyProperties(*profile);
   cudaOccSubPartitionsPerMultiprocessor(&num_partition, &occ_prop);
   cudaOccRegAllocationGranularity(&reg_allocation_granularity, &occ_prop);
-  int warp_size = prop->warpSize;
+  int warp_size = (int)profile->warp_size;
   int num_warps = (int)ceilDiv(threads_per_sm, warp_size);
 
   // warps could be distributed unevenly across partition
   int max_warps_per_sm_partition = (int)ceilDiv(num_warps, num_partition);
   // registers are evenly distributed across partitions, partition with most
   // wraps determins the maximum register available per warp
-  int max_reg_per_warp =
-      prop->regsPerBlock / num_partition / max_warps_per_sm_partition;
+  int max_reg_per_warp = (int)profile->regs_per_block / num_partition /
+      max_warps_per_sm_partition;
   // clamp down to register allocation granularity at warp level
   int effective_max_reg_per_warp = max_reg_per_warp /
       reg_allocation_granularity * reg_allocation_granularity;
@@ -395,17 +429,17 @@ int64_t getRegPerThreadGivenThreadsPerSM(int64_t threads_per_sm) {
 int64_t getThreadsPerSMGivenRegPerThread(int64_t reg_per_thread) {
   int num_partition = 0;
   int reg_allocation_granularity = 0;
-  const auto prop = at::cuda::getCurrentDeviceProperties();
-  cudaOccDeviceProp occ_prop(*prop);
+  const auto profile = currentDeviceProfile();
+  cudaOccDeviceProp occ_prop = toOccupancyProperties(*profile);
   cudaOccSubPartitionsPerMultiprocessor(&num_partition, &occ_prop);
   cudaOccRegAllocationGranularity(&reg_allocation_granularity, &occ_prop);
-  int warp_size = prop->warpSize;
+  int warp_size = (int)profile->warp_size;
 
   int reg_per_warp =
       (int)ceilDiv(reg_per_thread * warp_size, reg_allocation_granularity) *
       reg_allocation_granularity;
   int warps_per_sm_partition =
-      prop->regsPerBlock / reg_per_warp / num_partition;
+      (int)profile->regs_per_block / reg_per_warp / num_partition;
   int num_warps = warps_per_sm_partition * num_partition;
   return num_warps * static_cast<int64_t>(warp_size);
 }
@@ -91,6 +91,8 @@ enum class DebugDumpOption {
   BankConflictInfo, //! Dump bank confliction info
   SyncMap, //! RAW dependency info
   LowerVerbose, //! Print all passes' transform in GpuLower::lower
+  LowerPassStats, //! Print per-pass time and IR sizes of GpuLower::lower as
+                  //! JSON
   ExprSimplification, //! Print all passes' transform in simplifyExpr
   ExprSort, //! Print merging decisions on expression sorting
   LoopRotation, //! Print loop rotation log
@@ -116,9 +118,15 @@ enum class DisableOption {
   GroupedGridWelfordOuterOpt, //! Disable use of outer-optimized
                               //! grouped grid welford kernel
   IndexHoist, //! Disable index hoisting
+  KernelPreamblePruning, //! Always include every runtime helper in the
+                         //! kernel preamble
+  KernelReuse, //! Disable sharing compiled kernels between executors
   ExprSimplify, //! Disable expression simplifier
   Nvtx, //! Disable NVTX instrumentation
   PredicateElimination, //! Disable predicate elimination
+  SmemPersistence, //! Disable persistent buffers in shared memory
+  SpanningTreeCache, //! Disable reuse of spanning trees across propagations
+  SplitReduction, //! Disable two-stage reductions in place of grid reductions
   WelfordVectorization, //! Disable vectorizaton of Welford ops
   MagicZero, //! Disable nvfuser_zero
   VarNameRemapping, //! Disable variable name remapping
@@ -151,6 +159,9 @@ enum class EnableOption {
   GraphOp, //! Enable graphOps(index_select/gather/scatter)
   KernelDb, //! Enable Kernel Database
   WarnRegisterSpill, //! Enable warnings of register spill
+  AlignmentAgnostic, //! Don't recompile kernels when input alignment changes
+  ShapeBuckets, //! Snap input extents to buckets before computing heuristics
+  HorizontalFusion, //! Launch independent segments with a single kernel
   EndOfOption //! Placeholder for counting the number of elements
 };
 
@@ -2,6 +2,9 @@
 # All rights reserved.
 # SPDX-License-Identifier: BSD-3-Clause
 
+import functools
+import itertools
+import json
 import logging
 import os
 import sys
@@ -43,6 +46,23 @@ class FusionDefinition(_C._FusionDefinition):
     def schedule(self):
         raise NotImplementedError("schedule() should be implemented by child class!")
 
+    def definition_key(self, inputs):
+        """
+        Returns a key that identifies the definition for the given inputs
+
+        A child class may return a hashable key for which definition() always
+        records the same operations. On a repeated key, execute() maps the key
+        straight to the cached fusion and skips definition(). Child classes
+        that define a schedule() don't use the key.
+
+        Args:
+            inputs (List[Union[Tensor, Scalar]]): A list of inputs to fusion.
+
+        Returns:
+            Optional[Hashable], None if the definition has no key (default)
+        """
+        return None
+
     def execute(self, inputs, *, device=None, **kwargs):
         """
         Executes an nvFuser set of kernels for a given Fusion
@@ -67,6 +87,7 @@ class FusionDefinition(_C._FusionDefinition):
 
         Kwargs:
             override_user_schedule (bool): For a user defined schedule, override with auto-generated schedule (default: False)
+            collect_lower_pass_stats (bool): Collect the per-pass lowering statistics of the kernels compiled from now on, see last_lower_pass_stats (default: False)
             device (Optional[Union[int, str, torch.device]]): This is a hint to run
             the Fusion on the given CUDA device. This is not typically
             necessary, as the device is usually inferred from the locations of
@@ -81,6 +102,8 @@ class FusionDefinition(_C._FusionDefinition):
             List[Tensor]
         """
         override_user_schedule = kwargs.pop("override_user_schedule", False)
+        if kwargs.pop("collect_lower_pass_stats", False):
+            self._collect_lower_pass_stats(True)
         func_based_def = False
 
         if device is not None:
@@ -91,15 +114,23 @@ class FusionDefinition(_C._FusionDefinition):
             ), "If device argument is passed it must be a CUDA device"
             device = device.index
 
+        has_schedule = super(type(self), self).schedule != self.schedule
+
         # if definition is not defined by a context manager, try a child class
         if self.id() is None:
-            self._setup_definition()
-            self.definition()
-            self._finalize_definition()
-            func_based_def = True
+            key = None if has_schedule else self.definition_key(inputs)
+            if key is not None:
+                key = f"{type(self).__module__}.{type(self).__qualname__}:{key!r}"
+            if key is None or not self._setup_definition_from_key(key):
+                self._setup_definition()
+                self.definition()
+                self._finalize_definition()
+                if key is not None:
+                    self._record_definition_key(key)
+                func_based_def = True
 
         # If schedule is defined by child class, make a schedule for inputs
-        if func_based_def and (super(type(self), self).schedule != self.schedule):
+        if func_based_def and has_schedule:
             self._setup_schedule(inputs)
             self.schedule()
             self._finalize_schedule(inputs)
@@ -251,6 +282,158 @@ class FusionDefinition(_C._FusionDefinition):
             inputs, tensor_transforms, override_user_schedule
         )
 
+    def last_lower_pass_stats(self, **kwargs):
+        """
+        Returns the per-pass lowering statistics for the last executed set of inputs
+
+        Each kernel of the fusion has a list of passes, in the order they
+        ran in lowering. Each pass records its wall time in milliseconds,
+        and the number of IR nodes and expressions before and after it.
+        Statistics are only collected by kernels compiled by an execute call
+        with collect_lower_pass_stats=True, or with the lower_pass_stats dump
+        option.
+
+        Kwargs:
+            override_user_schedule (Bool): For a user defined schedule, override with auto-generated schedule (default: False)
+
+        Returns:
+            List[List[Dict]]
+        """
+        override_user_schedule = kwargs.pop("override_user_schedule", False)
+        return json.loads(self._last_lower_pass_stats(override_user_schedule))
+
+
+# Distinguishes the definition keys of functions with the same name
+_definition_func_ids = itertools.count()
+
+
+def _input_signature(inputs, static_sizes):
+    signature = []
+    for i in inputs:
+        if isinstance(i, torch.Tensor):
+            sizes = tuple(i.size())
+            signature.append(
+                (
+                    i.dtype,
+                    i.device.type,
+                    sizes if static_sizes else tuple(s == 1 for s in sizes),
+                    tuple(compute_contiguity(sizes, i.stride())),
+                )
+            )
+        else:
+            signature.append(type(i).__name__)
+    return repr(signature)
+
+
+def cached_definition(func=None, *, static_sizes=False):
+    """
+    Decorates a function that defines a fusion for its inputs, with a
+    definition key computed from the function and the input signature
+
+    The decorated function `func(fd, *inputs)` records the definition of
+    `fd` for the given inputs. Calling the decorated function with the inputs
+    executes the fusion. The definition is only recorded the first time an
+    input signature is seen, later calls map the signature straight to the
+    cached fusion and skip the record by record cache lookup.
+
+    The signature of a tensor input is its dtype, device type, broadcast
+    dimensions and contiguity, and the signature of any other input is its
+    type. The definition must not depend on anything else, like the sizes of
+    tensors or the values of scalars.
+
+    Example:
+        @nvfuser.cached_definition
+        def add_mul(fd, t0, t1, s0):
+            ...
+
+        out = add_mul(t0, t1, 2.0)
+
+    Kwargs:
+        static_sizes (bool): The definition depends on the tensor sizes, which
+                             are part of the signature (default: False)
+
+    Returns:
+        Callable that executes the fusion on the inputs, and takes the kwargs
+        of FusionDefinition.execute.
+    """
+    if func is None:
+        return functools.partial(cached_definition, static_sizes=static_sizes)
+
+    func_key = f"{func.__module__}.{func.__qualname__}#{next(_definition_func_ids)}"
+
+    @functools.wraps(func)
+    def wrapper(*inputs, **kwargs):
+        key = f"{func_key}:{_input_signature(inputs, static_sizes)}"
+        fd = FusionDefinition()
+        if not fd._setup_definition_from_key(key):
+            with fd:
+                func(fd, *inputs)
+            fd._record_definition_key(key)
+        return fd.execute(list(inputs), **kwargs)
+
+    return wrapper
+
+
+class FusionPipeline:
+    """
+    Runs a sequence of fusions, whose inputs may be outputs of earlier fusions,
+    with a single call
+
+    Consecutive FusionDefinition.execute calls convert every input from
+    python, look up the schedules of every fusion and return every
+    intermediate tensor to python. The pipeline does this once, and passes
+    intermediate tensors from fusion to fusion. An intermediate tensor is
+    released after the last fusion that reads it, so the CUDA caching
+    allocator reuses its memory.
+
+    Each step is a FusionDefinition with its inputs, in the order of the
+    fusion inputs. An input is either an int, the index of a pipeline input,
+    or a tuple (step, output) referring to an output of an earlier step.
+    Like execute, the values of parameterized constants are passed by the
+    pipeline and are not listed as inputs. The steps run the automatically
+    generated schedules of their fusions.
+
+    Example:
+        pipeline = FusionPipeline(
+            [(fd0, [0, 1]), (fd1, [(0, 0), 1])],
+            outputs=[(1, 0)],
+        )
+        out = pipeline.run([t0, 2.0])
+
+    Args:
+        steps (List[Tuple[FusionDefinition, List[Union[int, Tuple[int, int]]]]])
+        outputs (List[Tuple[int, int]]): The step outputs returned by run()
+    """
+
+    def __init__(self, steps, outputs):
+        def to_value(value):
+            if isinstance(value, int):
+                return (-1, value)
+            step, output = value
+            return (step, output)
+
+        pipeline_steps = [
+            (fd, [to_value(i) for i in inputs]) for fd, inputs in steps
+        ]
+        self._pipeline = _C._FusionPipeline(
+            pipeline_steps, [to_value(o) for o in outputs]
+        )
+
+    def num_inputs(self):
+        return self._pipeline.num_inputs()
+
+    def run(self, inputs):
+        """
+        Runs the steps in order on the pipeline inputs
+
+        Args:
+            inputs (List[Union[Tensor, Scalar]]): The inputs of the pipeline
+
+        Returns:
+            List[Tensor], the outputs of the pipeline
+        """
+        return self._pipeline.run(inputs)
+
 
 from .nvfuser_version import __version__
 
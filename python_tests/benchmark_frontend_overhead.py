@@ -0,0 +1,123 @@
+# SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+# All rights reserved.
+# SPDX-License-Identifier: BSD-3-Clause
+
+# Measures the host overhead of the python frontend when the same fusion is
+# redefined every step, as it is in an inference loop. The definition either
+# walks the FusionCache record by record, or is found by its definition key.
+# The cost of passing arguments is measured with a fusion of many inputs, and
+# a chain of fusions is run with sequential execute calls and as a pipeline.
+#
+# RUN CMD: python python_tests/benchmark_frontend_overhead.py --num-ops 64
+
+import argparse
+import time
+
+import torch
+
+from nvfuser import FusionDefinition, FusionPipeline, cached_definition
+
+
+def define_chain(fd: FusionDefinition, t0, num_ops):
+    t = fd.from_pytorch(t0)
+    s = fd.define_scalar()
+    for _ in range(num_ops):
+        t = fd.ops.add(t, s)
+        t = fd.ops.relu(t)
+    fd.add_output(t)
+
+
+def define_wide(fd: FusionDefinition, inputs):
+    t = fd.from_pytorch(inputs[0])
+    for inp in inputs[1:]:
+        t = fd.ops.add(t, fd.from_pytorch(inp))
+    fd.add_output(t)
+
+
+def time_per_iter(fn, iters):
+    # Warm up to compile the kernel and populate the caches
+    for _ in range(3):
+        fn()
+    torch.cuda.synchronize()
+    start = time.perf_counter()
+    for _ in range(iters):
+        fn()
+    torch.cuda.synchronize()
+    return (time.perf_counter() - start) / iters * 1e6
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--num-ops", type=int, default=64)
+    parser.add_argument("--iters", type=int, default=1000)
+    parser.add_argument("--size", type=int, default=1024)
+    parser.add_argument("--num-inputs", type=int, default=50)
+    parser.add_argument("--num-fusions", type=int, default=8)
+    args = parser.parse_args()
+
+    t0 = torch.randn(args.size, device="cuda")
+    inputs = [t0, 1.0]
+
+    def trie_walk():
+        with FusionDefinition() as fd:
+            define_chain(fd, t0, args.num_ops)
+        return fd.execute(inputs)
+
+    @cached_definition
+    def keyed(fd: FusionDefinition, t0, s0):
+        define_chain(fd, t0, args.num_ops)
+
+    def definition_key():
+        return keyed(*inputs)
+
+    def execute_only():
+        return fd.execute(inputs)
+
+    with FusionDefinition() as fd:
+        define_chain(fd, t0, args.num_ops)
+
+    print(f"Fusion with {2 * args.num_ops} ops, per iteration:")
+    for name, fn in [
+        ("Trie walk + execute", trie_walk),
+        ("Definition key + execute", definition_key),
+        ("Execute only", execute_only),
+    ]:
+        print(f"  {name:<26}{time_per_iter(fn, args.iters):10.1f} us")
+
+    wide_inputs = [
+        torch.randn(args.size, device="cuda") for _ in range(args.num_inputs)
+    ]
+    with FusionDefinition() as fd_wide:
+        define_wide(fd_wide, wide_inputs)
+
+    print(f"Fusion with {args.num_inputs} inputs, per iteration:")
+    name = "Execute only"
+    elapsed = time_per_iter(lambda: fd_wide.execute(wide_inputs), args.iters)
+    print(f"  {name:<26}{elapsed:10.1f} us")
+
+    # Each fusion of the chain takes the output of the previous one
+    fds = []
+    for _ in range(args.num_fusions):
+        with FusionDefinition() as fd_step:
+            define_chain(fd_step, t0, 1)
+        fds.append(fd_step)
+    steps = [(fds[0], [0, 1])]
+    steps += [(fd_step, [(i, 0), 1]) for i, fd_step in enumerate(fds[1:])]
+    pipeline = FusionPipeline(steps, outputs=[(len(fds) - 1, 0)])
+
+    def sequential():
+        out = t0
+        for fd_step in fds:
+            out = fd_step.execute([out, 1.0])[0]
+        return out
+
+    print(f"Chain of {args.num_fusions} fusions, per iteration:")
+    for name, fn in [
+        ("Sequential execute", sequential),
+        ("Pipeline", lambda: pipeline.run(inputs)),
+    ]:
+        print(f"  {name:<26}{time_per_iter(fn, args.iters):10.1f} us")
+
+
+if __name__ == "__main__":
+    main()
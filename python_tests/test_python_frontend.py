@@ -28,6 +28,8 @@ try:
         Tensor,
         version,
         compute_contiguity,
+        cached_definition,
+        FusionPipeline,
     )
     from nvfuser.pytorch_utils import torch_dtype_to_nvfuser_dtype
 except ImportError:
@@ -928,6 +930,128 @@ class TestNvFuserFrontend(TestCase):
         eager_out = torch.sigmoid(inputs[0])
         self.assertEqual(eager_out, nvf_out[0])
 
+    def test_cached_definition(self):
+        inputs = [
+            torch.randn(4, 8, device="cuda"),
+            torch.randn(4, 8, device="cuda"),
+        ]
+        num_definitions = 0
+
+        @cached_definition
+        def add_mul(fd: FusionDefinition, t0, t1, s0):
+            nonlocal num_definitions
+            num_definitions += 1
+            t0 = fd.from_pytorch(t0)
+            t1 = fd.from_pytorch(t1)
+            s0 = fd.define_scalar(DataType.Double)
+            t2 = fd.ops.add(t0, t1)
+            t3 = fd.ops.mul(t2, s0)
+            fd.add_output(t3)
+
+        fc = FusionCache.get()
+        before_fusions = fc.num_fusions()
+        for scale in [2.0, 3.0, 4.0]:
+            nvf_out = add_mul(*inputs, scale)
+            self.assertEqual(nvf_out[0], (inputs[0] + inputs[1]) * scale)
+        self.assertEqual(num_definitions, 1)
+        self.assertEqual(fc.num_fusions() - before_fusions, 1)
+        self.assertIn("Definition Key Hits: ", fc.stats())
+
+        # A new input signature records the definition again
+        half_inputs = [i.half() for i in inputs]
+        nvf_out = add_mul(*half_inputs, 2.0)
+        self.assertEqual(nvf_out[0], (half_inputs[0] + half_inputs[1]) * 2.0)
+        self.assertEqual(num_definitions, 2)
+        self.assertEqual(fc.num_fusions() - before_fusions, 2)
+
+        class KeyedFusion(FusionDefinition):
+            def definition(self):
+                t0 = self.from_pytorch(inputs[0])
+                t1 = self.ops.exp(t0)
+                self.add_output(t1)
+
+            def definition_key(self, inputs):
+                return tuple(i.dtype for i in inputs)
+
+        # A definition found by key prints the cached records
+        for _ in range(2):
+            keyed_fd = KeyedFusion()
+            nvf_out = keyed_fd.execute(inputs[:1])
+            self.assertEqual(nvf_out[0], torch.exp(inputs[0]))
+            self.assertIn("fd.ops.exp", keyed_fd.__repr__())
+
+    def test_parameterized_constant(self):
+        inputs = [torch.randn(4, 8, device="cuda")]
+
+        def fusion_func(fd: FusionDefinition, scale, offset):
+            t0 = fd.from_pytorch(inputs[0])
+            s0 = fd.define_constant(scale, parameterize=True)
+            s1 = fd.define_constant(offset, DataType.Int, parameterize=True)
+            t1 = fd.ops.mul(t0, s0)
+            t2 = fd.ops.add(t1, s1)
+            fd.add_output(t2)
+
+        fc = FusionCache.get()
+        before_fusions = fc.num_fusions()
+        for scale, offset in [(2.0, 1), (3.0, 2), (0.5, -4)]:
+            with FusionDefinition() as fd:
+                fusion_func(fd, scale, offset)
+            nvf_out = fd.execute(inputs)
+            self.assertEqual(nvf_out[0], inputs[0] * scale + offset)
+            self.assertIn("parameterize=True", fd.__repr__())
+        # All values share one fusion
+        self.assertEqual(fc.num_fusions() - before_fusions, 1)
+
+        # A constant that is not parameterized is still part of the definition
+        with FusionDefinition() as fd:
+            t0 = fd.from_pytorch(inputs[0])
+            s0 = fd.define_constant(2.0)
+            fd.add_output(fd.ops.mul(t0, s0))
+        fd.execute(inputs)
+        self.assertEqual(fc.num_fusions() - before_fusions, 2)
+
+    def test_fusion_pipeline(self):
+        inputs = [torch.randn(4, 8, device="cuda"), 2.0]
+
+        with FusionDefinition() as fd0:
+            t0 = fd0.from_pytorch(inputs[0])
+            s0 = fd0.define_scalar(DataType.Double)
+            fd0.add_output(fd0.ops.mul(t0, s0))
+            fd0.add_output(fd0.ops.exp(t0))
+
+        with FusionDefinition() as fd1:
+            t0 = fd1.from_pytorch(inputs[0])
+            t1 = fd1.from_pytorch(inputs[0])
+            fd1.add_output(fd1.ops.add(t0, t1))
+
+        pipeline = FusionPipeline(
+            [(fd0, [0, 1]), (fd1, [(0, 0), (0, 1)])],
+            outputs=[(1, 0)],
+        )
+        self.assertEqual(pipeline.num_inputs(), 2)
+        for _ in range(2):
+            nvf_out = pipeline.run(inputs)
+            self.assertEqual(len(nvf_out), 1)
+            eager_out = inputs[0] * inputs[1] + torch.exp(inputs[0])
+            self.assertEqual(nvf_out[0], eager_out)
+
+        # The pipeline passes the values of parameterized constants
+        with FusionDefinition() as fd2:
+            t0 = fd2.from_pytorch(inputs[0])
+            s0 = fd2.define_constant(3.0, parameterize=True)
+            fd2.add_output(fd2.ops.mul(t0, s0))
+
+        pipeline = FusionPipeline(
+            [(fd0, [0, 1]), (fd2, [(0, 1)])],
+            outputs=[(1, 0)],
+        )
+        nvf_out = pipeline.run(inputs)
+        self.assertEqual(nvf_out[0], torch.exp(inputs[0]) * 3.0)
+
+        # A step can only read the outputs of earlier steps
+        with self.assertRaisesRegex(RuntimeError, "doesn't run before it"):
+            FusionPipeline([(fd1, [(0, 0), (0, 1)])], outputs=[(0, 0)])
+
     def test_python_version_API(self):
         from nvfuser.nvfuser_version import Version
 
@@ -1586,7 +1710,7 @@ class TestNvFuserFrontend(TestCase):
                 with self.assertRaisesRegex(RuntimeError, "Invalid fusion definition!"):
                     _ = fd.fusion_ir()
 
-            _ = fd.execute(inputs)
+            _ = fd.execute(inputs, collect_lower_pass_stats=True)
 
             code_len = len(fd.last_cuda_code())
             self.assertTrue(code_len > 0, "Cuda Code was not produced!")
@@ -1599,6 +1723,13 @@ class TestNvFuserFrontend(TestCase):
             sched_ir_len = len(fd.fusion_ir())
             self.assertTrue(code_len > 0, "Unscheduled Fusion IR was not produced!")
 
+            lower_stats = fd.last_lower_pass_stats()
+            self.assertTrue(len(lower_stats) > 0, "Lowering stats were not produced!")
+            for kernel_stats in lower_stats:
+                pass_names = [p["name"] for p in kernel_stats]
+                self.assertIn("IndexLowering", pass_names)
+                self.assertTrue(all(p["time_ms"] >= 0 for p in kernel_stats))
+
             code_len = len(fd.cuda_code_for(inputs))
             self.assertTrue(code_len > 0, "Cuda Code was not produced!")
             code_len = len(fd.cuda_code_for(inputs, intrinsic_code=True))
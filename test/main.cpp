@@ -17,11 +17,29 @@ std::string add_negative_flag(const std::string& flag) {
   return filter;
 }
 
+// Replaces the positive patterns of the filter, unless the user gave some
+std::string set_default_positive_flag(const std::string& flag) {
+  std::string filter = ::testing::GTEST_FLAG(filter);
+  auto negative_begin = filter.find('-');
+  auto positive = filter.substr(0, negative_begin);
+  if (!positive.empty() && positive != "*") {
+    return filter;
+  }
+  return negative_begin == std::string::npos
+      ? flag
+      : flag + filter.substr(negative_begin);
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
-  TORCH_CHECK(
-      torch::cuda::is_available(),
-      "nvfuser_tests requires CUDA device being available");
+  if (!torch::cuda::is_available()) {
+    // Tests with the _CPU suffix, e.g., of the heuristic tuning database,
+    // do not need a GPU.  A filter given by the user is kept as is.
+    std::cout << "No CUDA device detected. Only running CPU tests"
+              << std::endl;
+    ::testing::GTEST_FLAG(filter) = set_default_positive_flag("*_CPU");
+    return RUN_ALL_TESTS();
+  }
 
   if (torch::cuda::device_count() < 2) {
     std::cout << "Only one CUDA device detected. Disabling MultiCUDA tests"
@@ -1110,6 +1110,45 @@ TEST_F(NVFuserTest, FusionInputsIdLookup_CUDA) {
   TORCH_CHECK(id_3_norecord.id == id_3_lookup_norecord.id);
 }
 
+// Lookup of the arguments captured from the inputs, as is done by the
+// FusionExecutorCache
+TEST_F(NVFuserTest, FusionInputsIdLookupArgs_CUDA) {
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({16, 8, 8}, options);
+  at::Tensor t1 = at::randn({8, 8}, options);
+  at::Tensor t2 = at::randn({6, 4}, options);
+  auto args = [](const std::vector<c10::IValue>& inputs) {
+    return KernelArgumentHolder::createKernelArgumentHolder(inputs);
+  };
+
+  nvfuser::InputsIdLookup inputs_id_lookup(2);
+
+  auto id_0 = inputs_id_lookup.lookupId(args({t0, t1, 5.0}));
+  auto id_0_lookup = inputs_id_lookup.lookupId(args({t0, t1, 2.5}));
+  TORCH_CHECK(id_0.id == id_0_lookup.id);
+  TORCH_CHECK(inputs_id_lookup.size() == 1);
+
+  // A transposed input has different strides
+  auto id_1 = inputs_id_lookup.lookupId(args({t0, t1.t(), 5.0}));
+  TORCH_CHECK(id_1.id != id_0.id);
+  TORCH_CHECK(inputs_id_lookup.size() == 2);
+
+  auto id_2 = inputs_id_lookup.lookupId(args({t2, t1, 5.0}));
+  TORCH_CHECK(id_2.eviction == true);
+  TORCH_CHECK(id_2.evict_id == id_0.id);
+
+  auto id_3 = inputs_id_lookup.lookupId(
+      args({t0, t1, 5.0, 1, true}), /*scalar_inputs_to_record*/ {2, 3, 4});
+  auto id_3_lookup = inputs_id_lookup.lookupId(
+      args({t0, t1, 2.5, 2, false}), /*scalar_inputs_to_record*/ {2, 3, 4});
+  auto id_3_norecord = inputs_id_lookup.lookupId(
+      args({t0, t1, 5.0, 1, true}), /*scalar_inputs_to_record*/ {});
+  auto id_3_lookup_norecord = inputs_id_lookup.lookupId(
+      args({t0, t1, 2.5, 2, false}), /*scalar_inputs_to_record*/ {});
+  TORCH_CHECK(id_3.id != id_3_lookup.id);
+  TORCH_CHECK(id_3_norecord.id == id_3_lookup_norecord.id);
+}
+
 TEST_F(NVFuserTest, FusionGroupGuardSimpleTensor_CUDA) {
   std::vector<int64_t> sizes_vec({16, 8, 8});
   std::vector<int64_t> strides_vec({64, 8, 1});
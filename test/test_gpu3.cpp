@@ -11,6 +11,8 @@
 #include <codegen.h>
 #include <device_lower/lower2device.h>
 #include <device_lower/pass/magic_zero.h>
+#include <device_lower/pass/scalar_hoist.h>
+#include <device_profile.h>
 #include <disjoint_set.h>
 #include <executor.h>
 #include <executor_params.h>
@@ -25,6 +27,7 @@
 #include <ir/iostream.h>
 #include <ir/utils.h>
 #include <iter_visitor.h>
+#include <kernel_bundle.h>
 #include <kernel_cache.h>
 #include <kernel_ir.h>
 #include <kernel_ir_dispatch.h>
@@ -32,6 +35,7 @@
 #include <ops/all_ops.h>
 #include <root_domain_map.h>
 #include <scheduler/all_schedulers.h>
+#include <scheduler/normalization_utils.h>
 #include <scheduler/reduction_utils.h>
 #include <scheduler/utils.h>
 #include <test/utils.h>
@@ -50,7 +54,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <optional>
 #include <sstream>
 #include <thread>
 
@@ -3244,6 +3251,125 @@ TEST_F(NVFuserMultithreadedTest, MultipleFunctions_CUDA) {
   }
 }
 
+// Different fusion groups are compiled and run concurrently
+TEST_F(NVFuserMultithreadedTest, DistinctFunctions_CUDA) {
+  auto run_kernel = [](int64_t alpha) {
+    const std::string ir = R"IR(
+  graph(%x.1 : Tensor,
+        %y.1 : Tensor):
+    %9 : int = prim::Constant[value=1]()
+    %alpha : int = prim::Constant[value=)IR" +
+        std::to_string(alpha) + R"IR(]()
+    %3 : Tensor = aten::exp(%x.1)
+    %5 : Tensor = aten::relu(%y.1)
+    %8 : Tensor = aten::add(%3, %5, %alpha)
+    %10 : Tensor = aten::mul(%8, %9)
+    return (%10)
+  )IR";
+    auto g = std::make_shared<torch::jit::Graph>();
+    torch::jit::parseIR(ir, g.get());
+    torch::jit::GraphFunction fn("nvfuser_test", g, nullptr);
+
+    auto x = torch::rand({32, 32}, at::TensorOptions(at::kCUDA));
+    auto y = torch::rand({32, 32}, at::TensorOptions(at::kCUDA));
+    auto expected = x.exp() + y.relu() * alpha;
+    for (const auto& i : c10::irange(10)) {
+      (void)i; // Suppress unused variable warning
+      auto stack = createStack({x.clone(), y.clone()});
+      fn.run(stack);
+      ASSERT_TRUE(at::allclose(stack.back().toTensor(), expected));
+    }
+  };
+
+  constexpr size_t kNumThreads = 4;
+  std::vector<std::thread> threads;
+  for (size_t id = 0; id < kNumThreads; ++id) {
+    threads.emplace_back(run_kernel, (int64_t)id + 1);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+// Threads share one FusionExecutorCache. The inputs of each thread have their
+// own sizes, so runtimes are compiled and reused while others run.
+TEST_F(NVFuserMultithreadedTest, SharedExecutorCache_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  fusion->addOutput(tv1);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto run_kernel = [&executor_cache](int64_t size) {
+    auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+    auto t0 = at::randn({size, 128}, options);
+    auto expected = t0.sum({1});
+    for (const auto& i : c10::irange(10)) {
+      (void)i; // Suppress unused variable warning
+      auto outputs = executor_cache.runFusionWithInputs({t0});
+      ASSERT_TRUE(at::allclose(outputs.at(0), expected, 1e-4, 1e-4));
+    }
+  };
+
+  constexpr size_t kNumThreads = 4;
+  std::vector<std::thread> threads;
+  for (size_t id = 0; id < kNumThreads; ++id) {
+    threads.emplace_back(run_kernel, 64 * ((int64_t)id + 1));
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+// Threads that run misaligned inputs at once share the scalar fallback of
+// an alignment-agnostic runtime
+TEST_F(NVFuserMultithreadedTest, SharedScalarFallback_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = add(tv0, IrBuilder::create<Double>(1.0));
+  fusion->addOutput(tv1);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+  executor_cache.setAlignmentAgnostic(true);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  const int64_t m = 128;
+  const int64_t n = 1024;
+  // Compile the vectorized kernel first
+  executor_cache.runFusionWithInputs({at::randn({m, n}, options)});
+
+  constexpr int64_t kNumRuns = 10;
+  auto run_kernel = [&]() {
+    auto t0 = at::randn({m * n + 1}, options).narrow(0, 1, m * n).view({m, n});
+    for (const auto& i : c10::irange(kNumRuns)) {
+      (void)i; // Suppress unused variable warning
+      auto outputs = executor_cache.runFusionWithInputs({t0});
+      ASSERT_TRUE(at::allclose(outputs.at(0), t0 + 1));
+    }
+  };
+
+  constexpr size_t kNumThreads = 4;
+  std::vector<std::thread> threads;
+  for (size_t id = 0; id < kNumThreads; ++id) {
+    threads.emplace_back(run_kernel);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  auto runtime = executor_cache.getMostRecentKernelRuntime();
+  EXPECT_EQ(executor_cache.getKernelRuntimes().begin()->second.size(), 1);
+  EXPECT_EQ(
+      runtime->numScalarFallbackLaunches(), (int64_t)kNumThreads * kNumRuns);
+}
+
 // Repro of issue #1655
 TEST_F(NVFuserTest, FusionIncompleteConcreteID_CUDA) {
   Fusion fusion;
@@ -4396,6 +4522,92 @@ to: 2
   TORCH_CHECK(printer2.ss.str() == expect);
 }
 
+// Spanning trees from the same reference are reused until the tensor graph
+// changes
+TEST_F(NVFuserTest, FusionMaxRootDomainInfoSpanningTreeCache_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sin(tv0);
+  auto tv2 = sum(tv1, {1});
+  fusion->addOutput(tv2);
+
+  struct Printer : public MaxInfoSpanningTree::Propagator {
+    std::stringstream ss;
+    void propagateC2P(TensorView* from, TensorView* to) override {
+      ss << "C2P " << from->name() << " " << to->name() << std::endl;
+    }
+    void propagateP2C(TensorView* from, TensorView* to) override {
+      ss << "P2C " << from->name() << " " << to->name() << std::endl;
+    }
+    void propagateSibling(TensorView* from, TensorView* to) override {
+      ss << "Sibling " << from->name() << " " << to->name() << std::endl;
+    }
+  };
+  auto path_from = [](TensorView* reference) {
+    Printer printer;
+    MaxRootDomainInfoSpanningTree(reference).traverse(&printer);
+    return printer.ss.str();
+  };
+
+  const auto version = fusion->tvGraphVersion();
+  const auto path = path_from(tv2);
+  EXPECT_EQ(path, "C2P 2 1\nC2P 1 0\n");
+
+  // Scheduling transformations don't change the tensor graph
+  tv2->split(1, 32);
+  scheduler_utils::transformPropagateToAllFrom(tv2, -1);
+  tv2->merge(0);
+  scheduler_utils::transformPropagateToAllFrom(tv2, -1);
+  EXPECT_EQ(fusion->tvGraphVersion(), version);
+  EXPECT_EQ(path_from(tv2), path);
+  EXPECT_EQ(tv0->nDims(), 2);
+
+  // New tensors are reached once they are added
+  auto tv3 = cos(tv1);
+  fusion->addOutput(tv3);
+  EXPECT_NE(fusion->tvGraphVersion(), version);
+  EXPECT_EQ(path_from(tv2), "C2P 2 1\nC2P 1 0\nP2C 1 3\n");
+
+  // A copy of the fusion doesn't use paths cached for the original
+  Fusion copy = *fusion;
+  FusionGuard copy_fg(&copy);
+  auto copy_tv2 = copy.outputs().at(0)->as<TensorView>();
+  EXPECT_EQ(path_from(copy_tv2), path_from(tv2));
+}
+
+// Replacing the root domains of tensors, e.g. by replacing their extents,
+// drops the root domain maps cached for the replaced IterDomains
+TEST_F(NVFuserTest, FusionMaxRootDomainInfoSpanningTreeCacheMutate_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sin(tv0);
+  auto tv2 = sum(tv1, {1});
+  fusion->addOutput(tv2);
+
+  tv2->split(1, 32);
+  scheduler_utils::transformPropagateToAllFrom(tv2, -1);
+  EXPECT_EQ(tv0->nDims(), 3);
+
+  const auto version = fusion->tvGraphVersion();
+  auto extent = IrBuilder::create<Int>(128);
+  ir_utils::replaceValue(fusion.get(), {{tv0->axis(0)->extent(), extent}});
+  EXPECT_NE(fusion->tvGraphVersion(), version);
+  EXPECT_EQ(tv0->getRootDomain().at(0)->extent(), extent);
+
+  // The transformations propagate through the replaced root domains
+  tv2->split(0, 4);
+  scheduler_utils::transformPropagateToAllFrom(tv2, -1);
+  EXPECT_EQ(tv0->nDims(), 4);
+  EXPECT_EQ(tv1->nDims(), 4);
+  EXPECT_EQ(tv0->axis(1)->extent()->evaluateInt(), 4);
+}
+
 TEST_F(NVFuserTest, FusionTransformPropagatorNoOverwrite_CUDA) {
   auto fusion = std::make_unique<Fusion>();
   FusionGuard fg(fusion.get());
@@ -8585,6 +8797,916 @@ TEST_F(NVFuserTest, IsFinite_CUDA) {
   }
 }
 
+// Identical address arithmetic of different tensors in the same loop
+// nest should be computed only once
+TEST_F(NVFuserTest, FusionIndexHoistAcrossTensors_CUDA) {
+  if (isOptionDisabled(DisableOption::IndexHoist)) {
+    GTEST_SKIP() << "Index hoisting disabled";
+  }
+
+  // Builds T2 = T0 + T1. With swap_operands, the same fusion is defined
+  // with T1 as the first input and the first operand of the addition.
+  auto define_fusion = [](Fusion* fusion, bool swap_operands) {
+    FusionGuard fg(fusion);
+    auto tv0 = makeSymbolicTensor(2);
+    auto tv1 = makeSymbolicTensor(2);
+    if (swap_operands) {
+      std::swap(tv0, tv1);
+    }
+    fusion->addInput(tv0);
+    fusion->addInput(tv1);
+    auto tv2 = add(tv0, tv1);
+    fusion->addOutput(tv2);
+
+    tv2->merge(0);
+    tv2->split(0, 128);
+    tv2->axis(0)->parallelize(ParallelType::BIDx);
+    tv2->axis(1)->parallelize(ParallelType::TIDx);
+  };
+
+  Fusion fusion;
+  define_fusion(&fusion, false);
+
+  GpuLower gpulw(&fusion);
+
+  // Collect all the scalars the indices of each input are computed from
+  std::unordered_map<StmtNameType, std::unordered_set<Val*>> index_vals;
+  for (auto expr :
+       ir_utils::flattenScopedExprs(gpulw.kernel()->topLevelExprs())) {
+    for (auto ti : ir_utils::filterByType<kir::TensorIndex>(expr->inputs())) {
+      auto& vals = index_vals[ti->view()->name()];
+      std::vector<Val*> to_visit{ti->index()};
+      while (!to_visit.empty()) {
+        auto val = to_visit.back();
+        to_visit.pop_back();
+        if (!vals.insert(val).second || val->definition() == nullptr) {
+          continue;
+        }
+        auto inputs = val->definition()->inputs();
+        to_visit.insert(to_visit.end(), inputs.begin(), inputs.end());
+      }
+    }
+  }
+  ASSERT_TRUE(index_vals.count(0));
+  ASSERT_TRUE(index_vals.count(1));
+
+  // Any computation T1 shares with T0, including commutative products
+  // whose operands are ordered differently, must reuse the same Val
+  bool shares_computation = false;
+  for (auto t0_val : index_vals.at(0)) {
+    if (t0_val->definition() == nullptr) {
+      continue;
+    }
+    for (auto t1_val : index_vals.at(1)) {
+      if (isEquivalentScalar(t0_val, t1_val)) {
+        EXPECT_EQ(t0_val, t1_val)
+            << "Not reused: " << t0_val->toInlineString() << " and "
+            << t1_val->toInlineString();
+        shares_computation = true;
+      }
+    }
+  }
+  EXPECT_TRUE(shares_computation)
+      << "T0 and T1 are expected to share their index computation";
+
+  // Which tensor is indexed first must not change what is hoisted, so
+  // renaming the tensors back gives the same kernel
+  const std::string kernel_string =
+      codegen::generateCudaKernel(gpulw.kernel());
+  Fusion swapped_fusion;
+  define_fusion(&swapped_fusion, true);
+  std::string swapped_kernel_string =
+      codegen::generateCudaKernel(GpuLower(&swapped_fusion).kernel());
+  for (auto i : c10::irange(1, swapped_kernel_string.size())) {
+    auto& c = swapped_kernel_string[i];
+    if (swapped_kernel_string[i - 1] != 'T' ||
+        (i > 1 && std::isalnum(swapped_kernel_string[i - 2]))) {
+      continue;
+    }
+    if (c == '0') {
+      c = '1';
+    } else if (c == '1') {
+      c = '0';
+    }
+  }
+  EXPECT_EQ(kernel_string, swapped_kernel_string);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  auto t0 = at::randn({99, 101}, options);
+  auto t1 = at::randn({99, 101}, options);
+
+  FusionExecutor fe;
+  fe.compileFusion(&fusion, {t0, t1});
+  auto cg_outputs = fe.runFusion({t0, t1});
+
+  testValidate(&fusion, cg_outputs, {t0, t1}, {t0 + t1}, __LINE__, __FILE__);
+}
+
+TEST_F(NVFuserTest, FusionEquivalentScalars_CUDA) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  Val* a = IrBuilder::create<Int>();
+  Val* b = IrBuilder::create<Int>();
+  Val* c = IrBuilder::create<Int>();
+
+  EXPECT_TRUE(isEquivalentScalar(add(a, mul(b, c)), add(mul(c, b), a)));
+  EXPECT_FALSE(isEquivalentScalar(add(a, mul(b, c)), add(mul(a, b), c)));
+
+  // Operands of non-commutative operations are ordered
+  EXPECT_FALSE(isEquivalentScalar(sub(a, b), sub(b, a)));
+  EXPECT_FALSE(isEquivalentScalar(div(a, b), div(b, a)));
+  EXPECT_FALSE(isEquivalentScalar(mod(a, b), mod(b, a)));
+  EXPECT_FALSE(isEquivalentScalar(lt(a, b), lt(b, a)));
+  EXPECT_TRUE(isEquivalentScalar(add(sub(a, b), c), add(c, sub(a, b))));
+  EXPECT_FALSE(isEquivalentScalar(add(sub(a, b), c), add(c, sub(b, a))));
+
+  // Every operand is compared in both orders unless memoized, which would
+  // take 2^depth comparisons
+  constexpr int64_t depth = 64;
+  Val* x = a;
+  Val* y = a;
+  Val* z = c;
+  for (auto i : c10::irange(depth)) {
+    (void)i;
+    x = add(add(x, x), b);
+    y = add(b, add(y, y));
+    z = add(b, add(z, z));
+  }
+  EXPECT_TRUE(isEquivalentScalar(x, y));
+  EXPECT_FALSE(isEquivalentScalar(x, z));
+}
+
+TEST_F(NVFuserTest, FusionLowerPassStats_CUDA) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion.addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  auto tv2 = add(tv1, IrBuilder::create<Double>(1));
+  fusion.addOutput(tv2);
+
+  tv1->split(1, 128);
+  tv1->axis(0)->parallelize(ParallelType::BIDx);
+  tv1->axis(-1)->parallelize(ParallelType::TIDx);
+  tv2->axis(0)->parallelize(ParallelType::BIDx);
+
+  // Nothing is collected unless requested
+  if (!isDebugDumpEnabled(DebugDumpOption::LowerPassStats)) {
+    EXPECT_TRUE(GpuLower(&fusion).passStats().empty());
+  }
+
+  GpuLower gpulw(&fusion, CompileParams(), /*collect_pass_stats=*/true);
+  const auto& stats = gpulw.passStats();
+
+  ASSERT_FALSE(stats.empty());
+  EXPECT_EQ(stats.front().name, "initialize lowering");
+  EXPECT_EQ(stats.back().name, "instrumentKernel");
+
+  for (auto pass_name : {"SyncMap", "insertAllocations", "IndexLowering"}) {
+    EXPECT_TRUE(std::any_of(
+        stats.begin(),
+        stats.end(),
+        [&pass_name](const LowerPassStats& pass) {
+          return pass.name == pass_name;
+        }))
+        << "Missing pass statistics: " << pass_name;
+  }
+
+  for (auto i : c10::irange(stats.size())) {
+    EXPECT_GE(stats.at(i).time_ms, 0);
+    // Each pass starts with the IR left by the previous pass
+    if (i > 0) {
+      EXPECT_EQ(stats.at(i).ir_nodes_before, stats.at(i - 1).ir_nodes_after);
+      EXPECT_EQ(stats.at(i).exprs_before, stats.at(i - 1).exprs_after);
+    }
+  }
+
+  // Indexing creates new scalar IR nodes
+  auto indexing = std::find_if(
+      stats.begin(), stats.end(), [](const LowerPassStats& pass) {
+        return pass.name == "IndexLowering";
+      });
+  EXPECT_GT(indexing->ir_nodes_after, indexing->ir_nodes_before);
+
+  const auto json = lowerPassStatsToJson(stats);
+  EXPECT_NE(json.find("\"name\": \"IndexLowering\""), std::string::npos)
+      << json;
+}
+
+// Segments compiled in parallel collect the lowering statistics requested
+// from their FusionExecutorCache
+TEST_F(NVFuserTest, FusionLowerPassStatsSegmented_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  fusion->addOutput(sum(tv0, {0}));
+  fusion->addOutput(sum(tv0, {1}));
+
+  FusionExecutorCache fec(std::move(fusion));
+  fec.collectLowerPassStats(true);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({128, 256}, options);
+  fec.runFusionWithInputs({t0});
+
+  const auto& executors = fec.getMostRecentKernelRuntime()->executors();
+  ASSERT_GT(executors.size(), 1);
+  for (const auto& executor : executors) {
+    const auto& stats = executor.lowerPassStats();
+    EXPECT_TRUE(std::any_of(
+        stats.begin(), stats.end(), [](const LowerPassStats& pass) {
+          return pass.name == "IndexLowering";
+        }));
+  }
+}
+
+// Lower many independent fusions concurrently. The generated code must be
+// identical to the code generated by lowering the same fusion serially.
+TEST_F(NVFuserTest, FusionConcurrentLowering_CUDA) {
+  auto lower_fusion = [](int64_t variant) {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+
+    auto tv0 = makeSymbolicTensor(2);
+    fusion.addInput(tv0);
+    auto tv1 = makeSymbolicTensor(2);
+    fusion.addInput(tv1);
+    auto tv2 = add(tv0, tv1);
+    auto tv3 = variant % 2 == 0 ? sum(tv2, {1}) : max(tv2, {1});
+    auto tv4 = broadcast(tv3, {false, true});
+    auto tv5 = sub(tv2, tv4);
+    fusion.addOutput(tv5);
+
+    tv5->split(1, 32 * (1 + variant % 4));
+    TransformPropagatorWithCheck propagator(tv5);
+    MaxRootDomainInfoSpanningTree(tv5).traverse(&propagator);
+    tv5->axis(0)->parallelize(ParallelType::BIDx);
+    tv5->axis(-1)->parallelize(ParallelType::TIDx);
+    scheduler_utils::parallelizeAllLike(tv5);
+    inlineMost();
+
+    return codegen::generateCudaKernel(GpuLower(&fusion).kernel());
+  };
+
+  constexpr int64_t kNumVariants = 8;
+  std::vector<std::string> ref_code;
+  for (auto variant : c10::irange(kNumVariants)) {
+    ref_code.push_back(lower_fusion(variant));
+  }
+
+  constexpr int64_t kNumThreads = 8;
+  constexpr int64_t kNumFusionsPerThread = 16;
+  std::vector<std::vector<std::string>> thread_code(kNumThreads);
+  std::vector<std::thread> threads;
+  for (auto thread_id : c10::irange(kNumThreads)) {
+    threads.emplace_back([&, thread_id]() {
+      for (auto i : c10::irange(kNumFusionsPerThread)) {
+        thread_code.at(thread_id).push_back(
+            lower_fusion((thread_id + i) % kNumVariants));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_FALSE(GpuLower::hasCurrent());
+
+  for (auto thread_id : c10::irange(kNumThreads)) {
+    for (auto i : c10::irange(kNumFusionsPerThread)) {
+      EXPECT_EQ(
+          thread_code.at(thread_id).at(i),
+          ref_code.at((thread_id + i) % kNumVariants))
+          << "Mismatched code in thread " << thread_id << ", fusion " << i;
+    }
+  }
+}
+
+// Kernels should only carry the runtime helpers they call into
+TEST_F(NVFuserTest, FusionKernelPreamblePruning_CUDA) {
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+
+  {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+
+    auto tv0 = makeSymbolicTensor(2);
+    fusion.addInput(tv0);
+    auto tv1 = add(tv0, IrBuilder::create<Double>(1));
+    fusion.addOutput(tv1);
+
+    tv1->merge(0);
+    tv1->split(0, 128);
+    tv1->axis(0)->parallelize(ParallelType::BIDx);
+    tv1->axis(1)->parallelize(ParallelType::TIDx);
+
+    at::Tensor t0 = at::randn({99, 101}, options);
+    FusionExecutor fe;
+    fe.compileFusion(&fusion, {t0});
+
+    EXPECT_TRUE(fe.runtimeModules().empty());
+    const auto pruned_code = fe.getStructuredCode();
+    const auto full_code =
+        fe.getStructuredCode(fe.kernelString(), fe.kernel()->indexType());
+    EXPECT_LT(pruned_code.size(), full_code.size());
+    EXPECT_EQ(pruned_code.find("gridReduce"), std::string::npos);
+    EXPECT_EQ(pruned_code.find("welfordCombine"), std::string::npos);
+
+    auto cg_outputs = fe.runFusion({t0});
+    testValidate(&fusion, cg_outputs, {t0}, {t0 + 1}, __LINE__, __FILE__);
+  }
+
+  {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+
+    auto tv0 = makeSymbolicTensor(2);
+    fusion.addInput(tv0);
+    auto tv1 = sum(tv0, {1});
+    fusion.addOutput(tv1);
+
+    tv1->split(1, 128);
+    tv1->axis(0)->parallelize(ParallelType::BIDy);
+    tv1->axis(1)->parallelize(ParallelType::BIDx);
+    tv1->axis(2)->parallelize(ParallelType::TIDx);
+
+    at::Tensor t0 = at::randn({10, 1000}, options);
+    FusionExecutor fe;
+    fe.compileFusion(&fusion, {t0});
+
+    const auto& modules = fe.runtimeModules();
+    EXPECT_EQ(modules.count(codegen::RuntimeModule::GridReduction), 1);
+    EXPECT_EQ(modules.count(codegen::RuntimeModule::Welford), 0);
+    EXPECT_EQ(modules.count(codegen::RuntimeModule::TensorCore), 0);
+    EXPECT_NE(fe.getStructuredCode().find("gridReduce"), std::string::npos);
+
+    auto cg_outputs = fe.runFusion({t0});
+    testValidate(
+        &fusion, cg_outputs, {t0}, {t0.sum({1})}, __LINE__, __FILE__);
+  }
+}
+
+// Structurally identical fusions should share one compiled kernel even when
+// their statement names differ
+TEST_F(NVFuserTest, FusionCompiledKernelReuse_CUDA) {
+  auto make_fusion = [](bool shift_names, bool use_mul) {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+
+    if (shift_names) {
+      // Unused statements only advance the name counters
+      auto unused = makeSymbolicTensor(3);
+      neg(unused);
+    }
+
+    auto tv0 = makeSymbolicTensor(2);
+    auto tv1 = makeSymbolicTensor(2);
+    fusion->addInput(tv0);
+    fusion->addInput(tv1);
+    auto tv2 = use_mul ? mul(tv0, tv1) : add(tv0, tv1);
+    fusion->addOutput(tv2);
+
+    tv2->merge(0);
+    tv2->split(0, 128);
+    tv2->axis(0)->parallelize(ParallelType::BIDx);
+    tv2->axis(1)->parallelize(ParallelType::TIDx);
+    return fusion;
+  };
+
+  auto fusion_a = make_fusion(false, false);
+  auto fusion_b = make_fusion(true, false);
+  auto fusion_c = make_fusion(false, true);
+
+  auto fingerprint_a = fingerprintFusion(fusion_a.get());
+  EXPECT_TRUE(fingerprint_a == fingerprintFusion(fusion_b.get()));
+  EXPECT_FALSE(fingerprint_a == fingerprintFusion(fusion_c.get()));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({33, 65}, options);
+  at::Tensor t1 = at::randn({33, 65}, options);
+  std::vector<c10::IValue> aten_inputs = {t0, t1};
+
+  auto& cache = CompiledKernelCache::get();
+  cache.clear();
+
+  FusionExecutor fe_a;
+  fe_a.compileFusion(fusion_a.get(), aten_inputs);
+  EXPECT_EQ(cache.stats().misses, 1);
+  EXPECT_EQ(cache.stats().hits, 0);
+
+  FusionExecutor fe_b;
+  fe_b.compileFusion(fusion_b.get(), aten_inputs);
+  EXPECT_EQ(cache.stats().misses, 1);
+  EXPECT_EQ(cache.stats().hits, 1);
+  EXPECT_EQ(cache.stats().entries, 1);
+  EXPECT_EQ(cache.stats().references, 2);
+  // Sharing the kernel keeps the ids of the executors apart
+  EXPECT_NE(fe_a.kernelName(), fe_b.kernelName());
+  EXPECT_THAT(
+      fe_b.kernelString(),
+      ::testing::HasSubstr("__global__ void " + fe_b.kernelName() + "("));
+
+  FusionExecutor fe_c;
+  fe_c.compileFusion(fusion_c.get(), aten_inputs);
+  EXPECT_EQ(cache.stats().misses, 2);
+  EXPECT_EQ(cache.stats().entries, 2);
+
+  // Kernels compiled with other NVRTC options are not shared
+  {
+    ThreadLocalFmaDisableOverwrite no_fma;
+    FusionExecutor fe_no_fma;
+    fe_no_fma.compileFusion(fusion_b.get(), aten_inputs);
+    EXPECT_EQ(cache.stats().misses, 3);
+    EXPECT_EQ(cache.stats().entries, 3);
+  }
+  EXPECT_EQ(cache.releaseUnused(), 1);
+
+  auto outputs_b = fe_b.runFusion(aten_inputs);
+  testValidate(
+      fusion_b.get(), outputs_b, aten_inputs, {t0 + t1}, __LINE__, __FILE__);
+  auto outputs_c = fe_c.runFusion(aten_inputs);
+  testValidate(
+      fusion_c.get(), outputs_c, aten_inputs, {t0 * t1}, __LINE__, __FILE__);
+
+  // Nothing can be released while the executors hold their kernels
+  EXPECT_EQ(cache.releaseUnused(), 0);
+  fe_c = FusionExecutor();
+  EXPECT_EQ(cache.releaseUnused(), 1);
+  EXPECT_EQ(cache.stats().entries, 1);
+  EXPECT_EQ(cache.stats().references, 2);
+}
+
+// The block size is derived from the inputs, so it does not split the
+// kernels of a fusion. Executors launching larger blocks than the shared
+// kernel was compiled for recompile it.
+TEST_F(NVFuserTest, FusionCompiledKernelReuseBlockSize_CUDA) {
+  auto make_fusion = []() {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeSymbolicTensor(1);
+    fusion->addInput(tv0);
+    auto tv1 = mul(tv0, IrBuilder::create<Double>(2.0));
+    fusion->addOutput(tv1);
+    tv1->axis(0)->parallelize(ParallelType::TIDx);
+    return fusion;
+  };
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t_small = at::randn({64}, options);
+  at::Tensor t_large = at::randn({512}, options);
+
+  auto& cache = CompiledKernelCache::get();
+  cache.clear();
+
+  auto fusion_small = make_fusion();
+  FusionExecutor fe_small;
+  fe_small.compileFusion(fusion_small.get(), {t_small});
+  auto fusion_large = make_fusion();
+  FusionExecutor fe_large;
+  fe_large.compileFusion(fusion_large.get(), {t_large});
+  EXPECT_EQ(cache.stats().misses, 1);
+  EXPECT_EQ(cache.stats().hits, 1);
+
+  auto entries = cache.entries();
+  ASSERT_EQ(entries.size(), 1u);
+  EXPECT_EQ(entries.front().second->block_size, 64);
+  EXPECT_EQ(entries.front().second->launch_params.bdimx(), 64);
+
+  auto outputs = fe_large.runFusion({t_large});
+  testValidate(
+      fusion_large.get(),
+      outputs,
+      {t_large},
+      {t_large * 2},
+      __LINE__,
+      __FILE__);
+  outputs = fe_small.runFusion({t_small});
+  testValidate(
+      fusion_small.get(),
+      outputs,
+      {t_small},
+      {t_small * 2},
+      __LINE__,
+      __FILE__);
+}
+
+TEST_F(NVFuserTest, FusionDeviceProfile_CUDA) {
+  auto real_profile = currentDeviceProfile();
+
+  {
+    DeviceProfileGuard v100_guard(DeviceProfile::builtin("v100"));
+    const DeviceProfile* v100_guard_profile = injectedDeviceProfile();
+    EXPECT_EQ(currentDeviceProfile()->computeCapability(), 70);
+    EXPECT_FALSE(isSupportedTypeByDevice(DataType::BFloat16));
+    {
+      DeviceProfileGuard a100_guard(DeviceProfile::builtin("a100"));
+      EXPECT_EQ(currentDeviceProfile()->multi_processor_count, 108);
+      EXPECT_TRUE(isSupportedTypeByDevice(DataType::BFloat16));
+    }
+    EXPECT_EQ(currentDeviceProfile()->name, "v100");
+
+    // Other threads only see the profile when it is passed to them
+    std::thread other([&]() {
+      EXPECT_EQ(currentDeviceProfile(), real_profile);
+      DeviceProfileGuard guard(v100_guard_profile);
+      EXPECT_EQ(currentDeviceProfile()->name, "v100");
+    });
+    other.join();
+  }
+  EXPECT_EQ(currentDeviceProfile(), real_profile);
+  EXPECT_EQ(injectedDeviceProfile(), nullptr);
+
+  EXPECT_THAT(
+      [&]() { DeviceProfile::builtin("not_a_gpu"); },
+      ::testing::ThrowsMessage<c10::Error>(
+          ::testing::HasSubstr("Unknown device profile")));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({8192, 1024}, options);
+
+  // Scheduling, lowering and codegen only depend on the injected profile
+  for (const auto& name : DeviceProfile::builtinNames()) {
+    DeviceProfileGuard guard(DeviceProfile::builtin(name));
+
+    auto make_scheduled_fusion = [&]() {
+      auto fusion = std::make_unique<Fusion>();
+      FusionGuard fg(fusion.get());
+      auto tv0 = makeSymbolicTensor(2);
+      fusion->addInput(tv0);
+      auto tv1 = sum(tv0, {0});
+      fusion->addOutput(tv1);
+
+      auto params = getReductionHeuristics(fusion.get(), {t0});
+      TORCH_CHECK(params, "Reduction schedule was not generated!");
+      scheduleReduction(fusion.get(), *params);
+      return std::make_pair(std::move(fusion), params);
+    };
+
+    auto [fusion, params] = make_scheduled_fusion();
+    auto [other_fusion, other_params] = make_scheduled_fusion();
+    EXPECT_TRUE(params->sameAs(other_params)) << name;
+
+    GpuLower gpulw(fusion.get());
+    EXPECT_FALSE(codegen::generateCudaKernel(gpulw.kernel()).empty()) << name;
+  }
+}
+
+TEST_F(NVFuserTest, FusionKernelBundle_CUDA) {
+  auto make_fusion = []() {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeSymbolicTensor(2);
+    fusion->addInput(tv0);
+    auto tv1 = sum(exp(tv0), {1});
+    auto tv2 = div(exp(tv0), broadcast(tv1, {false, true}));
+    fusion->addOutput(tv2);
+    return fusion;
+  };
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({128, 1024}, options);
+  auto ref = at::softmax(t0, 1);
+
+  const auto bundle_dir =
+      (std::filesystem::temp_directory_path() / "nvfuser_kernel_bundle_test")
+          .string();
+  std::filesystem::remove_all(bundle_dir);
+
+  auto& cache = CompiledKernelCache::get();
+  cache.clear();
+
+  // Builder side: compile and write the bundle
+  cache.setKeepCompiledBinaries(true);
+  {
+    FusionExecutorCache fec(make_fusion());
+    fec.runFusionWithInputs({t0});
+  }
+  cache.setKeepCompiledBinaries(false);
+  const auto num_kernels =
+      writeKernelBundle(bundle_dir, *currentDeviceProfile());
+  EXPECT_GT(num_kernels, 0);
+
+  // Deployment side: preload the bundle into an empty cache
+  cache.clear();
+  auto stats = FusionExecutorCache::preloadKernelBundle(bundle_dir);
+  EXPECT_EQ(stats.loaded, num_kernels);
+  EXPECT_EQ(stats.compiled, 0);
+  EXPECT_EQ(stats.skipped, 0);
+
+  // Every kernel records how it was scheduled and launched
+  for (const auto& key_and_entry : cache.entries()) {
+    const auto& entry = key_and_entry.second;
+    EXPECT_FALSE(entry->heuristic.empty());
+    EXPECT_THAT(entry->heuristic_params, ::testing::HasSubstr("bdimx="));
+    ASSERT_TRUE(entry->block_size.has_value());
+    EXPECT_EQ(entry->block_size.value(), entry->launch_params.nThreads());
+  }
+
+  FusionExecutorCache fec(make_fusion());
+  auto outputs = fec.runFusionWithInputs({t0});
+  EXPECT_EQ(cache.stats().misses, 0);
+  EXPECT_EQ(cache.stats().hits, num_kernels);
+  testValidate(fec.fusion(), outputs, {t0}, {ref}, __LINE__, __FILE__);
+
+  std::filesystem::remove_all(bundle_dir);
+}
+
+// Kernels generated for another device are only compiled, from proxy
+// inputs, for the compute capability of that device
+TEST_F(NVFuserTest, FusionKernelBundleOtherDevice_CUDA) {
+  const auto local = currentDeviceProfile();
+  std::optional<DeviceProfile> other;
+  for (const auto& name : DeviceProfile::builtinNames()) {
+    auto profile = DeviceProfile::builtin(name);
+    if (profile.computeCapability() != local->computeCapability()) {
+      other = profile;
+      break;
+    }
+  }
+  ASSERT_TRUE(other.has_value());
+
+  auto fusion = std::make_unique<Fusion>();
+  {
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeSymbolicTensor(2);
+    fusion->addInput(tv0);
+    fusion->addOutput(sum(tv0, {1}));
+  }
+
+  const auto bundle_dir = (std::filesystem::temp_directory_path() /
+                           "nvfuser_kernel_bundle_other_device_test")
+                              .string();
+  std::filesystem::remove_all(bundle_dir);
+
+  auto& cache = CompiledKernelCache::get();
+  cache.clear();
+  cache.setKeepCompiledBinaries(true);
+  int64_t num_kernels = 0;
+  {
+    DeviceProfileGuard profile_guard(other.value());
+    FusionExecutorCache fec(std::move(fusion));
+    KernelArgumentHolder args;
+    args.setDeviceIndex(0);
+    args.pushTensorProxy({128, 1024}, {1024, 1}, at::kFloat);
+    fec.compileFusionWithArgs(args);
+    num_kernels = writeKernelBundle(bundle_dir, other.value());
+  }
+  cache.setKeepCompiledBinaries(false);
+  EXPECT_GT(num_kernels, 0);
+
+  // The manifest records the compute capability of the kernels, and the
+  // binaries compiled for it are bundled
+  std::ifstream manifest(
+      (std::filesystem::path(bundle_dir) / "manifest.csv").string());
+  std::string line;
+  for (auto i : c10::irange(3)) {
+    (void)i;
+    std::getline(manifest, line);
+  }
+  const auto arch = "," + std::to_string(other->major) + "," +
+      std::to_string(other->minor) + ",";
+  while (std::getline(manifest, line)) {
+    EXPECT_THAT(line, ::testing::HasSubstr(arch));
+    EXPECT_NE(line.back(), ',');
+  }
+
+  // The kernels don't match the local device
+  cache.clear();
+  auto stats = FusionExecutorCache::preloadKernelBundle(bundle_dir);
+  EXPECT_EQ(stats.loaded, 0);
+  EXPECT_EQ(stats.skipped, num_kernels);
+
+  std::filesystem::remove_all(bundle_dir);
+}
+
+// An alignment-agnostic FusionExecutorCache must not compile a new runtime
+// when only the alignment of the inputs changes, and must run misaligned
+// inputs with the scalar fallback kernel
+TEST_F(NVFuserTest, FusionAlignmentAgnosticCache_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = add(tv0, IrBuilder::create<Double>(1.0));
+  fusion->addOutput(tv1);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  const int64_t m = 128;
+  const int64_t n = 1024;
+  auto t0 = at::randn({m, n}, options);
+  // Same sizes and strides, but shifted by one element
+  auto t0_misaligned =
+      at::randn({m * n + 1}, options).narrow(0, 1, m * n).view({m, n});
+
+  FusionExecutorCache fec(std::move(fusion));
+  fec.setAlignmentAgnostic(true);
+
+  auto outputs = fec.runFusionWithInputs({t0});
+  auto runtime = fec.getMostRecentKernelRuntime();
+  EXPECT_TRUE(runtime->isAlignmentAgnostic());
+  EXPECT_EQ(runtime->numScalarFallbackLaunches(), 0);
+  testValidate(fec.fusion(), outputs, {t0}, {t0 + 1}, __LINE__, __FILE__);
+
+  outputs = fec.runFusionWithInputs({t0_misaligned});
+  EXPECT_EQ(fec.getMostRecentKernelRuntime(), runtime);
+  EXPECT_EQ(runtime->numScalarFallbackLaunches(), 1);
+  testValidate(
+      fec.fusion(),
+      outputs,
+      {t0_misaligned},
+      {t0_misaligned + 1},
+      __LINE__,
+      __FILE__);
+
+  // Aligned inputs keep using the vectorized kernel
+  fec.runFusionWithInputs({t0});
+  EXPECT_EQ(runtime->numScalarFallbackLaunches(), 1);
+  EXPECT_EQ(fec.getKernelRuntimes().begin()->second.size(), 1);
+}
+
+namespace {
+
+// Softmax backward, where both inputs are persistent
+std::unique_ptr<Fusion> makeSoftmaxBackwardFusion() {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto grad_output = makeContigTensor(2);
+  auto output = makeContigTensor(2);
+  fusion->addInput(grad_output);
+  auto tv2 = mul(grad_output, output);
+  auto tv3 = sum(tv2, {1});
+  auto tv4 = broadcast(tv3, {false, true});
+  auto tv5 = sub(grad_output, tv4);
+  auto tv6 = mul(output, tv5);
+  fusion->addInput(output);
+  fusion->addOutput(tv6);
+  return fusion;
+}
+
+// Softmax backward along the outer dimension
+std::unique_ptr<Fusion> makeOuterSoftmaxBackwardFusion() {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto grad_output = makeContigTensor(2);
+  auto output = makeContigTensor(2);
+  fusion->addInput(grad_output);
+  auto tv2 = mul(grad_output, output);
+  auto tv3 = sum(tv2, {0});
+  auto tv4 = broadcast(tv3, {true, false});
+  auto tv5 = sub(grad_output, tv4);
+  auto tv6 = mul(output, tv5);
+  fusion->addInput(output);
+  fusion->addOutput(tv6);
+  return fusion;
+}
+
+} // namespace
+
+// Scheduling, lowering and codegen take every device property from an
+// injected profile, so they run without a GPU
+TEST(DeviceProfileTest, ScheduleWithInjectedProfile_CPU) {
+  auto options = at::TensorOptions().dtype(at::kFloat);
+  KernelArgumentHolder args;
+  args.setDeviceIndex(0);
+  args.push(at::empty({8192, 1024}, options));
+
+  for (const auto& name : DeviceProfile::builtinNames()) {
+    DeviceProfileGuard profile_guard(DeviceProfile::builtin(name));
+    EXPECT_EQ(currentDeviceProfile()->name, name);
+    EXPECT_EQ(deviceProfile(0), currentDeviceProfile());
+
+    auto make_scheduled_fusion = [&]() {
+      auto fusion = std::make_unique<Fusion>();
+      FusionGuard fg(fusion.get());
+      auto tv0 = makeSymbolicTensor(2);
+      fusion->addInput(tv0);
+      fusion->addOutput(sum(tv0, {1}));
+
+      SchedulerRuntimeInfo runtime_info(fusion.get(), args);
+      auto params = getReductionHeuristics(fusion.get(), runtime_info);
+      TORCH_CHECK(params, "Reduction schedule was not generated!");
+      scheduleReduction(fusion.get(), *params);
+      return std::make_pair(std::move(fusion), params);
+    };
+
+    auto [fusion, params] = make_scheduled_fusion();
+    auto [other_fusion, other_params] = make_scheduled_fusion();
+    EXPECT_TRUE(params->sameAs(other_params)) << name;
+
+    GpuLower gpulw(fusion.get());
+    EXPECT_FALSE(codegen::generateCudaKernel(gpulw.kernel()).empty()) << name;
+  }
+}
+
+// Persistent buffers that don't fit in registers are kept in shared memory
+TEST(PersistentSchedulerTest, SharedMemoryPersistence_CPU) {
+  DeviceProfileGuard profile_guard(DeviceProfile::builtin("a100"));
+
+  auto options = at::TensorOptions().dtype(at::kFloat);
+  auto make_args = [&](int64_t hidden_size) {
+    KernelArgumentHolder args;
+    args.setDeviceIndex(0);
+    args.push(at::empty({216, hidden_size}, options));
+    args.push(at::empty({216, hidden_size}, options));
+    return args;
+  };
+
+  // 2 * 4K floats fit in registers
+  {
+    auto fusion = makeSoftmaxBackwardFusion();
+    SchedulerRuntimeInfo runtime_info(fusion.get(), make_args(4096));
+    ASSERT_TRUE(SchedulerEntry::canSchedule(
+        ScheduleHeuristic::Persistent, fusion.get(), runtime_info));
+    auto rparams = getPersistentHeuristics(fusion.get(), runtime_info);
+    EXPECT_EQ(rparams->smem_persistent_buffers, 0);
+  }
+
+  // 2 * 32K floats don't, but one of the buffers fits in shared memory
+  {
+    auto fusion = makeSoftmaxBackwardFusion();
+    SchedulerRuntimeInfo runtime_info(fusion.get(), make_args(32768));
+    ASSERT_TRUE(SchedulerEntry::canSchedule(
+        ScheduleHeuristic::Persistent, fusion.get(), runtime_info));
+    auto rparams = getPersistentHeuristics(fusion.get(), runtime_info);
+    EXPECT_EQ(rparams->smem_persistent_buffers, 1);
+
+    schedulePersistentKernel(fusion.get(), *rparams);
+    auto tvs = ir_utils::allTvs(fusion.get());
+    EXPECT_EQ(
+        std::count_if(
+            tvs.begin(),
+            tvs.end(),
+            [](TensorView* tv) {
+              return tv->getMemoryType() == MemoryType::Shared;
+            }),
+        1);
+  }
+
+  // 2 * 64K floats fit in neither
+  {
+    auto fusion = makeSoftmaxBackwardFusion();
+    SchedulerRuntimeInfo runtime_info(fusion.get(), make_args(65536));
+    EXPECT_FALSE(SchedulerEntry::canSchedule(
+        ScheduleHeuristic::Persistent, fusion.get(), runtime_info));
+  }
+
+  // Outer normalizations never keep buffers in shared memory, so 2 * 32K
+  // floats along the reduction dimension are rejected
+  {
+    auto fusion = makeOuterSoftmaxBackwardFusion();
+    KernelArgumentHolder args;
+    args.setDeviceIndex(0);
+    args.push(at::empty({32768, 216}, options));
+    args.push(at::empty({32768, 216}, options));
+    SchedulerRuntimeInfo runtime_info(fusion.get(), args);
+    EXPECT_FALSE(SchedulerEntry::canSchedule(
+        ScheduleHeuristic::Persistent, fusion.get(), runtime_info));
+  }
+
+  // A buffer is moved as a whole
+  auto fusion = makeSoftmaxBackwardFusion();
+  auto inputs = ir_utils::filterByType<TensorView>(fusion->inputs()).vector();
+  auto plan = normalization_scheduler_utils::planSharedMemoryPersistence(
+      {{inputs[0], 200}, {inputs[1], 100}}, 300, 150, 1000);
+  ASSERT_TRUE(plan.has_value());
+  EXPECT_EQ(plan->n_smem_buffers, 1);
+  EXPECT_EQ(plan->smem_buffer_size, 200);
+  EXPECT_EQ(plan->register_buffer_size, 100);
+  EXPECT_FALSE(normalization_scheduler_utils::planSharedMemoryPersistence(
+                   {{inputs[0], 200}, {inputs[1], 100}}, 300, 150, 150)
+                   .has_value());
+}
+
+TEST_F(NVFuserTest, FusionSharedMemoryPersistence_CUDA) {
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({216, 32768}, options);
+  at::Tensor t1 = at::randn({216, 32768}, options);
+
+  FusionExecutorCache fec(makeSoftmaxBackwardFusion());
+  auto outputs = fec.runFusionWithInputs({t0, t1});
+  testValidate(
+      fec.fusion(),
+      outputs,
+      {t0, t1},
+      {t1 * (t0 - (t0 * t1).sum({1}, true))},
+      __LINE__,
+      __FILE__);
+
+  // Devices with enough shared memory run a single persistent kernel
+  auto runtime = fec.getMostRecentKernelRuntime();
+  if (!runtime->isSegmented()) {
+    auto heuristic =
+        runtime->schedulerHeuristics()->heuristicsList().at(0).get();
+    EXPECT_EQ(heuristic->heuristic(), ScheduleHeuristic::Persistent);
+    EXPECT_EQ(heuristic->reductionParams().smem_persistent_buffers, 1);
+  }
+}
+
 // Test file size should be up to 10K LoC. Create a new file for more tests.
 
 } // namespace nvfuser
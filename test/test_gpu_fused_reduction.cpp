@@ -9,6 +9,7 @@
 
 #include <codegen.h>
 #include <device_lower/lower2device.h>
+#include <device_profile.h>
 #include <disjoint_set.h>
 #include <executor.h>
 #include <executor_params.h>
@@ -2562,4 +2563,134 @@ TEST_F(NVFuserTest, FusionCrossEntropyGatherPattern_CUDA) {
   testValidate(&fusion, cg_outputs, inputs, {ref}, __LINE__, __FILE__);
 }
 
+TEST(SplitReductionTest, SplitReductionFactor_CPU) {
+  ReductionParams rparams;
+  rparams.cross_grid_inner_reduction = true;
+  rparams.grid_dim_inner_reduction = ParallelType::BIDx;
+  rparams.lparams = LaunchParams(1024, 4, LaunchParams::UNINITIALIZED_VAL, 256);
+  // Few outputs reduced by many blocks each
+  EXPECT_EQ(splitReductionFactor(rparams, 4, 4), 1024);
+  // Too many partial results to move through a workspace
+  EXPECT_EQ(splitReductionFactor(rparams, 1 << 20, 4), 1);
+
+  rparams.lparams = LaunchParams(16, 4, LaunchParams::UNINITIALIZED_VAL, 256);
+  EXPECT_EQ(splitReductionFactor(rparams, 4, 4), 1);
+
+  rparams.cross_grid_inner_reduction = false;
+  rparams.grid_dim_inner_reduction = ParallelType::Serial;
+  rparams.lparams = LaunchParams(4, LaunchParams::UNINITIALIZED_VAL);
+  EXPECT_EQ(splitReductionFactor(rparams, 4, 4), 1);
+}
+
+TEST(SplitReductionTest, SplitReductionInFusion_CPU) {
+  DeviceProfileGuard profile_guard(DeviceProfile::builtin("a100"));
+
+  auto make_fusion = []() {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeSymbolicTensor(2, DataType::Half);
+    fusion->addInput(tv0);
+    auto tv1 = sum(tv0, {1});
+    fusion->addOutput(tv1);
+    return fusion;
+  };
+  auto options = at::TensorOptions().dtype(at::kHalf);
+  auto make_args = [&](const std::vector<int64_t>& sizes) {
+    KernelArgumentHolder args;
+    args.setDeviceIndex(0);
+    args.push(at::empty(sizes, options));
+    return args;
+  };
+
+  // Enough outputs to fill the device without a grid reduction
+  auto fusion = make_fusion();
+  EXPECT_FALSE(SegmentCandidateFinder::splitReductionInFusion(
+                   fusion.get(), make_args({1024, 1024}))
+                   .has_value());
+  EXPECT_FALSE(SegmentCandidateFinder::hasSegmentHints(fusion.get()));
+
+  const std::vector<int64_t> sizes = {4, 1 << 24};
+  auto split_reduction_input = SegmentCandidateFinder::splitReductionInFusion(
+      fusion.get(), make_args(sizes));
+  ASSERT_TRUE(split_reduction_input.has_value());
+  EXPECT_EQ(split_reduction_input->input_index, 0);
+  EXPECT_EQ(split_reduction_input->reduction_axis, 1);
+  EXPECT_GT(split_reduction_input->chunks, 1);
+  const auto split_sizes = split_reduction_input->splitSizes(sizes);
+  ASSERT_EQ(split_sizes.size(), 3u);
+  EXPECT_EQ(split_sizes[0], sizes[0]);
+  EXPECT_EQ(split_sizes[1], split_reduction_input->chunks);
+  EXPECT_EQ(split_sizes[1] * split_sizes[2], sizes[1]);
+  EXPECT_TRUE(SegmentCandidateFinder::hasSegmentHints(fusion.get()));
+  EXPECT_EQ(fusion->inputs().at(0)->as<TensorView>()->nDims(), 3u);
+
+  auto segmented_fusion = SegmentCandidateFinder::segment(
+      std::move(fusion), make_args(split_sizes));
+  EXPECT_EQ(segmented_fusion->groups().size(), 2u);
+}
+
+// Four outputs each reduced over 2^24 elements run as two reduction kernels
+TEST_F(NVFuserTest, FusionSplitReduction_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  {
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeSymbolicTensor(2);
+    fusion->addInput(tv0);
+    auto tv1 = sum(tv0, {1});
+    auto tv2 = add(tv1, IrBuilder::create<Double>(1.0));
+    fusion->addOutput(tv2);
+  }
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({4, 1 << 24}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  for (auto i : c10::irange(2)) {
+    (void)i;
+    auto outputs = fec.runFusionWithInputs({t0});
+    testValidate(
+        fec.fusion(), outputs, {t0}, {t0.sum({1}) + 1}, __LINE__, __FILE__);
+  }
+  EXPECT_EQ(fec.getKernelRuntimes().size(), 1u);
+  auto runtime = fec.getMostRecentKernelRuntime();
+  ASSERT_TRUE(runtime->splitReductionInput().has_value());
+  EXPECT_TRUE(runtime->isSegmented());
+
+  // Short reductions are not split, so they need another runtime
+  at::Tensor t1 = at::randn({4, 1 << 10}, options);
+  auto outputs = fec.runFusionWithInputs({t1});
+  testValidate(
+      fec.fusion(), outputs, {t1}, {t1.sum({1}) + 1}, __LINE__, __FILE__);
+  EXPECT_NE(fec.getMostRecentKernelRuntime(), runtime);
+}
+
+// Reductions of different lengths split into the same number of chunks share
+// one runtime
+TEST_F(NVFuserTest, FusionSplitReductionReuse_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  {
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeSymbolicTensor(2);
+    fusion->addInput(tv0);
+    auto tv1 = sum(tv0, {1});
+    fusion->addOutput(tv1);
+  }
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({4, 1 << 24}, options);
+  at::Tensor t1 = at::randn({4, 1 << 23}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto outputs = fec.runFusionWithInputs({t0});
+  testValidate(fec.fusion(), outputs, {t0}, {t0.sum({1})}, __LINE__, __FILE__);
+  auto runtime = fec.getMostRecentKernelRuntime();
+  ASSERT_TRUE(runtime->splitReductionInput().has_value());
+
+  outputs = fec.runFusionWithInputs({t1});
+  testValidate(fec.fusion(), outputs, {t1}, {t1.sum({1})}, __LINE__, __FILE__);
+  EXPECT_EQ(fec.getMostRecentKernelRuntime(), runtime);
+  EXPECT_EQ(fec.runtimeStats().runtimes_created, 1);
+  EXPECT_EQ(fec.runtimeStats().runtimes_reused, 1);
+}
+
 } // namespace nvfuser
@@ -0,0 +1,594 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <gmock/gmock-matchers.h>
+#include <gtest/gtest.h>
+
+#include <device_profile.h>
+#include <fusion.h>
+#include <kernel_cache.h>
+#include <kernel_db/utils.h>
+#include <ops/all_ops.h>
+#include <scheduler/all_schedulers.h>
+#include <scheduler/autotune.h>
+#include <scheduler/tuning_db.h>
+#include <test/utils.h>
+#include <test/validator.h>
+
+#include <filesystem>
+#include <sstream>
+
+namespace nvfuser {
+
+namespace {
+
+std::unique_ptr<Fusion> makeSumFusion() {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  fusion->addOutput(tv1);
+  return fusion;
+}
+
+// Normalizes the rows of a 2D tensor, which needs the persistent scheduler
+std::unique_ptr<Fusion> makeRowNormalizeFusion() {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  auto tv2 = broadcast(tv1, {false, true});
+  auto tv3 = div(tv0, tv2);
+  fusion->addOutput(tv3);
+  return fusion;
+}
+
+std::string tempFile(const std::string& name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+} // namespace
+
+// Tests with the _CPU suffix do not use a GPU. Launch parameters are checked
+// against the limits of the current device, so a device profile is
+// injected.
+
+TEST(HeuristicTuningTest, SerializeParams_CPU) {
+  DeviceProfileGuard profile_guard(DeviceProfile::builtin("a100"));
+
+  ReductionParams rparams("reduction", PrimDataType::Int32);
+  rparams.fastest_dim = true;
+  rparams.persistent_kernel = true;
+  rparams.cross_block_inner_reduction = true;
+  rparams.vectorize_inner_reduction = true;
+  rparams.unroll_factor_inner_reduction = 4;
+  rparams.batches_per_block_inner_reduction = 3;
+  rparams.block_dim_inner_reduction = ParallelType::TIDx;
+  rparams.block_dim_iter_dom = ParallelType::TIDy;
+  rparams.grid_dim_iter_dom = ParallelType::BIDx;
+  rparams.cparams.maxrregcount = 128;
+  rparams.lparams = LaunchParams(-1, -1, -1, 128, 4, -1);
+  rparams.lparams.setSmem(1024);
+
+  PointwiseParams pparams("pointwise", PrimDataType::Int);
+  pparams.vectorize = true;
+  pparams.break_point = 1;
+  pparams.split_block = true;
+  pparams.unroll_factor = 8;
+  pparams.lparams.bind(128, ParallelType::TIDx);
+
+  TransposeParams tparams("transpose", PrimDataType::Int);
+  tparams.split_before_tiling = {{0, 2}, {1, 4}};
+  tparams.dims_merged_with_1 = {0, 2};
+  tparams.vectorize_factor1 = 4;
+  tparams.tile_size2 = 64;
+
+  MatmulParams mparams;
+  mparams.cparams.index_type = PrimDataType::Int32;
+  mparams.async_gmem_load_operands = true;
+  mparams.tile_sizes = MatMulTileOptions(
+      GemmTile(256, 128, 32), GemmTile(64, 64, 32), GemmTile(16, 8, 16));
+  mparams.mma_macro = MmaOptions::MacroType::Ampere_16_8_16;
+  mparams.cta_order = MatmulParams::TileRasterizationOrder::ColumnMajor;
+  mparams.double_buffer_options.double_buffer_smem_write = true;
+  mparams.double_buffer_options.smem_double_buffer_stage = 4;
+  mparams.grid_swizzle_factor = 2;
+
+  auto roundtrip = [](ScheduleHeuristic heuristic,
+                      const HeuristicParams& params) {
+    auto result = deserializeHeuristicParams(
+        heuristic, serializeHeuristicParams(params));
+    EXPECT_TRUE(result->sameAs(params.clone())) << params.toString();
+    EXPECT_EQ(result->cparams, params.cparams);
+    EXPECT_EQ(result->lparams, params.lparams);
+    EXPECT_EQ(result->lparams.smem(), params.lparams.smem());
+  };
+  roundtrip(ScheduleHeuristic::Persistent, rparams);
+  roundtrip(ScheduleHeuristic::PointWise, pparams);
+  roundtrip(ScheduleHeuristic::Transpose, tparams);
+  roundtrip(ScheduleHeuristic::Matmul, mparams);
+
+  // Parameters that are not given keep their defaults
+  auto defaults =
+      deserializeHeuristicParams(ScheduleHeuristic::PointWise, "vectorize=1");
+  auto defaults_pparams = std::dynamic_pointer_cast<PointwiseParams>(defaults);
+  ASSERT_TRUE(defaults_pparams != nullptr);
+  EXPECT_TRUE(defaults_pparams->vectorize);
+  EXPECT_EQ(defaults_pparams->unroll_factor, (size_t)1);
+}
+
+TEST(HeuristicTuningTest, ShapeSignature_CPU) {
+  EXPECT_EQ(
+      shapeSignature(PrimDataType::Int, {{{100, 1000}, 4}, {{}, 1}}),
+      "idx64|128x1024v4|s");
+  EXPECT_EQ(
+      shapeSignature(PrimDataType::Int32, {{{1, 0, 2, 3}, 1}}),
+      "idx32|1x0x2x4v1");
+  // Extents in the same power-of-two bucket share the signature
+  EXPECT_EQ(
+      shapeSignature(PrimDataType::Int, {{{65, 1024}, 8}}),
+      shapeSignature(PrimDataType::Int, {{{128, 513}, 8}}));
+  EXPECT_NE(
+      shapeSignature(PrimDataType::Int, {{{128, 1024}, 8}}),
+      shapeSignature(PrimDataType::Int, {{{128, 1025}, 8}}));
+  EXPECT_NE(
+      shapeSignature(PrimDataType::Int, {{{128, 1024}, 8}}),
+      shapeSignature(PrimDataType::Int, {{{128, 1024}, 4}}));
+}
+
+TEST(HeuristicTuningTest, ShapeBuckets_CPU) {
+  // Extents are snapped to the largest value of the bucket with the same
+  // divisibility by powers of two up to 16
+  auto pow2 = ShapeBuckets::powersOfTwo();
+  EXPECT_EQ(pow2.snap(0), 0);
+  EXPECT_EQ(pow2.snap(1), 1);
+  EXPECT_EQ(pow2.snap(3), 3);
+  EXPECT_EQ(pow2.snap(1000), 1016);
+  EXPECT_EQ(pow2.snap(1001), 1023);
+  EXPECT_EQ(pow2.snap(1024), 1024);
+  EXPECT_EQ(pow2.snap(513), 1023);
+
+  auto boundaries = ShapeBuckets::fromBoundaries({512, 128});
+  EXPECT_EQ(boundaries.snap(100), 124);
+  EXPECT_EQ(boundaries.snap(128), 128);
+  EXPECT_EQ(boundaries.snap(130), 510);
+  EXPECT_EQ(boundaries.snap(600), 600);
+
+  EXPECT_EQ(ShapeBuckets().snap(1000), 1000);
+
+  // Extents of the same bucket get the same heuristics
+  DeviceProfileGuard profile_guard(DeviceProfile::builtin("a100"));
+  auto fusion = makeSumFusion();
+  FusionGuard fg(fusion.get());
+  auto tv0 = fusion->inputs().at(0)->as<TensorView>();
+  auto options = at::TensorOptions().dtype(at::kFloat);
+  std::vector<std::shared_ptr<ReductionParams>> heuristics;
+  for (int64_t inner : {1000, 1016}) {
+    KernelArgumentHolder args;
+    args.setDeviceIndex(0);
+    args.push(at::randn({1000, inner}, options));
+    SchedulerRuntimeInfo runtime_info(
+        fusion.get(), args, nullptr, {}, std::nullopt, false, &pow2);
+    EXPECT_EQ(
+        runtime_info.expressionEvaluator()
+            .evaluate(tv0->axis(1)->extent())
+            ->as<int64_t>(),
+        1016);
+    heuristics.push_back(getReductionHeuristics(fusion.get(), runtime_info));
+  }
+  EXPECT_TRUE(heuristics.at(0)->sameAs(heuristics.at(1)));
+  EXPECT_EQ(heuristics.at(0)->lparams, heuristics.at(1)->lparams);
+}
+
+TEST(HeuristicTuningTest, RecordedEntries_CPU) {
+  DeviceProfileGuard profile_guard(DeviceProfile::builtin("a100"));
+
+  auto fusion = makeSumFusion();
+  const auto key = makeTuningKey(
+      ScheduleHeuristic::Reduction,
+      fusion.get(),
+      PrimDataType::Int,
+      {{{1000, 1000}, 4}});
+
+  // A database as it would have been recorded by a tuning run
+  const auto db_file = tempFile("nvfuser_tuning_db_test.csv");
+  std::stringstream recorded;
+  recorded << "nvfuser_tuning_db," << tuning_db_version << "\n"
+           << "reduction," << key.device_major << "," << key.device_minor
+           << "," << key.multi_processor_count << "," << key.shape_signature
+           << ",fastest_dim=1 cross_block_inner_reduction=1"
+           << " block_dim_inner_reduction="
+           << static_cast<int>(ParallelType::TIDx)
+           << " unroll_factor_inner_reduction=4 vectorize_inner_reduction=1"
+           << " index_type=" << static_cast<int>(PrimDataType::Int)
+           << " maxrregcount=96 bdimx=256,";
+  // The fingerprint is percent-encoded
+  for (char c : key.fingerprint.canonical_ir) {
+    if (c == '\n') {
+      recorded << "%0A";
+    } else if (c == ',') {
+      recorded << "%2C";
+    } else if (c == '%') {
+      recorded << "%25";
+    } else {
+      recorded << c;
+    }
+  }
+  recorded << "\n";
+  ASSERT_TRUE(copy_to_text_file(db_file, recorded.str()));
+
+  auto& db = TuningDatabase::get();
+  db.clear();
+  EXPECT_EQ(db.load(db_file), 1);
+
+  // Hits for all shapes of the bucket
+  for (const auto& sizes :
+       {std::vector<int64_t>{1000, 1000}, std::vector<int64_t>{513, 1024}}) {
+    auto params = db.lookup(makeTuningKey(
+        ScheduleHeuristic::Reduction,
+        fusion.get(),
+        PrimDataType::Int,
+        {{sizes, 4}}));
+    ASSERT_TRUE(params != nullptr);
+    auto rparams = std::dynamic_pointer_cast<ReductionParams>(params);
+    ASSERT_TRUE(rparams != nullptr);
+    EXPECT_TRUE(rparams->fastest_dim);
+    EXPECT_EQ(rparams->unroll_factor_inner_reduction, 4);
+    EXPECT_EQ(rparams->block_dim_inner_reduction, ParallelType::TIDx);
+    EXPECT_EQ(rparams->cparams.maxrregcount, 96);
+    EXPECT_EQ(rparams->lparams.bdimx(), 256);
+  }
+
+  // Misses for other buckets, vectorization limits, heuristics, devices and
+  // fusions
+  EXPECT_TRUE(
+      db.lookup(makeTuningKey(
+          ScheduleHeuristic::Reduction,
+          fusion.get(),
+          PrimDataType::Int,
+          {{{1000, 2000}, 4}})) == nullptr);
+  EXPECT_TRUE(
+      db.lookup(makeTuningKey(
+          ScheduleHeuristic::Reduction,
+          fusion.get(),
+          PrimDataType::Int,
+          {{{1000, 1000}, 2}})) == nullptr);
+  EXPECT_TRUE(
+      db.lookup(makeTuningKey(
+          ScheduleHeuristic::Persistent,
+          fusion.get(),
+          PrimDataType::Int,
+          {{{1000, 1000}, 4}})) == nullptr);
+  {
+    DeviceProfileGuard other_guard(DeviceProfile::builtin("h100"));
+    EXPECT_TRUE(
+        db.lookup(makeTuningKey(
+            ScheduleHeuristic::Reduction,
+            fusion.get(),
+            PrimDataType::Int,
+            {{{1000, 1000}, 4}})) == nullptr);
+  }
+  {
+    Fusion other;
+    FusionGuard fg(&other);
+    auto tv0 = makeSymbolicTensor(2);
+    other.addInput(tv0);
+    other.addOutput(max(tv0, {1}));
+    EXPECT_TRUE(
+        db.lookup(makeTuningKey(
+            ScheduleHeuristic::Reduction,
+            &other,
+            PrimDataType::Int,
+            {{{1000, 1000}, 4}})) == nullptr);
+  }
+  EXPECT_EQ(db.stats().hits, 2);
+  EXPECT_EQ(db.stats().misses, 5);
+
+  // Saving and loading again preserves the entries
+  auto recorded_params = db.lookup(key);
+  db.save(db_file);
+  db.clear();
+  EXPECT_EQ(db.load(db_file), 1);
+  auto reloaded_params = db.lookup(key);
+  ASSERT_TRUE(reloaded_params != nullptr);
+  EXPECT_TRUE(reloaded_params->sameAs(recorded_params));
+  EXPECT_EQ(reloaded_params->cparams, recorded_params->cparams);
+  EXPECT_EQ(reloaded_params->lparams, recorded_params->lparams);
+
+  // Other versions of the format are rejected
+  ASSERT_TRUE(copy_to_text_file(db_file, "nvfuser_tuning_db,0\n"));
+  EXPECT_THAT(
+      [&]() { db.load(db_file); },
+      ::testing::ThrowsMessage<c10::Error>(
+          ::testing::HasSubstr("is not supported")));
+
+  db.clear();
+  std::filesystem::remove(db_file);
+}
+
+// Recorded parameters that the schedulers would not produce for the inputs
+// and the device are ignored
+TEST(HeuristicTuningTest, IllegalRecordedParams_CPU) {
+  DeviceProfileGuard profile_guard(DeviceProfile::builtin("a100"));
+
+  auto fusion = makeSumFusion();
+  KernelArgumentHolder args;
+  args.setDeviceIndex(0);
+  args.push(at::empty({1000, 1024}, at::TensorOptions().dtype(at::kFloat)));
+  SchedulerRuntimeInfo runtime_info(fusion.get(), args);
+  const auto key =
+      makeTuningKey(ScheduleHeuristic::Reduction, fusion.get(), runtime_info);
+
+  ReductionParams rparams("reduction", runtime_info.getIndexType());
+  rparams.fastest_dim = true;
+  rparams.cross_block_inner_reduction = true;
+  rparams.block_dim_inner_reduction = ParallelType::TIDx;
+  rparams.lparams = LaunchParams(-1, -1, -1, 256, -1, -1);
+  EXPECT_EQ(
+      checkTunedParams(
+          ScheduleHeuristic::Reduction, rparams, fusion.get(), runtime_info),
+      "");
+
+  auto& db = TuningDatabase::get();
+  db.clear();
+  db.record(key, rparams);
+  EXPECT_TRUE(
+      db.lookup(ScheduleHeuristic::Reduction, fusion.get(), runtime_info) !=
+      nullptr);
+
+  // Vectorization the inputs don't allow
+  for (int64_t factor : {3, 32}) {
+    auto vectorized = rparams;
+    vectorized.vectorize_inner_reduction = true;
+    vectorized.unroll_factor_inner_reduction = factor;
+    EXPECT_THAT(
+        checkTunedParams(
+            ScheduleHeuristic::Reduction,
+            vectorized,
+            fusion.get(),
+            runtime_info),
+        ::testing::HasSubstr("vectorization"));
+  }
+
+  // More threads per block than the device has
+  rparams.lparams = LaunchParams(-1, -1, -1, 2048, -1, -1);
+  EXPECT_THAT(
+      checkTunedParams(
+          ScheduleHeuristic::Reduction, rparams, fusion.get(), runtime_info),
+      ::testing::HasSubstr("too many threads"));
+
+  // Another index type than the inputs need
+  auto other_index_type = rparams;
+  other_index_type.lparams = LaunchParams(-1, -1, -1, 256, -1, -1);
+  other_index_type.cparams.index_type =
+      runtime_info.getIndexType() == PrimDataType::Int ? PrimDataType::Int32
+                                                       : PrimDataType::Int;
+  EXPECT_THAT(
+      checkTunedParams(
+          ScheduleHeuristic::Reduction,
+          other_index_type,
+          fusion.get(),
+          runtime_info),
+      ::testing::HasSubstr("index type"));
+
+  db.record(key, rparams);
+  EXPECT_TRUE(
+      db.lookup(ScheduleHeuristic::Reduction, fusion.get(), runtime_info) ==
+      nullptr);
+  EXPECT_EQ(db.stats().hits, 1);
+  EXPECT_EQ(db.stats().misses, 1);
+  db.clear();
+}
+
+TEST(HeuristicTuningTest, EnumerateVariants_CPU) {
+  DeviceProfileGuard profile_guard(DeviceProfile::builtin("a100"));
+
+  ReductionParams seed("reduction", PrimDataType::Int);
+  seed.fastest_dim = true;
+  seed.cross_block_inner_reduction = true;
+  seed.block_dim_inner_reduction = ParallelType::TIDx;
+  seed.vectorize_inner_reduction = true;
+  seed.unroll_factor_inner_reduction = 4;
+  seed.lparams = LaunchParams(-1, -1, -1, 128, -1, -1);
+
+  TuningSpace space;
+  space.unroll_factors = {1, 2, 3, 4, 8};
+  space.iter_unroll_factors = {1};
+  space.block_dims_x = {128, 256, 2048};
+  auto variants =
+      enumerateTuningVariants(ScheduleHeuristic::Reduction, seed, space);
+
+  // Vectorization by 4, 2 and 1 with 128 and 256 threads. The seed cannot
+  // vectorize by 3 or 8, and 2048 threads exceed the block size limit.
+  ASSERT_EQ(variants.size(), 6u);
+  EXPECT_TRUE(variants.at(0)->sameAs(seed.clone()));
+  EXPECT_EQ(variants.at(0)->lparams, seed.lparams);
+  for (const auto& variant : variants) {
+    auto rparams = std::dynamic_pointer_cast<ReductionParams>(variant);
+    ASSERT_TRUE(rparams != nullptr);
+    EXPECT_THAT(
+        rparams->unroll_factor_inner_reduction,
+        ::testing::AnyOf(1, 2, 4));
+    EXPECT_EQ(
+        rparams->vectorize_inner_reduction,
+        rparams->unroll_factor_inner_reduction > 1);
+    EXPECT_THAT(rparams->lparams.bdimx(), ::testing::AnyOf(128, 256));
+    EXPECT_EQ(rparams->batches_per_block_inner_reduction, 1);
+  }
+
+  // Persistent kernels also vary the number of batches
+  seed.persistent_kernel = true;
+  seed.batches_per_block_inner_reduction = 4;
+  space.persistent_batches = {1, 4, 8};
+  EXPECT_EQ(
+      enumerateTuningVariants(ScheduleHeuristic::Persistent, seed, space)
+          .size(),
+      18u);
+
+  space.max_variants_per_heuristic = 5;
+  EXPECT_EQ(
+      enumerateTuningVariants(ScheduleHeuristic::Persistent, seed, space)
+          .size(),
+      5u);
+}
+
+TEST(HeuristicTuningTest, ModelSearch_CPU) {
+  // Allow fewer threads per block than the hardware, so that some of the
+  // persistent variants are illegal
+  auto profile = DeviceProfile::builtin("a100");
+  profile.max_threads_per_block = 256;
+  DeviceProfileGuard profile_guard(profile);
+
+  auto fusion = makeRowNormalizeFusion();
+  auto options = at::TensorOptions().dtype(at::kFloat);
+  at::Tensor t0 = at::randn({1024, 1024}, options);
+  KernelArgumentHolder args;
+  args.setDeviceIndex(0);
+  args.push(t0);
+
+  TuningSpace space;
+  space.unroll_factors = {1, 2, 4};
+  space.persistent_batches = {1, 2, 4, 8};
+  space.block_dims_x = {64, 128, 256};
+
+  // The model prefers blocks of 128 threads and larger unroll factors, and
+  // fails to measure kernels with 2 batches
+  auto model = [](const TuningCandidate& candidate) -> std::optional<double> {
+    auto rparams = std::dynamic_pointer_cast<ReductionParams>(candidate.params);
+    if (rparams->batches_per_block_inner_reduction == 2) {
+      return std::nullopt;
+    }
+    return (double)std::abs(candidate.launch_params.nThreads() - 128) +
+        1.0 / (double)rparams->unroll_factor_inner_reduction;
+  };
+  ModelTuningBackend backend(model);
+
+  auto& db = TuningDatabase::get();
+  db.clear();
+  auto report = autotuneFusion(fusion.get(), args, backend, space, &db);
+
+  EXPECT_GT(report.num_pruned, 0) << report.toString();
+  EXPECT_GT(report.num_failed, 0) << report.toString();
+  EXPECT_EQ(
+      report.num_variants,
+      (int64_t)report.measured.size() + report.num_pruned +
+          report.num_duplicates + report.num_failed);
+  EXPECT_EQ(
+      backend.numMeasured(),
+      (int64_t)report.measured.size() + report.num_failed);
+
+  ASSERT_TRUE(report.best.has_value()) << report.toString();
+  EXPECT_EQ(report.best->heuristic, ScheduleHeuristic::Persistent);
+  for (const auto& [candidate, time] : report.measured) {
+    EXPECT_LE(candidate.launch_params.nThreads(), 256);
+    EXPECT_GE(time, report.best_time_ms);
+  }
+
+  // The number of threads is inferred from the input, so it is not recorded
+  // as a launch constraint
+  EXPECT_FALSE(report.best->params->lparams.hasDim(ParallelType::TIDx));
+
+  SchedulerRuntimeInfo runtime_info(fusion.get(), args);
+  auto recorded = db.lookup(makeTuningKey(
+      ScheduleHeuristic::Persistent, fusion.get(), runtime_info));
+  ASSERT_TRUE(recorded != nullptr);
+  EXPECT_TRUE(recorded->sameAs(report.best->params));
+  EXPECT_EQ(recorded->lparams, report.best->params->lparams);
+
+  db.clear();
+}
+
+// Recorded parameters replace the analytical heuristics of a fusion
+TEST_F(NVFuserTest, FusionTuningDatabaseOverride_CUDA) {
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({1000, 1000}, options);
+
+  auto& db = TuningDatabase::get();
+  db.clear();
+
+  // Take the analytical parameters and change the register limit, which
+  // does not affect the result
+  auto fusion = makeSumFusion();
+  SchedulerRuntimeInfo runtime_info(fusion.get(), {t0});
+  auto analytical = SchedulerEntry::makeEntry(
+      ScheduleHeuristic::Reduction, fusion.get(), runtime_info);
+  auto tuned = analytical->params()->clone();
+  tuned->cparams.maxrregcount = 128;
+  db.record(
+      makeTuningKey(ScheduleHeuristic::Reduction, fusion.get(), runtime_info),
+      *tuned);
+
+  FusionExecutorCache fec(makeSumFusion());
+  auto outputs = fec.runFusionWithInputs({t0});
+  EXPECT_GT(db.stats().hits, 0);
+
+  const auto& heuristics =
+      fec.getMostRecentKernelRuntime()->schedulerHeuristics()->heuristicsList();
+  ASSERT_EQ(heuristics.size(), 1u);
+  EXPECT_EQ(heuristics.at(0)->params()->cparams.maxrregcount, 128);
+  EXPECT_TRUE(heuristics.at(0)->params()->sameAs(tuned));
+
+  testValidate(
+      fec.fusion(), outputs, {t0}, {t0.sum({1})}, __LINE__, __FILE__);
+
+  db.clear();
+}
+
+// Inputs whose extents fall in the same buckets share one runtime
+TEST_F(NVFuserTest, FusionShapeBucketsReuse_CUDA) {
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+
+  FusionExecutorCache fec(makeSumFusion());
+  fec.setShapeBuckets(ShapeBuckets::powersOfTwo());
+
+  // All inner extents snap to 1016
+  for (int64_t inner : {1000, 1016, 984}) {
+    at::Tensor t0 = at::randn({1000, inner}, options);
+    auto outputs = fec.runFusionWithInputs({t0});
+    testValidate(
+        fec.fusion(), outputs, {t0}, {t0.sum({1})}, __LINE__, __FILE__);
+  }
+  EXPECT_EQ(fec.runtimeStats().runtimes_created, 1);
+  EXPECT_EQ(fec.runtimeStats().runtimes_reused, 2);
+}
+
+// Tune on the GPU and run the fusion with the tuned parameters
+TEST_F(NVFuserTest, FusionAutotuneKernelTime_CUDA) {
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({1024, 1024}, options);
+
+  auto& db = TuningDatabase::get();
+  db.clear();
+
+  auto fusion = makeRowNormalizeFusion();
+  TuningSpace space;
+  space.unroll_factors = {1, 4};
+  space.persistent_batches = {2, 4};
+  KernelTimeTuningBackend backend(1, 3);
+  auto report = autotuneFusion(
+      fusion.get(),
+      KernelArgumentHolder::createKernelArgumentHolder({t0}),
+      backend,
+      space,
+      &db);
+  ASSERT_TRUE(report.best.has_value()) << report.toString();
+  EXPECT_GT(report.best_time_ms, 0);
+  EXPECT_EQ(db.stats().entries, 1);
+
+  FusionExecutorCache fec(makeRowNormalizeFusion());
+  auto outputs = fec.runFusionWithInputs({t0});
+  EXPECT_GT(db.stats().hits, 0);
+
+  auto t1 = t0 / t0.sum({1}).unsqueeze(1);
+  testValidate(fec.fusion(), outputs, {t0}, {t1}, __LINE__, __FILE__);
+
+  db.clear();
+}
+
+} // namespace nvfuser
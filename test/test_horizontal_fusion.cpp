@@ -0,0 +1,262 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <gtest/gtest.h>
+
+#include <codegen.h>
+#include <device_profile.h>
+#include <executor.h>
+#include <fusion.h>
+#include <fusion_segmenter.h>
+#include <horizontal_fusion.h>
+#include <ir/builder.h>
+#include <kernel_cache.h>
+#include <ops/all_ops.h>
+#include <scheduler/utils.h>
+#include <test/utils.h>
+#include <test/validator.h>
+#include <transform_replay.h>
+
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace nvfuser {
+
+namespace {
+
+// Reduces tv0 along its inner and tv1 along its outer dimension. The two
+// reductions can't be scheduled as one kernel, and don't depend on each
+// other.
+std::unique_ptr<Fusion> makeIndependentReductionsFusion() {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeSymbolicTensor(2);
+  auto tv1 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  auto tv2 = sum(tv0, {1});
+  auto tv3 = sum(tv1, {0});
+  fusion->addOutput(tv2);
+  fusion->addOutput(tv3);
+  return fusion;
+}
+
+// Order in which the groups can run, producers first
+std::vector<SegmentedGroup*> runOrder(SegmentedFusion* segmented_fusion) {
+  std::unordered_set<Val*> available(
+      segmented_fusion->inputs().begin(), segmented_fusion->inputs().end());
+  std::vector<SegmentedGroup*> pending = segmented_fusion->groups();
+  std::vector<SegmentedGroup*> order;
+  while (!pending.empty()) {
+    auto ready = std::find_if(
+        pending.begin(), pending.end(), [&](SegmentedGroup* group) {
+          return std::all_of(
+              group->inputs().begin(), group->inputs().end(), [&](Val* val) {
+                return available.count(val) > 0 || val->isConstScalar();
+              });
+        });
+    TORCH_INTERNAL_ASSERT(ready != pending.end());
+    available.insert((*ready)->outputs().begin(), (*ready)->outputs().end());
+    order.push_back(*ready);
+    pending.erase(ready);
+  }
+  return order;
+}
+
+} // namespace
+
+TEST(HorizontalFusionTest, PlanPacks_CPU) {
+  DeviceProfileGuard profile_guard(DeviceProfile::builtin("a100"));
+
+  auto fusion = makeIndependentReductionsFusion();
+  auto options = at::TensorOptions().dtype(at::kFloat);
+  KernelArgumentHolder args;
+  args.setDeviceIndex(0);
+  args.push(at::randn({64, 128}, options));
+  args.push(at::randn({64, 128}, options));
+
+  auto segmented_fusion =
+      SegmentCandidateFinder::segment(std::move(fusion), args);
+  auto run_order = runOrder(segmented_fusion.get());
+  ASSERT_GE(run_order.size(), 2u);
+
+  auto can_pack = [](SegmentedGroup*) { return true; };
+  auto packs = planHorizontalPacks(run_order, can_pack);
+  ASSERT_FALSE(packs.empty());
+  for (const auto& pack : packs) {
+    EXPECT_GE(pack.size(), 2u);
+    // Members are consecutive in the run order and independent
+    auto first = std::find(run_order.begin(), run_order.end(), pack.front());
+    std::unordered_set<Val*> pack_outputs;
+    for (auto i : c10::irange(pack.size())) {
+      ASSERT_TRUE(first + i != run_order.end());
+      EXPECT_EQ(*(first + i), pack[i]);
+      for (auto input : pack[i]->inputs()) {
+        EXPECT_EQ(pack_outputs.count(input), 0u);
+      }
+      pack_outputs.insert(
+          pack[i]->outputs().begin(), pack[i]->outputs().end());
+    }
+  }
+
+  // Packs of one segment are not returned
+  EXPECT_TRUE(planHorizontalPacks(run_order, can_pack, 1).empty());
+  EXPECT_TRUE(
+      planHorizontalPacks(run_order, [](SegmentedGroup*) { return false; })
+          .empty());
+}
+
+// Two independently compiled kernels run with a single launch
+TEST_F(NVFuserTest, FusionHorizontalKernel_CUDA) {
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({1000}, options);
+  at::Tensor t1 = at::randn({300, 7}, options);
+
+  Fusion fusion0;
+  {
+    FusionGuard fg(&fusion0);
+    auto tv0 = makeSymbolicTensor(1);
+    fusion0.addInput(tv0);
+    auto tv1 = mul(tv0, IrBuilder::create<Double>(2.0));
+    fusion0.addOutput(tv1);
+    tv1->split(0, 128);
+    tv1->axis(0)->parallelize(ParallelType::BIDx);
+    tv1->axis(1)->parallelize(ParallelType::TIDx);
+  }
+  Fusion fusion1;
+  {
+    FusionGuard fg(&fusion1);
+    auto tv0 = makeSymbolicTensor(2);
+    fusion1.addInput(tv0);
+    auto tv1 = sum(tv0, {1});
+    auto tv2 = add(tv1, IrBuilder::create<Double>(1.0));
+    fusion1.addOutput(tv2);
+    tv2->split(0, 128);
+    TransformPropagatorWithCheck propagator(tv2);
+    MaxRootDomainInfoSpanningTree(tv2).traverse(&propagator);
+    tv2->axis(0)->parallelize(ParallelType::BIDx);
+    tv2->axis(1)->parallelize(ParallelType::TIDx);
+    scheduler_utils::parallelizeAllLike(tv2);
+  }
+
+  FusionExecutor fe0;
+  fe0.compileFusion(&fusion0, {t0});
+  FusionExecutor fe1;
+  fe1.compileFusion(&fusion1, {t1});
+
+  HorizontalKernel horizontal_kernel({&fe0, &fe1});
+  const auto& code = horizontal_kernel.kernelString();
+  EXPECT_NE(code.find("__device__ void"), std::string::npos);
+  EXPECT_NE(code.find("k0_T0"), std::string::npos);
+  EXPECT_NE(code.find("k1_T0"), std::string::npos);
+  EXPECT_NE(code.find("block_idx.x"), std::string::npos);
+  EXPECT_EQ(
+      horizontal_kernel.numParameters(),
+      std::vector<size_t>(
+          {codegen::getKernelParameters(fe0.kernel()).size(),
+           codegen::getKernelParameters(fe1.kernel()).size()}));
+
+  for (auto i : c10::irange(2)) {
+    (void)i;
+    std::vector<KernelArgumentHolder> args = {
+        KernelArgumentHolder::createKernelArgumentHolder({t0}),
+        KernelArgumentHolder::createKernelArgumentHolder({t1})};
+    auto outputs = horizontal_kernel.run(
+        args,
+        {LaunchParams(), LaunchParams()},
+        {CompileParams(), CompileParams()});
+    ASSERT_EQ(outputs.size(), 2u);
+    testValidate(&fusion0, outputs[0], {t0}, {t0 * 2}, __LINE__, __FILE__);
+    testValidate(
+        &fusion1, outputs[1], {t1}, {t1.sum({1}) + 1}, __LINE__, __FILE__);
+  }
+  EXPECT_EQ(horizontal_kernel.numPackedLaunches(), 2);
+}
+
+// Kernels with different block sizes can't share a launch, so the pack falls
+// back to launching them one by one
+TEST_F(NVFuserTest, FusionHorizontalKernelMixedBlockSizes_CUDA) {
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({1000}, options);
+  at::Tensor t1 = at::randn({500}, options);
+
+  auto make_fusion = [](Fusion& fusion, int64_t block_size) {
+    FusionGuard fg(&fusion);
+    auto tv0 = makeSymbolicTensor(1);
+    fusion.addInput(tv0);
+    auto tv1 = mul(tv0, IrBuilder::create<Double>(2.0));
+    fusion.addOutput(tv1);
+    tv1->split(0, block_size);
+    tv1->axis(0)->parallelize(ParallelType::BIDx);
+    tv1->axis(1)->parallelize(ParallelType::TIDx);
+  };
+  Fusion fusion0;
+  make_fusion(fusion0, 128);
+  Fusion fusion1;
+  make_fusion(fusion1, 64);
+
+  FusionExecutor fe0;
+  fe0.compileFusion(&fusion0, {t0});
+  FusionExecutor fe1;
+  fe1.compileFusion(&fusion1, {t1});
+
+  HorizontalKernel horizontal_kernel({&fe0, &fe1});
+  std::vector<KernelArgumentHolder> args = {
+      KernelArgumentHolder::createKernelArgumentHolder({t0}),
+      KernelArgumentHolder::createKernelArgumentHolder({t1})};
+  auto outputs = horizontal_kernel.run(
+      args,
+      {LaunchParams(), LaunchParams()},
+      {CompileParams(), CompileParams()});
+  ASSERT_EQ(outputs.size(), 2u);
+  testValidate(&fusion0, outputs[0], {t0}, {t0 * 2}, __LINE__, __FILE__);
+  testValidate(&fusion1, outputs[1], {t1}, {t1 * 2}, __LINE__, __FILE__);
+  EXPECT_EQ(horizontal_kernel.numPackedLaunches(), 0);
+}
+
+// Independent segments of a fusion run through the packed kernels when
+// horizontal fusion is enabled. The two pointwise segments use the same block
+// size, so they are launched with a single kernel.
+TEST_F(NVFuserTest, FusionHorizontalFusionSegments_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  {
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeSymbolicTensor(1);
+    auto tv1 = makeSymbolicTensor(1);
+    fusion->addInput(tv0);
+    fusion->addInput(tv1);
+    auto tv2 = mul(tv0, IrBuilder::create<Double>(2.0));
+    auto tv3 = add(tv1, IrBuilder::create<Double>(1.0));
+    fusion->addOutput(tv2);
+    fusion->addOutput(tv3);
+  }
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({10000}, options);
+  at::Tensor t1 = at::randn({3000}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  fec.setHorizontalFusion(true);
+  for (auto i : c10::irange(3)) {
+    (void)i;
+    auto outputs = fec.runFusionWithInputs({t0, t1});
+    testValidate(
+        fec.fusion(),
+        outputs,
+        {t0, t1},
+        {t0 * 2, t1 + 1},
+        __LINE__,
+        __FILE__);
+  }
+  auto runtime = fec.getMostRecentKernelRuntime();
+  EXPECT_TRUE(runtime->isSegmented());
+  EXPECT_GT(runtime->numHorizontalLaunches(), 0);
+}
+
+} // namespace nvfuser
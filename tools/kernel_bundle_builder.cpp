@@ -0,0 +1,158 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+
+// Generates the kernels of serialized fusion definitions ahead of time and
+// writes them to a kernel bundle, see csrc/kernel_bundle.h.
+//
+// Usage:
+//   nvfuser_kernel_bundle_builder <fusion_cache> <signatures> <bundle_dir>
+//       [--profile <name>]
+//
+// <fusion_cache> is a FusionCache serialized with FusionCache::serialize,
+// e.g., FusionCache.get().serialize() in python. Each line of <signatures>
+// lists the id of a fusion in the cache followed by its inputs. Tensor
+// inputs are given by their sizes, optionally followed by their strides,
+// e.g., 128x1024 or 128x1024:1x128. Scalar inputs are given by their value.
+// Lines starting with # are ignored.
+//
+// The kernels are scheduled for the given built-in device profile, or for
+// the current device if no profile is given. They are only compiled, never
+// launched, and the tensor inputs are proxies that hold no data. Binaries
+// are compiled for the compute capability of the profile, whatever device
+// the builder runs on.
+
+#include <compiled_kernel_cache.h>
+#include <device_profile.h>
+#include <kernel_bundle.h>
+#include <kernel_cache.h>
+#include <python_frontend/fusion_cache.h>
+#include <type.h>
+
+#include <ATen/ATen.h>
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace nvfuser;
+
+namespace {
+
+std::vector<int64_t> parseDims(const std::string& dims) {
+  std::vector<int64_t> result;
+  std::stringstream ss(dims);
+  std::string dim;
+  while (std::getline(ss, dim, 'x')) {
+    result.push_back(std::stoll(dim));
+  }
+  return result;
+}
+
+// Contiguous strides of sizes
+std::vector<int64_t> contiguousStrides(const std::vector<int64_t>& sizes) {
+  std::vector<int64_t> strides(sizes.size());
+  int64_t stride = 1;
+  for (auto i = (int64_t)sizes.size() - 1; i >= 0; i--) {
+    strides[i] = stride;
+    stride *= std::max<int64_t>(sizes[i], 1);
+  }
+  return strides;
+}
+
+KernelArgumentHolder makeArgs(
+    Fusion* fusion,
+    const std::vector<std::string>& tokens) {
+  TORCH_CHECK(
+      tokens.size() == fusion->inputs().size(),
+      "Expected ",
+      fusion->inputs().size(),
+      " inputs but got ",
+      tokens.size());
+
+  KernelArgumentHolder args;
+  args.setDeviceIndex(0);
+  for (const auto i : c10::irange(tokens.size())) {
+    auto input = fusion->inputs().at(i);
+    const auto& token = tokens.at(i);
+    if (auto tv = dynamic_cast<TensorView*>(input)) {
+      const auto colon = token.find(':');
+      const auto sizes = parseDims(token.substr(0, colon));
+      const auto strides = colon == std::string::npos
+          ? contiguousStrides(sizes)
+          : parseDims(token.substr(colon + 1));
+      args.pushTensorProxy(
+          sizes, strides, data_type_to_aten(tv->getDataType().value()));
+    } else if (isIntegralType(input->getDataType().value())) {
+      args.push((int64_t)std::stoll(token));
+    } else if (isBooleanType(input->getDataType().value())) {
+      args.push(c10::IValue(token == "true" || token == "1"));
+    } else {
+      args.push(c10::IValue(std::stod(token)));
+    }
+  }
+  return args;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 4 && !(argc == 6 && std::string(argv[4]) == "--profile")) {
+    std::cerr << "Usage: " << argv[0]
+              << " <fusion_cache> <signatures> <bundle_dir>"
+              << " [--profile <name>]" << std::endl;
+    return 1;
+  }
+  const std::string fusion_cache_file = argv[1];
+  const std::string signatures_file = argv[2];
+  const std::string bundle_dir = argv[3];
+
+  std::optional<DeviceProfileGuard> profile_guard;
+  if (argc == 6) {
+    profile_guard.emplace(DeviceProfile::builtin(argv[5]));
+  }
+  const auto target = currentDeviceProfile();
+  std::cout << "Target device: " << target->toString() << std::endl;
+
+  auto fusion_cache = python_frontend::FusionCache::get();
+  fusion_cache->deserialize(fusion_cache_file);
+
+  CompiledKernelCache::get().setKeepCompiledBinaries(true);
+
+  std::ifstream signatures(signatures_file);
+  TORCH_CHECK(signatures, "Unable to open ", signatures_file);
+  int64_t num_signatures = 0;
+  for (std::string line; std::getline(signatures, line);) {
+    if (line.empty() || line.front() == '#') {
+      continue;
+    }
+    std::stringstream ss(line);
+    size_t fusion_id = 0;
+    ss >> fusion_id;
+    std::vector<std::string> tokens;
+    for (std::string token; ss >> token;) {
+      tokens.push_back(token);
+    }
+
+    auto fec =
+        fusion_cache->queryFusionSchedules(fusion_id)->auto_gen_schedules.get();
+    auto args = makeArgs(fec->fusion(), tokens);
+    // Compiles all segments without launching them
+    fec->compileFusionWithArgs(args);
+    num_signatures++;
+  }
+
+  const auto num_kernels = writeKernelBundle(bundle_dir, *target);
+  std::cout << "Wrote " << num_kernels << " kernels for " << num_signatures
+            << " input signatures to " << bundle_dir << std::endl;
+  return 0;
+}
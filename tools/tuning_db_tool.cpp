@@ -0,0 +1,80 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+
+// Inspects and merges heuristic tuning databases, see
+// csrc/scheduler/tuning_db.h. Does not need a GPU.
+//
+// Usage:
+//   nvfuser_tuning_db_tool show <db>
+//   nvfuser_tuning_db_tool merge <out_db> <db>...
+//
+// show validates a database by loading it and prints its entries. merge
+// loads the given databases in order, so entries of later databases replace
+// the ones of earlier databases for the same key, and saves the result.
+
+#include <device_profile.h>
+#include <scheduler/tuning_db.h>
+
+#include <iostream>
+#include <string>
+
+using namespace nvfuser;
+
+namespace {
+
+int usage(const char* tool) {
+  std::cerr << "Usage: " << tool << " show <db>\n"
+            << "       " << tool << " merge <out_db> <db>..." << std::endl;
+  return 1;
+}
+
+void show(const std::string& file) {
+  auto& db = TuningDatabase::get();
+  db.clear();
+  const auto num_entries = db.load(file);
+  std::cout << file << ": " << num_entries << " entries" << std::endl;
+  for (const auto& [key, params] : db.entries()) {
+    std::cout << "\n" << toString(key.heuristic) << " fusion "
+              << key.fingerprint.hash << " sm_" << key.device_major
+              << key.device_minor << " x" << key.multi_processor_count
+              << " shapes " << key.shape_signature << params->toString()
+              << std::endl;
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    return usage(argv[0]);
+  }
+  const std::string command = argv[1];
+
+  // Launch parameters are validated against the device limits when they
+  // are loaded, which must not require a GPU
+  DeviceProfileGuard profile_guard(DeviceProfile::builtin("h100"));
+
+  if (command == "show" && argc == 3) {
+    show(argv[2]);
+    return 0;
+  }
+  if (command == "merge" && argc >= 4) {
+    auto& db = TuningDatabase::get();
+    db.clear();
+    for (int i = 3; i < argc; i++) {
+      const auto num_entries = db.load(argv[i]);
+      std::cout << "Loaded " << num_entries << " entries from " << argv[i]
+                << std::endl;
+    }
+    db.save(argv[2]);
+    std::cout << "Wrote " << db.stats().entries << " entries to " << argv[2]
+              << std::endl;
+    return 0;
+  }
+  return usage(argv[0]);
+}